@@ -0,0 +1,1087 @@
+// Throughput comparison of ds containers against their std counterparts.
+//
+//   container_bench [--size N] [--reps R] [--filter TEXT] [--json FILE]
+//                   [--perf] [--latency]
+//
+// Every case runs R times; the table and the JSON report show the fastest
+// and the median run in nanoseconds per element operation. Cases that a
+// container does not support yet are reported as skipped.
+//
+// --perf adds hardware counters per operation (cycles, instructions, L1D,
+// LLC and dTLB misses, branch misses, page faults) read with
+// perf_event_open around the timed region of the median run.
+//
+// --latency adds single-operation cases that time every call separately
+// and report p50/p99/p99.9/max, where reallocation and block allocation
+// show up as the tail that per-op means hide.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <queue>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../include/ds/vector.hpp"
+#include "../include/ds/btree_map.hpp"
+#include "../include/ds/deque.hpp"
+#include "../include/ds/flat_hash_map.hpp"
+#include "../include/ds/flat_map.hpp"
+#include "../include/ds/gap_buffer.hpp"
+#include "../include/ds/gather.hpp"
+#include "../include/ds/hive.hpp"
+#include "../include/ds/priority_queue.hpp"
+#include "../include/ds/radix_heap.hpp"
+#include "../include/ds/slot_map.hpp"
+#include "../include/ds/sort.hpp"
+#include "../testing/A.hpp"
+#include "latency_histogram.hpp"
+#include "perf_counters.hpp"
+
+namespace
+{
+    struct pod64
+    {
+        std::uint64_t v[8];
+    };
+
+    template <typename T>
+    T make(std::size_t i);
+
+    template <>
+    int make<int>(std::size_t i) { return int(i); }
+
+    template <>
+    pod64 make<pod64>(std::size_t i)
+    {
+        pod64 p{};
+        p.v[0] = i;
+        return p;
+    }
+
+    template <>
+    A make<A>(std::size_t i) { return A(int(i), float(i)); }
+
+    std::uint64_t key(int x) { return std::uint64_t(x); }
+    std::uint64_t key(const pod64 &x) { return x.v[0]; }
+    std::uint64_t key(const A &x) { return x.i != nullptr ? std::uint64_t(*x.i) : 0; }
+
+    template <typename T>
+    void do_not_optimize(const T &value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    template <typename T>
+    const char *type_name();
+    template <>
+    const char *type_name<int>() { return "int"; }
+    template <>
+    const char *type_name<pod64>() { return "pod64"; }
+    template <>
+    const char *type_name<A>() { return "A"; }
+
+    template <typename C, typename = void>
+    struct has_push_back : std::false_type {};
+    template <typename C>
+    struct has_push_back<C, std::void_t<decltype(std::declval<C &>().push_back(std::declval<typename C::value_type>()))>> : std::true_type {};
+
+    template <typename C, typename = void>
+    struct has_insert : std::false_type {};
+    template <typename C>
+    struct has_insert<C, std::void_t<decltype(std::declval<C &>().insert(std::declval<C &>().begin(), std::declval<typename C::value_type>()))>> : std::true_type {};
+
+    template <typename C, typename = void>
+    struct has_erase : std::false_type {};
+    template <typename C>
+    struct has_erase<C, std::void_t<decltype(std::declval<C &>().erase(std::declval<C &>().begin()))>> : std::true_type {};
+
+    template <typename C, typename = void>
+    struct has_range_erase : std::false_type {};
+    template <typename C>
+    struct has_range_erase<C, std::void_t<decltype(std::declval<C &>().erase(std::declval<C &>().begin(), std::declval<C &>().end()))>> : std::true_type {};
+
+    // remove-erase idiom, or the container's own single pass compaction
+    template <typename C, typename P>
+    void prune(C &_c, P _pred) { _c.erase(std::remove_if(_c.begin(), _c.end(), _pred), _c.end()); }
+    template <typename T, typename P>
+    void prune(ds::vector<T> &_c, P _pred) { ds::erase_if(_c, _pred); }
+    template <typename T, typename P>
+    void prune(ds::hive<T> &_c, P _pred) { ds::erase_if(_c, _pred); }
+
+    // positional cases (middle insert/erase, indexing) need random access
+    template <typename C>
+    struct is_random_access : std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<typename C::iterator>::iterator_category> {};
+
+    template <typename C, typename = void>
+    struct has_pop_front : std::false_type {};
+    template <typename C>
+    struct has_pop_front<C, std::void_t<decltype(std::declval<C &>().pop_front())>> : std::true_type {};
+
+    struct options
+    {
+        std::size_t size = std::size_t(1) << 20;
+        int reps = 5;
+        std::string filter;
+        std::string json;
+        bool perf = false;
+        bool latency = false;
+    };
+
+    struct result
+    {
+        std::string container;
+        std::string type;
+        std::string op;
+        std::size_t ops = 0;
+        double best = 0;
+        double median = 0;
+        bool skipped = false;
+
+        bool hasCounters = false;
+        perf_counters::sample counters{}; // per operation
+
+        bool latency = false;
+        std::uint64_t p50 = 0, p99 = 0, p999 = 0, max = 0;
+    };
+
+    using clock_type = std::chrono::steady_clock;
+
+    std::uint64_t elapsed_ns(clock_type::time_point _start, clock_type::time_point _stop)
+    {
+        return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(_stop - _start).count());
+    }
+
+    // cheapest observed cost of reading the clock, subtracted from latency samples
+    std::uint64_t clock_overhead()
+    {
+        std::uint64_t best = ~std::uint64_t(0);
+
+        for (int i = 0; i < 1000; i++)
+        {
+            auto a = clock_type::now();
+            auto b = clock_type::now();
+            best = std::min(best, elapsed_ns(a, b));
+        }
+
+        return best;
+    }
+
+    // Brackets the timed region of a case; the body does its setup first,
+    // then calls start() and stop() around the work being measured.
+    class probe
+    {
+    public:
+        explicit probe(perf_counters *_counters) : counters(_counters) {}
+
+        void start()
+        {
+            if (counters != nullptr)
+            {
+                counters->start();
+            }
+            begin = clock_type::now();
+        }
+
+        void stop()
+        {
+            ns = double(elapsed_ns(begin, clock_type::now()));
+            if (counters != nullptr)
+            {
+                counts = counters->stop();
+            }
+        }
+
+        double ns = 0;
+        perf_counters::sample counts;
+
+    private:
+        perf_counters *counters;
+        clock_type::time_point begin;
+    };
+
+    class runner
+    {
+    public:
+        explicit runner(const options &_opt) : opt(_opt)
+        {
+            if (opt.perf && !counters.any_available())
+            {
+                std::fprintf(stderr, "perf_event_open is unavailable here; counters will read n/a\n");
+            }
+
+            if (opt.latency)
+            {
+                overhead = clock_overhead();
+            }
+        }
+
+        // throughput case: body(probe&) runs the whole operation batch once
+        template <typename Body>
+        void run(const char *_container, const char *_type, const char *_op, std::size_t _ops, bool _supported, Body &&_body)
+        {
+            result r{_container, _type, _op, _ops};
+
+            if (!selected(r))
+            {
+                return;
+            }
+
+            if (!_supported)
+            {
+                r.skipped = true;
+            }
+            else
+            {
+                std::vector<std::pair<double, perf_counters::sample>> samples;
+
+                for (int i = 0; i < opt.reps; i++)
+                {
+                    probe p(opt.perf ? &counters : nullptr);
+                    _body(p);
+                    samples.emplace_back(p.ns / double(_ops), p.counts);
+                }
+
+                std::sort(samples.begin(), samples.end(), [](const auto &a, const auto &b)
+                          { return a.first < b.first; });
+
+                r.best = samples.front().first;
+                r.median = samples[samples.size() / 2].first;
+
+                if (opt.perf)
+                {
+                    r.hasCounters = true;
+                    r.counters = samples[samples.size() / 2].second;
+
+                    for (double &v : r.counters.value)
+                    {
+                        v /= double(_ops);
+                    }
+                }
+            }
+
+            print(r);
+            results.push_back(r);
+        }
+
+        // latency case, only with --latency: body(record) calls record(start,
+        // stop) once per operation with clock readings taken around it
+        template <typename Body>
+        void run_latency(const char *_container, const char *_type, const char *_op, std::size_t _ops, bool _supported, Body &&_body)
+        {
+            if (!opt.latency)
+            {
+                return;
+            }
+
+            result r{_container, _type, _op, _ops};
+            r.latency = true;
+
+            if (!selected(r))
+            {
+                return;
+            }
+
+            if (!_supported)
+            {
+                r.skipped = true;
+            }
+            else
+            {
+                latency_histogram histogram;
+                const std::uint64_t clockCost = overhead;
+
+                for (int i = 0; i < opt.reps; i++)
+                {
+                    _body([&](clock_type::time_point a, clock_type::time_point b)
+                          {
+                              const std::uint64_t ns = elapsed_ns(a, b);
+                              histogram.record(ns > clockCost ? ns - clockCost : 0); });
+                }
+
+                r.p50 = histogram.percentile(0.50);
+                r.p99 = histogram.percentile(0.99);
+                r.p999 = histogram.percentile(0.999);
+                r.max = histogram.max();
+            }
+
+            print(r);
+            results.push_back(r);
+        }
+
+        void write_json() const
+        {
+            if (opt.json.empty())
+            {
+                return;
+            }
+
+            std::ofstream out(opt.json);
+            out << "{\n  \"context\": {\"compiler\": \"" << __VERSION__ << "\", \"size\": " << opt.size
+                << ", \"reps\": " << opt.reps << ", \"clock_overhead_ns\": " << overhead << "},\n  \"benchmarks\": [\n";
+
+            for (std::size_t i = 0; i < results.size(); i++)
+            {
+                const result &r = results[i];
+                out << "    {\"container\": \"" << r.container << "\", \"type\": \"" << r.type << "\", \"op\": \"" << r.op
+                    << "\", \"ops\": " << r.ops;
+
+                if (r.skipped)
+                {
+                    out << ", \"skipped\": true}";
+                }
+                else if (r.latency)
+                {
+                    out << ", \"latency_ns\": {\"p50\": " << r.p50 << ", \"p99\": " << r.p99 << ", \"p99.9\": " << r.p999
+                        << ", \"max\": " << r.max << "}}";
+                }
+                else
+                {
+                    out << ", \"ns_per_op_min\": " << r.best << ", \"ns_per_op_median\": " << r.median;
+
+                    if (r.hasCounters)
+                    {
+                        out << ", \"counters_per_op\": {";
+                        for (int e = 0; e < perf_counters::event_count; e++)
+                        {
+                            out << (e ? ", " : "") << "\"" << perf_counters::name(e) << "\": ";
+                            if (r.counters.valid[e])
+                            {
+                                out << r.counters.value[e];
+                            }
+                            else
+                            {
+                                out << "null";
+                            }
+                        }
+                        out << "}";
+                    }
+
+                    out << "}";
+                }
+
+                out << (i + 1 < results.size() ? ",\n" : "\n");
+            }
+
+            out << "  ]\n}\n";
+        }
+
+        static void print_header()
+        {
+            std::printf("%-20s %-6s %-14s %10s %12s %12s\n", "container", "type", "op", "ops", "min ns/op", "median ns/op");
+        }
+
+    private:
+        const options &opt;
+        std::vector<result> results;
+        perf_counters counters;
+        std::uint64_t overhead = 0;
+
+        bool selected(const result &r) const
+        {
+            const std::string name = r.container + "/" + r.type + "/" + r.op;
+            return opt.filter.empty() || name.find(opt.filter) != std::string::npos;
+        }
+
+        static void print(const result &r)
+        {
+            if (r.skipped)
+            {
+                std::printf("%-20s %-6s %-14s %10zu %12s %12s\n", r.container.c_str(), r.type.c_str(), r.op.c_str(), r.ops, "skipped", "-");
+            }
+            else if (r.latency)
+            {
+                std::printf("%-20s %-6s %-14s %10zu   p50 %llu ns  p99 %llu ns  p99.9 %llu ns  max %llu ns\n", r.container.c_str(),
+                            r.type.c_str(), r.op.c_str(), r.ops, (unsigned long long)r.p50, (unsigned long long)r.p99,
+                            (unsigned long long)r.p999, (unsigned long long)r.max);
+            }
+            else
+            {
+                std::printf("%-20s %-6s %-14s %10zu %12.2f %12.2f\n", r.container.c_str(), r.type.c_str(), r.op.c_str(), r.ops, r.best, r.median);
+            }
+
+            if (r.hasCounters)
+            {
+                std::printf("%35s", "per op:");
+                for (int e = 0; e < perf_counters::event_count; e++)
+                {
+                    if (r.counters.valid[e])
+                    {
+                        std::printf(" %s %.3f", perf_counters::name(e), r.counters.value[e]);
+                    }
+                    else
+                    {
+                        std::printf(" %s n/a", perf_counters::name(e));
+                    }
+                }
+                std::printf("\n");
+            }
+
+            std::fflush(stdout);
+        }
+    };
+
+    template <typename C>
+    void bench_container(runner &_run, const char *_name, std::size_t n)
+    {
+        using T = typename C::value_type;
+        const char *type = type_name<T>();
+        const std::size_t m = std::max<std::size_t>(1, std::min<std::size_t>(n / 16, 8192));
+
+        _run.run(_name, type, "push_back", n, has_push_back<C>::value, [&](probe &p)
+                 {
+                     if constexpr (has_push_back<C>::value)
+                     {
+                         p.start();
+                         C c;
+                         for (std::size_t i = 0; i < n; i++)
+                         {
+                             c.push_back(make<T>(i));
+                         }
+                         do_not_optimize(c);
+                         p.stop();
+                     } });
+
+        constexpr bool positional = is_random_access<C>::value;
+
+        _run.run(_name, type, "middle_insert", m, has_insert<C>::value && positional, [&](probe &p)
+                 {
+                     if constexpr (has_insert<C>::value && positional)
+                     {
+                         C c(m, make<T>(0));
+                         p.start();
+                         for (std::size_t i = 0; i < m; i++)
+                         {
+                             c.insert(c.begin() + c.size() / 2, make<T>(i));
+                         }
+                         p.stop();
+                         do_not_optimize(c);
+                     } });
+
+        _run.run(_name, type, "middle_erase", m, has_erase<C>::value && positional, [&](probe &p)
+                 {
+                     if constexpr (has_erase<C>::value && positional)
+                     {
+                         C c(2 * m, make<T>(0));
+                         p.start();
+                         for (std::size_t i = 0; i < m; i++)
+                         {
+                             c.erase(c.begin() + c.size() / 2);
+                         }
+                         p.stop();
+                         do_not_optimize(c);
+                     } });
+
+        _run.run(_name, type, "erase_if", n, has_range_erase<C>::value, [&](probe &p)
+                 {
+                     if constexpr (has_range_erase<C>::value)
+                     {
+                         C c(n, make<T>(0));
+                         std::size_t i = 0;
+                         p.start();
+                         prune(c, [&i](const T &)
+                               { return i++ % 2 == 0; });
+                         p.stop();
+                         do_not_optimize(c);
+                     } });
+
+        _run.run(_name, type, "copy", n, true, [&](probe &p)
+                 {
+                     C src(n, make<T>(1));
+                     p.start();
+                     C dst(src);
+                     do_not_optimize(dst);
+                     p.stop(); });
+
+        _run.run(_name, type, "iterate", n, true, [&](probe &p)
+                 {
+                     C c(n, make<T>(1));
+                     p.start();
+                     std::uint64_t sum = 0;
+                     for (const T &x : c)
+                     {
+                         sum += key(x);
+                     }
+                     do_not_optimize(sum);
+                     p.stop(); });
+
+        _run.run(_name, type, "random_access", n, positional, [&](probe &p)
+                 {
+                     if constexpr (positional)
+                     {
+                         C c(n, make<T>(1));
+                         std::vector<std::size_t> index(n);
+                         std::uint64_t x = 88172645463325252ull;
+                         for (std::size_t &i : index)
+                         {
+                             x ^= x << 13;
+                             x ^= x >> 7;
+                             x ^= x << 17;
+                             i = std::size_t(x % n);
+                         }
+                         p.start();
+                         std::uint64_t sum = 0;
+                         for (std::size_t i : index)
+                         {
+                             sum += key(c[i]);
+                         }
+                         do_not_optimize(sum);
+                         p.stop();
+                     } });
+
+        constexpr bool fifo = has_push_back<C>::value && has_pop_front<C>::value;
+
+        _run.run(_name, type, "fifo", n, fifo, [&](probe &p)
+                 {
+                     if constexpr (fifo)
+                     {
+                         const std::size_t window = 1024;
+                         p.start();
+                         C c;
+                         std::uint64_t sum = 0;
+                         for (std::size_t i = 0; i < n; i++)
+                         {
+                             c.push_back(make<T>(i));
+                             if (c.size() > window)
+                             {
+                                 sum += key(c.front());
+                                 c.pop_front();
+                             }
+                         }
+                         do_not_optimize(sum);
+                         p.stop();
+                     } });
+
+        // single operations; the tail comes from vector reallocation and
+        // from deque block allocation at block boundaries
+        _run.run_latency(_name, type, "push_back_lat", n, has_push_back<C>::value, [&](auto &&record)
+                         {
+                             if constexpr (has_push_back<C>::value)
+                             {
+                                 C c;
+                                 for (std::size_t i = 0; i < n; i++)
+                                 {
+                                     T value = make<T>(i);
+                                     auto a = clock_type::now();
+                                     c.push_back(std::move(value));
+                                     auto b = clock_type::now();
+                                     record(a, b);
+                                 }
+                                 do_not_optimize(c);
+                             } });
+
+        _run.run_latency(_name, type, "fifo_lat", n, fifo, [&](auto &&record)
+                         {
+                             if constexpr (fifo)
+                             {
+                                 const std::size_t window = 1024;
+                                 C c;
+                                 for (std::size_t i = 0; i < n; i++)
+                                 {
+                                     T value = make<T>(i);
+                                     auto a = clock_type::now();
+                                     c.push_back(std::move(value));
+                                     if (c.size() > window)
+                                     {
+                                         c.pop_front();
+                                     }
+                                     auto b = clock_type::now();
+                                     record(a, b);
+                                 }
+                                 do_not_optimize(c);
+                             } });
+    }
+
+    // keyed lookups with scattered int keys, the map holding T values
+    template <typename M>
+    void bench_map(runner &_run, const char *_name, std::size_t n)
+    {
+        using T = typename M::mapped_type;
+        const char *type = type_name<T>();
+
+        // distinct keys: odd multiples of a large odd constant, missing keys even
+        std::vector<int> keys(n);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            keys[i] = int((2 * i + 1) * 2654435761u);
+        }
+
+        _run.run(_name, type, "map_insert", n, true, [&](probe &p)
+                 {
+                     p.start();
+                     M m;
+                     for (std::size_t i = 0; i < n; i++)
+                     {
+                         m.try_emplace(keys[i], make<T>(i));
+                     }
+                     do_not_optimize(m);
+                     p.stop(); });
+
+        _run.run(_name, type, "map_find_hit", n, true, [&](probe &p)
+                 {
+                     M m;
+                     for (std::size_t i = 0; i < n; i++)
+                     {
+                         m.try_emplace(keys[i], make<T>(i));
+                     }
+                     p.start();
+                     std::uint64_t sum = 0;
+                     for (std::size_t i = n; i-- > 0;)
+                     {
+                         sum += key(m.find(keys[i])->second);
+                     }
+                     do_not_optimize(sum);
+                     p.stop(); });
+
+        _run.run(_name, type, "map_find_miss", n, true, [&](probe &p)
+                 {
+                     M m;
+                     for (std::size_t i = 0; i < n; i++)
+                     {
+                         m.try_emplace(keys[i], make<T>(i));
+                     }
+                     p.start();
+                     std::size_t found = 0;
+                     for (std::size_t i = 0; i < n; i++)
+                     {
+                         found += m.find(int(2 * i * 2654435761u)) != m.end();
+                     }
+                     do_not_optimize(found);
+                     p.stop(); });
+
+        _run.run(_name, type, "map_erase", n, true, [&](probe &p)
+                 {
+                     M m;
+                     for (std::size_t i = 0; i < n; i++)
+                     {
+                         m.try_emplace(keys[i], make<T>(i));
+                     }
+                     p.start();
+                     for (std::size_t i = 0; i < n; i++)
+                     {
+                         m.erase(keys[i]);
+                     }
+                     p.stop();
+                     do_not_optimize(m); });
+    }
+
+    template <typename M>
+    void build_sorted(M &_m, const std::vector<std::pair<int, typename M::mapped_type>> &_items) { _m.insert(_items.begin(), _items.end()); }
+    template <typename T>
+    void build_sorted(ds::flat_map<int, T> &_m, const std::vector<std::pair<int, T>> &_items) { _m.insert_range(_items.begin(), _items.end()); }
+
+    // build-once, read-many sorted maps: one batched build, then lookups
+    // in scattered order; _indexed adds flat_map's Eytzinger index
+    template <typename M>
+    void bench_sorted_map(runner &_run, const char *_name, std::size_t n, bool _indexed = false)
+    {
+        using T = typename M::mapped_type;
+        const char *type = type_name<T>();
+
+        std::vector<std::pair<int, T>> items;
+        std::vector<int> probes(n);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            items.emplace_back(int((2 * i + 1) * 2654435761u), make<T>(i));
+        }
+
+        // every key once, in random order
+        std::uint64_t x = 88172645463325252ull;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            probes[i] = items[i].first;
+        }
+        for (std::size_t i = n; i > 1; i--)
+        {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            std::swap(probes[i - 1], probes[x % i]);
+        }
+
+        _run.run(_name, type, "sorted_build", n, true, [&](probe &p)
+                 {
+                     p.start();
+                     M m;
+                     build_sorted(m, items);
+                     do_not_optimize(m);
+                     p.stop(); });
+
+        _run.run(_name, type, "sorted_find", n, true, [&](probe &p)
+                 {
+                     M m;
+                     build_sorted(m, items);
+                     if constexpr (std::is_same_v<M, ds::flat_map<int, T>>)
+                     {
+                         if (_indexed)
+                         {
+                             m.build_search_index();
+                         }
+                     }
+                     p.start();
+                     std::uint64_t sum = 0;
+                     for (int k : probes)
+                     {
+                         sum += key(m.find(k)->second);
+                     }
+                     do_not_optimize(sum);
+                     p.stop(); });
+
+        // short ordered scans from scattered starting points
+        constexpr std::size_t scan = 64;
+        _run.run(_name, type, "range_scan", n, true, [&](probe &p)
+                 {
+                     M m;
+                     build_sorted(m, items);
+                     p.start();
+                     std::uint64_t sum = 0;
+                     for (std::size_t i = 0; i < n / scan; i++)
+                     {
+                         auto it = m.lower_bound(probes[i]);
+                         for (std::size_t j = 0; j < scan && it != m.end(); j++, ++it)
+                         {
+                             sum += key(it->second);
+                         }
+                     }
+                     do_not_optimize(sum);
+                     p.stop(); });
+    }
+
+    // handle-addressed storage: insert, lookups in scattered order, erase
+    template <typename T>
+    void bench_slot_map(runner &_run, const char *_name, std::size_t n)
+    {
+        const char *type = type_name<T>();
+
+        std::vector<std::size_t> order(n);
+        std::uint64_t x = 88172645463325252ull;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            order[i] = i;
+        }
+        for (std::size_t i = n; i > 1; i--)
+        {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            std::swap(order[i - 1], order[x % i]);
+        }
+
+        std::vector<ds::slot_key> keys(n);
+
+        _run.run(_name, type, "handle_insert", n, true, [&](probe &p)
+                 {
+                     p.start();
+                     ds::slot_map<T> m;
+                     for (std::size_t i = 0; i < n; i++)
+                     {
+                         keys[i] = m.emplace(make<T>(i));
+                     }
+                     do_not_optimize(m);
+                     p.stop(); });
+
+        _run.run(_name, type, "handle_get", n, true, [&](probe &p)
+                 {
+                     ds::slot_map<T> m;
+                     for (std::size_t i = 0; i < n; i++)
+                     {
+                         keys[i] = m.emplace(make<T>(i));
+                     }
+                     p.start();
+                     std::uint64_t sum = 0;
+                     for (std::size_t i : order)
+                     {
+                         sum += key(*m.get(keys[i]));
+                     }
+                     do_not_optimize(sum);
+                     p.stop(); });
+
+        _run.run(_name, type, "handle_erase", n, true, [&](probe &p)
+                 {
+                     ds::slot_map<T> m;
+                     for (std::size_t i = 0; i < n; i++)
+                     {
+                         keys[i] = m.emplace(make<T>(i));
+                     }
+                     p.start();
+                     for (std::size_t i : order)
+                     {
+                         m.erase(keys[i]);
+                     }
+                     p.stop();
+                     do_not_optimize(m); });
+    }
+
+    // min-heaps of (key, T) ordered on the key alone
+    struct key_greater
+    {
+        template <typename P>
+        bool operator()(const P &_a, const P &_b) const { return _a.first > _b.first; }
+    };
+
+    template <typename T>
+    using std_heap = std::priority_queue<std::pair<std::uint32_t, T>, std::vector<std::pair<std::uint32_t, T>>, key_greater>;
+    template <typename T, std::size_t Arity>
+    using ds_heap = ds::priority_queue<std::pair<std::uint32_t, T>, key_greater, Arity>;
+
+    // all pushes then all pops, and a Dijkstra-like steady state where
+    // each pop pushes a later key
+    template <typename Q>
+    void bench_heap(runner &_run, const char *_name, std::size_t n)
+    {
+        using T = typename Q::value_type::second_type;
+        const char *type = type_name<T>();
+
+        std::vector<std::uint32_t> keys(n);
+        std::uint64_t x = 88172645463325252ull;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            keys[i] = std::uint32_t(x >> 40);
+        }
+
+        _run.run(_name, type, "heap_push_pop", n, true, [&](probe &p)
+                 {
+                     p.start();
+                     Q q;
+                     for (std::size_t i = 0; i < n; i++)
+                     {
+                         q.emplace(keys[i], make<T>(i));
+                     }
+                     std::uint64_t sum = 0;
+                     while (!q.empty())
+                     {
+                         sum += key(q.top().second);
+                         q.pop();
+                     }
+                     do_not_optimize(sum);
+                     p.stop(); });
+
+        _run.run(_name, type, "heap_monotone", n, true, [&](probe &p)
+                 {
+                     Q q;
+                     for (std::size_t i = 0; i < n / 16 + 1; i++)
+                     {
+                         q.emplace(keys[i] & 0xffff, make<T>(i));
+                     }
+                     p.start();
+                     for (std::size_t i = 0; i < n; i++)
+                     {
+                         const std::uint32_t next = q.top().first + (keys[i] & 0x3ff);
+                         q.pop();
+                         q.emplace(next, make<T>(i));
+                     }
+                     do_not_optimize(q);
+                     p.stop(); });
+    }
+
+    // ds::sort against std::sort on the same ds::vector; ints take the
+    // radix path, the others pdqsort through a comparator on their key
+    template <typename T>
+    void bench_sort(runner &_run, std::size_t n)
+    {
+        const char *type = type_name<T>();
+
+        std::vector<T> random;
+        std::vector<T> nearly;
+        std::uint64_t x = 88172645463325252ull;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            random.push_back(make<T>(std::size_t(x >> 33)));
+            nearly.push_back(make<T>(i % 64 == 0 ? std::size_t(x >> 33) : i));
+        }
+
+        const auto sorter = [&](const char *_name, const char *_op, const std::vector<T> &_input, auto _sort)
+        {
+            _run.run(_name, type, _op, n, true, [&](probe &p)
+                     {
+                         ds::vector<T> v;
+                         v.reserve(n);
+                         for (const T &e : _input)
+                         {
+                             v.push_back(e);
+                         }
+                         p.start();
+                         _sort(v);
+                         p.stop();
+                         do_not_optimize(v); });
+        };
+
+        const auto ds_sort = [](ds::vector<T> &_v)
+        {
+            if constexpr (std::is_same_v<T, int>)
+            {
+                ds::sort(_v);
+            }
+            else
+            {
+                ds::sort(_v, [](const T &_a, const T &_b) { return key(_a) < key(_b); });
+            }
+        };
+        const auto std_sort = [](ds::vector<T> &_v)
+        {
+            std::sort(_v.begin(), _v.end(), [](const T &_a, const T &_b) { return key(_a) < key(_b); });
+        };
+
+        sorter("ds::sort", "sort_random", random, ds_sort);
+        sorter("std::sort", "sort_random", random, std_sort);
+        sorter("ds::sort", "sort_nearly_sorted", nearly, ds_sort);
+        sorter("std::sort", "sort_nearly_sorted", nearly, std_sort);
+    }
+
+    // n lookups at random indices into an n element table, one indexed
+    // load at a time against ds::gather's prefetching batch
+    template <typename C>
+    void bench_gather(runner &_run, const char *_name, std::size_t n)
+    {
+        using T = typename C::value_type;
+        const char *type = type_name<T>();
+
+        C table(n);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            table[i] = make<T>(i);
+        }
+
+        ds::vector<std::uint32_t> indices;
+        std::uint64_t x = 88172645463325252ull;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            indices.push_back(std::uint32_t(x % n));
+        }
+
+        std::vector<T> out(n);
+
+        _run.run(_name, type, "index_loop", n, true, [&](probe &p)
+                 {
+                     p.start();
+                     for (std::size_t i = 0; i < n; i++)
+                     {
+                         out[i] = table[indices[i]];
+                     }
+                     p.stop();
+                     do_not_optimize(out); });
+
+        _run.run(_name, type, "gather", n, true, [&](probe &p)
+                 {
+                     p.start();
+                     ds::gather(table, indices, out.begin());
+                     p.stop();
+                     do_not_optimize(out); });
+    }
+
+    template <typename T>
+    void bench_type(runner &_run, std::size_t n)
+    {
+        bench_container<ds::vector<T>>(_run, "ds::vector", n);
+        bench_container<std::vector<T>>(_run, "std::vector", n);
+        bench_container<ds::deque<T>>(_run, "ds::deque", n);
+        bench_container<std::deque<T>>(_run, "std::deque", n);
+        bench_container<ds::gap_buffer<T>>(_run, "ds::gap_buffer", n);
+        bench_container<ds::hive<T>>(_run, "ds::hive", n);
+        bench_map<ds::flat_hash_map<int, T>>(_run, "ds::flat_hash_map", n);
+        bench_map<std::unordered_map<int, T>>(_run, "std::unordered_map", n);
+        bench_map<ds::btree_map<int, T>>(_run, "ds::btree_map", n);
+        bench_map<std::map<int, T>>(_run, "std::map", n);
+        bench_slot_map<T>(_run, "ds::slot_map", n);
+        bench_heap<ds_heap<T, 4>>(_run, "ds::priority_queue", n);
+        bench_heap<ds_heap<T, 2>>(_run, "ds::priority_queue/2", n);
+        bench_heap<std_heap<T>>(_run, "std::priority_queue", n);
+        bench_heap<ds::radix_heap<std::uint32_t, T>>(_run, "ds::radix_heap", n);
+        bench_sort<T>(_run, n);
+        bench_gather<ds::vector<T>>(_run, "ds::vector", n);
+        bench_gather<ds::deque<T>>(_run, "ds::deque", n);
+        bench_sorted_map<ds::flat_map<int, T>>(_run, "ds::flat_map", n);
+        bench_sorted_map<ds::flat_map<int, T>>(_run, "ds::flat_map/eytz", n, true);
+        bench_sorted_map<ds::btree_map<int, T>>(_run, "ds::btree_map", n);
+        bench_sorted_map<std::map<int, T>>(_run, "std::map", n);
+    }
+
+    void usage(const char *argv0)
+    {
+        std::fprintf(stderr, "usage: %s [--size N] [--reps R] [--filter TEXT] [--json FILE] [--perf] [--latency]\n", argv0);
+        std::exit(2);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    options opt;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+
+        if (arg == "--perf")
+        {
+            opt.perf = true;
+            continue;
+        }
+
+        if (arg == "--latency")
+        {
+            opt.latency = true;
+            continue;
+        }
+
+        if (i + 1 >= argc)
+        {
+            usage(argv[0]);
+        }
+
+        if (arg == "--size")
+        {
+            opt.size = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--reps")
+        {
+            opt.reps = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--filter")
+        {
+            opt.filter = argv[++i];
+        }
+        else if (arg == "--json")
+        {
+            opt.json = argv[++i];
+        }
+        else
+        {
+            usage(argv[0]);
+        }
+    }
+
+    if (opt.size == 0)
+    {
+        usage(argv[0]);
+    }
+
+    runner run(opt);
+    runner::print_header();
+
+    bench_type<int>(run, opt.size);
+    bench_type<pod64>(run, opt.size);
+    bench_type<A>(run, opt.size);
+
+    run.write_json();
+
+    return 0;
+}
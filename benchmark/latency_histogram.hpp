@@ -0,0 +1,90 @@
+#pragma once
+
+// Log-linear latency histogram in the style of HdrHistogram: every power of
+// two is split into 32 linear sub-buckets, so any recorded value is within
+// about 3% of its bucket and recording is a few shifts and an increment.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class latency_histogram
+{
+public:
+    latency_histogram() : counts(64 * SUB_BUCKETS, 0) {}
+
+    void record(std::uint64_t _value)
+    {
+        counts[index(_value)]++;
+        total++;
+        if (_value > maximum)
+        {
+            maximum = _value;
+        }
+    }
+
+    std::uint64_t count() const { return total; }
+    std::uint64_t max() const { return maximum; }
+
+    // smallest bucket value at or above fraction _q of all samples
+    std::uint64_t percentile(double _q) const
+    {
+        if (total == 0)
+        {
+            return 0;
+        }
+
+        std::uint64_t rank = std::uint64_t(_q * double(total));
+        if (rank >= total)
+        {
+            rank = total - 1;
+        }
+
+        std::uint64_t seen = 0;
+
+        for (std::size_t i = 0; i < counts.size(); i++)
+        {
+            seen += counts[i];
+
+            if (seen > rank)
+            {
+                std::uint64_t v = upper(i);
+                return v < maximum ? v : maximum;
+            }
+        }
+
+        return maximum;
+    }
+
+private:
+    static constexpr unsigned SUB_BITS = 5;
+    static constexpr std::uint64_t SUB_BUCKETS = std::uint64_t(1) << SUB_BITS;
+
+    std::vector<std::uint64_t> counts;
+    std::uint64_t total = 0;
+    std::uint64_t maximum = 0;
+
+    static std::size_t index(std::uint64_t _v)
+    {
+        if (_v < SUB_BUCKETS)
+        {
+            return std::size_t(_v);
+        }
+
+        const unsigned magnitude = 63 - unsigned(__builtin_clzll(_v));
+        const unsigned shift = magnitude - SUB_BITS;
+        return std::size_t((shift + 1) * SUB_BUCKETS + ((_v >> shift) - SUB_BUCKETS));
+    }
+
+    static std::uint64_t upper(std::size_t _i)
+    {
+        if (_i < SUB_BUCKETS)
+        {
+            return _i;
+        }
+
+        const unsigned shift = unsigned(_i / SUB_BUCKETS) - 1;
+        const std::uint64_t sub = _i % SUB_BUCKETS + SUB_BUCKETS;
+        return ((sub + 1) << shift) - 1;
+    }
+};
@@ -0,0 +1,152 @@
+#pragma once
+
+// Per-thread hardware counters through Linux perf_event_open. Each event is
+// opened on its own so a host that lacks one (virtual machines often expose
+// no PMU) still reports the rest; missing events read as unavailable.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+class perf_counters
+{
+public:
+    enum event
+    {
+        cycles,
+        instructions,
+        l1d_misses,
+        llc_misses,
+        dtlb_misses,
+        branch_misses,
+        page_faults,
+        event_count
+    };
+
+    struct sample
+    {
+        double value[event_count] = {};
+        bool valid[event_count] = {};
+    };
+
+    static const char *name(int _e)
+    {
+        static const char *const names[event_count] = {"cycles", "instructions", "l1d_misses", "llc_misses",
+                                                       "dtlb_misses", "branch_misses", "page_faults"};
+        return names[_e];
+    }
+
+    perf_counters()
+    {
+#ifdef __linux__
+        const std::uint64_t cache_read_miss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+        fd[cycles] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        fd[instructions] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        fd[l1d_misses] = open(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | cache_read_miss);
+        fd[llc_misses] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        fd[dtlb_misses] = open(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | cache_read_miss);
+        fd[branch_misses] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        fd[page_faults] = open(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+#endif
+    }
+
+    ~perf_counters()
+    {
+#ifdef __linux__
+        for (int f : fd)
+        {
+            if (f != -1)
+            {
+                ::close(f);
+            }
+        }
+#endif
+    }
+
+    perf_counters(const perf_counters &) = delete;
+    perf_counters &operator=(const perf_counters &) = delete;
+
+    bool any_available() const
+    {
+        for (int f : fd)
+        {
+            if (f != -1)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void start()
+    {
+#ifdef __linux__
+        for (int f : fd)
+        {
+            if (f != -1)
+            {
+                ::ioctl(f, PERF_EVENT_IOC_RESET, 0);
+                ::ioctl(f, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    // stops counting and returns the counts, scaled up when the kernel had
+    // to multiplex an event
+    sample stop()
+    {
+        sample s;
+#ifdef __linux__
+        for (int f : fd)
+        {
+            if (f != -1)
+            {
+                ::ioctl(f, PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+
+        for (int e = 0; e < event_count; e++)
+        {
+            std::uint64_t buf[3];
+
+            if (fd[e] == -1 || ::read(fd[e], buf, sizeof(buf)) != sizeof(buf) || buf[2] == 0)
+            {
+                continue;
+            }
+
+            s.value[e] = double(buf[0]) * double(buf[1]) / double(buf[2]);
+            s.valid[e] = true;
+        }
+#endif
+        return s;
+    }
+
+private:
+    int fd[event_count] = {-1, -1, -1, -1, -1, -1, -1};
+
+#ifdef __linux__
+    static int open(std::uint32_t _type, std::uint64_t _config)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = _type;
+        attr.config = _config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        return int(::syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+#endif
+};
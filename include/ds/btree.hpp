@@ -0,0 +1,990 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "btree_iterator.hpp"
+#include "key_arg.hpp"
+#include "memory.hpp"
+#include "node_pool.hpp"
+
+namespace ds
+{
+    namespace detail
+    {
+        // bytes of keys per B+tree node, four cache lines; the slot count is
+        // clamped to [4, 64]
+        inline constexpr std::size_t BTREE_NODE_BYTES = 256;
+
+        template <typename Key>
+        constexpr std::size_t btree_node_slots()
+        {
+            constexpr std::size_t slots = BTREE_NODE_BYTES / sizeof(Key);
+            return slots < 4 ? 4 : (slots > 64 ? 64 : slots);
+        }
+
+        // moves _count objects from _from to _to and destroys the sources;
+        // the ranges may overlap
+        template <typename T>
+        void btree_relocate(T *_to, T *_from, std::size_t _count)
+        {
+            if constexpr (std::is_trivially_copyable_v<T>)
+            {
+                if (_count != 0)
+                {
+                    std::memmove(static_cast<void *>(_to), static_cast<const void *>(_from), _count * sizeof(T));
+                }
+            }
+            else if (std::less<T *>()(_to, _from))
+            {
+                for (std::size_t i = 0; i < _count; i++)
+                {
+                    detail::construct_at(_to + i, std::move(_from[i]));
+                    _from[i].~T();
+                }
+            }
+            else
+            {
+                for (std::size_t i = _count; i-- > 0;)
+                {
+                    detail::construct_at(_to + i, std::move(_from[i]));
+                    _from[i].~T();
+                }
+            }
+        }
+
+        template <typename Key, std::size_t N>
+        struct btree_inner;
+
+        // Fields shared by leaves and inner nodes. The keys of a node sit in
+        // one array, so the search inside a node walks contiguous memory.
+        template <typename Key, std::size_t N>
+        struct btree_node
+        {
+            btree_inner<Key, N> *parent = nullptr;
+            std::uint16_t count = 0; // keys in use
+            bool leaf;
+            alignas(Key) unsigned char keyBytes[N * sizeof(Key)];
+
+            explicit btree_node(bool _leaf) : leaf(_leaf) {}
+
+            Key *keys() { return reinterpret_cast<Key *>(keyBytes); }
+            const Key *keys() const { return reinterpret_cast<const Key *>(keyBytes); }
+        };
+
+        // count separator keys and count + 1 children; every key in
+        // children[i] is less than keys[i], and every key in children[i + 1]
+        // is not
+        template <typename Key, std::size_t N>
+        struct btree_inner : btree_node<Key, N>
+        {
+            btree_node<Key, N> *children[N + 1];
+
+            btree_inner() : btree_node<Key, N>(false) {}
+        };
+
+        // a map leaf's values, parallel to its keys; sets have none
+        template <typename Mapped, std::size_t N>
+        struct btree_values
+        {
+            alignas(Mapped) unsigned char valueBytes[N * sizeof(Mapped)];
+
+            Mapped *values() { return reinterpret_cast<Mapped *>(valueBytes); }
+        };
+
+        template <std::size_t N>
+        struct btree_values<void, N>
+        {
+        };
+
+        template <typename Key, typename Mapped>
+        struct btree_types
+        {
+            using value_type = std::pair<Key, Mapped>;
+            template <bool Const>
+            using reference = std::pair<const Key &, std::conditional_t<Const, const Mapped &, Mapped &>>;
+        };
+
+        template <typename Key>
+        struct btree_types<Key, void>
+        {
+            using value_type = Key;
+            template <bool Const>
+            using reference = const Key &;
+        };
+
+        // the elements, linked to the neighbouring leaves for range scans
+        template <typename Key, typename Mapped, std::size_t N>
+        struct btree_leaf : btree_node<Key, N>, btree_values<Mapped, N>
+        {
+            using value_type = typename btree_types<Key, Mapped>::value_type;
+            template <bool Const>
+            using reference = typename btree_types<Key, Mapped>::template reference<Const>;
+
+            btree_leaf *prev = nullptr;
+            btree_leaf *next = nullptr;
+
+            btree_leaf() : btree_node<Key, N>(true) {}
+
+            template <bool Const>
+            reference<Const> get(std::size_t _index)
+            {
+                if constexpr (std::is_void_v<Mapped>)
+                {
+                    return this->keys()[_index];
+                }
+                else
+                {
+                    return reference<Const>(this->keys()[_index], this->values()[_index]);
+                }
+            }
+        };
+
+        // B+tree behind btree_map and btree_set (Mapped = void). Elements
+        // live only in the leaves; inner nodes hold copies of keys to route
+        // searches. Nodes come from a node_pool, one for leaves and one for
+        // inner nodes. Elements are moved between slots on insert and erase,
+        // which invalidates iterators, so Key and Mapped should have
+        // non-throwing moves.
+        template <typename Key, typename Mapped, typename Compare>
+        class btree
+        {
+        public:
+            using key_type = Key;
+            using value_type = typename btree_types<Key, Mapped>::value_type;
+            using size_type = std::size_t;
+            using key_compare = Compare;
+
+            // slots per node
+            static constexpr size_type node_slots = btree_node_slots<Key>();
+
+        protected:
+            using node = btree_node<Key, node_slots>;
+            using inner = btree_inner<Key, node_slots>;
+            using leaf = btree_leaf<Key, Mapped, node_slots>;
+
+        public:
+            using iterator = BTreeIterator<leaf, std::is_void_v<Mapped>>;
+            using const_iterator = BTreeIterator<leaf, true>;
+
+            template <typename K>
+            using key_arg = typename key_arg_impl<is_transparent<Compare>::value>::template type<K, key_type>;
+
+            // constructors
+            btree() = default;
+            explicit btree(const Compare &_comp) : comp(_comp) {}
+            btree(const btree &_other);
+            btree(btree &&_temp) noexcept : comp(_temp.comp) { swap(_temp); }
+
+            // destructors
+            ~btree() noexcept { destroyElements(); }
+
+            // operator=
+            btree &operator=(const btree &_other);
+            btree &operator=(btree &&_other) noexcept;
+
+            // iterators
+            iterator begin() { return iterator(first, 0); }
+            const_iterator begin() const { return const_iterator(first, 0); }
+
+            iterator end() { return iterator(last, last != nullptr ? last->count : 0); }
+            const_iterator end() const { return const_iterator(last, last != nullptr ? last->count : 0); }
+
+            const_iterator cbegin() const { return begin(); }
+            const_iterator cend() const { return end(); }
+
+            // capacity
+            size_type size() const { return elementCount; }
+            bool empty() const { return elementCount == 0; }
+
+            // levels from the root to the leaves, 0 when empty
+            size_type height() const;
+
+            // lookup; with a transparent Compare the key may be any type it accepts
+            template <typename K = key_type>
+            iterator find(const key_arg<K> &_key);
+            template <typename K = key_type>
+            const_iterator find(const key_arg<K> &_key) const { return const_cast<btree *>(this)->find(_key); }
+
+            template <typename K = key_type>
+            bool contains(const key_arg<K> &_key) const { return find(_key) != end(); }
+            template <typename K = key_type>
+            size_type count(const key_arg<K> &_key) const { return contains(_key) ? 1 : 0; }
+
+            template <typename K = key_type>
+            iterator lower_bound(const key_arg<K> &_key);
+            template <typename K = key_type>
+            const_iterator lower_bound(const key_arg<K> &_key) const { return const_cast<btree *>(this)->lower_bound(_key); }
+
+            template <typename K = key_type>
+            iterator upper_bound(const key_arg<K> &_key);
+            template <typename K = key_type>
+            const_iterator upper_bound(const key_arg<K> &_key) const { return const_cast<btree *>(this)->upper_bound(_key); }
+
+            template <typename K = key_type>
+            std::pair<iterator, iterator> equal_range(const key_arg<K> &_key) { return {lower_bound(_key), upper_bound(_key)}; }
+            template <typename K = key_type>
+            std::pair<const_iterator, const_iterator> equal_range(const key_arg<K> &_key) const { return {lower_bound(_key), upper_bound(_key)}; }
+
+            // modifiers; keys arriving in ascending order skip the descent
+            // and fill the leaves almost completely
+            std::pair<iterator, bool> insert(const value_type &_value);
+            std::pair<iterator, bool> insert(value_type &&_value);
+            void insert(std::initializer_list<value_type> _list) { insert(_list.begin(), _list.end()); }
+
+            template <typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+            void insert(InputIt _first, InputIt _last);
+
+            // returns the iterator following the erased element(s)
+            iterator erase(const_iterator _position) { return eraseAt(_position.leaf, _position.index); }
+            iterator erase(const_iterator _first, const_iterator _last);
+
+            template <typename K = key_type>
+            size_type erase(const key_arg<K> &_key);
+
+            // keeps the node storage for the next inserts
+            void clear() noexcept;
+            void swap(btree &_other) noexcept;
+
+            // observers
+            key_compare key_comp() const { return comp; }
+
+        protected:
+            // builds the element from _key and args only when _key is new
+            template <typename K, typename... Args>
+            std::pair<iterator, bool> emplaceKey(K &&_key, Args &&...args);
+
+        private:
+            // a node at the minimum may not give a slot away; below it, it
+            // takes one from a neighbour or merges with it
+            static constexpr size_type minSlots = node_slots / 2;
+
+            // arithmetic keys under std::less are searched by counting the
+            // smaller keys, which compiles to branch-free SIMD compares
+            template <typename K>
+            static constexpr bool countingSearch = std::is_arithmetic_v<Key> && std::is_arithmetic_v<K> &&
+                                                   (std::is_same_v<Compare, std::less<Key>> || std::is_same_v<Compare, std::less<>>);
+
+            node_pool<leaf> leafPool;
+            node_pool<inner> innerPool;
+            node *root = nullptr;
+            leaf *first = nullptr; // leftmost leaf, begin()
+            leaf *last = nullptr;  // rightmost leaf, end()
+            size_type elementCount = 0;
+            Compare comp;
+
+            template <typename K>
+            size_type lowerPos(const node *_node, const K &_key) const;
+            template <typename K>
+            size_type upperPos(const node *_node, const K &_key) const;
+
+            template <typename K>
+            leaf *findLeaf(const K &_key) const;
+
+            iterator normalized(leaf *_leaf, size_type _index);
+
+            static size_type childIndex(const inner *_parent, const node *_child);
+
+            leaf *splitLeaf(leaf *_leaf, size_type _index);
+            void splitInner(inner *_node, bool _append);
+            void insertChild(node *_left, Key &&_separator, node *_right, bool _append);
+
+            iterator eraseAt(leaf *_leaf, size_type _index);
+            void rebalanceLeaf(leaf *&_leaf, size_type &_index);
+            void rebalanceInner(inner *_node);
+            void mergeInner(inner *_into, size_type _separator, inner *_from);
+            void removeChild(inner *_parent, size_type _separator);
+            void unlinkLeaf(leaf *_leaf);
+
+            void destroyNode(node *_node) noexcept;
+            void destroyElements() noexcept;
+        };
+
+        template <typename Key, typename Mapped, typename Compare>
+        btree<Key, Mapped, Compare>::btree(const btree &_other) : comp(_other.comp)
+        {
+            // appending in order is linear and packs the leaves
+            for (leaf *l = _other.first; l != nullptr; l = l->next)
+            {
+                for (size_type i = 0; i < l->count; i++)
+                {
+                    if constexpr (std::is_void_v<Mapped>)
+                    {
+                        emplaceKey(l->keys()[i]);
+                    }
+                    else
+                    {
+                        emplaceKey(l->keys()[i], l->values()[i]);
+                    }
+                }
+            }
+        }
+
+        template <typename Key, typename Mapped, typename Compare>
+        btree<Key, Mapped, Compare> &btree<Key, Mapped, Compare>::operator=(const btree &_other)
+        {
+            if (this != &_other)
+            {
+                btree(_other).swap(*this);
+            }
+            return *this;
+        }
+
+        template <typename Key, typename Mapped, typename Compare>
+        btree<Key, Mapped, Compare> &btree<Key, Mapped, Compare>::operator=(btree &&_other) noexcept
+        {
+            if (this != &_other)
+            {
+                btree(std::move(_other)).swap(*this);
+            }
+            return *this;
+        }
+
+        template <typename Key, typename Mapped, typename Compare>
+        typename btree<Key, Mapped, Compare>::size_type btree<Key, Mapped, Compare>::height() const
+        {
+            size_type levels = 0;
+            for (const node *n = root; n != nullptr; n = n->leaf ? nullptr : static_cast<const inner *>(n)->children[0])
+            {
+                levels++;
+            }
+            return levels;
+        }
+
+        template <typename Key, typename Mapped, typename Compare>
+        template <typename K>
+        typename btree<Key, Mapped, Compare>::size_type btree<Key, Mapped, Compare>::lowerPos(const node *_node, const K &_key) const
+        {
+            const Key *keys = _node->keys();
+            if constexpr (countingSearch<K>)
+            {
+                size_type below = 0;
+                for (size_type i = 0; i < _node->count; i++)
+                {
+                    below += comp(keys[i], _key) ? 1 : 0;
+                }
+                return below;
+            }
+            else
+            {
+                return size_type(std::lower_bound(keys, keys + _node->count, _key, comp) - keys);
+            }
+        }
+
+        template <typename Key, typename Mapped, typename Compare>
+        template <typename K>
+        typename btree<Key, Mapped, Compare>::size_type btree<Key, Mapped, Compare>::upperPos(const node *_node, const K &_key) const
+        {
+            const Key *keys = _node->keys();
+            if constexpr (countingSearch<K>)
+            {
+                size_type notAbove = 0;
+                for (size_type i = 0; i < _node->count; i++)
+                {
+                    notAbove += comp(_key, keys[i]) ? 0 : 1;
+                }
+                return notAbove;
+            }
+            else
+            {
+                return size_type(std::upper_bound(keys, keys + _node->count, _key, comp) - keys);
+            }
+        }
+
+        // the leaf whose range holds _key; the tree must not be empty
+        template <typename Key, typename Mapped, typename Compare>
+        template <typename K>
+        typename btree<Key, Mapped, Compare>::leaf *btree<Key, Mapped, Compare>::findLeaf(const K &_key) const
+        {
+            node *n = root;
+            while (!n->leaf)
+            {
+                n = static_cast<inner *>(n)->children[upperPos(n, _key)];
+            }
+            return static_cast<leaf *>(n);
+        }
+
+        // one past a leaf's last element is the next leaf's first
+        template <typename Key, typename Mapped, typename Compare>
+        typename btree<Key, Mapped, Compare>::iterator btree<Key, Mapped, Compare>::normalized(leaf *_leaf, size_type _index)
+        {
+            if (_index == _leaf->count && _leaf->next != nullptr)
+            {
+                return iterator(_leaf->next, 0);
+            }
+            return iterator(_leaf, _index);
+        }
+
+        template <typename Key, typename Mapped, typename Compare>
+        typename btree<Key, Mapped, Compare>::size_type btree<Key, Mapped, Compare>::childIndex(const inner *_parent, const node *_child)
+        {
+            size_type i = 0;
+            while (_parent->children[i] != _child)
+            {
+                i++;
+            }
+            return i;
+        }
+
+        template <typename Key, typename Mapped, typename Compare>
+        template <typename K>
+        typename btree<Key, Mapped, Compare>::iterator btree<Key, Mapped, Compare>::find(const key_arg<K> &_key)
+        {
+            if (root == nullptr)
+            {
+                return end();
+            }
+
+            // a key past this leaf's last is below the next leaf's separator
+            leaf *l = findLeaf(_key);
+            const size_type i = lowerPos(l, _key);
+            return i != l->count && !comp(_key, l->keys()[i]) ? iterator(l, i) : end();
+        }
+
+        template <typename Key, typename Mapped, typename Compare>
+        template <typename K>
+        typename btree<Key, Mapped, Compare>::iterator btree<Key, Mapped, Compare>::lower_bound(const key_arg<K> &_key)
+        {
+            if (root == nullptr)
+            {
+                return end();
+            }
+
+            leaf *l = findLeaf(_key);
+            return normalized(l, lowerPos(l, _key));
+        }
+
+        template <typename Key, typename Mapped, typename Compare>
+        template <typename K>
+        typename btree<Key, Mapped, Compare>::iterator btree<Key, Mapped, Compare>::upper_bound(const key_arg<K> &_key)
+        {
+            if (root == nullptr)
+            {
+                return end();
+            }
+
+            leaf *l = findLeaf(_key);
+            return normalized(l, upperPos(l, _key));
+        }
+
+        template <typename Key, typename Mapped, typename Compare>
+        std::pair<typename btree<Key, Mapped, Compare>::iterator, bool> btree<Key, Mapped, Compare>::insert(const value_type &_value)
+        {
+            if constexpr (std::is_void_v<Mapped>)
+            {
+                return emplaceKey(_value);
+            }
+            else
+            {
+                return emplaceKey(_value.first, _value.second);
+            }
+        }
+
+        template <typename Key, typename Mapped, typename Compare>
+        std::pair<typename btree<Key, Mapped, Compare>::iterator, bool> btree<Key, Mapped, Compare>::insert(value_type &&_value)
+        {
+            if constexpr (std::is_void_v<Mapped>)
+            {
+                return emplaceKey(std::move(_value));
+            }
+            else
+            {
+                return emplaceKey(std::move(_value.first), std::move(_value.second));
+            }
+        }
+
+        template <typename Key, typename Mapped, typename Compare>
+        template <typename InputIt, typename>
+        void btree<Key, Mapped, Compare>::insert(InputIt _first, InputIt _last)
+        {
+            for (; _first != _last; ++_first)
+            {
+                insert(*_first);
+            }
+        }
+
+        template <typename Key, typename Mapped, typename Compare>
+        template <typename K, typename... Args>
+        std::pair<typename btree<Key, Mapped, Compare>::iterator, bool> btree<Key, Mapped, Compare>::emplaceKey(K &&_key, Args &&...args)
+        {
+            leaf *l = nullptr;
+            size_type pos = 0;
+
+            if (last != nullptr && last->count != 0 && comp(last->keys()[last->count - 1], _key))
+            {
+                l = last;
+                pos = last->count;
+            }
+            else if (root == nullptr)
+            {
+                l = ::new (static_cast<void *>(leafPool.allocate())) leaf();
+                root = first = last = l;
+            }
+            else
+            {
+                l = findLeaf(_key);
+                pos = lowerPos(l, _key);
+                if (pos != l->count && !comp(_key, l->keys()[pos]))
+                {
+                    return {iterator(l, pos), false};
+                }
+            }
+
+            // split before building the element, so a throwing constructor
+            // leaves a valid tree without it
+            if (l->count == node_slots)
+            {
+                leaf *right = splitLeaf(l, pos);
+                if (pos > l->count)
+                {
+                    pos -= l->count;
+                    l = right;
+                }
+            }
+
+            Key *keys = l->keys();
+            const size_type tail = l->count - pos;
+            btree_relocate(keys + pos + 1, keys + pos, tail);
+            if constexpr (!std::is_void_v<Mapped>)
+            {
+                btree_relocate(l->values() + pos + 1, l->values() + pos, tail);
+            }
+
+            try
+            {
+                detail::construct_at(keys + pos, std::forward<K>(_key));
+                if constexpr (!std::is_void_v<Mapped>)
+                {
+                    try
+                    {
+                        detail::construct_at(l->values() + pos, std::forward<Args>(args)...);
+                    }
+                    catch (...)
+                    {
+                        keys[pos].~Key();
+                        throw;
+                    }
+                }
+            }
+            catch (...)
+            {
+                btree_relocate(keys + pos, keys + pos + 1, tail);
+                if constexpr (!std::is_void_v<Mapped>)
+                {
+                    btree_relocate(l->values() + pos, l->values() + pos + 1, tail);
+                }
+                throw;
+            }
+
+            l->count++;
+            elementCount++;
+            return {iterator(l, pos), true};
+        }
+
+        // Splits a full leaf ahead of an insert at _index and returns the new
+        // right half. Everything that can fail, the separator copy and the
+        // nodes for the splits up the tree, is done first, so a failure leaves
+        // the tree untouched.
+        template <typename Key, typename Mapped, typename Compare>
+        typename btree<Key, Mapped, Compare>::leaf *btree<Key, Mapped, Compare>::splitLeaf(leaf *_leaf, size_type _index)
+        {
+            // appending to the last leaf splits off a single element, so keys
+            // arriving in order leave full leaves behind
+            const bool append = _leaf == last && _index == _leaf->count;
+            const size_type keep = append ? _leaf->count - 1 : _leaf->count / 2;
+
+            size_type splits = 1;
+            for (inner *p = _leaf->parent; p != nullptr && p->count == node_slots; p = p->parent)
+            {
+                splits++;
+            }
+
+            Key separator(_leaf->keys()[keep]);
+            innerPool.reserve(splits);
+            leaf *right = ::new (static_cast<void *>(leafPool.allocate())) leaf();
+
+            const size_type moved = _leaf->count - keep;
+            btree_relocate(right->keys(), _leaf->keys() + keep, moved);
+            if constexpr (!std::is_void_v<Mapped>)
+            {
+                btree_relocate(right->values(), _leaf->values() + keep, moved);
+            }
+            right->count = std::uint16_t(moved);
+            _leaf->count = std::uint16_t(keep);
+
+            right->prev = _leaf;
+            right->next = _leaf->next;
+            if (_leaf->next != nullptr)
+            {
+                _leaf->next->prev = right;
+            }
+            else
+            {
+                last = right;
+            }
+            _leaf->next = right;
+
+            insertChild(_leaf, std::move(separator), right, append);
+            return right;
+        }
+
+        // adds _right after _left in their parent, with _separator between them
+        template <typename Key, typename Mapped, typename Compare>
+        void btree<Key, Mapped, Compare>::insertChild(node *_left, Key &&_separator, node *_right, bool _append)
+        {
+            inner *parent = _left->parent;
+            if (parent == nullptr)
+            {
+                inner *r = ::new (static_cast<void *>(innerPool.allocate())) inner();
+                detail::construct_at(r->keys(), std::move(_separator));
+                r->children[0] = _left;
+                r->children[1] = _right;
+                r->count = 1;
+                _left->parent = _right->parent = r;
+                root = r;
+                return;
+            }
+
+            size_type at = childIndex(parent, _left);
+            if (parent->count == node_slots)
+            {
+                splitInner(parent, _append);
+                parent = _left->parent;
+                at = childIndex(parent, _left);
+            }
+
+            btree_relocate(parent->keys() + at + 1, parent->keys() + at, parent->count - at);
+            detail::construct_at(parent->keys() + at, std::move(_separator));
+            btree_relocate(parent->children + at + 2, parent->children + at + 1, parent->count - at);
+            parent->children[at + 1] = _right;
+            _right->parent = parent;
+            parent->count++;
+        }
+
+        // Splits a full inner node: the middle key moves up and the keys and
+        // children after it move to a new node. When appending, only the
+        // last child moves, and the caller's insert then fills the new node.
+        template <typename Key, typename Mapped, typename Compare>
+        void btree<Key, Mapped, Compare>::splitInner(inner *_node, bool _append)
+        {
+            const size_type middle = _append ? _node->count - 1 : _node->count / 2;
+            const size_type moved = _node->count - middle - 1;
+
+            inner *right = ::new (static_cast<void *>(innerPool.allocate())) inner();
+            btree_relocate(right->keys(), _node->keys() + middle + 1, moved);
+            for (size_type i = 0; i <= moved; i++)
+            {
+                right->children[i] = _node->children[middle + 1 + i];
+                right->children[i]->parent = right;
+            }
+            right->count = std::uint16_t(moved);
+
+            Key up(std::move(_node->keys()[middle]));
+            _node->keys()[middle].~Key();
+            _node->count = std::uint16_t(middle);
+
+            insertChild(_node, std::move(up), right, _append);
+        }
+
+        template <typename Key, typename Mapped, typename Compare>
+        typename btree<Key, Mapped, Compare>::iterator btree<Key, Mapped, Compare>::erase(const_iterator _first, const_iterator _last)
+        {
+            size_type n = size_type(std::distance(_first, _last));
+            iterator it(_first.leaf, _first.index);
+            while (n-- != 0)
+            {
+                it = eraseAt(it.leaf, it.index);
+            }
+            return it;
+        }
+
+        template <typename Key, typename Mapped, typename Compare>
+        template <typename K>
+        typename btree<Key, Mapped, Compare>::size_type btree<Key, Mapped, Compare>::erase(const key_arg<K> &_key)
+        {
+            const iterator it = find(_key);
+            if (it == end())
+            {
+                return 0;
+            }
+
+            eraseAt(it.leaf, it.index);
+            return 1;
+        }
+
+        template <typename Key, typename Mapped, typename Compare>
+        typename btree<Key, Mapped, Compare>::iterator btree<Key, Mapped, Compare>::eraseAt(leaf *_leaf, size_type _index)
+        {
+            const size_type tail = _leaf->count - _index - 1;
+            _leaf->keys()[_index].~Key();
+            btree_relocate(_leaf->keys() + _index, _leaf->keys() + _index + 1, tail);
+            if constexpr (!std::is_void_v<Mapped>)
+            {
+                _leaf->values()[_index].~Mapped();
+                btree_relocate(_leaf->values() + _index, _leaf->values() + _index + 1, tail);
+            }
+            _leaf->count--;
+            elementCount--;
+
+            if (_leaf == root)
+            {
+                if (_leaf->count == 0)
+                {
+                    leafPool.deallocate(_leaf);
+                    root = first = last = nullptr;
+                    return end();
+                }
+            }
+            else if (_leaf->count < minSlots)
+            {
+                rebalanceLeaf(_leaf, _index);
+            }
+
+            return normalized(_leaf, _index);
+        }
+
+        // Refills an underfull leaf from a neighbour with the same parent, or
+        // merges the two. _leaf and _index track the element after the erased
+        // one as it moves.
+        template <typename Key, typename Mapped, typename Compare>
+        void btree<Key, Mapped, Compare>::rebalanceLeaf(leaf *&_leaf, size_type &_index)
+        {
+            inner *parent = _leaf->parent;
+            const size_type at = childIndex(parent, _leaf);
+            leaf *left = at != 0 ? static_cast<leaf *>(parent->children[at - 1]) : nullptr;
+            leaf *right = at != parent->count ? static_cast<leaf *>(parent->children[at + 1]) : nullptr;
+
+            if (left != nullptr && left->count > minSlots)
+            {
+                btree_relocate(_leaf->keys() + 1, _leaf->keys(), _leaf->count);
+                btree_relocate(_leaf->keys(), left->keys() + left->count - 1, 1);
+                if constexpr (!std::is_void_v<Mapped>)
+                {
+                    btree_relocate(_leaf->values() + 1, _leaf->values(), _leaf->count);
+                    btree_relocate(_leaf->values(), left->values() + left->count - 1, 1);
+                }
+                left->count--;
+                _leaf->count++;
+                parent->keys()[at - 1] = _leaf->keys()[0];
+                _index++;
+                return;
+            }
+
+            if (right != nullptr && right->count > minSlots)
+            {
+                btree_relocate(_leaf->keys() + _leaf->count, right->keys(), 1);
+                btree_relocate(right->keys(), right->keys() + 1, right->count - 1u);
+                if constexpr (!std::is_void_v<Mapped>)
+                {
+                    btree_relocate(_leaf->values() + _leaf->count, right->values(), 1);
+                    btree_relocate(right->values(), right->values() + 1, right->count - 1u);
+                }
+                right->count--;
+                _leaf->count++;
+                parent->keys()[at] = right->keys()[0];
+                return;
+            }
+
+            // merge the right one of the pair into the left one
+            leaf *into = left != nullptr ? left : _leaf;
+            leaf *from = left != nullptr ? _leaf : right;
+            if (from == _leaf)
+            {
+                _index += into->count;
+                _leaf = into;
+            }
+
+            btree_relocate(into->keys() + into->count, from->keys(), from->count);
+            if constexpr (!std::is_void_v<Mapped>)
+            {
+                btree_relocate(into->values() + into->count, from->values(), from->count);
+            }
+            into->count = std::uint16_t(into->count + from->count);
+            from->count = 0;
+
+            removeChild(parent, left != nullptr ? at - 1 : at);
+            unlinkLeaf(from);
+            rebalanceInner(parent);
+        }
+
+        // the inner counterpart, rotating keys through the parent
+        template <typename Key, typename Mapped, typename Compare>
+        void btree<Key, Mapped, Compare>::rebalanceInner(inner *_node)
+        {
+            if (_node == root)
+            {
+                // a root left with a single child hands the tree to it
+                if (_node->count == 0)
+                {
+                    root = _node->children[0];
+                    root->parent = nullptr;
+                    innerPool.deallocate(_node);
+                }
+                return;
+            }
+
+            if (_node->count >= minSlots)
+            {
+                return;
+            }
+
+            inner *parent = _node->parent;
+            const size_type at = childIndex(parent, _node);
+            inner *left = at != 0 ? static_cast<inner *>(parent->children[at - 1]) : nullptr;
+            inner *right = at != parent->count ? static_cast<inner *>(parent->children[at + 1]) : nullptr;
+
+            if (left != nullptr && left->count > minSlots)
+            {
+                btree_relocate(_node->keys() + 1, _node->keys(), _node->count);
+                btree_relocate(_node->children + 1, _node->children, _node->count + 1u);
+                detail::construct_at(_node->keys(), std::move(parent->keys()[at - 1]));
+                parent->keys()[at - 1] = std::move(left->keys()[left->count - 1]);
+                left->keys()[left->count - 1].~Key();
+                _node->children[0] = left->children[left->count];
+                _node->children[0]->parent = _node;
+                left->count--;
+                _node->count++;
+                return;
+            }
+
+            if (right != nullptr && right->count > minSlots)
+            {
+                detail::construct_at(_node->keys() + _node->count, std::move(parent->keys()[at]));
+                parent->keys()[at] = std::move(right->keys()[0]);
+                right->keys()[0].~Key();
+                _node->children[_node->count + 1] = right->children[0];
+                _node->children[_node->count + 1]->parent = _node;
+                btree_relocate(right->keys(), right->keys() + 1, right->count - 1u);
+                btree_relocate(right->children, right->children + 1, size_type(right->count));
+                right->count--;
+                _node->count++;
+                return;
+            }
+
+            if (left != nullptr)
+            {
+                mergeInner(left, at - 1, _node);
+            }
+            else
+            {
+                mergeInner(_node, at, right);
+            }
+            rebalanceInner(parent);
+        }
+
+        // appends the parent's separator and all of _from to _into, then
+        // drops _from
+        template <typename Key, typename Mapped, typename Compare>
+        void btree<Key, Mapped, Compare>::mergeInner(inner *_into, size_type _separator, inner *_from)
+        {
+            inner *parent = _into->parent;
+            detail::construct_at(_into->keys() + _into->count, std::move(parent->keys()[_separator]));
+            btree_relocate(_into->keys() + _into->count + 1, _from->keys(), _from->count);
+            for (size_type i = 0; i <= _from->count; i++)
+            {
+                _into->children[_into->count + 1 + i] = _from->children[i];
+                _from->children[i]->parent = _into;
+            }
+            _into->count = std::uint16_t(_into->count + 1 + _from->count);
+            _from->count = 0;
+
+            removeChild(parent, _separator);
+            innerPool.deallocate(_from);
+        }
+
+        // removes separator _separator and the child to its right
+        template <typename Key, typename Mapped, typename Compare>
+        void btree<Key, Mapped, Compare>::removeChild(inner *_parent, size_type _separator)
+        {
+            const size_type tail = _parent->count - _separator - 1;
+            _parent->keys()[_separator].~Key();
+            btree_relocate(_parent->keys() + _separator, _parent->keys() + _separator + 1, tail);
+            btree_relocate(_parent->children + _separator + 1, _parent->children + _separator + 2, tail);
+            _parent->count--;
+        }
+
+        template <typename Key, typename Mapped, typename Compare>
+        void btree<Key, Mapped, Compare>::unlinkLeaf(leaf *_leaf)
+        {
+            if (_leaf->prev != nullptr)
+            {
+                _leaf->prev->next = _leaf->next;
+            }
+            else
+            {
+                first = _leaf->next;
+            }
+
+            if (_leaf->next != nullptr)
+            {
+                _leaf->next->prev = _leaf->prev;
+            }
+            else
+            {
+                last = _leaf->prev;
+            }
+
+            leafPool.deallocate(_leaf);
+        }
+
+        // destroys the keys and elements under _node; the pools own the nodes
+        template <typename Key, typename Mapped, typename Compare>
+        void btree<Key, Mapped, Compare>::destroyNode(node *_node) noexcept
+        {
+            if (!_node->leaf)
+            {
+                inner *n = static_cast<inner *>(_node);
+                for (size_type i = 0; i <= n->count; i++)
+                {
+                    destroyNode(n->children[i]);
+                }
+            }
+            else if constexpr (!std::is_void_v<Mapped>)
+            {
+                std::destroy(static_cast<leaf *>(_node)->values(), static_cast<leaf *>(_node)->values() + _node->count);
+            }
+
+            std::destroy(_node->keys(), _node->keys() + _node->count);
+        }
+
+        template <typename Key, typename Mapped, typename Compare>
+        void btree<Key, Mapped, Compare>::destroyElements() noexcept
+        {
+            constexpr bool trivial = std::is_trivially_destructible_v<Key> && std::is_trivially_destructible_v<std::conditional_t<std::is_void_v<Mapped>, int, Mapped>>;
+            if (!trivial && root != nullptr)
+            {
+                destroyNode(root);
+            }
+        }
+
+        template <typename Key, typename Mapped, typename Compare>
+        void btree<Key, Mapped, Compare>::clear() noexcept
+        {
+            destroyElements();
+            leafPool.reset();
+            innerPool.reset();
+            root = first = last = nullptr;
+            elementCount = 0;
+        }
+
+        template <typename Key, typename Mapped, typename Compare>
+        void btree<Key, Mapped, Compare>::swap(btree &_other) noexcept
+        {
+            leafPool.swap(_other.leafPool);
+            innerPool.swap(_other.innerPool);
+            std::swap(root, _other.root);
+            std::swap(first, _other.first);
+            std::swap(last, _other.last);
+            std::swap(elementCount, _other.elementCount);
+            std::swap(comp, _other.comp);
+        }
+    }
+}
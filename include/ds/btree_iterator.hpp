@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace ds
+{
+    namespace detail
+    {
+        template <typename Key, typename Mapped, typename Compare>
+        class btree;
+    }
+
+    // Bidirectional iterator over a B+tree: a leaf and a slot index, moving
+    // to the neighbouring leaf through the leaf links, so a range scan never
+    // goes back up the tree. end() is one past the last slot of the last
+    // leaf. Map leaves keep keys and values apart, so for a map dereferencing
+    // yields a pair of references and operator-> goes through a small proxy.
+    template <typename Leaf, bool Const>
+    class BTreeIterator
+    {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = typename Leaf::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = typename Leaf::template reference<Const>;
+
+        struct proxy
+        {
+            reference ref;
+            reference *operator->() { return &ref; }
+        };
+
+        using pointer = std::conditional_t<std::is_reference_v<reference>, std::add_pointer_t<reference>, proxy>;
+
+        BTreeIterator() = default;
+
+        template <bool C, typename = std::enable_if_t<Const && !C>>
+        BTreeIterator(const BTreeIterator<Leaf, C> &_other) : leaf(_other.leaf), index(_other.index) {}
+
+        reference operator*() const { return leaf->template get<Const>(index); }
+        pointer operator->() const
+        {
+            if constexpr (std::is_reference_v<reference>)
+            {
+                return &**this;
+            }
+            else
+            {
+                return pointer{**this};
+            }
+        }
+
+        BTreeIterator &operator++()
+        {
+            if (++index == leaf->count && leaf->next != nullptr)
+            {
+                leaf = leaf->next;
+                index = 0;
+            }
+            return *this;
+        }
+
+        BTreeIterator operator++(int)
+        {
+            BTreeIterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        BTreeIterator &operator--()
+        {
+            if (index == 0)
+            {
+                leaf = leaf->prev;
+                index = leaf->count;
+            }
+            --index;
+            return *this;
+        }
+
+        BTreeIterator operator--(int)
+        {
+            BTreeIterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        template <bool C>
+        bool operator==(const BTreeIterator<Leaf, C> &_other) const { return leaf == _other.leaf && index == _other.index; }
+        template <bool C>
+        bool operator!=(const BTreeIterator<Leaf, C> &_other) const { return !(*this == _other); }
+
+    private:
+        template <typename L, bool C>
+        friend class BTreeIterator;
+
+        template <typename Key, typename Mapped, typename Compare>
+        friend class detail::btree;
+
+        BTreeIterator(Leaf *_leaf, std::size_t _index) : leaf(_leaf), index(_index) {}
+
+        Leaf *leaf = nullptr;
+        std::size_t index = 0;
+    };
+}
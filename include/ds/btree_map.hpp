@@ -0,0 +1,100 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "btree.hpp"
+
+namespace ds
+{
+    // Ordered map on a B+tree with wide nodes: each node holds up to
+    // node_slots keys in about four cache lines, so a lookup touches a few
+    // nodes instead of one node per level as in std::map's red-black tree.
+    // Leaves keep keys and values in separate arrays and are linked to
+    // their neighbours, so iterating a range walks leaves in order without
+    // climbing the tree. Nodes come from a pool. Inserts and erases move
+    // elements between slots and invalidate iterators and references.
+    template <typename Key, typename T, typename Compare = std::less<Key>>
+    class btree_map : public detail::btree<Key, T, Compare>
+    {
+        using base = detail::btree<Key, T, Compare>;
+
+    public:
+        using mapped_type = T;
+        using typename base::const_iterator;
+        using typename base::iterator;
+        using typename base::key_type;
+        using typename base::size_type;
+        using typename base::value_type;
+
+        template <typename K>
+        using key_arg = typename base::template key_arg<K>;
+
+        // constructors
+        btree_map() = default;
+        explicit btree_map(const Compare &_comp) : base(_comp) {}
+        btree_map(std::initializer_list<value_type> _list, const Compare &_comp = Compare()) : base(_comp) { this->insert(_list); }
+
+        template <typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+        btree_map(InputIt _first, InputIt _last, const Compare &_comp = Compare()) : base(_comp) { this->insert(_first, _last); }
+
+        // element access
+        T &operator[](const key_type &_key) { return try_emplace(_key).first->second; }
+        T &operator[](key_type &&_key) { return try_emplace(std::move(_key)).first->second; }
+
+        template <typename K = key_type>
+        T &at(const key_arg<K> &_key);
+        template <typename K = key_type>
+        const T &at(const key_arg<K> &_key) const { return const_cast<btree_map *>(this)->at(_key); }
+
+        // modifiers: the mapped value is only built when the key is new
+        template <typename... Args>
+        std::pair<iterator, bool> try_emplace(const key_type &_key, Args &&...args) { return this->emplaceKey(_key, std::forward<Args>(args)...); }
+        template <typename... Args>
+        std::pair<iterator, bool> try_emplace(key_type &&_key, Args &&...args) { return this->emplaceKey(std::move(_key), std::forward<Args>(args)...); }
+
+        template <typename M>
+        std::pair<iterator, bool> insert_or_assign(const key_type &_key, M &&_value);
+        template <typename M>
+        std::pair<iterator, bool> insert_or_assign(key_type &&_key, M &&_value);
+    };
+
+    template <typename Key, typename T, typename Compare>
+    template <typename K>
+    T &btree_map<Key, T, Compare>::at(const key_arg<K> &_key)
+    {
+        auto it = this->find(_key);
+        if (it == this->end())
+        {
+            throw std::out_of_range("ds::btree_map - key not found");
+        }
+        return it->second;
+    }
+
+    template <typename Key, typename T, typename Compare>
+    template <typename M>
+    std::pair<typename btree_map<Key, T, Compare>::iterator, bool> btree_map<Key, T, Compare>::insert_or_assign(const key_type &_key, M &&_value)
+    {
+        auto result = try_emplace(_key, std::forward<M>(_value));
+        if (!result.second)
+        {
+            result.first->second = std::forward<M>(_value);
+        }
+        return result;
+    }
+
+    template <typename Key, typename T, typename Compare>
+    template <typename M>
+    std::pair<typename btree_map<Key, T, Compare>::iterator, bool> btree_map<Key, T, Compare>::insert_or_assign(key_type &&_key, M &&_value)
+    {
+        auto result = try_emplace(std::move(_key), std::forward<M>(_value));
+        if (!result.second)
+        {
+            result.first->second = std::forward<M>(_value);
+        }
+        return result;
+    }
+}
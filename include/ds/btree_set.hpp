@@ -0,0 +1,30 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <type_traits>
+
+#include "btree.hpp"
+
+namespace ds
+{
+    // Ordered set on a B+tree; see btree_map. Elements are immutable
+    // through iterators, since changing one would break the order.
+    template <typename Key, typename Compare = std::less<Key>>
+    class btree_set : public detail::btree<Key, void, Compare>
+    {
+        using base = detail::btree<Key, void, Compare>;
+
+    public:
+        using typename base::size_type;
+        using typename base::value_type;
+
+        // constructors
+        btree_set() = default;
+        explicit btree_set(const Compare &_comp) : base(_comp) {}
+        btree_set(std::initializer_list<value_type> _list, const Compare &_comp = Compare()) : base(_comp) { this->insert(_list); }
+
+        template <typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+        btree_set(InputIt _first, InputIt _last, const Compare &_comp = Compare()) : base(_comp) { this->insert(_first, _last); }
+    };
+}
@@ -0,0 +1,414 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "index_iterator.hpp"
+#include "memory.hpp"
+
+namespace ds
+{
+    // what circular_buffer does with a new element when it is full
+    enum class full_policy
+    {
+        overwrite, // drop the oldest element
+        reject     // keep the contents and report failure
+    };
+
+    // Fixed capacity FIFO ring in a single allocation. The capacity is
+    // rounded up to a power of two so positions wrap with a mask, and the
+    // readable elements are always at most two contiguous runs, which
+    // readable() hands out for memcpy or writev. Unlike ds::deque there is
+    // no map to walk when crossing from one block to the next.
+    template <typename T>
+    class circular_buffer
+    {
+    public:
+        using value_type = T;
+        using pointer = T *;
+        using const_pointer = const T *;
+        using reference = T &;
+        using const_reference = const T &;
+        using size_type = std::size_t;
+
+        using iterator = IndexIterator<circular_buffer, reference, pointer>;
+        using const_iterator = IndexIterator<const circular_buffer, const_reference, const_pointer>;
+
+        // a contiguous run of elements
+        template <typename P>
+        struct basic_span
+        {
+            P data = nullptr;
+            size_type size = 0;
+        };
+
+        using span = basic_span<pointer>;
+        using const_span = basic_span<const_pointer>;
+
+        // constructors
+        explicit circular_buffer(size_type _capacity, full_policy _policy = full_policy::overwrite);
+        circular_buffer(const circular_buffer &_other);
+        circular_buffer(circular_buffer &&_temp) noexcept;
+
+        // destructors
+        ~circular_buffer() noexcept;
+
+        // operator=
+        circular_buffer &operator=(const circular_buffer &_other);
+        circular_buffer &operator=(circular_buffer &&_other) noexcept;
+
+        // element access, oldest first
+        reference at(size_type _index);
+        const_reference at(size_type _index) const;
+
+        reference operator[](size_type _index) { return array[(head + _index) & mask]; }
+        const_reference operator[](size_type _index) const { return array[(head + _index) & mask]; }
+
+        reference front() { return array[head & mask]; }
+        const_reference front() const { return array[head & mask]; }
+
+        reference back() { return array[(head + count - 1) & mask]; }
+        const_reference back() const { return array[(head + count - 1) & mask]; }
+
+        // The elements oldest first as at most two runs; second.size is zero
+        // unless the contents wrap around the end of the allocation.
+        std::pair<span, span> readable();
+        std::pair<const_span, const_span> readable() const;
+
+        // copies up to _max elements, oldest first, and returns the count
+        size_type copy_to(pointer _out, size_type _max) const;
+
+        // iterators
+        iterator begin() { return iterator(this, 0); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+
+        iterator end() { return iterator(this, count); }
+        const_iterator end() const { return const_iterator(this, count); }
+
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+
+        // capacity
+        size_type size() const { return count; }
+        size_type capacity() const { return mask + 1; }
+        bool empty() const { return count == 0; }
+        bool full() const { return count == mask + 1; }
+        full_policy policy() const { return fullPolicy; }
+
+        // modifiers: each returns false if the buffer was full and rejects
+        bool push_back(const T &_value) { return emplace_back(_value); }
+        bool push_back(T &&_value) { return emplace_back(std::move(_value)); }
+
+        template <typename... Args>
+        bool emplace_back(Args &&...args);
+
+        // appends _count elements and returns how many were stored; with
+        // overwrite all are stored and only the newest capacity() survive
+        size_type push_back(const_pointer _data, size_type _count);
+
+        void pop_front();
+        void pop_front(size_type _count);
+        void clear();
+
+    private:
+        pointer array = nullptr;
+        size_type mask = 0;  // capacity - 1
+        size_type head = 0;  // position of the oldest element, kept below capacity
+        size_type count = 0;
+        full_policy fullPolicy;
+
+        static size_type roundCapacity(size_type _capacity);
+    };
+
+    template <typename T>
+    typename circular_buffer<T>::size_type circular_buffer<T>::roundCapacity(size_type _capacity)
+    {
+        if (_capacity == 0)
+        {
+            throw std::invalid_argument("ds::circular_buffer - capacity must be non-zero");
+        }
+
+        size_type rounded = 1;
+        while (rounded < _capacity)
+        {
+            if (rounded > (size_type(-1) >> 1))
+            {
+                throw std::length_error("ds::circular_buffer - capacity is too large");
+            }
+            rounded <<= 1;
+        }
+
+        return rounded;
+    }
+
+    // parameterised constructor
+    template <typename T>
+    circular_buffer<T>::circular_buffer(size_type _capacity, full_policy _policy) : mask(roundCapacity(_capacity) - 1),
+                                                                                     fullPolicy(_policy)
+    {
+        array = detail::allocate<T>(mask + 1);
+    }
+
+    // copy constructor: the copy starts at position zero
+    template <typename T>
+    circular_buffer<T>::circular_buffer(const circular_buffer &_other) : circular_buffer(_other.capacity(), _other.fullPolicy)
+    {
+        for (const T &x : _other)
+        {
+            emplace_back(x);
+        }
+    }
+
+    // move constructor: the source keeps no storage and rejects until reassigned
+    template <typename T>
+    circular_buffer<T>::circular_buffer(circular_buffer &&_temp) noexcept : array(_temp.array),
+                                                                          mask(_temp.mask),
+                                                                          head(_temp.head),
+                                                                          count(_temp.count),
+                                                                          fullPolicy(_temp.fullPolicy)
+    {
+        _temp.array = nullptr;
+        _temp.mask = _temp.head = _temp.count = 0;
+        _temp.fullPolicy = full_policy::reject;
+    }
+
+    // destructor
+    template <typename T>
+    circular_buffer<T>::~circular_buffer() noexcept
+    {
+        clear();
+        detail::deallocate(array, mask + 1);
+    }
+
+    // copy assignment
+    template <typename T>
+    circular_buffer<T> &circular_buffer<T>::operator=(const circular_buffer &_other)
+    {
+        if (this != &_other)
+        {
+            circular_buffer copy(_other);
+            *this = std::move(copy);
+        }
+
+        return *this;
+    }
+
+    // move assignment
+    template <typename T>
+    circular_buffer<T> &circular_buffer<T>::operator=(circular_buffer &&_other) noexcept
+    {
+        if (this == &_other)
+        {
+            return *this;
+        }
+
+        clear();
+        detail::deallocate(array, mask + 1);
+
+        array = _other.array;
+        mask = _other.mask;
+        head = _other.head;
+        count = _other.count;
+        fullPolicy = _other.fullPolicy;
+
+        _other.array = nullptr;
+        _other.mask = _other.head = _other.count = 0;
+        _other.fullPolicy = full_policy::reject;
+
+        return *this;
+    }
+
+    template <typename T>
+    typename circular_buffer<T>::reference circular_buffer<T>::at(size_type _index)
+    {
+        if (_index >= count)
+        {
+            throw std::out_of_range("ds::circular_buffer - index is out of bounds");
+        }
+        return (*this)[_index];
+    }
+
+    template <typename T>
+    typename circular_buffer<T>::const_reference circular_buffer<T>::at(size_type _index) const
+    {
+        if (_index >= count)
+        {
+            throw std::out_of_range("ds::circular_buffer - index is out of bounds");
+        }
+        return (*this)[_index];
+    }
+
+    template <typename T>
+    std::pair<typename circular_buffer<T>::span, typename circular_buffer<T>::span> circular_buffer<T>::readable()
+    {
+        const size_type firstSize = count < capacity() - head ? count : capacity() - head;
+
+        return {span{array + head, firstSize}, span{array, count - firstSize}};
+    }
+
+    template <typename T>
+    std::pair<typename circular_buffer<T>::const_span, typename circular_buffer<T>::const_span> circular_buffer<T>::readable() const
+    {
+        const size_type firstSize = count < capacity() - head ? count : capacity() - head;
+
+        return {const_span{array + head, firstSize}, const_span{array, count - firstSize}};
+    }
+
+    template <typename T>
+    typename circular_buffer<T>::size_type circular_buffer<T>::copy_to(pointer _out, size_type _max) const
+    {
+        const std::pair<const_span, const_span> runs = readable();
+        size_type copied = 0;
+
+        for (const const_span &run : {runs.first, runs.second})
+        {
+            const size_type n = run.size < _max - copied ? run.size : _max - copied;
+
+            if constexpr (std::is_trivially_copyable_v<T>)
+            {
+                if (n != 0)
+                {
+                    std::memcpy(static_cast<void *>(_out + copied), static_cast<const void *>(run.data), n * sizeof(T));
+                }
+            }
+            else
+            {
+                for (size_type i = 0; i < n; i++)
+                {
+                    _out[copied + i] = run.data[i];
+                }
+            }
+
+            copied += n;
+        }
+
+        return copied;
+    }
+
+    template <typename T>
+    template <typename... Args>
+    bool circular_buffer<T>::emplace_back(Args &&...args)
+    {
+        if (array == nullptr)
+        {
+            return false;
+        }
+
+        if (count == mask + 1)
+        {
+            if (fullPolicy == full_policy::reject)
+            {
+                return false;
+            }
+
+            // the new element takes the oldest one's slot
+            T value(std::forward<Args>(args)...);
+            array[head] = std::move(value);
+            head = (head + 1) & mask;
+            return true;
+        }
+
+        detail::construct_at(array + ((head + count) & mask), std::forward<Args>(args)...);
+        count++;
+
+        return true;
+    }
+
+    template <typename T>
+    typename circular_buffer<T>::size_type circular_buffer<T>::push_back(const_pointer _data, size_type _count)
+    {
+        if (array == nullptr)
+        {
+            return 0;
+        }
+
+        size_type stored = 0;
+
+        if (fullPolicy == full_policy::reject)
+        {
+            const size_type room = capacity() - count;
+            _count = _count < room ? _count : room;
+        }
+        else if (_count > capacity())
+        {
+            // only the newest capacity() elements would survive
+            stored = _count - capacity();
+            _data += stored;
+            _count = capacity();
+        }
+
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            const size_type dropped = count + _count > capacity() ? count + _count - capacity() : 0;
+            pop_front(dropped);
+
+            const size_type tail = (head + count) & mask;
+            const size_type firstSize = _count < capacity() - tail ? _count : capacity() - tail;
+
+            if (firstSize != 0)
+            {
+                std::memcpy(static_cast<void *>(array + tail), static_cast<const void *>(_data), firstSize * sizeof(T));
+            }
+            if (_count != firstSize)
+            {
+                std::memcpy(static_cast<void *>(array), static_cast<const void *>(_data + firstSize), (_count - firstSize) * sizeof(T));
+            }
+
+            count += _count;
+            stored += _count;
+        }
+        else
+        {
+            for (size_type i = 0; i < _count; i++)
+            {
+                emplace_back(_data[i]);
+            }
+            stored += _count;
+        }
+
+        return stored;
+    }
+
+    template <typename T>
+    void circular_buffer<T>::pop_front()
+    {
+        if (count != 0)
+        {
+            array[head].~T();
+            head = (head + 1) & mask;
+            count--;
+        }
+    }
+
+    template <typename T>
+    void circular_buffer<T>::pop_front(size_type _count)
+    {
+        if (_count > count)
+        {
+            throw std::out_of_range("ds::circular_buffer - pop past end");
+        }
+
+        if constexpr (std::is_trivially_destructible_v<T>)
+        {
+            head = (head + _count) & mask;
+            count -= _count;
+        }
+        else
+        {
+            for (size_type i = 0; i < _count; i++)
+            {
+                pop_front();
+            }
+        }
+    }
+
+    template <typename T>
+    void circular_buffer<T>::clear()
+    {
+        pop_front(count);
+        head = 0;
+    }
+}
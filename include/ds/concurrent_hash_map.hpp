@@ -0,0 +1,362 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "flat_hash_map.hpp"
+
+namespace ds
+{
+    namespace detail
+    {
+        // shards per hardware thread when the count is left to the map
+        inline constexpr std::size_t CONCURRENT_SHARDS_PER_THREAD = 4;
+    }
+
+    // Hash map for many threads, split into a power of two of shards. Each
+    // shard is a flat_hash_map behind its own reader-writer lock, on its own
+    // cache lines, and a key's shard comes from the top bits of its mixed
+    // hash, which the shard's table does not use for probing. Lookups on
+    // different shards never touch the same lock, and lookups on the same
+    // shard share it. A shard grows by rehashing under its own lock, so a
+    // rehash holds up only the threads that want that shard.
+    //
+    // Nothing hands out references or iterators, since they would outlive
+    // the lock: find copies the value out, and visit runs a callable on the
+    // element while the shard is locked. The callable must not call back
+    // into the map.
+    template <typename Key, typename T, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+    class concurrent_hash_map
+    {
+        using map_type = flat_hash_map<Key, T, Hash, KeyEqual>;
+
+    public:
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = std::pair<const Key, T>;
+        using size_type = std::size_t;
+        using hasher = Hash;
+        using key_equal = KeyEqual;
+
+        template <typename K>
+        using key_arg = typename map_type::template key_arg<K>;
+
+        // constructors; zero shards picks CONCURRENT_SHARDS_PER_THREAD per
+        // hardware thread, and any count is rounded up to a power of two
+        explicit concurrent_hash_map(size_type _shards = 0, const Hash &_hash = Hash(), const KeyEqual &_equal = KeyEqual());
+        concurrent_hash_map(const concurrent_hash_map &) = delete;
+
+        // operator=
+        concurrent_hash_map &operator=(const concurrent_hash_map &) = delete;
+
+        // lookup
+        template <typename K = key_type>
+        std::optional<T> find(const key_arg<K> &_key) const;
+
+        template <typename K = key_type>
+        bool contains(const key_arg<K> &_key) const;
+
+        // Runs _f(value) on the element with _key while its shard is locked,
+        // exclusively for the non-const overload and shared for the const
+        // one, and returns whether the key was there.
+        template <typename F, typename K = key_type>
+        bool visit(const key_arg<K> &_key, F &&_f);
+        template <typename F, typename K = key_type>
+        bool visit(const key_arg<K> &_key, F &&_f) const;
+
+        // Runs _f(key, value) on every element, one shard at a time, so
+        // elements inserted or erased meanwhile may or may not be seen.
+        template <typename F>
+        void visit_all(F &&_f);
+        template <typename F>
+        void visit_all(F &&_f) const;
+
+        // modifiers; each returns whether a new element was inserted
+        template <typename... Args>
+        bool try_emplace(const key_type &_key, Args &&...args);
+        template <typename... Args>
+        bool try_emplace(key_type &&_key, Args &&...args);
+
+        bool insert(const value_type &_value) { return try_emplace(_value.first, _value.second); }
+
+        template <typename M>
+        bool insert_or_assign(const key_type &_key, M &&_value);
+        template <typename M>
+        bool insert_or_assign(key_type &&_key, M &&_value);
+
+        template <typename K = key_type>
+        size_type erase(const key_arg<K> &_key);
+
+        // erases the elements _pred(key, value) accepts, one shard at a time
+        template <typename Pred>
+        size_type erase_if(Pred _pred);
+
+        void clear();
+
+        // spreads room for _count elements over the shards
+        void reserve(size_type _count);
+
+        // capacity; under concurrent updates a snapshot that may be stale
+        // by the time it returns
+        size_type size() const;
+        bool empty() const { return size() == 0; }
+
+        size_type shard_count() const { return shardMask + 1; }
+
+        // observers
+        hasher hash_function() const { return hashFn; }
+        key_equal key_eq() const { return equalFn; }
+
+    private:
+        struct alignas(64) shard
+        {
+            mutable std::shared_mutex lock;
+            map_type map;
+        };
+
+        std::unique_ptr<shard[]> shards;
+        size_type shardMask = 0;
+        unsigned shardShift = 64;
+        Hash hashFn;
+        KeyEqual equalFn;
+
+        template <typename K>
+        shard &shardFor(const K &_key) const;
+    };
+
+    template <typename Key, typename T, typename Hash, typename KeyEqual>
+    concurrent_hash_map<Key, T, Hash, KeyEqual>::concurrent_hash_map(size_type _shards, const Hash &_hash, const KeyEqual &_equal) : hashFn(_hash), equalFn(_equal)
+    {
+        if (_shards == 0)
+        {
+            const size_type threads = std::thread::hardware_concurrency();
+            _shards = detail::CONCURRENT_SHARDS_PER_THREAD * (threads != 0 ? threads : 1);
+        }
+
+        size_type count = 1;
+        unsigned bits = 0;
+        while (count < _shards)
+        {
+            count *= 2;
+            bits++;
+        }
+
+        shards.reset(new shard[count]);
+        shardMask = count - 1;
+        shardShift = 64 - bits;
+
+        for (size_type i = 0; i < count; i++)
+        {
+            shards[i].map = map_type(0, _hash, _equal);
+        }
+    }
+
+    // the shard index comes from the top bits, which the table only uses
+    // for probing once a shard holds 2^(57 - log2 shards) slots
+    template <typename Key, typename T, typename Hash, typename KeyEqual>
+    template <typename K>
+    typename concurrent_hash_map<Key, T, Hash, KeyEqual>::shard &concurrent_hash_map<Key, T, Hash, KeyEqual>::shardFor(const K &_key) const
+    {
+        if (shardMask == 0)
+        {
+            return shards[0];
+        }
+        return shards[size_type(detail::mix_hash(std::uint64_t(hashFn(_key))) >> shardShift)];
+    }
+
+    template <typename Key, typename T, typename Hash, typename KeyEqual>
+    template <typename K>
+    std::optional<T> concurrent_hash_map<Key, T, Hash, KeyEqual>::find(const key_arg<K> &_key) const
+    {
+        const shard &s = shardFor(_key);
+        std::shared_lock<std::shared_mutex> guard(s.lock);
+
+        auto it = s.map.find(_key);
+        if (it == s.map.end())
+        {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    template <typename Key, typename T, typename Hash, typename KeyEqual>
+    template <typename K>
+    bool concurrent_hash_map<Key, T, Hash, KeyEqual>::contains(const key_arg<K> &_key) const
+    {
+        const shard &s = shardFor(_key);
+        std::shared_lock<std::shared_mutex> guard(s.lock);
+        return s.map.contains(_key);
+    }
+
+    template <typename Key, typename T, typename Hash, typename KeyEqual>
+    template <typename F, typename K>
+    bool concurrent_hash_map<Key, T, Hash, KeyEqual>::visit(const key_arg<K> &_key, F &&_f)
+    {
+        shard &s = shardFor(_key);
+        std::unique_lock<std::shared_mutex> guard(s.lock);
+
+        auto it = s.map.find(_key);
+        if (it == s.map.end())
+        {
+            return false;
+        }
+        _f(it->second);
+        return true;
+    }
+
+    template <typename Key, typename T, typename Hash, typename KeyEqual>
+    template <typename F, typename K>
+    bool concurrent_hash_map<Key, T, Hash, KeyEqual>::visit(const key_arg<K> &_key, F &&_f) const
+    {
+        const shard &s = shardFor(_key);
+        std::shared_lock<std::shared_mutex> guard(s.lock);
+
+        auto it = s.map.find(_key);
+        if (it == s.map.end())
+        {
+            return false;
+        }
+        _f(static_cast<const T &>(it->second));
+        return true;
+    }
+
+    template <typename Key, typename T, typename Hash, typename KeyEqual>
+    template <typename F>
+    void concurrent_hash_map<Key, T, Hash, KeyEqual>::visit_all(F &&_f)
+    {
+        for (size_type i = 0; i <= shardMask; i++)
+        {
+            std::unique_lock<std::shared_mutex> guard(shards[i].lock);
+            for (auto &kv : shards[i].map)
+            {
+                _f(static_cast<const Key &>(kv.first), kv.second);
+            }
+        }
+    }
+
+    template <typename Key, typename T, typename Hash, typename KeyEqual>
+    template <typename F>
+    void concurrent_hash_map<Key, T, Hash, KeyEqual>::visit_all(F &&_f) const
+    {
+        for (size_type i = 0; i <= shardMask; i++)
+        {
+            std::shared_lock<std::shared_mutex> guard(shards[i].lock);
+            for (const auto &kv : shards[i].map)
+            {
+                _f(kv.first, kv.second);
+            }
+        }
+    }
+
+    template <typename Key, typename T, typename Hash, typename KeyEqual>
+    template <typename... Args>
+    bool concurrent_hash_map<Key, T, Hash, KeyEqual>::try_emplace(const key_type &_key, Args &&...args)
+    {
+        shard &s = shardFor(_key);
+        std::unique_lock<std::shared_mutex> guard(s.lock);
+        return s.map.try_emplace(_key, std::forward<Args>(args)...).second;
+    }
+
+    template <typename Key, typename T, typename Hash, typename KeyEqual>
+    template <typename... Args>
+    bool concurrent_hash_map<Key, T, Hash, KeyEqual>::try_emplace(key_type &&_key, Args &&...args)
+    {
+        shard &s = shardFor(_key);
+        std::unique_lock<std::shared_mutex> guard(s.lock);
+        return s.map.try_emplace(std::move(_key), std::forward<Args>(args)...).second;
+    }
+
+    template <typename Key, typename T, typename Hash, typename KeyEqual>
+    template <typename M>
+    bool concurrent_hash_map<Key, T, Hash, KeyEqual>::insert_or_assign(const key_type &_key, M &&_value)
+    {
+        shard &s = shardFor(_key);
+        std::unique_lock<std::shared_mutex> guard(s.lock);
+        return s.map.insert_or_assign(_key, std::forward<M>(_value)).second;
+    }
+
+    template <typename Key, typename T, typename Hash, typename KeyEqual>
+    template <typename M>
+    bool concurrent_hash_map<Key, T, Hash, KeyEqual>::insert_or_assign(key_type &&_key, M &&_value)
+    {
+        shard &s = shardFor(_key);
+        std::unique_lock<std::shared_mutex> guard(s.lock);
+        return s.map.insert_or_assign(std::move(_key), std::forward<M>(_value)).second;
+    }
+
+    template <typename Key, typename T, typename Hash, typename KeyEqual>
+    template <typename K>
+    typename concurrent_hash_map<Key, T, Hash, KeyEqual>::size_type concurrent_hash_map<Key, T, Hash, KeyEqual>::erase(const key_arg<K> &_key)
+    {
+        shard &s = shardFor(_key);
+        std::unique_lock<std::shared_mutex> guard(s.lock);
+        return s.map.erase(_key);
+    }
+
+    template <typename Key, typename T, typename Hash, typename KeyEqual>
+    template <typename Pred>
+    typename concurrent_hash_map<Key, T, Hash, KeyEqual>::size_type concurrent_hash_map<Key, T, Hash, KeyEqual>::erase_if(Pred _pred)
+    {
+        size_type erased = 0;
+        for (size_type i = 0; i <= shardMask; i++)
+        {
+            std::unique_lock<std::shared_mutex> guard(shards[i].lock);
+            map_type &m = shards[i].map;
+            for (auto it = m.begin(); it != m.end();)
+            {
+                if (_pred(static_cast<const Key &>(it->first), it->second))
+                {
+                    it = m.erase(it);
+                    erased++;
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+        return erased;
+    }
+
+    template <typename Key, typename T, typename Hash, typename KeyEqual>
+    void concurrent_hash_map<Key, T, Hash, KeyEqual>::clear()
+    {
+        for (size_type i = 0; i <= shardMask; i++)
+        {
+            std::unique_lock<std::shared_mutex> guard(shards[i].lock);
+            shards[i].map.clear();
+        }
+    }
+
+    template <typename Key, typename T, typename Hash, typename KeyEqual>
+    void concurrent_hash_map<Key, T, Hash, KeyEqual>::reserve(size_type _count)
+    {
+        // hashing spreads keys evenly, give or take a few per shard
+        const size_type perShard = _count / shard_count() + _count / shard_count() / 8 + 1;
+        for (size_type i = 0; i <= shardMask; i++)
+        {
+            std::unique_lock<std::shared_mutex> guard(shards[i].lock);
+            shards[i].map.reserve(perShard);
+        }
+    }
+
+    template <typename Key, typename T, typename Hash, typename KeyEqual>
+    typename concurrent_hash_map<Key, T, Hash, KeyEqual>::size_type concurrent_hash_map<Key, T, Hash, KeyEqual>::size() const
+    {
+        size_type total = 0;
+        for (size_type i = 0; i <= shardMask; i++)
+        {
+            std::shared_lock<std::shared_mutex> guard(shards[i].lock);
+            total += shards[i].map.size();
+        }
+        return total;
+    }
+}
@@ -7,6 +7,11 @@
 #include <initializer_list>
 
 #include "deque_iterator.hpp"
+#include "stats.hpp"
+
+#ifdef DS_ENABLE_STATS
+#include <typeinfo>
+#endif
 
 namespace ds
 {
@@ -69,7 +74,12 @@ namespace ds
 
         // capacity
         bool empty() const { return start_ == end_;}
-        const size_type size() const { return end_ - start_;}
+        size_type size() const { return end_ - start_;}
+
+
+
+        // telemetry
+        container_stats stats() const;
 
 
 
@@ -80,8 +90,12 @@ namespace ds
         iterator end_;
         size_t mapSize;
 
+#ifdef DS_ENABLE_STATS
+        detail::stats_record statsRecord{"ds::deque", typeid(T)};
+#endif
+
 
-        constexpr inline size_t deque_block_size()
+        static constexpr size_t deque_block_size()
         {
             return sizeof(T) < DEQUE_BUF_SIZE ? size_t(DEQUE_BUF_SIZE / sizeof(T)) : size_t(1);
         }
@@ -107,6 +121,85 @@ namespace ds
             delete[] reinterpret_cast<char*>(map[blockIndex]);
         }
 
+        // allocates blocks for count elements without constructing them
+        void createStorage(size_t count)
+        {
+            mapSize = count / deque_block_size() + 1;
+
+            map = allocateMap(mapSize);
+
+            for (size_t i = 0; i < mapSize; i++)
+            {
+                map[i] = allocateBlock();
+            }
+
+            start_ = iterator(&map[0][0], map);
+            end_ = start_ + count;
+
+            statsSync();
+        }
+
+        void destroyStorage() noexcept
+        {
+            for(iterator it = start_; it != end_; ++it)
+            {
+                (*it).~T();
+            }
+
+            for (size_t i = 0; i < mapSize; i++)
+            {
+                deallocateBlock(i);
+            }
+
+            deallocateMap();
+
+            map = nullptr;
+            mapSize = 0;
+            start_ = iterator();
+            end_ = iterator();
+
+            statsSync();
+        }
+
+        // calls f(pointer, count) for each contiguous run of elements, front to back
+        template<typename F>
+        void forEachSegment(F&& f) const
+        {
+            if (start_ == end_)
+            {
+                return;
+            }
+
+            for (T** node = start_.node; node != end_.node; ++node)
+            {
+                T* first = node == start_.node ? start_.current : *node;
+                f(first, size_t(*node + deque_block_size() - first));
+            }
+
+            T* first = start_.node == end_.node ? start_.current : end_.first;
+
+            if (end_.current != first)
+            {
+                f(first, size_t(end_.current - first));
+            }
+        }
+
+        // every map slot owns a block, so slots and blocks are the same count
+        void statsSync() noexcept
+        {
+#ifdef DS_ENABLE_STATS
+            statsRecord.set_size(mapSize * (sizeof(T*) + sizeof(T) * deque_block_size()), size() * sizeof(T));
+            statsRecord.set_blocks(mapSize, mapSize);
+#endif
+        }
+
+        // map slot and in-block offset of the first element, for ds::gather
+        T** firstNode() const { return start_.node; }
+        size_t firstOffset() const { return size_t(start_.current - start_.first); }
+
+        friend struct snapshot_access;
+        friend struct gather_access;
+
     };
 
 
@@ -150,6 +243,8 @@ namespace ds
         {
             new (it.base()) T(); 
         }
+
+        statsSync();
         
     }
 
@@ -178,6 +273,8 @@ namespace ds
         {
             new (it.base()) T(value); 
         }
+
+        statsSync();
     }
 
 
@@ -202,6 +299,8 @@ namespace ds
         {
             new (it.base()) T(other[i++]); 
         }
+
+        statsSync();
         
     }
 
@@ -210,11 +309,6 @@ namespace ds
     deque<T>::
     deque(deque&& other) noexcept
     {
-        if (&other == *this)
-        {
-            return ;
-        }
-
         mapSize = other.mapSize;
         start_ = other.start_;
         end_ = other.end_;
@@ -224,6 +318,9 @@ namespace ds
         other.start_ = iterator();
         other.end_ = iterator();
         other.map = nullptr;
+
+        statsSync();
+        other.statsSync();
     }
 
 
@@ -254,6 +351,8 @@ namespace ds
             new (it.base()) T(*(li.begin() + i++)); 
         }
 
+        statsSync();
+
     }
 
 
@@ -261,26 +360,13 @@ namespace ds
     deque<T>::
     ~deque() noexcept
     {
-        
-        for(iterator it = start_; it != end_; ++it)
-        {
-            (*it).~T();
-        }
-
-        for (size_t i = 0; i < mapSize; i++)
-        {
-            deallocateBlock(i);
-        }
-
-
-        deallocateMap();
-        
+        destroyStorage();
     }
 
     template<typename T>
     deque<T>& deque<T>::operator=(const deque& other)
     {
-        if (&other == *this)
+        if (&other == this)
         {
             return *this;
         }
@@ -310,6 +396,10 @@ namespace ds
 
                 deallocateMap();
 
+#ifdef DS_ENABLE_STATS
+                statsRecord.add_growth(mapSize * sizeof(T*));
+#endif
+
                 map = tempMap;
                 mapSize = other.mapSize;
             }
@@ -345,6 +435,8 @@ namespace ds
             new (it.base()) T(other[i++]);
         }
 
+        statsSync();
+
         return *this;
     }
 
@@ -358,6 +450,8 @@ namespace ds
             return *this;
         }
 
+        destroyStorage();
+
         mapSize = other.mapSize;
         map = other.map;
         start_ = other.start_;
@@ -367,6 +461,28 @@ namespace ds
         other.map = nullptr;
         other.start_ = iterator();
         other.end_ = iterator();
+
+        statsSync();
+        other.statsSync();
+
+        return *this;
+    }
+
+
+
+    template<typename T>
+    container_stats deque<T>::stats() const
+    {
+#ifdef DS_ENABLE_STATS
+        container_stats s = statsRecord.snapshot();
+#else
+        container_stats s;
+#endif
+        s.bytes_reserved = mapSize * (sizeof(T*) + sizeof(T) * deque_block_size());
+        s.bytes_in_use = size() * sizeof(T);
+        s.map_slots = mapSize;
+        s.blocks = mapSize;
+        return s;
     }
 
 
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <cstddef>
 #include <iterator>
 #include <type_traits>
@@ -7,6 +9,9 @@ namespace ds
 
 #define DEQUE_BUF_SIZE 512
 
+    template <typename T>
+    class deque;
+
     template <typename T, typename PTR, typename REF>
     class DequeIterator
     {
@@ -24,6 +29,8 @@ namespace ds
 
         DequeIterator(const DequeIterator& it);
 
+        DequeIterator& operator=(const DequeIterator& it) = default;
+
         reference operator*() const { return *current; }
         pointer operator->() const { return current; }
 
@@ -61,7 +68,7 @@ namespace ds
             nodes_in_between--;
 
             
-            return (it.last - it.current) + nodes_in_between * 128 + (current - first);
+            return (it.last - it.current) + nodes_in_between * deque_block_size() + (current - first);
         }
 
         friend bool operator==(const DequeIterator& first, const DequeIterator &it)
@@ -79,6 +86,9 @@ namespace ds
         T* base() const { return current; }
 
     private:
+        template <typename>
+        friend class deque;
+
         T *current;
         T *first;
         T *last;
@@ -91,7 +101,7 @@ namespace ds
             last = first + deque_block_size();
         }
 
-        inline size_t deque_block_size()
+        static constexpr size_t deque_block_size()
         {
             return ( sizeof(T) < DEQUE_BUF_SIZE ) ?  size_t(DEQUE_BUF_SIZE / sizeof(T)) : size_t(1);
         }
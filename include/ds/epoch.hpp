@@ -0,0 +1,293 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "thread_record.hpp"
+
+namespace ds
+{
+    namespace detail
+    {
+        // a thread tries to reclaim once this many of its objects wait
+        inline constexpr std::size_t EPOCH_RECLAIM_THRESHOLD = 64;
+
+        struct epoch_retired
+        {
+            void *object;
+            void (*deleter)(void *);
+            std::uint64_t epoch;
+        };
+
+        // One per registered thread; a record whose thread exited is reused.
+        struct epoch_record
+        {
+            static constexpr std::uint64_t quiescent = 0;
+
+            // quiescent, or 2 * epoch + 1 while in a critical section
+            std::atomic<std::uint64_t> state{quiescent};
+            std::atomic<bool> inUse{true};
+            epoch_record *next = nullptr;
+
+            // touched by the owner only
+            unsigned depth = 0;
+            std::vector<epoch_retired> retired;
+        };
+
+        struct epoch_state
+        {
+            std::atomic<std::uint64_t> global{0};
+            std::atomic<epoch_record *> records{nullptr};
+
+            // left behind by exited threads, freed by whoever reclaims next
+            std::mutex orphanLock;
+            std::vector<epoch_retired> orphans;
+            std::atomic<std::size_t> orphanCount{0};
+
+            // no thread is left at exit, so everything can go
+            ~epoch_state()
+            {
+                for (const epoch_retired &r : orphans)
+                {
+                    r.deleter(r.object);
+                }
+                for (epoch_record *r = records.load(); r != nullptr; r = r->next)
+                {
+                    for (const epoch_retired &x : r->retired)
+                    {
+                        x.deleter(x.object);
+                    }
+                }
+                free_records(records);
+            }
+        };
+
+        inline epoch_state &epoch_globals()
+        {
+            static epoch_state state;
+            return state;
+        }
+
+        // the calling thread's record, registered on first use; at exit the
+        // record is handed back and what it still holds becomes an orphan
+        struct epoch_thread
+        {
+            epoch_record *record = acquire_record(epoch_globals().records);
+
+            ~epoch_thread()
+            {
+                record->depth = 0;
+                record->state.store(epoch_record::quiescent, std::memory_order_release);
+
+                if (!record->retired.empty())
+                {
+                    epoch_state &g = epoch_globals();
+                    std::lock_guard<std::mutex> lock(g.orphanLock);
+                    g.orphans.insert(g.orphans.end(), record->retired.begin(), record->retired.end());
+                    g.orphanCount.store(g.orphans.size(), std::memory_order_relaxed);
+                    record->retired.clear();
+                }
+                record->inUse.store(false, std::memory_order_release);
+            }
+        };
+
+        inline epoch_record &epoch_local()
+        {
+            thread_local epoch_thread thread;
+            return *thread.record;
+        }
+
+        // moves the entries of _list that are two epochs behind _now into _ready
+        inline void epoch_take_ready(std::vector<epoch_retired> &_list, std::uint64_t _now, std::vector<epoch_retired> &_ready)
+        {
+            std::size_t kept = 0;
+            for (const epoch_retired &r : _list)
+            {
+                if (r.epoch + 2 <= _now)
+                {
+                    _ready.push_back(r);
+                }
+                else
+                {
+                    _list[kept++] = r;
+                }
+            }
+            _list.resize(kept);
+        }
+    }
+
+    // Epoch-based memory reclamation for data that readers reach without
+    // locks. A reader wraps its accesses in an epoch::guard, which announces
+    // the global epoch in the thread's record. A writer unlinks an object so
+    // that new readers cannot reach it, then hands it to retire(). The
+    // object is freed once the global epoch is two steps past its retire
+    // epoch, and the epoch only advances when every reader in a critical
+    // section has announced the current one, so by then no reader can
+    // still hold it.
+    //
+    // Entering and leaving a guard are wait-free: a load, a store and a
+    // fence, with no loop and no shared write. Each thread keeps its retired
+    // objects in its own list, so retire() takes no lock, and reclaims them
+    // in batches. What a thread still holds when it exits is handed to the
+    // next thread that reclaims. A thread registers on its first guard or
+    // retire, or up front with register_thread(). A reader that stays inside
+    // a guard holds back reclamation for everyone, so guards should be
+    // short; see hazard_pointer for a scheme without that limit.
+    class epoch
+    {
+    public:
+        // critical section for the calling thread; guards nest
+        class guard
+        {
+        public:
+            guard() : record(detail::epoch_local())
+            {
+                if (record.depth++ == 0)
+                {
+                    const std::uint64_t now = detail::epoch_globals().global.load(std::memory_order_relaxed);
+                    record.state.store(2 * now + 1, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                }
+            }
+
+            ~guard()
+            {
+                if (--record.depth == 0)
+                {
+                    record.state.store(detail::epoch_record::quiescent, std::memory_order_release);
+                }
+            }
+
+            guard(const guard &) = delete;
+            guard &operator=(const guard &) = delete;
+
+        private:
+            detail::epoch_record &record;
+        };
+
+        // registers the calling thread now rather than on first use, so the
+        // allocation stays off a latency-sensitive path
+        static void register_thread() { detail::epoch_local(); }
+
+        // Hands over an object that readers can no longer reach; _deleter
+        // runs once no critical section that might have seen it is left.
+        static void retire(void *_object, void (*_deleter)(void *));
+
+        template <typename T>
+        static void retire(T *_object)
+        {
+            retire(const_cast<void *>(static_cast<const void *>(_object)), [](void *_p)
+                   { delete static_cast<T *>(_p); });
+        }
+
+        // Advances the epoch if every reader has caught up, then frees what
+        // the calling thread and exited threads retired that is old enough;
+        // returns how many were freed. Called from retire() once enough of
+        // the thread's objects are waiting.
+        static std::size_t reclaim();
+
+        // Waits until every critical section open at the call has ended,
+        // then reclaims, so all the calling thread retired before the call
+        // is freed. Must not be called inside a guard.
+        static void synchronize();
+
+        static std::uint64_t current() { return detail::epoch_globals().global.load(std::memory_order_acquire); }
+
+    private:
+        static bool tryAdvance(std::uint64_t _epoch);
+    };
+
+    inline void epoch::retire(void *_object, void (*_deleter)(void *))
+    {
+        detail::epoch_record &record = detail::epoch_local();
+
+        // the unlink comes before the epoch read, so a reader that saw the
+        // object announced this epoch or an earlier one
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::uint64_t now = detail::epoch_globals().global.load(std::memory_order_relaxed);
+        record.retired.push_back(detail::epoch_retired{_object, _deleter, now});
+
+        if (record.retired.size() >= detail::EPOCH_RECLAIM_THRESHOLD)
+        {
+            reclaim();
+        }
+    }
+
+    // every critical section in progress has announced _epoch
+    inline bool epoch::tryAdvance(std::uint64_t _epoch)
+    {
+        detail::epoch_state &g = detail::epoch_globals();
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (detail::epoch_record *r = g.records.load(std::memory_order_acquire); r != nullptr; r = r->next)
+        {
+            const std::uint64_t state = r->state.load(std::memory_order_acquire);
+            if (state != detail::epoch_record::quiescent && state != 2 * _epoch + 1)
+            {
+                return false;
+            }
+        }
+
+        return g.global.compare_exchange_strong(_epoch, _epoch + 1, std::memory_order_acq_rel);
+    }
+
+    inline std::size_t epoch::reclaim()
+    {
+        detail::epoch_state &g = detail::epoch_globals();
+        detail::epoch_record &record = detail::epoch_local();
+
+        // two steps put everything retired before this call out of reach
+        for (int step = 0; step < 2; step++)
+        {
+            if (!tryAdvance(g.global.load(std::memory_order_acquire)))
+            {
+                break;
+            }
+        }
+
+        const std::uint64_t now = g.global.load(std::memory_order_acquire);
+        std::vector<detail::epoch_retired> ready;
+        detail::epoch_take_ready(record.retired, now, ready);
+
+        if (g.orphanCount.load(std::memory_order_relaxed) != 0)
+        {
+            std::lock_guard<std::mutex> lock(g.orphanLock);
+            detail::epoch_take_ready(g.orphans, now, ready);
+            g.orphanCount.store(g.orphans.size(), std::memory_order_relaxed);
+        }
+
+        // after the lists are settled, so a deleter may retire in turn
+        for (const detail::epoch_retired &r : ready)
+        {
+            r.deleter(r.object);
+        }
+        return ready.size();
+    }
+
+    inline void epoch::synchronize()
+    {
+        detail::epoch_state &g = detail::epoch_globals();
+        if (detail::epoch_local().depth != 0)
+        {
+            throw std::logic_error("ds::epoch - synchronize inside a critical section");
+        }
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::uint64_t target = g.global.load(std::memory_order_acquire) + 2;
+        for (std::uint64_t now = g.global.load(std::memory_order_acquire); now < target; now = g.global.load(std::memory_order_acquire))
+        {
+            if (!tryAdvance(now))
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        reclaim();
+    }
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+
+#include "vector.hpp"
+
+namespace ds
+{
+    namespace detail
+    {
+        // Read-only search index over a sorted key array, in Eytzinger (BFS)
+        // order: node k has children 2k and 2k + 1, so the first levels of
+        // every search share the same few cache lines, and the nodes four
+        // levels down sit next to each other and can be prefetched. A
+        // plain binary search instead touches a new line at almost every
+        // step once the array outgrows the cache. Positions are reported as
+        // ranks in the sorted array.
+        template <typename Key>
+        class eytzinger_index
+        {
+        public:
+            using size_type = std::size_t;
+
+            bool built() const { return isBuilt; }
+
+            // copies the _count keys at _sorted, which must be ascending
+            void build(const Key *_sorted, size_type _count);
+            void clear();
+
+            // rank of the first key not less than / greater than _key, or
+            // the key count if there is none
+            template <typename K, typename Compare>
+            size_type lower_bound(const K &_key, const Compare &_comp) const;
+            template <typename K, typename Compare>
+            size_type upper_bound(const K &_key, const Compare &_comp) const;
+
+            // rank of the key equal to _key, or the key count; the final
+            // comparison is against the node just visited, not the sorted array
+            template <typename K, typename Compare>
+            size_type find(const K &_key, const Compare &_comp) const;
+
+        private:
+            ds::vector<Key> nodes;       // 1-based; nodes[0] is padding
+            ds::vector<size_type> ranks; // sorted position of each node, ranks[0] = count
+            bool isBuilt = false;
+
+            size_type fill(const Key *_sorted, size_type _next, size_type _node);
+
+            // node where the search path last went left, 0 if it never did
+            template <typename Right>
+            size_type descend(Right _right) const;
+        };
+
+        template <typename Key>
+        void eytzinger_index<Key>::build(const Key *_sorted, size_type _count)
+        {
+            clear();
+
+            ranks = ds::vector<size_type>(_count + 1, _count);
+            if (_count != 0)
+            {
+                nodes = ds::vector<Key>(_count + 1, _sorted[0]);
+                fill(_sorted, 0, 1);
+            }
+
+            isBuilt = true;
+        }
+
+        template <typename Key>
+        void eytzinger_index<Key>::clear()
+        {
+            nodes = ds::vector<Key>();
+            ranks = ds::vector<size_type>();
+            isBuilt = false;
+        }
+
+        // in-order walk of the implicit tree hands out the sorted keys
+        template <typename Key>
+        typename eytzinger_index<Key>::size_type eytzinger_index<Key>::fill(const Key *_sorted, size_type _next, size_type _node)
+        {
+            if (_node < nodes.size())
+            {
+                _next = fill(_sorted, _next, 2 * _node);
+                nodes[_node] = _sorted[_next];
+                ranks[_node] = _next;
+                _next = fill(_sorted, _next + 1, 2 * _node + 1);
+            }
+            return _next;
+        }
+
+        template <typename Key>
+        template <typename Right>
+        typename eytzinger_index<Key>::size_type eytzinger_index<Key>::descend(Right _right) const
+        {
+            const size_type count = nodes.size();
+
+            // nodes four levels below k start at 16k
+            constexpr size_type ahead = 16;
+
+            size_type k = 1;
+            while (k < count)
+            {
+#if defined(__GNUC__) || defined(__clang__)
+                if (ahead * k < count)
+                {
+                    __builtin_prefetch(nodes.data() + ahead * k);
+                }
+#endif
+                k = 2 * k + (_right(nodes[k]) ? 1 : 0);
+            }
+
+            // the answer is where the path last went left: drop the trailing
+            // right turns and that left turn
+#if defined(__GNUC__) || defined(__clang__)
+            k >>= __builtin_ctzll(~static_cast<unsigned long long>(k)) + 1;
+#else
+            while (k & 1)
+            {
+                k >>= 1;
+            }
+            k >>= 1;
+#endif
+
+            return k;
+        }
+
+        template <typename Key>
+        template <typename K, typename Compare>
+        typename eytzinger_index<Key>::size_type eytzinger_index<Key>::lower_bound(const K &_key, const Compare &_comp) const
+        {
+            return ranks[descend([&](const Key &_node) { return _comp(_node, _key); })];
+        }
+
+        template <typename Key>
+        template <typename K, typename Compare>
+        typename eytzinger_index<Key>::size_type eytzinger_index<Key>::upper_bound(const K &_key, const Compare &_comp) const
+        {
+            return ranks[descend([&](const Key &_node) { return !_comp(_key, _node); })];
+        }
+
+        template <typename Key>
+        template <typename K, typename Compare>
+        typename eytzinger_index<Key>::size_type eytzinger_index<Key>::find(const K &_key, const Compare &_comp) const
+        {
+            const size_type k = descend([&](const Key &_node) { return _comp(_node, _key); });
+            return k != 0 && !_comp(_key, nodes[k]) ? ranks[k] : ranks[0];
+        }
+    }
+}
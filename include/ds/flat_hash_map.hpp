@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "swiss_table.hpp"
+
+namespace ds
+{
+    namespace detail
+    {
+        template <typename K, typename V>
+        struct map_policy
+        {
+            using key_type = K;
+            using value_type = std::pair<const K, V>;
+            using reference = value_type &;
+            using pointer = value_type *;
+
+            // What a slot holds. The element is constructed as a pair with a
+            // mutable key and read through the layout-compatible value
+            // member, as abseil's map_slot_type does, so a relocation can
+            // move the key without modifying a const object.
+            union slot_type
+            {
+                value_type value;
+                std::pair<K, V> mutableValue;
+
+                template <typename... Args>
+                explicit slot_type(Args &&...args) : mutableValue(std::forward<Args>(args)...) {}
+                ~slot_type() { mutableValue.~pair(); }
+            };
+
+            static value_type *element(slot_type *_slot) { return &_slot->value; }
+            static std::pair<K, V> &&take(slot_type *_slot) { return std::move(_slot->mutableValue); }
+
+            static const K &key(const value_type &_value) { return _value.first; }
+
+            // builds *_to from *_from, which the caller then destroys
+            static void relocate(slot_type *_to, slot_type *_from)
+            {
+                if constexpr (std::is_nothrow_move_constructible_v<K> && std::is_nothrow_move_constructible_v<V>)
+                {
+                    detail::construct_at(_to, std::move(_from->mutableValue));
+                }
+                else
+                {
+                    detail::construct_at(_to, static_cast<const std::pair<K, V> &>(_from->mutableValue));
+                }
+            }
+        };
+    }
+
+    // Open addressing hash map with SwissTable probing: a control byte per
+    // slot holds 7 bits of the hash, and lookups compare a whole group of
+    // them at once (SSE2 when available). Elements live inline in one slot
+    // array, so a hit usually costs one control byte load and one slot load
+    // instead of a bucket and a node as in std::unordered_map. Iterators and
+    // references are invalidated by a rehash, which happens on insert.
+    template <typename Key, typename T, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+    class flat_hash_map : public detail::swiss_table<detail::map_policy<Key, T>, Hash, KeyEqual>
+    {
+        using base = detail::swiss_table<detail::map_policy<Key, T>, Hash, KeyEqual>;
+
+    public:
+        using mapped_type = T;
+        using typename base::const_iterator;
+        using typename base::iterator;
+        using typename base::key_type;
+        using typename base::size_type;
+        using typename base::value_type;
+
+        template <typename K>
+        using key_arg = typename base::template key_arg<K>;
+
+        // constructors
+        flat_hash_map() = default;
+        explicit flat_hash_map(size_type _capacity, const Hash &_hash = Hash(), const KeyEqual &_equal = KeyEqual()) : base(_capacity, _hash, _equal) {}
+        flat_hash_map(std::initializer_list<value_type> _list) { this->insert(_list); }
+
+        template <typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+        flat_hash_map(InputIt _first, InputIt _last) { this->insert(_first, _last); }
+
+        // element access
+        T &operator[](const key_type &_key) { return try_emplace(_key).first->second; }
+        T &operator[](key_type &&_key) { return try_emplace(std::move(_key)).first->second; }
+
+        template <typename K = key_type>
+        T &at(const key_arg<K> &_key);
+        template <typename K = key_type>
+        const T &at(const key_arg<K> &_key) const { return const_cast<flat_hash_map *>(this)->at(_key); }
+
+        // modifiers: the mapped value is only built when the key is new
+        using base::emplace;
+
+        // emplace(key, value) with the key already a key_type skips the
+        // temporary pair
+        template <typename K, typename M, typename = std::enable_if_t<std::is_same_v<std::decay_t<K>, Key>>>
+        std::pair<iterator, bool> emplace(K &&_key, M &&_value) { return try_emplace(std::forward<K>(_key), std::forward<M>(_value)); }
+
+        template <typename... Args>
+        std::pair<iterator, bool> try_emplace(const key_type &_key, Args &&...args)
+        {
+            return this->emplaceKey(_key, std::piecewise_construct, std::forward_as_tuple(_key), std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+
+        template <typename... Args>
+        std::pair<iterator, bool> try_emplace(key_type &&_key, Args &&...args)
+        {
+            return this->emplaceKey(_key, std::piecewise_construct, std::forward_as_tuple(std::move(_key)), std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+
+        template <typename M>
+        std::pair<iterator, bool> insert_or_assign(const key_type &_key, M &&_value);
+        template <typename M>
+        std::pair<iterator, bool> insert_or_assign(key_type &&_key, M &&_value);
+    };
+
+    template <typename Key, typename T, typename Hash, typename KeyEqual>
+    template <typename K>
+    T &flat_hash_map<Key, T, Hash, KeyEqual>::at(const key_arg<K> &_key)
+    {
+        auto it = this->find(_key);
+        if (it == this->end())
+        {
+            throw std::out_of_range("ds::flat_hash_map - key not found");
+        }
+        return it->second;
+    }
+
+    template <typename Key, typename T, typename Hash, typename KeyEqual>
+    template <typename M>
+    std::pair<typename flat_hash_map<Key, T, Hash, KeyEqual>::iterator, bool> flat_hash_map<Key, T, Hash, KeyEqual>::insert_or_assign(const key_type &_key, M &&_value)
+    {
+        auto result = try_emplace(_key, std::forward<M>(_value));
+        if (!result.second)
+        {
+            result.first->second = std::forward<M>(_value);
+        }
+        return result;
+    }
+
+    template <typename Key, typename T, typename Hash, typename KeyEqual>
+    template <typename M>
+    std::pair<typename flat_hash_map<Key, T, Hash, KeyEqual>::iterator, bool> flat_hash_map<Key, T, Hash, KeyEqual>::insert_or_assign(key_type &&_key, M &&_value)
+    {
+        auto result = try_emplace(std::move(_key), std::forward<M>(_value));
+        if (!result.second)
+        {
+            result.first->second = std::forward<M>(_value);
+        }
+        return result;
+    }
+}
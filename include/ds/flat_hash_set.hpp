@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+#include "swiss_table.hpp"
+
+namespace ds
+{
+    namespace detail
+    {
+        template <typename K>
+        struct set_policy
+        {
+            using key_type = K;
+            using value_type = K;
+            using reference = const K &;
+            using pointer = const K *;
+
+            using slot_type = K;
+
+            static K *element(K *_slot) { return _slot; }
+            static K &&take(K *_slot) { return std::move(*_slot); }
+
+            static const K &key(const K &_value) { return _value; }
+
+            // builds *_to from *_from, which the caller then destroys
+            static void relocate(K *_to, K *_from)
+            {
+                if constexpr (std::is_nothrow_move_constructible_v<K>)
+                {
+                    detail::construct_at(_to, std::move(*_from));
+                }
+                else
+                {
+                    detail::construct_at(_to, *_from);
+                }
+            }
+        };
+    }
+
+    // Open addressing hash set with SwissTable probing; see flat_hash_map.
+    // Elements are immutable through iterators, since changing one would
+    // change its hash.
+    template <typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+    class flat_hash_set : public detail::swiss_table<detail::set_policy<Key>, Hash, KeyEqual>
+    {
+        using base = detail::swiss_table<detail::set_policy<Key>, Hash, KeyEqual>;
+
+    public:
+        using typename base::size_type;
+        using typename base::value_type;
+
+        // constructors
+        flat_hash_set() = default;
+        explicit flat_hash_set(size_type _capacity, const Hash &_hash = Hash(), const KeyEqual &_equal = KeyEqual()) : base(_capacity, _hash, _equal) {}
+        flat_hash_set(std::initializer_list<value_type> _list) { this->insert(_list); }
+
+        template <typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+        flat_hash_set(InputIt _first, InputIt _last) { this->insert(_first, _last); }
+    };
+}
@@ -0,0 +1,390 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "eytzinger.hpp"
+#include "flat_map_iterator.hpp"
+#include "key_arg.hpp"
+#include "vector.hpp"
+
+namespace ds
+{
+    // Sorted associative container over two ds::vectors, keys and values
+    // kept apart so a search only walks keys. Single inserts and erases
+    // shift the tail like a vector; insert_range appends, sorts the new
+    // part and merges it in a single pass, which is the way to fill one.
+    // For tables that are built once and then only read,
+    // build_search_index() adds an Eytzinger ordered copy of the keys that
+    // lookups use until the next change to the keys.
+    template <typename Key, typename T, typename Compare = std::less<Key>>
+    class flat_map
+    {
+    public:
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = std::pair<Key, T>;
+        using key_compare = Compare;
+        using size_type = std::size_t;
+        using reference = std::pair<const Key &, T &>;
+        using const_reference = std::pair<const Key &, const T &>;
+
+        using iterator = FlatMapIterator<Key, T, false>;
+        using const_iterator = FlatMapIterator<Key, T, true>;
+
+        template <typename K>
+        using key_arg = typename detail::key_arg_impl<detail::is_transparent<Compare>::value>::template type<K, key_type>;
+
+        // constructors
+        flat_map() = default;
+        explicit flat_map(const Compare &_comp) : comp(_comp) {}
+        flat_map(std::initializer_list<value_type> _list, const Compare &_comp = Compare()) : comp(_comp) { insert_range(_list.begin(), _list.end()); }
+
+        template <typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+        flat_map(InputIt _first, InputIt _last, const Compare &_comp = Compare()) : comp(_comp) { insert_range(_first, _last); }
+
+        // element access
+        T &operator[](const key_type &_key) { return try_emplace(_key).first->second; }
+        T &operator[](key_type &&_key) { return try_emplace(std::move(_key)).first->second; }
+
+        template <typename K = key_type>
+        T &at(const key_arg<K> &_key);
+        template <typename K = key_type>
+        const T &at(const key_arg<K> &_key) const { return const_cast<flat_map *>(this)->at(_key); }
+
+        // the underlying arrays, keys ascending
+        const ds::vector<Key> &keys() const { return keyStore; }
+        const ds::vector<T> &values() const { return valueStore; }
+
+        // iterators
+        iterator begin() { return iterator(keyStore.data(), valueStore.data()); }
+        const_iterator begin() const { return const_iterator(keyStore.data(), valueStore.data()); }
+
+        iterator end() { return begin() + difference(size()); }
+        const_iterator end() const { return begin() + difference(size()); }
+
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+
+        // capacity
+        size_type size() const { return keyStore.size(); }
+        bool empty() const { return keyStore.empty(); }
+        void reserve(size_type _count);
+
+        // lookup; with a transparent Compare the key may be any type it accepts
+        template <typename K = key_type>
+        iterator find(const key_arg<K> &_key) { return begin() + difference(findIndex(_key)); }
+        template <typename K = key_type>
+        const_iterator find(const key_arg<K> &_key) const { return begin() + difference(findIndex(_key)); }
+
+        template <typename K = key_type>
+        bool contains(const key_arg<K> &_key) const { return findIndex(_key) != size(); }
+        template <typename K = key_type>
+        size_type count(const key_arg<K> &_key) const { return contains(_key) ? 1 : 0; }
+
+        template <typename K = key_type>
+        iterator lower_bound(const key_arg<K> &_key) { return begin() + difference(lowerIndex(_key)); }
+        template <typename K = key_type>
+        const_iterator lower_bound(const key_arg<K> &_key) const { return begin() + difference(lowerIndex(_key)); }
+
+        template <typename K = key_type>
+        iterator upper_bound(const key_arg<K> &_key) { return begin() + difference(upperIndex(_key)); }
+        template <typename K = key_type>
+        const_iterator upper_bound(const key_arg<K> &_key) const { return begin() + difference(upperIndex(_key)); }
+
+        // search index for read-mostly maps; any insert or erase drops it
+        void build_search_index() { searchIndex.build(keyStore.data(), size()); }
+        void drop_search_index() { searchIndex.clear(); }
+        bool has_search_index() const { return searchIndex.built(); }
+
+        // modifiers
+        template <typename... Args>
+        std::pair<iterator, bool> try_emplace(const key_type &_key, Args &&...args) { return emplaceKey(_key, std::forward<Args>(args)...); }
+        template <typename... Args>
+        std::pair<iterator, bool> try_emplace(key_type &&_key, Args &&...args) { return emplaceKey(std::move(_key), std::forward<Args>(args)...); }
+
+        std::pair<iterator, bool> insert(const value_type &_value) { return emplaceKey(_value.first, _value.second); }
+        std::pair<iterator, bool> insert(value_type &&_value) { return emplaceKey(std::move(_value.first), std::move(_value.second)); }
+
+        template <typename M>
+        std::pair<iterator, bool> insert_or_assign(const key_type &_key, M &&_value);
+
+        // Inserts a batch in O((n + m) log m) rather than O(n) per element:
+        // appends, stable sorts the new elements by key and merges them with
+        // the existing ones. As with single inserts an existing key keeps
+        // its value, and among new duplicates the first one wins.
+        template <typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+        void insert_range(InputIt _first, InputIt _last);
+        void insert_range(std::initializer_list<value_type> _list) { insert_range(_list.begin(), _list.end()); }
+
+        template <typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+        void insert(InputIt _first, InputIt _last) { insert_range(_first, _last); }
+
+        iterator erase(const_iterator _position) { return erase(_position, _position + 1); }
+        iterator erase(const_iterator _first, const_iterator _last);
+
+        template <typename K = key_type>
+        size_type erase(const key_arg<K> &_key);
+
+        void clear();
+
+        // observers
+        key_compare key_comp() const { return comp; }
+
+    private:
+        ds::vector<Key> keyStore;
+        ds::vector<T> valueStore;
+        Compare comp;
+        detail::eytzinger_index<Key> searchIndex;
+
+        static std::ptrdiff_t difference(size_type _index) { return std::ptrdiff_t(_index); }
+
+        template <typename K>
+        size_type lowerIndex(const K &_key) const;
+        template <typename K>
+        size_type upperIndex(const K &_key) const;
+        template <typename K>
+        size_type findIndex(const K &_key) const;
+
+        template <typename K, typename... Args>
+        std::pair<iterator, bool> emplaceKey(K &&_key, Args &&...args);
+    };
+
+    template <typename Key, typename T, typename Compare>
+    template <typename K>
+    T &flat_map<Key, T, Compare>::at(const key_arg<K> &_key)
+    {
+        const size_type i = findIndex(_key);
+        if (i == size())
+        {
+            throw std::out_of_range("ds::flat_map - key not found");
+        }
+        return valueStore[i];
+    }
+
+    template <typename Key, typename T, typename Compare>
+    void flat_map<Key, T, Compare>::reserve(size_type _count)
+    {
+        keyStore.reserve(_count);
+        valueStore.reserve(_count);
+    }
+
+    template <typename Key, typename T, typename Compare>
+    template <typename K>
+    typename flat_map<Key, T, Compare>::size_type flat_map<Key, T, Compare>::lowerIndex(const K &_key) const
+    {
+        if (searchIndex.built())
+        {
+            return searchIndex.lower_bound(_key, comp);
+        }
+        return size_type(std::lower_bound(keyStore.data(), keyStore.data() + size(), _key, comp) - keyStore.data());
+    }
+
+    template <typename Key, typename T, typename Compare>
+    template <typename K>
+    typename flat_map<Key, T, Compare>::size_type flat_map<Key, T, Compare>::upperIndex(const K &_key) const
+    {
+        if (searchIndex.built())
+        {
+            return searchIndex.upper_bound(_key, comp);
+        }
+        return size_type(std::upper_bound(keyStore.data(), keyStore.data() + size(), _key, comp) - keyStore.data());
+    }
+
+    // position of _key, or size() if absent
+    template <typename Key, typename T, typename Compare>
+    template <typename K>
+    typename flat_map<Key, T, Compare>::size_type flat_map<Key, T, Compare>::findIndex(const K &_key) const
+    {
+        if (searchIndex.built())
+        {
+            return searchIndex.find(_key, comp);
+        }
+
+        const size_type i = lowerIndex(_key);
+        return i != size() && !comp(_key, keyStore[i]) ? i : size();
+    }
+
+    template <typename Key, typename T, typename Compare>
+    template <typename K, typename... Args>
+    std::pair<typename flat_map<Key, T, Compare>::iterator, bool> flat_map<Key, T, Compare>::emplaceKey(K &&_key, Args &&...args)
+    {
+        const size_type i = lowerIndex(_key);
+        if (i != size() && !comp(_key, keyStore[i]))
+        {
+            return {begin() + difference(i), false};
+        }
+
+        // the value first: building it may throw, and it may refer into the map
+        T value(std::forward<Args>(args)...);
+
+        keyStore.insert(keyStore.begin() + difference(i), Key(std::forward<K>(_key)));
+        try
+        {
+            valueStore.insert(valueStore.begin() + difference(i), std::move(value));
+        }
+        catch (...)
+        {
+            keyStore.erase(keyStore.begin() + difference(i));
+            throw;
+        }
+
+        searchIndex.clear();
+        return {begin() + difference(i), true};
+    }
+
+    template <typename Key, typename T, typename Compare>
+    template <typename M>
+    std::pair<typename flat_map<Key, T, Compare>::iterator, bool> flat_map<Key, T, Compare>::insert_or_assign(const key_type &_key, M &&_value)
+    {
+        auto result = try_emplace(_key, std::forward<M>(_value));
+        if (!result.second)
+        {
+            result.first->second = std::forward<M>(_value);
+        }
+        return result;
+    }
+
+    template <typename Key, typename T, typename Compare>
+    template <typename InputIt, typename>
+    void flat_map<Key, T, Compare>::insert_range(InputIt _first, InputIt _last)
+    {
+        const size_type oldSize = size();
+
+        try
+        {
+            for (; _first != _last; ++_first)
+            {
+                const auto &kv = *_first;
+                keyStore.push_back(kv.first);
+                try
+                {
+                    valueStore.push_back(kv.second);
+                }
+                catch (...)
+                {
+                    keyStore.pop_back();
+                    throw;
+                }
+            }
+        }
+        catch (...)
+        {
+            keyStore.erase(keyStore.begin() + difference(oldSize), keyStore.end());
+            valueStore.erase(valueStore.begin() + difference(oldSize), valueStore.end());
+            throw;
+        }
+
+        const size_type total = size();
+        if (total == oldSize)
+        {
+            return;
+        }
+
+        searchIndex.clear();
+
+        // when entries are copied, a throw leaves the old entries as they
+        // were and only the appended batch has to go
+        ds::vector<Key> mergedKeys;
+        ds::vector<T> mergedValues;
+        try
+        {
+            // order of the new elements; stable so the first of equal keys wins
+            ds::vector<size_type> order(total - oldSize);
+            for (size_type j = 0; j < order.size(); j++)
+            {
+                order[j] = oldSize + j;
+            }
+            std::stable_sort(order.data(), order.data() + order.size(), [this](size_type _a, size_type _b)
+                             { return comp(keyStore[_a], keyStore[_b]); });
+
+            mergedKeys.reserve(total);
+            mergedValues.reserve(total);
+
+            // an old key sorts first among equals, so existing entries win;
+            // anything not greater than the last key taken is a duplicate
+            size_type i = 0;
+            size_type j = 0;
+            while (i < oldSize || j < order.size())
+            {
+                size_type from;
+                if (j == order.size() || (i < oldSize && !comp(keyStore[order[j]], keyStore[i])))
+                {
+                    from = i++;
+                }
+                else
+                {
+                    from = order[j++];
+                }
+
+                if (mergedKeys.empty() || comp(mergedKeys.back(), keyStore[from]))
+                {
+                    // one decision for both arrays: moving only one of them and
+                    // then throwing on the other would leave keys and values apart
+                    if constexpr (std::is_nothrow_move_constructible_v<Key> && std::is_nothrow_move_constructible_v<T>)
+                    {
+                        mergedKeys.push_back(std::move(keyStore[from]));
+                        mergedValues.push_back(std::move(valueStore[from]));
+                    }
+                    else
+                    {
+                        mergedKeys.push_back(keyStore[from]);
+                        mergedValues.push_back(valueStore[from]);
+                    }
+                }
+            }
+        }
+        catch (...)
+        {
+            keyStore.erase(keyStore.begin() + difference(oldSize), keyStore.end());
+            valueStore.erase(valueStore.begin() + difference(oldSize), valueStore.end());
+            throw;
+        }
+
+        keyStore = std::move(mergedKeys);
+        valueStore = std::move(mergedValues);
+    }
+
+    template <typename Key, typename T, typename Compare>
+    typename flat_map<Key, T, Compare>::iterator flat_map<Key, T, Compare>::erase(const_iterator _first, const_iterator _last)
+    {
+        const std::ptrdiff_t first = _first - cbegin();
+        const std::ptrdiff_t last = _last - cbegin();
+
+        if (first != last)
+        {
+            keyStore.erase(keyStore.begin() + first, keyStore.begin() + last);
+            valueStore.erase(valueStore.begin() + first, valueStore.begin() + last);
+            searchIndex.clear();
+        }
+
+        return begin() + first;
+    }
+
+    template <typename Key, typename T, typename Compare>
+    template <typename K>
+    typename flat_map<Key, T, Compare>::size_type flat_map<Key, T, Compare>::erase(const key_arg<K> &_key)
+    {
+        const size_type i = findIndex(_key);
+        if (i == size())
+        {
+            return 0;
+        }
+
+        erase(cbegin() + difference(i));
+        return 1;
+    }
+
+    template <typename Key, typename T, typename Compare>
+    void flat_map<Key, T, Compare>::clear()
+    {
+        keyStore.clear();
+        valueStore.clear();
+        searchIndex.clear();
+    }
+}
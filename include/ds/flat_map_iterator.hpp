@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace ds
+{
+    // Random access iterator over flat_map's separate key and value arrays.
+    // Dereferencing yields a pair of references rather than a stored pair,
+    // so operator-> goes through a small proxy.
+    template <typename Key, typename T, bool Const>
+    class FlatMapIterator
+    {
+        using mapped_pointer = std::conditional_t<Const, const T *, T *>;
+        using mapped_reference = std::conditional_t<Const, const T &, T &>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::pair<Key, T>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::pair<const Key &, mapped_reference>;
+
+        struct pointer
+        {
+            reference ref;
+            reference *operator->() { return &ref; }
+        };
+
+        FlatMapIterator() = default;
+        FlatMapIterator(const Key *_key, mapped_pointer _value) : key(_key), value(_value) {}
+
+        template <bool C, typename = std::enable_if_t<Const && !C>>
+        FlatMapIterator(const FlatMapIterator<Key, T, C> &_other) : key(_other.key), value(_other.value) {}
+
+        reference operator*() const { return reference(*key, *value); }
+        pointer operator->() const { return pointer{**this}; }
+        reference operator[](difference_type _n) const { return reference(key[_n], value[_n]); }
+
+        FlatMapIterator &operator++() { ++key; ++value; return *this; }
+        FlatMapIterator operator++(int) { FlatMapIterator tmp = *this; ++*this; return tmp; }
+        FlatMapIterator &operator--() { --key; --value; return *this; }
+        FlatMapIterator operator--(int) { FlatMapIterator tmp = *this; --*this; return tmp; }
+
+        FlatMapIterator &operator+=(difference_type _n) { key += _n; value += _n; return *this; }
+        FlatMapIterator &operator-=(difference_type _n) { key -= _n; value -= _n; return *this; }
+        FlatMapIterator operator+(difference_type _n) const { return FlatMapIterator(key + _n, value + _n); }
+        FlatMapIterator operator-(difference_type _n) const { return FlatMapIterator(key - _n, value - _n); }
+
+        template <bool C>
+        difference_type operator-(const FlatMapIterator<Key, T, C> &_other) const { return key - _other.key; }
+
+        template <bool C>
+        bool operator==(const FlatMapIterator<Key, T, C> &_other) const { return key == _other.key; }
+        template <bool C>
+        bool operator!=(const FlatMapIterator<Key, T, C> &_other) const { return key != _other.key; }
+        template <bool C>
+        bool operator<(const FlatMapIterator<Key, T, C> &_other) const { return key < _other.key; }
+        template <bool C>
+        bool operator>(const FlatMapIterator<Key, T, C> &_other) const { return key > _other.key; }
+        template <bool C>
+        bool operator<=(const FlatMapIterator<Key, T, C> &_other) const { return key <= _other.key; }
+        template <bool C>
+        bool operator>=(const FlatMapIterator<Key, T, C> &_other) const { return key >= _other.key; }
+
+    private:
+        template <typename K, typename V, bool C>
+        friend class FlatMapIterator;
+
+        const Key *key = nullptr;
+        mapped_pointer value = nullptr;
+    };
+}
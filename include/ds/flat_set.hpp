@@ -0,0 +1,251 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+#include "eytzinger.hpp"
+#include "key_arg.hpp"
+#include "vector.hpp"
+
+namespace ds
+{
+    // Sorted set over one ds::vector; see flat_map for insert_range and the
+    // optional Eytzinger search index.
+    template <typename Key, typename Compare = std::less<Key>>
+    class flat_set
+    {
+    public:
+        using key_type = Key;
+        using value_type = Key;
+        using key_compare = Compare;
+        using size_type = std::size_t;
+
+        // elements are immutable, since changing one would break the order
+        using iterator = typename ds::vector<Key>::const_iterator;
+        using const_iterator = iterator;
+
+        template <typename K>
+        using key_arg = typename detail::key_arg_impl<detail::is_transparent<Compare>::value>::template type<K, key_type>;
+
+        // constructors
+        flat_set() = default;
+        explicit flat_set(const Compare &_comp) : comp(_comp) {}
+        flat_set(std::initializer_list<Key> _list, const Compare &_comp = Compare()) : comp(_comp) { insert_range(_list.begin(), _list.end()); }
+
+        template <typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+        flat_set(InputIt _first, InputIt _last, const Compare &_comp = Compare()) : comp(_comp) { insert_range(_first, _last); }
+
+        // the underlying array, ascending
+        const ds::vector<Key> &keys() const { return keyStore; }
+
+        // iterators
+        const_iterator begin() const { return keyStore.cbegin(); }
+        const_iterator end() const { return keyStore.cend(); }
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+
+        // capacity
+        size_type size() const { return keyStore.size(); }
+        bool empty() const { return keyStore.empty(); }
+        void reserve(size_type _count) { keyStore.reserve(_count); }
+
+        // lookup; with a transparent Compare the key may be any type it accepts
+        template <typename K = key_type>
+        const_iterator find(const key_arg<K> &_key) const { return begin() + difference(findIndex(_key)); }
+        template <typename K = key_type>
+        bool contains(const key_arg<K> &_key) const { return findIndex(_key) != size(); }
+        template <typename K = key_type>
+        size_type count(const key_arg<K> &_key) const { return contains(_key) ? 1 : 0; }
+
+        template <typename K = key_type>
+        const_iterator lower_bound(const key_arg<K> &_key) const { return begin() + difference(lowerIndex(_key)); }
+        template <typename K = key_type>
+        const_iterator upper_bound(const key_arg<K> &_key) const { return begin() + difference(upperIndex(_key)); }
+
+        // search index for read-mostly sets; any insert or erase drops it
+        void build_search_index() { searchIndex.build(keyStore.data(), size()); }
+        void drop_search_index() { searchIndex.clear(); }
+        bool has_search_index() const { return searchIndex.built(); }
+
+        // modifiers
+        std::pair<iterator, bool> insert(const Key &_key) { return emplaceKey(_key); }
+        std::pair<iterator, bool> insert(Key &&_key) { return emplaceKey(std::move(_key)); }
+
+        // batched insert: append, sort the new keys, merge; O((n + m) log m)
+        template <typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+        void insert_range(InputIt _first, InputIt _last);
+        void insert_range(std::initializer_list<Key> _list) { insert_range(_list.begin(), _list.end()); }
+
+        template <typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+        void insert(InputIt _first, InputIt _last) { insert_range(_first, _last); }
+
+        iterator erase(const_iterator _position) { return erase(_position, _position + 1); }
+        iterator erase(const_iterator _first, const_iterator _last);
+
+        template <typename K = key_type>
+        size_type erase(const key_arg<K> &_key);
+
+        void clear();
+
+        // observers
+        key_compare key_comp() const { return comp; }
+
+    private:
+        ds::vector<Key> keyStore;
+        Compare comp;
+        detail::eytzinger_index<Key> searchIndex;
+
+        static std::ptrdiff_t difference(size_type _index) { return std::ptrdiff_t(_index); }
+
+        template <typename K>
+        size_type lowerIndex(const K &_key) const;
+        template <typename K>
+        size_type upperIndex(const K &_key) const;
+        template <typename K>
+        size_type findIndex(const K &_key) const;
+
+        template <typename K>
+        std::pair<iterator, bool> emplaceKey(K &&_key);
+    };
+
+    template <typename Key, typename Compare>
+    template <typename K>
+    typename flat_set<Key, Compare>::size_type flat_set<Key, Compare>::lowerIndex(const K &_key) const
+    {
+        if (searchIndex.built())
+        {
+            return searchIndex.lower_bound(_key, comp);
+        }
+        return size_type(std::lower_bound(keyStore.data(), keyStore.data() + size(), _key, comp) - keyStore.data());
+    }
+
+    template <typename Key, typename Compare>
+    template <typename K>
+    typename flat_set<Key, Compare>::size_type flat_set<Key, Compare>::upperIndex(const K &_key) const
+    {
+        if (searchIndex.built())
+        {
+            return searchIndex.upper_bound(_key, comp);
+        }
+        return size_type(std::upper_bound(keyStore.data(), keyStore.data() + size(), _key, comp) - keyStore.data());
+    }
+
+    // position of _key, or size() if absent
+    template <typename Key, typename Compare>
+    template <typename K>
+    typename flat_set<Key, Compare>::size_type flat_set<Key, Compare>::findIndex(const K &_key) const
+    {
+        if (searchIndex.built())
+        {
+            return searchIndex.find(_key, comp);
+        }
+
+        const size_type i = lowerIndex(_key);
+        return i != size() && !comp(_key, keyStore[i]) ? i : size();
+    }
+
+    template <typename Key, typename Compare>
+    template <typename K>
+    std::pair<typename flat_set<Key, Compare>::iterator, bool> flat_set<Key, Compare>::emplaceKey(K &&_key)
+    {
+        const size_type i = lowerIndex(_key);
+        if (i != size() && !comp(_key, keyStore[i]))
+        {
+            return {begin() + difference(i), false};
+        }
+
+        keyStore.insert(keyStore.begin() + difference(i), Key(std::forward<K>(_key)));
+        searchIndex.clear();
+
+        return {begin() + difference(i), true};
+    }
+
+    template <typename Key, typename Compare>
+    template <typename InputIt, typename>
+    void flat_set<Key, Compare>::insert_range(InputIt _first, InputIt _last)
+    {
+        const size_type oldSize = size();
+
+        try
+        {
+            for (; _first != _last; ++_first)
+            {
+                keyStore.push_back(*_first);
+            }
+        }
+        catch (...)
+        {
+            keyStore.erase(keyStore.begin() + difference(oldSize), keyStore.end());
+            throw;
+        }
+
+        const size_type total = size();
+        if (total == oldSize)
+        {
+            return;
+        }
+
+        searchIndex.clear();
+
+        Key *keys = keyStore.data();
+        std::stable_sort(keys + oldSize, keys + total, comp);
+
+        ds::vector<Key> merged;
+        merged.reserve(total);
+
+        // an old key sorts first among equals, so anything not greater than
+        // the last key taken is a duplicate
+        size_type i = 0;
+        size_type j = oldSize;
+        while (i < oldSize || j < total)
+        {
+            const size_type from = j == total || (i < oldSize && !comp(keys[j], keys[i])) ? i++ : j++;
+
+            if (merged.empty() || comp(merged.back(), keys[from]))
+            {
+                merged.push_back(std::move_if_noexcept(keys[from]));
+            }
+        }
+
+        keyStore = std::move(merged);
+    }
+
+    template <typename Key, typename Compare>
+    typename flat_set<Key, Compare>::iterator flat_set<Key, Compare>::erase(const_iterator _first, const_iterator _last)
+    {
+        const std::ptrdiff_t first = _first - begin();
+
+        if (_first != _last)
+        {
+            keyStore.erase(_first, _last);
+            searchIndex.clear();
+        }
+
+        return begin() + first;
+    }
+
+    template <typename Key, typename Compare>
+    template <typename K>
+    typename flat_set<Key, Compare>::size_type flat_set<Key, Compare>::erase(const key_arg<K> &_key)
+    {
+        const size_type i = findIndex(_key);
+        if (i == size())
+        {
+            return 0;
+        }
+
+        erase(begin() + difference(i));
+        return 1;
+    }
+
+    template <typename Key, typename Compare>
+    void flat_set<Key, Compare>::clear()
+    {
+        keyStore.clear();
+        searchIndex.clear();
+    }
+}
@@ -0,0 +1,523 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "index_iterator.hpp"
+#include "memory.hpp"
+
+namespace ds
+{
+    // Sequence stored in one buffer with a movable gap of free slots. Elements
+    // [0, gapStart) sit before the gap and the rest after it, at the end of
+    // the buffer. Inserting or erasing at the gap is O(1); elsewhere the gap
+    // first moves there, costing only the distance moved, so runs of edits
+    // around one position avoid vector's shift of the whole tail. Growth
+    // doubles the capacity like ds::vector.
+    template <typename T>
+    class gap_buffer
+    {
+    public:
+        using value_type = T;
+        using pointer = T *;
+        using const_pointer = const T *;
+        using reference = T &;
+        using const_reference = const T &;
+        using size_type = std::size_t;
+
+        using iterator = IndexIterator<gap_buffer, reference, pointer>;
+        using const_iterator = IndexIterator<const gap_buffer, const_reference, const_pointer>;
+
+        // constructors
+        gap_buffer() noexcept = default;
+        explicit gap_buffer(size_type _count);
+        gap_buffer(size_type _count, const T &_value);
+        gap_buffer(std::initializer_list<T> _li);
+        gap_buffer(const gap_buffer &_other);
+        gap_buffer(gap_buffer &&_temp) noexcept;
+
+        // destructors
+        ~gap_buffer() noexcept;
+
+        // operator=
+        gap_buffer &operator=(const gap_buffer &_other);
+        gap_buffer &operator=(gap_buffer &&_other) noexcept;
+
+        // element access
+        reference at(size_type _index);
+        const_reference at(size_type _index) const;
+
+        reference operator[](size_type _index) { return array[_index < gapStart ? _index : _index + gapLength()]; }
+        const_reference operator[](size_type _index) const { return array[_index < gapStart ? _index : _index + gapLength()]; }
+
+        reference front() { return (*this)[0]; }
+        const_reference front() const { return (*this)[0]; }
+
+        reference back() { return (*this)[size() - 1]; }
+        const_reference back() const { return (*this)[size() - 1]; }
+
+        // Closes the gap by moving it to the end and returns the elements as
+        // one array of size(). Inserting at the end keeps it contiguous.
+        pointer contiguous();
+
+        // iterators
+        iterator begin() { return iterator(this, 0); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+
+        iterator end() { return iterator(this, size()); }
+        const_iterator end() const { return const_iterator(this, size()); }
+
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+
+        // capacity
+        size_type size() const { return reservedSize - gapLength(); }
+        size_type capacity() const { return reservedSize; }
+        bool empty() const { return size() == 0; }
+        void reserve(size_type _new_cap);
+        void shrink_to_fit();
+
+        // gap
+        size_type gap_position() const { return gapStart; }
+        void move_gap(size_type _position);
+
+        // modifiers
+        void clear();
+
+        iterator insert(const_iterator _position, const T &_value);
+        iterator insert(const_iterator _position, T &&_value);
+        iterator insert(const_iterator _position, size_type _count, const T &_value);
+        iterator insert(const_iterator _position, std::initializer_list<T> _li);
+
+        template <typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+        iterator insert(const_iterator _position, InputIt _first, InputIt _last);
+
+        template <typename... Args>
+        iterator emplace(const_iterator _position, Args &&...args);
+
+        iterator erase(const_iterator _position);
+        iterator erase(const_iterator _first, const_iterator _last);
+
+        void push_back(const T &_value) { emplace(cend(), _value); }
+        void push_back(T &&_value) { emplace(cend(), std::move(_value)); }
+        void pop_back() { erase(cend() - 1); }
+
+    private:
+        pointer array = nullptr;
+
+        size_type reservedSize = 0;
+        size_type gapStart = 0;
+        size_type gapEnd = 0;
+
+        size_type gapLength() const { return gapEnd - gapStart; }
+
+        bool isElement(const T *_p) const;
+        void relocate(pointer _dest, pointer _source, size_type _count);
+        void growGap(size_type _needed);
+        void release() noexcept;
+    };
+
+    template <typename T>
+    bool gap_buffer<T>::isElement(const T *_p) const
+    {
+        std::less<const T *> less;
+
+        return (!less(_p, array) && less(_p, array + gapStart)) ||
+               (!less(_p, array + gapEnd) && less(_p, array + reservedSize));
+    }
+
+    // moves _count elements into raw slots and leaves the source slots raw;
+    // the ranges may overlap
+    template <typename T>
+    void gap_buffer<T>::relocate(pointer _dest, pointer _source, size_type _count)
+    {
+        if (_count == 0 || _dest == _source)
+        {
+            return;
+        }
+
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            std::memmove(static_cast<void *>(_dest), static_cast<const void *>(_source), _count * sizeof(T));
+        }
+        else if (_dest < _source)
+        {
+            for (size_type i = 0; i < _count; i++)
+            {
+                detail::construct_at(_dest + i, std::move(_source[i]));
+                _source[i].~T();
+            }
+        }
+        else
+        {
+            for (size_type i = _count; i-- > 0;)
+            {
+                detail::construct_at(_dest + i, std::move(_source[i]));
+                _source[i].~T();
+            }
+        }
+    }
+
+    // reallocates so the gap holds at least _needed slots
+    template <typename T>
+    void gap_buffer<T>::growGap(size_type _needed)
+    {
+        if (gapLength() >= _needed)
+        {
+            return;
+        }
+
+        const size_type used = size();
+        size_type newCapacity = reservedSize == 0 ? 1 : reservedSize * 2;
+
+        if (newCapacity < used + _needed)
+        {
+            newCapacity = used + _needed;
+        }
+
+        pointer tempArray = detail::allocate<T>(newCapacity);
+        const size_type tail = reservedSize - gapEnd;
+
+        relocate(tempArray, array, gapStart);
+        relocate(tempArray + newCapacity - tail, array + gapEnd, tail);
+
+        detail::deallocate(array, reservedSize);
+
+        array = tempArray;
+        gapEnd = newCapacity - tail;
+        reservedSize = newCapacity;
+    }
+
+    template <typename T>
+    void gap_buffer<T>::release() noexcept
+    {
+        clear();
+        detail::deallocate(array, reservedSize);
+
+        array = nullptr;
+        reservedSize = gapStart = gapEnd = 0;
+    }
+
+    // parameterised constructor
+    template <typename T>
+    gap_buffer<T>::gap_buffer(size_type _count) : gap_buffer()
+    {
+        reserve(_count);
+
+        for (; gapStart < _count; gapStart++)
+        {
+            detail::construct_at(array + gapStart);
+        }
+    }
+
+    // parameterised constructor
+    template <typename T>
+    gap_buffer<T>::gap_buffer(size_type _count, const T &_value) : gap_buffer()
+    {
+        insert(cend(), _count, _value);
+    }
+
+    // initializer list constructor
+    template <typename T>
+    gap_buffer<T>::gap_buffer(std::initializer_list<T> _li) : gap_buffer()
+    {
+        insert(cend(), _li.begin(), _li.end());
+    }
+
+    // copy constructor: the copy has its gap at the end
+    template <typename T>
+    gap_buffer<T>::gap_buffer(const gap_buffer &_other) : gap_buffer()
+    {
+        insert(cend(), _other.begin(), _other.end());
+    }
+
+    // move constructor
+    template <typename T>
+    gap_buffer<T>::gap_buffer(gap_buffer &&_temp) noexcept : array(_temp.array),
+                                                             reservedSize(_temp.reservedSize),
+                                                             gapStart(_temp.gapStart),
+                                                             gapEnd(_temp.gapEnd)
+    {
+        _temp.array = nullptr;
+        _temp.reservedSize = _temp.gapStart = _temp.gapEnd = 0;
+    }
+
+    // destructor
+    template <typename T>
+    gap_buffer<T>::~gap_buffer() noexcept
+    {
+        release();
+    }
+
+    // copy assignment
+    template <typename T>
+    gap_buffer<T> &gap_buffer<T>::operator=(const gap_buffer &_other)
+    {
+        if (this != &_other)
+        {
+            gap_buffer copy(_other);
+            *this = std::move(copy);
+        }
+
+        return *this;
+    }
+
+    // move assignment
+    template <typename T>
+    gap_buffer<T> &gap_buffer<T>::operator=(gap_buffer &&_other) noexcept
+    {
+        if (this == &_other)
+        {
+            return *this;
+        }
+
+        release();
+
+        array = _other.array;
+        reservedSize = _other.reservedSize;
+        gapStart = _other.gapStart;
+        gapEnd = _other.gapEnd;
+
+        _other.array = nullptr;
+        _other.reservedSize = _other.gapStart = _other.gapEnd = 0;
+
+        return *this;
+    }
+
+    template <typename T>
+    typename gap_buffer<T>::reference gap_buffer<T>::at(size_type _index)
+    {
+        if (_index >= size())
+        {
+            throw std::out_of_range("ds::gap_buffer - index is out of bounds");
+        }
+        return (*this)[_index];
+    }
+
+    template <typename T>
+    typename gap_buffer<T>::const_reference gap_buffer<T>::at(size_type _index) const
+    {
+        if (_index >= size())
+        {
+            throw std::out_of_range("ds::gap_buffer - index is out of bounds");
+        }
+        return (*this)[_index];
+    }
+
+    template <typename T>
+    typename gap_buffer<T>::pointer gap_buffer<T>::contiguous()
+    {
+        move_gap(size());
+        return array;
+    }
+
+    template <typename T>
+    void gap_buffer<T>::reserve(size_type _new_cap)
+    {
+        if (_new_cap > reservedSize)
+        {
+            growGap(_new_cap - size());
+        }
+    }
+
+    template <typename T>
+    void gap_buffer<T>::shrink_to_fit()
+    {
+        if (gapLength() == 0)
+        {
+            return;
+        }
+
+        const size_type used = size();
+        pointer tempArray = used == 0 ? nullptr : detail::allocate<T>(used);
+
+        relocate(tempArray, array, gapStart);
+        relocate(tempArray + gapStart, array + gapEnd, reservedSize - gapEnd);
+
+        detail::deallocate(array, reservedSize);
+
+        array = tempArray;
+        reservedSize = gapStart = gapEnd = used;
+    }
+
+    // Moves the gap so that it starts before element _position; only the
+    // elements between the old and the new place are moved.
+    template <typename T>
+    void gap_buffer<T>::move_gap(size_type _position)
+    {
+        if (_position > size())
+        {
+            throw std::out_of_range("ds::gap_buffer - gap position is out of bounds");
+        }
+
+        if (_position < gapStart)
+        {
+            const size_type count = gapStart - _position;
+            relocate(array + gapEnd - count, array + _position, count);
+            gapStart -= count;
+            gapEnd -= count;
+        }
+        else if (_position > gapStart)
+        {
+            const size_type count = _position - gapStart;
+            relocate(array + gapStart, array + gapEnd, count);
+            gapStart += count;
+            gapEnd += count;
+        }
+    }
+
+    template <typename T>
+    void gap_buffer<T>::clear()
+    {
+        for (size_type i = 0; i < gapStart; i++)
+        {
+            array[i].~T();
+        }
+
+        for (size_type i = gapEnd; i < reservedSize; i++)
+        {
+            array[i].~T();
+        }
+
+        gapStart = 0;
+        gapEnd = reservedSize;
+    }
+
+    template <typename T>
+    typename gap_buffer<T>::iterator gap_buffer<T>::insert(const_iterator _position, const T &_value)
+    {
+        return emplace(_position, _value);
+    }
+
+    template <typename T>
+    typename gap_buffer<T>::iterator gap_buffer<T>::insert(const_iterator _position, T &&_value)
+    {
+        return emplace(_position, std::move(_value));
+    }
+
+    template <typename T>
+    typename gap_buffer<T>::iterator gap_buffer<T>::insert(const_iterator _position, size_type _count, const T &_value)
+    {
+        const size_type index = _position.position();
+
+        if (_count == 0)
+        {
+            return begin() + index;
+        }
+
+        if (isElement(&_value))
+        {
+            const T copy(_value);
+            return insert(_position, _count, copy);
+        }
+
+        growGap(_count);
+        move_gap(index);
+
+        for (size_type i = 0; i < _count; i++)
+        {
+            detail::construct_at(array + gapStart, _value);
+            gapStart++;
+        }
+
+        return begin() + index;
+    }
+
+    template <typename T>
+    typename gap_buffer<T>::iterator gap_buffer<T>::insert(const_iterator _position, std::initializer_list<T> _li)
+    {
+        return insert(_position, _li.begin(), _li.end());
+    }
+
+    // Forward ranges are counted first so the gap grows once; input ranges
+    // grow it as they go. The range must not refer into this buffer.
+    template <typename T>
+    template <typename InputIt, typename>
+    typename gap_buffer<T>::iterator gap_buffer<T>::insert(const_iterator _position, InputIt _first, InputIt _last)
+    {
+        const size_type index = _position.position();
+
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>)
+        {
+            growGap(size_type(std::distance(_first, _last)));
+        }
+
+        move_gap(index);
+
+        for (; _first != _last; ++_first)
+        {
+            growGap(1);
+            detail::construct_at(array + gapStart, *_first);
+            gapStart++;
+        }
+
+        return begin() + index;
+    }
+
+    template <typename T>
+    template <typename... Args>
+    typename gap_buffer<T>::iterator gap_buffer<T>::emplace(const_iterator _position, Args &&...args)
+    {
+        const size_type index = _position.position();
+
+        if (gapLength() == 0 || index != gapStart)
+        {
+            // args may refer to an element that growing or moving the gap relocates
+            if constexpr (sizeof...(Args) == 1 && (std::is_same_v<std::decay_t<Args>, T> && ...))
+            {
+                if ((isElement(&args) || ...))
+                {
+                    T copy(std::forward<Args>(args)...);
+                    growGap(1);
+                    move_gap(index);
+                    detail::construct_at(array + gapStart, std::move(copy));
+                    gapStart++;
+                    return begin() + index;
+                }
+            }
+
+            growGap(1);
+            move_gap(index);
+        }
+
+        detail::construct_at(array + gapStart, std::forward<Args>(args)...);
+        gapStart++;
+
+        return begin() + index;
+    }
+
+    template <typename T>
+    typename gap_buffer<T>::iterator gap_buffer<T>::erase(const_iterator _position)
+    {
+        return erase(_position, _position + 1);
+    }
+
+    // moves the gap to _first and widens it over the erased elements
+    template <typename T>
+    typename gap_buffer<T>::iterator gap_buffer<T>::erase(const_iterator _first, const_iterator _last)
+    {
+        const size_type index = _first.position();
+        const size_type count = _last.position() - index;
+
+        if (count == 0)
+        {
+            return begin() + index;
+        }
+
+        move_gap(index);
+
+        for (size_type i = 0; i < count; i++)
+        {
+            array[gapEnd].~T();
+            gapEnd++;
+        }
+
+        return begin() + index;
+    }
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+
+#include "deque.hpp"
+#include "vector.hpp"
+
+namespace ds
+{
+    namespace detail
+    {
+        // how many lookups ahead the prefetches run; about enough to cover a
+        // DRAM access at a few nanoseconds per element
+        inline constexpr std::size_t GATHER_PREFETCH_DISTANCE = 16;
+
+        // lines prefetched per element at most, for elements wider than one
+        inline constexpr std::size_t GATHER_MAX_LINES = 16;
+        inline constexpr std::size_t GATHER_LINE_BYTES = 64;
+
+        template <typename T>
+        inline void gather_prefetch(const T *_p)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            constexpr std::size_t lines = (sizeof(T) + GATHER_LINE_BYTES - 1) / GATHER_LINE_BYTES;
+            constexpr std::size_t count = lines < GATHER_MAX_LINES ? lines : GATHER_MAX_LINES;
+            for (std::size_t line = 0; line < count; line++)
+            {
+                __builtin_prefetch(reinterpret_cast<const char *>(_p) + line * GATHER_LINE_BYTES);
+            }
+#else
+            (void)_p;
+#endif
+        }
+
+        template <typename Indices>
+        std::size_t gather_count(const Indices &_indices)
+        {
+            return std::size_t(std::size(_indices));
+        }
+    }
+
+    // gives ds::gather the deque's block map
+    struct gather_access
+    {
+        template <typename T>
+        static T *const *first_node(const deque<T> &_d) { return _d.firstNode(); }
+
+        template <typename T>
+        static std::size_t first_offset(const deque<T> &_d) { return _d.firstOffset(); }
+
+        template <typename T>
+        static constexpr std::size_t block_size() { return deque<T>::deque_block_size(); }
+    };
+
+    // Writes _source[_indices[i]] to _out for every i in order and returns
+    // the end of the output. Random lookups into a table much larger than
+    // the caches each wait for DRAM; here the element _distance lookups
+    // ahead is prefetched before the current one is copied, so that many
+    // misses are in flight at once. Indices are not checked.
+    template <typename T, typename Indices, typename OutputIt>
+    OutputIt gather(const vector<T> &_source, const Indices &_indices, OutputIt _out,
+                    std::size_t _distance = detail::GATHER_PREFETCH_DISTANCE)
+    {
+        const std::size_t count = detail::gather_count(_indices);
+        const T *data = _source.data();
+        const std::size_t ahead = _distance < count ? _distance : count;
+
+        for (std::size_t i = 0; i < ahead; i++)
+        {
+            detail::gather_prefetch(data + _indices[i]);
+        }
+
+        std::size_t i = 0;
+        for (; i + ahead < count; i++)
+        {
+            detail::gather_prefetch(data + _indices[i + ahead]);
+            *_out = data[_indices[i]];
+            ++_out;
+        }
+        for (; i < count; i++)
+        {
+            *_out = data[_indices[i]];
+            ++_out;
+        }
+        return _out;
+    }
+
+    // The same for a deque, where a lookup reads the block map before the
+    // element and a large deque's map misses too. The map slot is
+    // prefetched 2 * _distance ahead, and at _distance ahead the block
+    // pointer is read from it to prefetch the element.
+    template <typename T, typename Indices, typename OutputIt>
+    OutputIt gather(const deque<T> &_source, const Indices &_indices, OutputIt _out,
+                    std::size_t _distance = detail::GATHER_PREFETCH_DISTANCE)
+    {
+        constexpr std::size_t block = gather_access::block_size<T>();
+        const std::size_t count = detail::gather_count(_indices);
+        if (count == 0)
+        {
+            return _out;
+        }
+
+        T *const *map = gather_access::first_node(_source);
+        const std::size_t offset = gather_access::first_offset(_source);
+
+        const auto slot = [&](std::size_t _i)
+        { return map + (offset + std::size_t(_indices[_i])) / block; };
+        const auto element = [&](std::size_t _i)
+        { return *slot(_i) + (offset + std::size_t(_indices[_i])) % block; };
+
+        const std::size_t ahead = _distance < count ? _distance : count;
+        const std::size_t mapAhead = 2 * _distance < count ? 2 * _distance : count;
+
+        for (std::size_t i = 0; i < mapAhead; i++)
+        {
+            detail::gather_prefetch(slot(i));
+        }
+        for (std::size_t i = 0; i < ahead; i++)
+        {
+            detail::gather_prefetch(element(i));
+        }
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (i + mapAhead < count)
+            {
+                detail::gather_prefetch(slot(i + mapAhead));
+            }
+            if (i + ahead < count)
+            {
+                detail::gather_prefetch(element(i + ahead));
+            }
+            *_out = *element(i);
+            ++_out;
+        }
+        return _out;
+    }
+}
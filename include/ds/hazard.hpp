@@ -0,0 +1,244 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "thread_record.hpp"
+
+namespace ds
+{
+    namespace detail
+    {
+        // a thread scans once this many of its objects wait, or twice the
+        // number of hazard slots if that is more
+        inline constexpr std::size_t HAZARD_RECLAIM_THRESHOLD = 64;
+
+        // one published pointer, owned by one hazard_pointer at a time
+        struct hazard_record
+        {
+            std::atomic<const void *> pointer{nullptr};
+            std::atomic<bool> inUse{true};
+            hazard_record *next = nullptr;
+        };
+
+        struct hazard_retired
+        {
+            void *object;
+            void (*deleter)(void *);
+        };
+
+        struct hazard_state
+        {
+            std::atomic<hazard_record *> records{nullptr};
+            std::atomic<std::size_t> recordCount{0};
+
+            // left behind by exited threads, freed by whoever reclaims next
+            std::mutex orphanLock;
+            std::vector<hazard_retired> orphans;
+            std::atomic<std::size_t> orphanCount{0};
+
+            // no thread is left at exit, so everything can go
+            ~hazard_state()
+            {
+                for (const hazard_retired &r : orphans)
+                {
+                    r.deleter(r.object);
+                }
+                free_records(records);
+            }
+        };
+
+        inline hazard_state &hazard_globals()
+        {
+            static hazard_state state;
+            return state;
+        }
+
+        // Frees the entries of _list that no hazard slot names and keeps the
+        // rest; returns how many were freed.
+        inline std::size_t hazard_scan(std::vector<hazard_retired> &_list)
+        {
+            hazard_state &g = hazard_globals();
+
+            // the unlinks come before the slot reads, so a reader that still
+            // holds an object has published it by now
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::vector<const void *> live;
+            for (hazard_record *r = g.records.load(std::memory_order_acquire); r != nullptr; r = r->next)
+            {
+                if (const void *p = r->pointer.load(std::memory_order_acquire))
+                {
+                    live.push_back(p);
+                }
+            }
+            std::sort(live.begin(), live.end());
+
+            std::vector<hazard_retired> ready;
+            std::size_t kept = 0;
+            for (const hazard_retired &r : _list)
+            {
+                if (std::binary_search(live.begin(), live.end(), static_cast<const void *>(r.object)))
+                {
+                    _list[kept++] = r;
+                }
+                else
+                {
+                    ready.push_back(r);
+                }
+            }
+            _list.resize(kept);
+
+            // after the list is settled, so a deleter may retire in turn
+            for (const hazard_retired &r : ready)
+            {
+                r.deleter(r.object);
+            }
+            return ready.size();
+        }
+
+        // the calling thread's retire list; at exit what is still protected
+        // becomes an orphan
+        struct hazard_thread
+        {
+            std::vector<hazard_retired> retired;
+
+            hazard_thread() { hazard_globals(); } // outlive the globals' users
+
+            ~hazard_thread()
+            {
+                hazard_scan(retired);
+                if (!retired.empty())
+                {
+                    hazard_state &g = hazard_globals();
+                    std::lock_guard<std::mutex> lock(g.orphanLock);
+                    g.orphans.insert(g.orphans.end(), retired.begin(), retired.end());
+                    g.orphanCount.store(g.orphans.size(), std::memory_order_relaxed);
+                }
+            }
+        };
+
+        inline hazard_thread &hazard_local()
+        {
+            thread_local hazard_thread thread;
+            return thread;
+        }
+    }
+
+    // Hazard pointers: memory reclamation that protects single objects
+    // rather than whole critical sections. A reader publishes the pointer it
+    // is about to use in its hazard_pointer's slot and checks that the
+    // source still holds it; a retired object is freed only once no slot
+    // names it. Unlike ds::epoch, a stalled reader holds back just the
+    // objects it protects, at the price of a fence per protect and a scan
+    // of every slot per batch of retires.
+    //
+    // A hazard_pointer owns one slot for its lifetime and should stay on
+    // one thread; slots come from a shared list and are reused once their
+    // hazard_pointer is destroyed. Retire lists are per thread. Neither
+    // protect nor retire takes a lock, and what a thread still has retired
+    // when it exits is handed to the next thread that reclaims.
+    class hazard_pointer
+    {
+    public:
+        // constructors
+        hazard_pointer() : record(detail::acquire_record(detail::hazard_globals().records))
+        {
+            detail::hazard_globals().recordCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        hazard_pointer(const hazard_pointer &) = delete;
+
+        // destructors
+        ~hazard_pointer()
+        {
+            record->pointer.store(nullptr, std::memory_order_release);
+            detail::hazard_globals().recordCount.fetch_sub(1, std::memory_order_relaxed);
+            record->inUse.store(false, std::memory_order_release);
+        }
+
+        // operator=
+        hazard_pointer &operator=(const hazard_pointer &) = delete;
+
+        // Loads _source and protects the result; the object stays valid
+        // until this slot is reset or protects something else.
+        template <typename T>
+        T *protect(const std::atomic<T *> &_source)
+        {
+            T *p = _source.load(std::memory_order_relaxed);
+            while (!try_protect(p, _source))
+            {
+            }
+            return p;
+        }
+
+        // Protects _pointer if _source still holds it; otherwise loads the
+        // new value into _pointer, clears the slot and returns false.
+        template <typename T>
+        bool try_protect(T *&_pointer, const std::atomic<T *> &_source)
+        {
+            T *expected = _pointer;
+            record->pointer.store(expected, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            _pointer = _source.load(std::memory_order_acquire);
+            if (_pointer != expected)
+            {
+                record->pointer.store(nullptr, std::memory_order_release);
+                return false;
+            }
+            return true;
+        }
+
+        void reset() { record->pointer.store(nullptr, std::memory_order_release); }
+
+        // Hands over an object that can no longer be loaded from any source;
+        // _deleter runs once no slot names it.
+        static void retire(void *_object, void (*_deleter)(void *));
+
+        template <typename T>
+        static void retire(T *_object)
+        {
+            retire(const_cast<void *>(static_cast<const void *>(_object)), [](void *_p)
+                   { delete static_cast<T *>(_p); });
+        }
+
+        // Frees what the calling thread and exited threads retired that no
+        // slot names; returns how many were freed. Called from retire()
+        // once enough of the thread's objects are waiting.
+        static std::size_t reclaim();
+
+    private:
+        detail::hazard_record *record;
+    };
+
+    inline void hazard_pointer::retire(void *_object, void (*_deleter)(void *))
+    {
+        detail::hazard_thread &local = detail::hazard_local();
+        local.retired.push_back(detail::hazard_retired{_object, _deleter});
+
+        const std::size_t slots = detail::hazard_globals().recordCount.load(std::memory_order_relaxed);
+        if (local.retired.size() >= std::max(detail::HAZARD_RECLAIM_THRESHOLD, 2 * slots))
+        {
+            reclaim();
+        }
+    }
+
+    inline std::size_t hazard_pointer::reclaim()
+    {
+        detail::hazard_state &g = detail::hazard_globals();
+        detail::hazard_thread &local = detail::hazard_local();
+
+        if (g.orphanCount.load(std::memory_order_relaxed) != 0)
+        {
+            std::lock_guard<std::mutex> lock(g.orphanLock);
+            local.retired.insert(local.retired.end(), g.orphans.begin(), g.orphans.end());
+            g.orphans.clear();
+            g.orphanCount.store(0, std::memory_order_relaxed);
+        }
+
+        return detail::hazard_scan(local.retired);
+    }
+}
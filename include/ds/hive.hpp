@@ -0,0 +1,687 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "hive_iterator.hpp"
+#include "memory.hpp"
+
+namespace ds
+{
+    namespace detail
+    {
+        // target size of one hive block; the slot count is clamped so that
+        // skip field values fit in 16 bits
+        inline constexpr std::size_t HIVE_BLOCK_BYTES = 8192;
+
+        // One block of hive slots. skip is the low-complexity jump-counting
+        // skip field: zero for an element, and for each run of erased slots
+        // the first and last entries hold the run length (the interior ones
+        // are stale). skip has capacity + 1 entries and everything from
+        // highWater on is zero, so a forward step never leaves the array.
+        // Each run is on the block's free list, whose links live in the
+        // storage of the run's first slot.
+        template <typename T>
+        struct hive_block
+        {
+            using skip_type = std::uint16_t;
+            static constexpr skip_type noRun = skip_type(-1);
+
+            struct free_links
+            {
+                skip_type prev;
+                skip_type next;
+            };
+
+            struct slot
+            {
+                alignas(T) alignas(free_links) unsigned char bytes[sizeof(T) > sizeof(free_links) ? sizeof(T) : sizeof(free_links)];
+            };
+
+            slot *slots = nullptr;
+            skip_type *skip = nullptr;
+            std::size_t capacity = 0;
+            std::size_t highWater = 0; // slots past it were never used
+            std::size_t size = 0;
+            skip_type freeHead = noRun;
+
+            hive_block *prev = nullptr; // iteration order
+            hive_block *next = nullptr;
+            hive_block *prevFree = nullptr; // blocks with erased slots
+            hive_block *nextFree = nullptr;
+
+            T *element(std::size_t _index) { return std::launder(reinterpret_cast<T *>(slots[_index].bytes)); }
+
+            free_links &links(std::size_t _index) { return *std::launder(reinterpret_cast<free_links *>(slots[_index].bytes)); }
+            void setLinks(std::size_t _index, free_links _links) { ::new (static_cast<void *>(slots[_index].bytes)) free_links(_links); }
+        };
+    }
+
+    // Unordered container with stable element addresses, in the style of
+    // plf::colony. Elements live in fixed size blocks like ds::deque's and
+    // never move; erase destroys the element, records the slot in the
+    // block's skip field and free list, and insert reuses erased slots
+    // before it appends. Iteration jumps over runs of erased slots, and a
+    // block that empties is released, so churn does not leave holes to walk.
+    template <typename T>
+    class hive
+    {
+    public:
+        using value_type = T;
+        using pointer = T *;
+        using const_pointer = const T *;
+        using reference = T &;
+        using const_reference = const T &;
+        using size_type = std::size_t;
+
+        using iterator = HiveIterator<T, reference, pointer>;
+        using const_iterator = HiveIterator<T, const_reference, const_pointer>;
+
+        // constructors
+        hive() = default;
+        hive(size_type _count, const T &_value);
+        hive(std::initializer_list<T> _list);
+        hive(const hive &_other);
+        hive(hive &&_temp) noexcept;
+
+        // destructors
+        ~hive() noexcept;
+
+        // operator=
+        hive &operator=(const hive &_other);
+        hive &operator=(hive &&_other) noexcept;
+
+        // iterators
+        iterator begin() { return head == nullptr ? end() : iterator(head, head->skip[0]); }
+        const_iterator begin() const { return const_cast<hive *>(this)->begin(); }
+
+        iterator end() { return iterator(tail, tail == nullptr ? 0 : tail->highWater); }
+        const_iterator end() const { return const_cast<hive *>(this)->end(); }
+
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+
+        // iterator to the element at _p, which must be in this hive; O(blocks)
+        iterator get_iterator(const_pointer _p);
+        const_iterator get_iterator(const_pointer _p) const { return const_cast<hive *>(this)->get_iterator(_p); }
+
+        // capacity
+        size_type size() const { return count; }
+        bool empty() const { return count == 0; }
+        size_type capacity() const { return (blockCount + (spare != nullptr ? 1 : 0)) * block_capacity(); }
+
+        // slots per block
+        static constexpr size_type block_capacity();
+
+        // releases the block kept for reuse after the last one emptied
+        void shrink_to_fit();
+
+        // modifiers
+        iterator insert(const T &_value) { return emplace(_value); }
+        iterator insert(T &&_value) { return emplace(std::move(_value)); }
+        void insert(size_type _count, const T &_value);
+        void insert(std::initializer_list<T> _list);
+
+        template <typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+        void insert(InputIt _first, InputIt _last);
+
+        template <typename... Args>
+        iterator emplace(Args &&...args);
+
+        // returns the iterator following the erased element(s)
+        iterator erase(const_iterator _position);
+        iterator erase(const_iterator _first, const_iterator _last);
+
+        void clear();
+
+    private:
+        using block = detail::hive_block<T>;
+        using skip_type = typename block::skip_type;
+
+        block *head = nullptr;
+        block *tail = nullptr;
+        block *freeBlocks = nullptr; // blocks with at least one erased slot
+        block *spare = nullptr;      // an emptied block kept for the next append
+        size_type count = 0;
+        size_type blockCount = 0;
+
+        block *createBlock();
+        void destroyBlock(block *_b) noexcept;
+        void destroyElements(block *_b) noexcept;
+        void appendBlock();
+        void removeBlock(block *_b) noexcept;
+
+        void pushRun(block *_b, size_type _start) noexcept;
+        void removeRun(block *_b, size_type _start) noexcept;
+        void moveRun(block *_b, size_type _from, size_type _to) noexcept;
+        void unlinkFree(block *_b) noexcept;
+    };
+
+    template <typename T>
+    constexpr typename hive<T>::size_type hive<T>::block_capacity()
+    {
+        constexpr size_type bySize = detail::HIVE_BLOCK_BYTES / sizeof(typename block::slot);
+        constexpr size_type maxSlots = block::noRun - 1;
+
+        return bySize < 16 ? 16 : bySize > maxSlots ? maxSlots : bySize;
+    }
+
+    // parameterised constructor
+    template <typename T>
+    hive<T>::hive(size_type _count, const T &_value)
+    {
+        try
+        {
+            insert(_count, _value);
+        }
+        catch (...)
+        {
+            clear();
+            shrink_to_fit();
+            throw;
+        }
+    }
+
+    // initializer list constructor
+    template <typename T>
+    hive<T>::hive(std::initializer_list<T> _list)
+    {
+        try
+        {
+            insert(_list);
+        }
+        catch (...)
+        {
+            clear();
+            shrink_to_fit();
+            throw;
+        }
+    }
+
+    // copy constructor: the copy is compact, with no erased slots
+    template <typename T>
+    hive<T>::hive(const hive &_other)
+    {
+        try
+        {
+            insert(_other.begin(), _other.end());
+        }
+        catch (...)
+        {
+            clear();
+            shrink_to_fit();
+            throw;
+        }
+    }
+
+    // move constructor
+    template <typename T>
+    hive<T>::hive(hive &&_temp) noexcept : head(_temp.head),
+                                           tail(_temp.tail),
+                                           freeBlocks(_temp.freeBlocks),
+                                           spare(_temp.spare),
+                                           count(_temp.count),
+                                           blockCount(_temp.blockCount)
+    {
+        _temp.head = _temp.tail = _temp.freeBlocks = _temp.spare = nullptr;
+        _temp.count = _temp.blockCount = 0;
+    }
+
+    // destructor
+    template <typename T>
+    hive<T>::~hive() noexcept
+    {
+        clear();
+        shrink_to_fit();
+    }
+
+    // copy assignment
+    template <typename T>
+    hive<T> &hive<T>::operator=(const hive &_other)
+    {
+        if (this != &_other)
+        {
+            hive copy(_other);
+            *this = std::move(copy);
+        }
+
+        return *this;
+    }
+
+    // move assignment
+    template <typename T>
+    hive<T> &hive<T>::operator=(hive &&_other) noexcept
+    {
+        if (this == &_other)
+        {
+            return *this;
+        }
+
+        clear();
+        shrink_to_fit();
+
+        head = _other.head;
+        tail = _other.tail;
+        freeBlocks = _other.freeBlocks;
+        spare = _other.spare;
+        count = _other.count;
+        blockCount = _other.blockCount;
+
+        _other.head = _other.tail = _other.freeBlocks = _other.spare = nullptr;
+        _other.count = _other.blockCount = 0;
+
+        return *this;
+    }
+
+    template <typename T>
+    typename hive<T>::iterator hive<T>::get_iterator(const_pointer _p)
+    {
+        std::less<const_pointer> before;
+
+        for (block *b = head; b != nullptr; b = b->next)
+        {
+            const_pointer first = b->element(0);
+            if (!before(_p, first) && before(_p, first + b->capacity))
+            {
+                return iterator(b, size_type(_p - first));
+            }
+        }
+
+        return end();
+    }
+
+    template <typename T>
+    void hive<T>::shrink_to_fit()
+    {
+        if (spare != nullptr)
+        {
+            destroyBlock(spare);
+            spare = nullptr;
+        }
+    }
+
+    template <typename T>
+    void hive<T>::insert(size_type _count, const T &_value)
+    {
+        for (size_type i = 0; i < _count; i++)
+        {
+            emplace(_value);
+        }
+    }
+
+    template <typename T>
+    void hive<T>::insert(std::initializer_list<T> _list)
+    {
+        insert(_list.begin(), _list.end());
+    }
+
+    template <typename T>
+    template <typename InputIt, typename>
+    void hive<T>::insert(InputIt _first, InputIt _last)
+    {
+        for (; _first != _last; ++_first)
+        {
+            emplace(*_first);
+        }
+    }
+
+    template <typename T>
+    template <typename... Args>
+    typename hive<T>::iterator hive<T>::emplace(Args &&...args)
+    {
+        if (freeBlocks != nullptr)
+        {
+            // take the last slot of the first erased run, so a longer run
+            // keeps its start and its free list links
+            block *b = freeBlocks;
+            const size_type start = b->freeHead;
+            const size_type length = b->skip[start];
+            const size_type slot = start + length - 1;
+
+            if (length == 1)
+            {
+                // the element overwrites the run's links, so unlink it first
+                removeRun(b, start);
+                try
+                {
+                    detail::construct_at(b->element(slot), std::forward<Args>(args)...);
+                }
+                catch (...)
+                {
+                    pushRun(b, start);
+                    throw;
+                }
+            }
+            else
+            {
+                detail::construct_at(b->element(slot), std::forward<Args>(args)...);
+                b->skip[start] = b->skip[slot - 1] = skip_type(length - 1);
+            }
+
+            b->skip[slot] = 0;
+            b->size++;
+            count++;
+
+            return iterator(b, slot);
+        }
+
+        if (tail == nullptr || tail->highWater == tail->capacity)
+        {
+            appendBlock();
+        }
+
+        block *b = tail;
+        try
+        {
+            detail::construct_at(b->element(b->highWater), std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            if (b->size == 0)
+            {
+                removeBlock(b);
+            }
+            throw;
+        }
+
+        b->size++;
+        count++;
+
+        return iterator(b, b->highWater++);
+    }
+
+    template <typename T>
+    typename hive<T>::iterator hive<T>::erase(const_iterator _position)
+    {
+        block *b = _position.block;
+        const size_type i = _position.index;
+
+        iterator next(b, i);
+        ++next;
+
+        b->element(i)->~T();
+
+        const size_type left = i > 0 ? b->skip[i - 1] : 0;
+        const size_type right = b->skip[i + 1];
+
+        if (left == 0 && right == 0)
+        {
+            b->skip[i] = 1;
+            pushRun(b, i);
+        }
+        else if (right == 0)
+        {
+            // grow the run ending at i - 1
+            b->skip[i - left] = b->skip[i] = skip_type(left + 1);
+        }
+        else if (left == 0)
+        {
+            // the run starting at i + 1 now starts at i
+            moveRun(b, i + 1, i);
+            b->skip[i] = b->skip[i + right] = skip_type(right + 1);
+        }
+        else
+        {
+            // join the runs on either side
+            removeRun(b, i + 1);
+            b->skip[i - left] = b->skip[i + right] = skip_type(left + 1 + right);
+        }
+
+        b->size--;
+        count--;
+
+        if (b->size == 0)
+        {
+            removeBlock(b);
+            if (next.block == b)
+            {
+                return end();
+            }
+        }
+
+        return next;
+    }
+
+    template <typename T>
+    typename hive<T>::iterator hive<T>::erase(const_iterator _first, const_iterator _last)
+    {
+        // end() moves when the tail block is released, so compare against
+        // it afresh rather than against the saved _last
+        if (_last == end())
+        {
+            while (_first != end())
+            {
+                _first = erase(_first);
+            }
+            return end();
+        }
+
+        while (_first != _last)
+        {
+            _first = erase(_first);
+        }
+
+        return iterator(_last.block, _last.index);
+    }
+
+    template <typename T>
+    void hive<T>::clear()
+    {
+        while (head != nullptr)
+        {
+            block *b = head;
+            head = b->next;
+            destroyElements(b);
+            destroyBlock(b);
+        }
+
+        tail = freeBlocks = nullptr;
+        count = blockCount = 0;
+    }
+
+    template <typename T>
+    typename hive<T>::block *hive<T>::createBlock()
+    {
+        block *b = new block;
+        b->capacity = block_capacity();
+
+        try
+        {
+            b->slots = detail::allocate<typename block::slot>(b->capacity);
+            b->skip = detail::allocate<skip_type>(b->capacity + 1);
+        }
+        catch (...)
+        {
+            detail::deallocate(b->slots, b->capacity);
+            delete b;
+            throw;
+        }
+
+        for (size_type i = 0; i <= b->capacity; i++)
+        {
+            b->skip[i] = 0;
+        }
+
+        return b;
+    }
+
+    template <typename T>
+    void hive<T>::destroyBlock(block *_b) noexcept
+    {
+        detail::deallocate(_b->slots, _b->capacity);
+        detail::deallocate(_b->skip, _b->capacity + 1);
+        delete _b;
+    }
+
+    template <typename T>
+    void hive<T>::destroyElements(block *_b) noexcept
+    {
+        if constexpr (!std::is_trivially_destructible_v<T>)
+        {
+            for (size_type i = _b->skip[0]; i < _b->highWater; i += 1 + _b->skip[i + 1])
+            {
+                _b->element(i)->~T();
+            }
+        }
+    }
+
+    // links a fresh or spare block after tail
+    template <typename T>
+    void hive<T>::appendBlock()
+    {
+        block *b = spare != nullptr ? spare : createBlock();
+        spare = nullptr;
+
+        b->prev = tail;
+        b->next = nullptr;
+        if (tail != nullptr)
+        {
+            tail->next = b;
+        }
+        else
+        {
+            head = b;
+        }
+        tail = b;
+        blockCount++;
+    }
+
+    // unlinks an empty block and keeps it as the spare if there is none
+    template <typename T>
+    void hive<T>::removeBlock(block *_b) noexcept
+    {
+        if (_b->freeHead != block::noRun)
+        {
+            unlinkFree(_b);
+        }
+
+        (_b->prev != nullptr ? _b->prev->next : head) = _b->next;
+        (_b->next != nullptr ? _b->next->prev : tail) = _b->prev;
+        blockCount--;
+
+        if (spare != nullptr)
+        {
+            destroyBlock(_b);
+            return;
+        }
+
+        for (size_type i = 0; i <= _b->highWater; i++)
+        {
+            _b->skip[i] = 0;
+        }
+        _b->highWater = 0;
+        _b->freeHead = block::noRun;
+        _b->prev = _b->next = nullptr;
+        spare = _b;
+    }
+
+    // adds the run starting at _start to the block's free list
+    template <typename T>
+    void hive<T>::pushRun(block *_b, size_type _start) noexcept
+    {
+        const skip_type oldHead = _b->freeHead;
+
+        _b->setLinks(_start, {block::noRun, oldHead});
+        _b->freeHead = skip_type(_start);
+
+        if (oldHead != block::noRun)
+        {
+            _b->links(oldHead).prev = skip_type(_start);
+            return;
+        }
+
+        // first erased run in the block
+        _b->prevFree = nullptr;
+        _b->nextFree = freeBlocks;
+        if (freeBlocks != nullptr)
+        {
+            freeBlocks->prevFree = _b;
+        }
+        freeBlocks = _b;
+    }
+
+    template <typename T>
+    void hive<T>::removeRun(block *_b, size_type _start) noexcept
+    {
+        const typename block::free_links links = _b->links(_start);
+
+        if (links.prev != block::noRun)
+        {
+            _b->links(links.prev).next = links.next;
+        }
+        else
+        {
+            _b->freeHead = links.next;
+        }
+
+        if (links.next != block::noRun)
+        {
+            _b->links(links.next).prev = links.prev;
+        }
+
+        if (_b->freeHead == block::noRun)
+        {
+            unlinkFree(_b);
+        }
+    }
+
+    template <typename T>
+    void hive<T>::moveRun(block *_b, size_type _from, size_type _to) noexcept
+    {
+        const typename block::free_links links = _b->links(_from);
+
+        _b->setLinks(_to, links);
+
+        if (links.prev != block::noRun)
+        {
+            _b->links(links.prev).next = skip_type(_to);
+        }
+        else
+        {
+            _b->freeHead = skip_type(_to);
+        }
+
+        if (links.next != block::noRun)
+        {
+            _b->links(links.next).prev = skip_type(_to);
+        }
+    }
+
+    template <typename T>
+    void hive<T>::unlinkFree(block *_b) noexcept
+    {
+        (_b->prevFree != nullptr ? _b->prevFree->nextFree : freeBlocks) = _b->nextFree;
+        if (_b->nextFree != nullptr)
+        {
+            _b->nextFree->prevFree = _b->prevFree;
+        }
+        _b->prevFree = _b->nextFree = nullptr;
+        _b->freeHead = block::noRun;
+    }
+
+    // erases every element matching _pred and returns how many went
+    template <typename T, typename Pred>
+    typename hive<T>::size_type erase_if(hive<T> &_h, Pred _pred)
+    {
+        const typename hive<T>::size_type before = _h.size();
+
+        for (auto it = _h.begin(); it != _h.end();)
+        {
+            if (_pred(*it))
+            {
+                it = _h.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        return before - _h.size();
+    }
+}
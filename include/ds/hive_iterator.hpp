@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace ds
+{
+    template <typename T>
+    class hive;
+
+    namespace detail
+    {
+        template <typename T>
+        struct hive_block;
+    }
+
+    // Bidirectional iterator over a hive. It holds the block and the slot
+    // index, and steps over runs of erased slots using the block's skip
+    // field, so a step costs the same however many elements were erased.
+    template <typename T, typename Ref, typename Ptr>
+    class HiveIterator
+    {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Ptr;
+        using reference = Ref;
+
+        HiveIterator() = default;
+
+        template <typename R, typename P,
+                  typename = std::enable_if_t<std::is_convertible_v<P, Ptr> && !std::is_same_v<P, Ptr>>>
+        HiveIterator(const HiveIterator<T, R, P> &_other) : block(_other.block), index(_other.index) {}
+
+        reference operator*() const { return *block->element(index); }
+        pointer operator->() const { return block->element(index); }
+
+        HiveIterator &operator++();
+        HiveIterator operator++(int)
+        {
+            HiveIterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        HiveIterator &operator--();
+        HiveIterator operator--(int)
+        {
+            HiveIterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        template <typename R, typename P>
+        bool operator==(const HiveIterator<T, R, P> &_other) const { return block == _other.block && index == _other.index; }
+        template <typename R, typename P>
+        bool operator!=(const HiveIterator<T, R, P> &_other) const { return !(*this == _other); }
+
+    private:
+        template <typename U, typename R, typename P>
+        friend class HiveIterator;
+
+        template <typename U>
+        friend class hive;
+
+        HiveIterator(detail::hive_block<T> *_block, std::size_t _index) : block(_block), index(_index) {}
+
+        detail::hive_block<T> *block = nullptr;
+        std::size_t index = 0;
+    };
+
+    template <typename T, typename Ref, typename Ptr>
+    HiveIterator<T, Ref, Ptr> &HiveIterator<T, Ref, Ptr>::operator++()
+    {
+        ++index;
+
+        // a block without erased slots is dense and needs no skip field load
+        if (block->freeHead != detail::hive_block<T>::noRun)
+        {
+            index += block->skip[index];
+        }
+
+        // every block in the hive holds at least one element
+        if (index == block->highWater && block->next != nullptr)
+        {
+            block = block->next;
+            index = block->skip[0];
+        }
+
+        return *this;
+    }
+
+    template <typename T, typename Ref, typename Ptr>
+    HiveIterator<T, Ref, Ptr> &HiveIterator<T, Ref, Ptr>::operator--()
+    {
+        // skip[index - 1] is zero for an element or the length of the erased
+        // run ending there
+        if (index != 0 && block->skip[index - 1] < index)
+        {
+            index -= 1 + block->skip[index - 1];
+        }
+        else
+        {
+            block = block->prev;
+            index = block->highWater - 1;
+            index -= block->skip[index];
+        }
+
+        return *this;
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace ds
+{
+    // Random access iterator for containers whose elements are reached
+    // through operator[] rather than a pointer (gap_buffer, circular_buffer).
+    // It holds the container and a logical index, so it stays valid while
+    // the container rearranges its storage, as long as the index exists.
+    template <typename Buffer, typename Ref, typename Ptr>
+    class IndexIterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = typename Buffer::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Ptr;
+        using reference = Ref;
+
+        IndexIterator() = default;
+        IndexIterator(Buffer *_buffer, std::size_t _index) : buffer(_buffer), index(_index) {}
+
+        template <typename B, typename R, typename P,
+                  typename = std::enable_if_t<std::is_convertible_v<B *, Buffer *> && !std::is_same_v<B, Buffer>>>
+        IndexIterator(const IndexIterator<B, R, P> &_other) : buffer(_other.buffer), index(_other.index) {}
+
+        reference operator*() const { return (*buffer)[index]; }
+        pointer operator->() const { return &(*buffer)[index]; }
+        reference operator[](difference_type _n) const { return (*buffer)[index + _n]; }
+
+        IndexIterator &operator++() { ++index; return *this; }
+        IndexIterator operator++(int) { IndexIterator tmp = *this; ++index; return tmp; }
+        IndexIterator &operator--() { --index; return *this; }
+        IndexIterator operator--(int) { IndexIterator tmp = *this; --index; return tmp; }
+
+        IndexIterator &operator+=(difference_type _n) { index += _n; return *this; }
+        IndexIterator &operator-=(difference_type _n) { index -= _n; return *this; }
+        IndexIterator operator+(difference_type _n) const { return IndexIterator(buffer, index + _n); }
+        IndexIterator operator-(difference_type _n) const { return IndexIterator(buffer, index - _n); }
+
+        template <typename B, typename R, typename P>
+        difference_type operator-(const IndexIterator<B, R, P> &_other) const
+        {
+            return difference_type(index) - difference_type(_other.index);
+        }
+
+        template <typename B, typename R, typename P>
+        bool operator==(const IndexIterator<B, R, P> &_other) const { return index == _other.index; }
+        template <typename B, typename R, typename P>
+        bool operator!=(const IndexIterator<B, R, P> &_other) const { return index != _other.index; }
+        template <typename B, typename R, typename P>
+        bool operator<(const IndexIterator<B, R, P> &_other) const { return index < _other.index; }
+        template <typename B, typename R, typename P>
+        bool operator>(const IndexIterator<B, R, P> &_other) const { return index > _other.index; }
+        template <typename B, typename R, typename P>
+        bool operator<=(const IndexIterator<B, R, P> &_other) const { return index <= _other.index; }
+        template <typename B, typename R, typename P>
+        bool operator>=(const IndexIterator<B, R, P> &_other) const { return index >= _other.index; }
+
+        std::size_t position() const { return index; }
+
+    private:
+        template <typename B, typename R, typename P>
+        friend class IndexIterator;
+
+        Buffer *buffer = nullptr;
+        std::size_t index = 0;
+    };
+
+}
@@ -0,0 +1,362 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include <limits.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include "deque.hpp"
+
+namespace ds
+{
+    // FIFO byte queue laid out like ds::deque<char>: a map of fixed size
+    // blocks, filled at the back and released from the front. Incoming data
+    // is read straight into free block space and outgoing data is written
+    // straight from the filled blocks, so bytes are never copied into a
+    // contiguous staging buffer. The map is a ring so releasing front blocks
+    // never shifts it, and released blocks are kept for reuse.
+    class iobuf_chain
+    {
+    public:
+        using size_type = std::size_t;
+
+        // constructors
+        explicit iobuf_chain(size_type _block_size = DEQUE_BUF_SIZE);
+        iobuf_chain(const iobuf_chain &) = delete;
+        iobuf_chain(iobuf_chain &&_temp) noexcept;
+
+        // destructors
+        ~iobuf_chain() noexcept;
+
+        // operator=
+        iobuf_chain &operator=(const iobuf_chain &) = delete;
+        iobuf_chain &operator=(iobuf_chain &&_other) noexcept;
+
+        // capacity
+        size_type size() const { return chainSize; }
+        bool empty() const { return chainSize == 0; }
+        size_type block_size() const { return blockSize; }
+        size_type block_count() const { return blockCount; }
+
+        // producer side: describe at least _bytes of free space (fewer if
+        // _max_iov runs out) and mark the first _bytes of it as filled
+        int prepare(size_type _bytes, iovec *_iov, int _max_iov);
+        void commit(size_type _bytes);
+        void append(const void *_data, size_type _bytes);
+
+        // consumer side: describe the filled bytes front to back, copy some
+        // out for parsing, and release bytes from the front
+        int readable(iovec *_iov, int _max_iov) const;
+        size_type copy_to(void *_out, size_type _offset, size_type _bytes) const;
+        void consume(size_type _bytes);
+        void clear();
+
+        // readv into free space / writev from filled blocks. Both return the
+        // byte count or -1 with errno set, exactly like the system calls.
+        ssize_t read_from(int _fd, size_type _max_bytes);
+        ssize_t write_to(int _fd);
+
+    private:
+        char **map = nullptr;
+        size_type mapSize = 0;     // slots in the ring
+        size_type headSlot = 0;    // ring slot holding the front block
+        size_type blockCount = 0;  // blocks in the ring, starting at headSlot
+        size_type headOffset = 0;  // first filled byte in the front block
+        size_type chainSize = 0;   // filled bytes
+
+        size_type blockSize;
+
+        static constexpr size_type MAX_SPARE_BLOCKS = 16;
+        char *spare[MAX_SPARE_BLOCKS];
+        size_type spareCount = 0;
+
+        char *&block(size_type _i) const { return map[(headSlot + _i) % mapSize]; }
+
+        char *allocateBlock();
+        void releaseBlock(char *_block) noexcept;
+        void pushBlock();
+        void release() noexcept;
+    };
+
+    inline char *iobuf_chain::allocateBlock()
+    {
+        if (spareCount != 0)
+        {
+            return spare[--spareCount];
+        }
+
+        return new char[blockSize];
+    }
+
+    inline void iobuf_chain::releaseBlock(char *_block) noexcept
+    {
+        if (spareCount < MAX_SPARE_BLOCKS)
+        {
+            spare[spareCount++] = _block;
+        }
+        else
+        {
+            delete[] _block;
+        }
+    }
+
+    // appends an empty block at the back, doubling the ring when full
+    inline void iobuf_chain::pushBlock()
+    {
+        if (blockCount == mapSize)
+        {
+            size_type newMapSize = mapSize == 0 ? 8 : mapSize * 2;
+            char **tempMap = new char *[newMapSize];
+
+            for (size_type i = 0; i < blockCount; i++)
+            {
+                tempMap[i] = block(i);
+            }
+
+            delete[] map;
+
+            map = tempMap;
+            mapSize = newMapSize;
+            headSlot = 0;
+        }
+
+        char *b = allocateBlock();
+        block(blockCount) = b;
+        blockCount++;
+    }
+
+    inline void iobuf_chain::release() noexcept
+    {
+        for (size_type i = 0; i < blockCount; i++)
+        {
+            delete[] block(i);
+        }
+
+        for (size_type i = 0; i < spareCount; i++)
+        {
+            delete[] spare[i];
+        }
+
+        delete[] map;
+
+        map = nullptr;
+        mapSize = headSlot = blockCount = headOffset = chainSize = spareCount = 0;
+    }
+
+    // constructor
+    inline iobuf_chain::iobuf_chain(size_type _block_size) : blockSize(_block_size)
+    {
+        if (blockSize == 0)
+        {
+            throw std::invalid_argument("ds::iobuf_chain - block size must be non-zero");
+        }
+    }
+
+    // move constructor
+    inline iobuf_chain::iobuf_chain(iobuf_chain &&_temp) noexcept : blockSize(_temp.blockSize)
+    {
+        *this = std::move(_temp);
+    }
+
+    // destructor
+    inline iobuf_chain::~iobuf_chain() noexcept
+    {
+        release();
+    }
+
+    // move assignment
+    inline iobuf_chain &iobuf_chain::operator=(iobuf_chain &&_other) noexcept
+    {
+        if (this == &_other)
+        {
+            return *this;
+        }
+
+        release();
+
+        map = _other.map;
+        mapSize = _other.mapSize;
+        headSlot = _other.headSlot;
+        blockCount = _other.blockCount;
+        headOffset = _other.headOffset;
+        chainSize = _other.chainSize;
+        blockSize = _other.blockSize;
+        spareCount = _other.spareCount;
+        std::copy(_other.spare, _other.spare + _other.spareCount, spare);
+
+        _other.map = nullptr;
+        _other.mapSize = _other.headSlot = _other.blockCount = 0;
+        _other.headOffset = _other.chainSize = _other.spareCount = 0;
+
+        return *this;
+    }
+
+    inline int iobuf_chain::prepare(size_type _bytes, iovec *_iov, int _max_iov)
+    {
+        size_type tail = headOffset + chainSize;
+
+        while (blockCount * blockSize < tail + _bytes)
+        {
+            pushBlock();
+        }
+
+        int used = 0;
+
+        for (size_type i = tail / blockSize; _bytes != 0 && used < _max_iov; i++)
+        {
+            const size_type offset = i == tail / blockSize ? tail % blockSize : 0;
+            const size_type len = std::min(_bytes, blockSize - offset);
+
+            _iov[used++] = iovec{block(i) + offset, len};
+            _bytes -= len;
+        }
+
+        return used;
+    }
+
+    inline void iobuf_chain::commit(size_type _bytes)
+    {
+        if (headOffset + chainSize + _bytes > blockCount * blockSize)
+        {
+            throw std::out_of_range("ds::iobuf_chain - commit past prepared space");
+        }
+
+        chainSize += _bytes;
+    }
+
+    inline void iobuf_chain::append(const void *_data, size_type _bytes)
+    {
+        const char *p = static_cast<const char *>(_data);
+        iovec iov[IOV_MAX];
+
+        while (_bytes != 0)
+        {
+            int used = prepare(_bytes, iov, IOV_MAX);
+            size_type done = 0;
+
+            for (int i = 0; i < used; i++)
+            {
+                std::memcpy(iov[i].iov_base, p + done, iov[i].iov_len);
+                done += iov[i].iov_len;
+            }
+
+            commit(done);
+            p += done;
+            _bytes -= done;
+        }
+    }
+
+    inline int iobuf_chain::readable(iovec *_iov, int _max_iov) const
+    {
+        size_type remaining = chainSize;
+        int used = 0;
+
+        for (size_type i = 0; remaining != 0 && used < _max_iov; i++)
+        {
+            const size_type offset = i == 0 ? headOffset : 0;
+            const size_type len = std::min(remaining, blockSize - offset);
+
+            _iov[used++] = iovec{block(i) + offset, len};
+            remaining -= len;
+        }
+
+        return used;
+    }
+
+    // copies up to _bytes starting _offset bytes past the front; returns the count copied
+    inline iobuf_chain::size_type iobuf_chain::copy_to(void *_out, size_type _offset, size_type _bytes) const
+    {
+        if (_offset >= chainSize)
+        {
+            return 0;
+        }
+
+        _bytes = std::min(_bytes, chainSize - _offset);
+
+        char *out = static_cast<char *>(_out);
+        size_type pos = headOffset + _offset;
+        size_type remaining = _bytes;
+
+        while (remaining != 0)
+        {
+            const size_type offset = pos % blockSize;
+            const size_type len = std::min(remaining, blockSize - offset);
+
+            std::memcpy(out, block(pos / blockSize) + offset, len);
+            out += len;
+            pos += len;
+            remaining -= len;
+        }
+
+        return _bytes;
+    }
+
+    inline void iobuf_chain::consume(size_type _bytes)
+    {
+        if (_bytes > chainSize)
+        {
+            throw std::out_of_range("ds::iobuf_chain - consume past end");
+        }
+
+        headOffset += _bytes;
+        chainSize -= _bytes;
+
+        while (headOffset >= blockSize)
+        {
+            releaseBlock(block(0));
+            headSlot = (headSlot + 1) % mapSize;
+            blockCount--;
+            headOffset -= blockSize;
+        }
+
+        if (chainSize == 0)
+        {
+            headOffset = 0;
+        }
+    }
+
+    inline void iobuf_chain::clear()
+    {
+        consume(chainSize);
+    }
+
+    inline ssize_t iobuf_chain::read_from(int _fd, size_type _max_bytes)
+    {
+        iovec iov[IOV_MAX];
+        int used = prepare(_max_bytes, iov, IOV_MAX);
+
+        ssize_t n = ::readv(_fd, iov, used);
+
+        if (n > 0)
+        {
+            commit(size_type(n));
+        }
+
+        return n;
+    }
+
+    inline ssize_t iobuf_chain::write_to(int _fd)
+    {
+        iovec iov[IOV_MAX];
+        int used = readable(iov, IOV_MAX);
+
+        if (used == 0)
+        {
+            return 0;
+        }
+
+        ssize_t n = ::writev(_fd, iov, used);
+
+        if (n > 0)
+        {
+            consume(size_type(n));
+        }
+
+        return n;
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <type_traits>
+
+namespace ds
+{
+    namespace detail
+    {
+        template <typename T, typename = void>
+        struct is_transparent : std::false_type {};
+        template <typename T>
+        struct is_transparent<T, std::void_t<typename T::is_transparent>> : std::true_type {};
+
+        // Parameter type of the lookup functions of the associative
+        // containers: any K when heterogeneous lookup is enabled, otherwise
+        // the key type. Written as a member alias of a class that does not
+        // depend on K, so K is still deduced from the argument.
+        template <bool Transparent>
+        struct key_arg_impl
+        {
+            template <typename K, typename Key>
+            using type = Key;
+        };
+
+        template <>
+        struct key_arg_impl<true>
+        {
+            template <typename K, typename Key>
+            using type = K;
+        };
+    }
+}
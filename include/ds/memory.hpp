@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Raw storage helpers for the containers. Under C++20 they go through
+// std::allocator and std::construct_at, which are usable in constant
+// evaluation, and DS_CONSTEXPR20 expands to constexpr; under C++17 they are
+// plain operator new and placement new and DS_CONSTEXPR20 is empty.
+
+#if defined(__cpp_constexpr_dynamic_alloc) && __cpp_constexpr_dynamic_alloc >= 201907L
+#define DS_CONSTEXPR20 constexpr
+#define DS_HAS_CONSTEXPR_VECTOR 1
+#else
+#define DS_CONSTEXPR20
+#endif
+
+namespace ds
+{
+    namespace detail
+    {
+        template <typename T>
+        DS_CONSTEXPR20 T *allocate(std::size_t _count)
+        {
+            return std::allocator<T>().allocate(_count);
+        }
+
+        // _count must be what the storage was allocated with
+        template <typename T>
+        DS_CONSTEXPR20 void deallocate(T *_p, std::size_t _count) noexcept
+        {
+            if (_p != nullptr)
+            {
+                std::allocator<T>().deallocate(_p, _count);
+            }
+        }
+
+        template <typename T, typename... Args>
+        DS_CONSTEXPR20 void construct_at(T *_p, Args &&...args)
+        {
+#ifdef DS_HAS_CONSTEXPR_VECTOR
+            std::construct_at(_p, std::forward<Args>(args)...);
+#else
+            ::new (static_cast<void *>(_p)) T(std::forward<Args>(args)...);
+#endif
+        }
+    }
+
+    // Frees a buffer of T (the elements must already be destroyed) given its
+    // pointer and capacity in elements. Default constructed it returns the
+    // buffer to std::allocator<T>, like every buffer ds::vector allocates
+    // itself; otherwise it calls the stored callable as d(ptr, capacity) or
+    // d(ptr), so free, a munmap wrapper or a library's release hook fit.
+    template <typename T>
+    class buffer_deleter
+    {
+    public:
+        constexpr buffer_deleter() noexcept = default;
+
+        template <typename D, typename = std::enable_if_t<!std::is_same_v<std::decay_t<D>, buffer_deleter>>>
+        explicit buffer_deleter(D &&_d) : custom(new holder<std::decay_t<D>>(std::forward<D>(_d))) {}
+
+        buffer_deleter(const buffer_deleter &) = delete;
+        buffer_deleter &operator=(const buffer_deleter &) = delete;
+
+        DS_CONSTEXPR20 buffer_deleter(buffer_deleter &&_other) noexcept : custom(_other.custom)
+        {
+            _other.custom = nullptr;
+        }
+
+        DS_CONSTEXPR20 buffer_deleter &operator=(buffer_deleter &&_other) noexcept
+        {
+            if (this != &_other)
+            {
+                delete custom;
+                custom = _other.custom;
+                _other.custom = nullptr;
+            }
+            return *this;
+        }
+
+        DS_CONSTEXPR20 ~buffer_deleter() noexcept { delete custom; }
+
+        DS_CONSTEXPR20 void operator()(T *_p, std::size_t _capacity) const noexcept
+        {
+            if (custom != nullptr)
+            {
+                custom->free(_p, _capacity);
+            }
+            else
+            {
+                detail::deallocate(_p, _capacity);
+            }
+        }
+
+        // true when the buffer belongs to std::allocator<T>
+        DS_CONSTEXPR20 bool is_default() const noexcept { return custom == nullptr; }
+
+    private:
+        struct holder_base
+        {
+            virtual void free(T *_p, std::size_t _capacity) noexcept = 0;
+            virtual ~holder_base() = default;
+        };
+
+        template <typename D>
+        struct holder final : holder_base
+        {
+            D d;
+
+            template <typename U>
+            explicit holder(U &&_d) : d(std::forward<U>(_d)) {}
+
+            void free(T *_p, std::size_t _capacity) noexcept override
+            {
+                if constexpr (std::is_invocable_v<D &, T *, std::size_t>)
+                {
+                    d(_p, _capacity);
+                }
+                else
+                {
+                    d(_p);
+                }
+            }
+        };
+
+        holder_base *custom = nullptr;
+    };
+}
@@ -0,0 +1,449 @@
+#pragma once
+
+#include <cstddef>
+#include <cerrno>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "normal_iterator.hpp"
+
+namespace ds
+{
+    // File backed vector for trivially copyable types. The file holds the raw
+    // elements with no header, so a table written by any tool can be mapped
+    // directly. While open for writing the file may be longer than size() to
+    // hold spare capacity; close() trims it back to exactly size() elements.
+    template <typename T>
+    class mmap_vector
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "ds::mmap_vector requires a trivially copyable type");
+
+    public:
+        using value_type = T;
+        using pointer = T *;
+        using const_pointer = const T *;
+        using reference = T &;
+        using const_reference = const T &;
+        using size_type = std::size_t;
+
+        using iterator = NormalIterator<pointer, mmap_vector>;
+        using const_iterator = NormalIterator<const_pointer, mmap_vector>;
+
+        enum class mode
+        {
+            read_only,
+            read_write
+        };
+
+        // constructors
+        mmap_vector() noexcept;
+        explicit mmap_vector(const char *_path, mode _mode = mode::read_write);
+        mmap_vector(const mmap_vector &) = delete;
+        mmap_vector(mmap_vector &&_temp) noexcept;
+
+        // destructors
+        ~mmap_vector() noexcept;
+
+        // operator=
+        mmap_vector &operator=(const mmap_vector &) = delete;
+        mmap_vector &operator=(mmap_vector &&_other) noexcept;
+
+        // file
+        void open(const char *_path, mode _mode = mode::read_write);
+        void close();
+        void flush(bool _async = false);
+        bool is_open() const { return fd != -1; }
+        bool read_only() const { return readOnly; }
+
+        // element access
+        reference at(size_type _index);
+        const_reference at(size_type _index) const;
+
+        reference operator[](size_type _index) { return *(array + _index); };
+        const_reference operator[](size_type _index) const { return *(array + _index); };
+
+        reference front() { return *array; };
+        const_reference front() const { return *array; };
+
+        reference back() { return *(array + vectorSize - 1); };
+        const_reference back() const { return *(array + vectorSize - 1); };
+
+        pointer data() { return array; }
+        const_pointer data() const { return array; }
+
+        // iterators
+        iterator begin() { return iterator(array); }
+        const_iterator begin() const { return const_iterator(array); }
+
+        iterator end() { return iterator(array + vectorSize); }
+        const_iterator end() const { return const_iterator(array + vectorSize); }
+
+        const_iterator cbegin() const { return const_iterator(array); }
+        const_iterator cend() const { return const_iterator(array + vectorSize); }
+
+        // capacity
+        size_type size() const { return vectorSize; }
+        size_type capacity() const { return reservedSize; }
+        bool empty() const { return vectorSize == 0; };
+        void reserve(size_type new_cap);
+        void shrink_to_fit();
+
+        // modifiers
+        void clear();
+        void resize(size_type _count);
+        void push_back(const T &_value);
+        void pop_back();
+
+    private:
+        pointer array = nullptr;
+
+        size_type reservedSize = 0;
+        size_type vectorSize = 0;
+
+        int fd = -1;
+        bool readOnly = false;
+
+        void remap(size_type _new_cap);
+        void unmap() noexcept;
+        void require_writable() const;
+    };
+
+    // Maps the first _new_cap elements of the file. The new mapping is made
+    // while the old one is still in place, so if growing the file or
+    // mapping it fails the vector keeps its old mapping and capacity.
+    template <typename T>
+    void mmap_vector<T>::remap(size_type _new_cap)
+    {
+        const bool grow = _new_cap > reservedSize;
+
+        if (grow && ::ftruncate(fd, static_cast<off_t>(_new_cap * sizeof(T))) != 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "ds::mmap_vector - ftruncate failed");
+        }
+
+        pointer fresh = nullptr;
+
+        if (_new_cap != 0)
+        {
+            void *addr = ::mmap(nullptr, _new_cap * sizeof(T), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+            if (addr == MAP_FAILED)
+            {
+                throw std::system_error(errno, std::generic_category(), "ds::mmap_vector - mmap failed");
+            }
+
+            fresh = static_cast<pointer>(addr);
+        }
+
+        unmap();
+        array = fresh;
+        reservedSize = _new_cap;
+
+        // shrinking cuts the file only once nothing maps the tail; a failure
+        // leaves a longer file, which close() trims anyway
+        if (!grow && ::ftruncate(fd, static_cast<off_t>(_new_cap * sizeof(T))) != 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "ds::mmap_vector - ftruncate failed");
+        }
+    }
+
+    template <typename T>
+    void mmap_vector<T>::unmap() noexcept
+    {
+        if (array != nullptr)
+        {
+            ::munmap(array, reservedSize * sizeof(T));
+            array = nullptr;
+        }
+
+        reservedSize = 0;
+    }
+
+    template <typename T>
+    void mmap_vector<T>::require_writable() const
+    {
+        if (fd == -1 || readOnly)
+        {
+            throw std::logic_error("ds::mmap_vector - mapping is not writable");
+        }
+    }
+
+    // default constructor
+    template <typename T>
+    mmap_vector<T>::mmap_vector() noexcept
+    {
+    }
+
+    // file constructor
+    template <typename T>
+    mmap_vector<T>::mmap_vector(const char *_path, mode _mode)
+    {
+        open(_path, _mode);
+    }
+
+    // move constructor
+    template <typename T>
+    mmap_vector<T>::mmap_vector(mmap_vector<T> &&_temp) noexcept : array(_temp.array),
+                                                                   reservedSize(_temp.reservedSize),
+                                                                   vectorSize(_temp.vectorSize),
+                                                                   fd(_temp.fd),
+                                                                   readOnly(_temp.readOnly)
+    {
+        _temp.array = nullptr;
+        _temp.vectorSize = _temp.reservedSize = 0;
+        _temp.fd = -1;
+    }
+
+    // destructor
+    template <typename T>
+    mmap_vector<T>::~mmap_vector() noexcept
+    {
+        try
+        {
+            close();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    // move assignment
+    template <typename T>
+    mmap_vector<T> &mmap_vector<T>::operator=(mmap_vector<T> &&_other) noexcept
+    {
+        if (this == &_other)
+        {
+            return *this;
+        }
+
+        try
+        {
+            close();
+        }
+        catch (...)
+        {
+        }
+
+        array = _other.array;
+        vectorSize = _other.vectorSize;
+        reservedSize = _other.reservedSize;
+        fd = _other.fd;
+        readOnly = _other.readOnly;
+
+        _other.array = nullptr;
+        _other.vectorSize = 0;
+        _other.reservedSize = 0;
+        _other.fd = -1;
+
+        return *this;
+    }
+
+    // opens _path and maps its whole contents. read_only maps the file
+    // PROT_READ without copying; read_write creates the file if missing.
+    template <typename T>
+    void mmap_vector<T>::open(const char *_path, mode _mode)
+    {
+        close();
+
+        readOnly = _mode == mode::read_only;
+
+        fd = readOnly ? ::open(_path, O_RDONLY | O_CLOEXEC)
+                      : ::open(_path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+        if (fd == -1)
+        {
+            throw std::system_error(errno, std::generic_category(), "ds::mmap_vector - open failed");
+        }
+
+        struct stat st;
+
+        if (::fstat(fd, &st) != 0)
+        {
+            int err = errno;
+            ::close(fd);
+            fd = -1;
+            throw std::system_error(err, std::generic_category(), "ds::mmap_vector - fstat failed");
+        }
+
+        if (st.st_size % sizeof(T) != 0)
+        {
+            ::close(fd);
+            fd = -1;
+            throw std::runtime_error("ds::mmap_vector - file size is not a multiple of sizeof(T)");
+        }
+
+        const size_type count = static_cast<size_type>(st.st_size) / sizeof(T);
+
+        if (count != 0)
+        {
+            void *addr = ::mmap(nullptr, count * sizeof(T), readOnly ? PROT_READ : PROT_READ | PROT_WRITE,
+                                MAP_SHARED, fd, 0);
+
+            if (addr == MAP_FAILED)
+            {
+                int err = errno;
+                ::close(fd);
+                fd = -1;
+                throw std::system_error(err, std::generic_category(), "ds::mmap_vector - mmap failed");
+            }
+
+            array = static_cast<pointer>(addr);
+        }
+
+        reservedSize = vectorSize = count;
+    }
+
+    // unmaps the file and, when writable, trims it to size() elements
+    template <typename T>
+    void mmap_vector<T>::close()
+    {
+        if (fd == -1)
+        {
+            return;
+        }
+
+        unmap();
+
+        int err = 0;
+
+        if (!readOnly && ::ftruncate(fd, static_cast<off_t>(vectorSize * sizeof(T))) != 0)
+        {
+            err = errno;
+        }
+
+        ::close(fd);
+        fd = -1;
+        vectorSize = 0;
+
+        if (err != 0)
+        {
+            throw std::system_error(err, std::generic_category(), "ds::mmap_vector - ftruncate failed");
+        }
+    }
+
+    // writes dirty pages back to the file; _async schedules the write and returns
+    template <typename T>
+    void mmap_vector<T>::flush(bool _async)
+    {
+        if (array == nullptr || readOnly)
+        {
+            return;
+        }
+
+        if (::msync(array, reservedSize * sizeof(T), _async ? MS_ASYNC : MS_SYNC) != 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "ds::mmap_vector - msync failed");
+        }
+    }
+
+    template <typename T>
+    typename mmap_vector<T>::reference mmap_vector<T>::at(size_type _index)
+    {
+        if (_index >= vectorSize)
+        {
+            throw std::out_of_range("ds::mmap_vector - index is out of bounds");
+        }
+        return *(array + _index);
+    }
+
+    template <typename T>
+    typename mmap_vector<T>::const_reference mmap_vector<T>::at(size_type _index) const
+    {
+        if (_index >= vectorSize)
+        {
+            throw std::out_of_range("ds::mmap_vector - index is out of bounds");
+        }
+        return *(array + _index);
+    }
+
+    template <typename T>
+    void mmap_vector<T>::reserve(size_type new_cap)
+    {
+        require_writable();
+
+        if (new_cap > reservedSize)
+        {
+            remap(new_cap);
+        }
+    }
+
+    template <typename T>
+    void mmap_vector<T>::shrink_to_fit()
+    {
+        require_writable();
+
+        if (reservedSize > vectorSize)
+        {
+            remap(vectorSize);
+        }
+    }
+
+    template <typename T>
+    void mmap_vector<T>::clear()
+    {
+        require_writable();
+
+        vectorSize = 0;
+    }
+
+    // new elements are value initialised; the file is zero filled on growth
+    template <typename T>
+    void mmap_vector<T>::resize(size_type _count)
+    {
+        require_writable();
+
+        if (_count > reservedSize)
+        {
+            remap(_count);
+        }
+
+        for (size_type i = vectorSize; i < _count; i++)
+        {
+            new (array + i) T();
+        }
+
+        vectorSize = _count;
+    }
+
+    template <typename T>
+    void mmap_vector<T>::push_back(const T &_value)
+    {
+        require_writable();
+
+        if (vectorSize == reservedSize)
+        {
+            // _value may live inside the mapping that remap() replaces
+            T copy = _value;
+
+            remap(reservedSize == 0 ? 1 : reservedSize * 2);
+
+            array[vectorSize] = copy;
+        }
+        else
+        {
+            array[vectorSize] = _value;
+        }
+
+        vectorSize++;
+    }
+
+    template <typename T>
+    void mmap_vector<T>::pop_back()
+    {
+        require_writable();
+
+        if (vectorSize != 0)
+        {
+            --vectorSize;
+        }
+    }
+
+}
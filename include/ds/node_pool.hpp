@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#include "memory.hpp"
+#include "vector.hpp"
+
+namespace ds
+{
+    namespace detail
+    {
+        // target size of one pool chunk once the pool has grown
+        inline constexpr std::size_t NODE_POOL_CHUNK_BYTES = 64 * 1024;
+
+        // Fixed-size storage for the nodes of a linked container. Nodes are
+        // carved out of chunks that double in size up to
+        // NODE_POOL_CHUNK_BYTES, so a small container stays small, and nodes
+        // allocated together sit next to each other in memory. Released nodes
+        // go on a free list, which allocate() takes from first. The pool hands
+        // out raw storage: constructing and destroying the Node is the
+        // caller's job.
+        template <typename Node>
+        class node_pool
+        {
+        public:
+            // constructors
+            node_pool() = default;
+            node_pool(const node_pool &) = delete;
+            node_pool(node_pool &&_temp) noexcept { swap(_temp); }
+
+            // destructors
+            ~node_pool() noexcept { release(); }
+
+            // operator=
+            node_pool &operator=(const node_pool &) = delete;
+            node_pool &operator=(node_pool &&_other) noexcept
+            {
+                node_pool(std::move(_other)).swap(*this);
+                return *this;
+            }
+
+            // storage for one Node
+            Node *allocate();
+            void deallocate(Node *_node) noexcept;
+
+            // makes sure the next _count allocate() calls cannot throw
+            void reserve(std::size_t _count);
+
+            // takes back every node at once but keeps the chunks
+            void reset() noexcept;
+
+            // frees the chunks; nothing allocated may be in use
+            void release() noexcept;
+
+            void swap(node_pool &_other) noexcept;
+
+        private:
+            union slot
+            {
+                slot *next;
+                alignas(Node) unsigned char bytes[sizeof(Node)];
+            };
+
+            struct chunk
+            {
+                slot *slots;
+                std::size_t capacity;
+            };
+
+            static constexpr std::size_t firstChunk = 4;
+            static constexpr std::size_t maxChunk = NODE_POOL_CHUNK_BYTES / sizeof(slot) > firstChunk ? NODE_POOL_CHUNK_BYTES / sizeof(slot) : firstChunk;
+
+            ds::vector<chunk> chunks;
+            slot *freeList = nullptr;
+            std::size_t freeCount = 0;
+            std::size_t current = 0; // chunk being carved
+            std::size_t used = 0;    // slots of it handed out
+
+            void addChunk(std::size_t _capacity);
+        };
+
+        template <typename Node>
+        Node *node_pool<Node>::allocate()
+        {
+            if (freeList != nullptr)
+            {
+                slot *s = freeList;
+                freeList = s->next;
+                freeCount--;
+                return reinterpret_cast<Node *>(s->bytes);
+            }
+
+            while (chunks.empty() || used == chunks[current].capacity)
+            {
+                if (!chunks.empty() && current + 1 < chunks.size())
+                {
+                    current++;
+                    used = 0;
+                }
+                else
+                {
+                    addChunk(chunks.empty() ? firstChunk : (2 * chunks.back().capacity < maxChunk ? 2 * chunks.back().capacity : maxChunk));
+                }
+            }
+
+            return reinterpret_cast<Node *>(chunks[current].slots[used++].bytes);
+        }
+
+        template <typename Node>
+        void node_pool<Node>::reserve(std::size_t _count)
+        {
+            std::size_t available = freeCount;
+            for (std::size_t i = current; i < chunks.size(); i++)
+            {
+                available += chunks[i].capacity - (i == current ? used : 0);
+            }
+
+            if (available < _count)
+            {
+                const std::size_t next = chunks.empty() ? firstChunk : (2 * chunks.back().capacity < maxChunk ? 2 * chunks.back().capacity : maxChunk);
+                addChunk(next > _count - available ? next : _count - available);
+            }
+        }
+
+        // appends a chunk; carving moves on to it once the earlier ones are used up
+        template <typename Node>
+        void node_pool<Node>::addChunk(std::size_t _capacity)
+        {
+            if (chunks.size() == chunks.capacity())
+            {
+                chunks.reserve(2 * chunks.size() + 4);
+            }
+
+            const bool first = chunks.empty();
+            chunks.push_back(chunk{detail::allocate<slot>(_capacity), _capacity});
+            if (first)
+            {
+                current = 0;
+                used = 0;
+            }
+        }
+
+        template <typename Node>
+        void node_pool<Node>::deallocate(Node *_node) noexcept
+        {
+            slot *s = reinterpret_cast<slot *>(_node);
+            s->next = freeList;
+            freeList = s;
+            freeCount++;
+        }
+
+        template <typename Node>
+        void node_pool<Node>::reset() noexcept
+        {
+            freeList = nullptr;
+            freeCount = 0;
+            current = 0;
+            used = 0;
+        }
+
+        template <typename Node>
+        void node_pool<Node>::release() noexcept
+        {
+            for (const chunk &c : chunks)
+            {
+                detail::deallocate(c.slots, c.capacity);
+            }
+            chunks = ds::vector<chunk>();
+            reset();
+        }
+
+        template <typename Node>
+        void node_pool<Node>::swap(node_pool &_other) noexcept
+        {
+            std::swap(chunks, _other.chunks);
+            std::swap(freeList, _other.freeList);
+            std::swap(freeCount, _other.freeCount);
+            std::swap(current, _other.current);
+            std::swap(used, _other.used);
+        }
+    }
+}
@@ -12,67 +12,67 @@ public:
     using pointer           = typename std::iterator_traits<IteratorType>::pointer;
     using reference         = typename std::iterator_traits<IteratorType>::reference;
 
-    NormalIterator() : current() {}
+    constexpr NormalIterator() : current() {}
 
 
     template<typename Iter>
-    NormalIterator(const NormalIterator<Iter, Container>& other,
+    constexpr NormalIterator(const NormalIterator<Iter, Container>& other,
      std::enable_if_t< std::is_convertible_v<Iter, IteratorType>, int > = 0) : current(other.base()) {}
 
 
-    explicit NormalIterator(const IteratorType& it) : current(it) {}
+    constexpr explicit NormalIterator(const IteratorType& it) : current(it) {}
 
-    reference operator*() const { return *current; }
-    pointer operator->() const { return current; }
+    constexpr reference operator*() const { return *current; }
+    constexpr pointer operator->() const { return current; }
 
-    NormalIterator& operator++() { ++current; return *this; }
-    NormalIterator operator++(int) { NormalIterator tmp = *this; ++current; return tmp; }
+    constexpr NormalIterator& operator++() { ++current; return *this; }
+    constexpr NormalIterator operator++(int) { NormalIterator tmp = *this; ++current; return tmp; }
 
-    NormalIterator& operator--() { --current; return *this; }
-    NormalIterator operator--(int) { NormalIterator tmp = *this; --current; return tmp; }
+    constexpr NormalIterator& operator--() { --current; return *this; }
+    constexpr NormalIterator operator--(int) { NormalIterator tmp = *this; --current; return tmp; }
 
-    NormalIterator& operator+=(difference_type n) { current += n; return *this; }
-    NormalIterator operator+(difference_type n) const { return NormalIterator(current + n); }
+    constexpr NormalIterator& operator+=(difference_type n) { current += n; return *this; }
+    constexpr NormalIterator operator+(difference_type n) const { return NormalIterator(current + n); }
 
-    NormalIterator& operator-=(difference_type n) { current -= n; return *this; }
-    NormalIterator operator-(difference_type n) const { return NormalIterator(current - n); }
+    constexpr NormalIterator& operator-=(difference_type n) { current -= n; return *this; }
+    constexpr NormalIterator operator-(difference_type n) const { return NormalIterator(current - n); }
 
-    difference_type operator-(const NormalIterator& other) const { return current - other.current; }
+    constexpr difference_type operator-(const NormalIterator& other) const { return current - other.current; }
 
-    reference operator[](difference_type n) const { return current[n]; }
+    constexpr reference operator[](difference_type n) const { return current[n]; }
 
-    IteratorType base() const { return current; }
+    constexpr IteratorType base() const { return current; }
 
 private:
     IteratorType current;
 };
 
 template <typename Iter1, typename Iter2, typename Container>
-bool operator!=(const NormalIterator<Iter1, Container>& lhs, const NormalIterator<Iter2, Container>& rhs) {
+constexpr bool operator!=(const NormalIterator<Iter1, Container>& lhs, const NormalIterator<Iter2, Container>& rhs) {
     return lhs.base() != rhs.base();
 }
 
 template <typename Iter1, typename Iter2, typename Container>
-bool operator==(const NormalIterator<Iter1, Container>& lhs, const NormalIterator<Iter2, Container>& rhs) {
+constexpr bool operator==(const NormalIterator<Iter1, Container>& lhs, const NormalIterator<Iter2, Container>& rhs) {
     return lhs.base() == rhs.base();
 }
 
 template <typename Iter1, typename Iter2, typename Container>
-bool operator<(const NormalIterator<Iter1, Container>& lhs, const NormalIterator<Iter2, Container>& rhs) {
+constexpr bool operator<(const NormalIterator<Iter1, Container>& lhs, const NormalIterator<Iter2, Container>& rhs) {
     return lhs.base() < rhs.base();
 }
 
 template <typename Iter1, typename Iter2, typename Container>
-bool operator>(const NormalIterator<Iter1, Container>& lhs, const NormalIterator<Iter2, Container>& rhs) {
+constexpr bool operator>(const NormalIterator<Iter1, Container>& lhs, const NormalIterator<Iter2, Container>& rhs) {
     return lhs.base() > rhs.base();
 }
 
 template <typename Iter1, typename Iter2, typename Container>
-bool operator<=(const NormalIterator<Iter1, Container>& lhs, const NormalIterator<Iter2, Container>& rhs) {
+constexpr bool operator<=(const NormalIterator<Iter1, Container>& lhs, const NormalIterator<Iter2, Container>& rhs) {
     return lhs.base() <= rhs.base();
 }
 
 template <typename Iter1, typename Iter2, typename Container>
-bool operator>=(const NormalIterator<Iter1, Container>& lhs, const NormalIterator<Iter2, Container>& rhs) {
+constexpr bool operator>=(const NormalIterator<Iter1, Container>& lhs, const NormalIterator<Iter2, Container>& rhs) {
     return lhs.base() >= rhs.base();
 }
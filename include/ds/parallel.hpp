@@ -0,0 +1,236 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#ifdef DS_HAVE_NUMA
+#include <numa.h>
+#endif
+
+namespace ds
+{
+    // Execution policy for the parallel overloads, e.g. ds::parallel or
+    // ds::parallel(8). Zero threads means std::thread::hardware_concurrency().
+    struct parallel_t
+    {
+        unsigned threads = 0;
+
+        constexpr parallel_t operator()(unsigned _threads) const { return parallel_t{_threads}; }
+    };
+
+    inline constexpr parallel_t parallel{};
+
+    namespace detail
+    {
+        // below this much memory per thread, starting a thread costs more than it saves
+        constexpr std::size_t PARALLEL_MIN_BYTES_PER_THREAD = std::size_t(1) << 20;
+
+        inline std::size_t page_size()
+        {
+            static const std::size_t size = []
+            {
+                long p = ::sysconf(_SC_PAGESIZE);
+                return p > 0 ? std::size_t(p) : std::size_t(4096);
+            }();
+
+            return size;
+        }
+
+        // spreads spawned workers round-robin over the NUMA nodes, so the
+        // pages each one first-touches are placed on its node
+        inline void bind_worker(std::size_t _worker)
+        {
+#ifdef DS_HAVE_NUMA
+            if (numa_available() >= 0)
+            {
+                const int nodes = numa_num_configured_nodes();
+
+                if (nodes > 1)
+                {
+                    numa_run_on_node(int(_worker % std::size_t(nodes)));
+                }
+            }
+#else
+            (void)_worker;
+#endif
+        }
+    }
+
+    // number of workers the parallel overloads use for _count elements of _element_size bytes
+    inline std::size_t parallel_workers(std::size_t _count, std::size_t _element_size, parallel_t _policy)
+    {
+        std::size_t threads = _policy.threads != 0 ? _policy.threads : std::thread::hardware_concurrency();
+        const std::size_t pages = (_count * _element_size + detail::page_size() - 1) / detail::page_size();
+
+        if (_policy.threads == 0)
+        {
+            threads = std::min<std::size_t>(threads, _count * _element_size / detail::PARALLEL_MIN_BYTES_PER_THREAD);
+        }
+
+        return std::max<std::size_t>(1, std::min(threads, pages));
+    }
+
+    // The element range [first, last) owned by _worker. Parts are whole
+    // multiples of a page worth of elements, so apart from the pages at part
+    // boundaries each page is touched by one worker. Process data with the
+    // same partition (see parallel_for) to keep threads on their own pages.
+    inline std::pair<std::size_t, std::size_t> parallel_partition(std::size_t _count, std::size_t _element_size,
+                                                                  std::size_t _workers, std::size_t _worker)
+    {
+        const std::size_t perPage = std::max<std::size_t>(1, detail::page_size() / std::max<std::size_t>(1, _element_size));
+        const std::size_t pages = (_count + perPage - 1) / perPage;
+        const std::size_t pagesPerWorker = (pages + _workers - 1) / _workers;
+
+        const std::size_t first = std::min(_count, _worker * pagesPerWorker * perPage);
+        const std::size_t last = std::min(_count, first + pagesPerWorker * perPage);
+
+        return {first, last};
+    }
+
+    // Calls _f(first, last, worker) for every part of [0, _count), one
+    // thread per part with the calling thread taking the last one. The first
+    // exception thrown by a worker is rethrown once all have finished.
+    template <typename F>
+    void parallel_for(std::size_t _count, std::size_t _element_size, parallel_t _policy, F &&_f)
+    {
+        if (_count == 0)
+        {
+            return;
+        }
+
+        const std::size_t workers = parallel_workers(_count, _element_size, _policy);
+
+        if (workers == 1)
+        {
+            _f(std::size_t(0), _count, std::size_t(0));
+            return;
+        }
+
+        std::vector<std::thread> threads;
+        std::vector<std::exception_ptr> errors(workers);
+
+        for (std::size_t t = 0; t < workers; t++)
+        {
+            const std::pair<std::size_t, std::size_t> part = parallel_partition(_count, _element_size, workers, t);
+
+            if (part.first >= part.second)
+            {
+                break;
+            }
+
+            auto work = [&, t, part]
+            {
+                try
+                {
+                    _f(part.first, part.second, t);
+                }
+                catch (...)
+                {
+                    errors[t] = std::current_exception();
+                }
+            };
+
+            if (t + 1 == workers || parallel_partition(_count, _element_size, workers, t + 1).first >= _count)
+            {
+                work();
+            }
+            else
+            {
+                threads.emplace_back([work, t]
+                                     {
+                                         detail::bind_worker(t);
+                                         work();
+                                     });
+            }
+        }
+
+        for (std::thread &w : threads)
+        {
+            w.join();
+        }
+
+        for (std::exception_ptr &e : errors)
+        {
+            if (e)
+            {
+                std::rethrow_exception(e);
+            }
+        }
+    }
+
+    namespace detail
+    {
+        // Partitions [0, _span) with parallel_for, constructs _construct(slot,
+        // index) for the first _count slots and writes one byte into every
+        // page of the remaining raw slots, so each worker first-touches its
+        // own part. If any construction throws, everything constructed is
+        // destroyed again and the exception is rethrown.
+        template <typename T, typename Construct>
+        void parallel_construct(T *_dest, std::size_t _count, std::size_t _span, parallel_t _policy, Construct _construct)
+        {
+            const std::size_t workers = parallel_workers(_span, sizeof(T), _policy);
+            std::vector<char> completed(workers, 0);
+
+            try
+            {
+                parallel_for(_span, sizeof(T), parallel_t{unsigned(workers)}, [&](std::size_t _first, std::size_t _last, std::size_t _worker)
+                             {
+                                 const std::size_t end = std::min(_last, _count);
+                                 std::size_t i = _first;
+
+                                 try
+                                 {
+                                     for (; i < end; i++)
+                                     {
+                                         _construct(_dest + i, i);
+                                     }
+                                 }
+                                 catch (...)
+                                 {
+                                     for (std::size_t j = _first; j < i; j++)
+                                     {
+                                         _dest[j].~T();
+                                     }
+                                     throw;
+                                 }
+
+                                 if (_last > _count)
+                                 {
+                                     const std::size_t page = page_size();
+                                     char *p = reinterpret_cast<char *>(_dest + std::max(_first, _count));
+                                     char *stop = reinterpret_cast<char *>(_dest + _last);
+
+                                     for (; p < stop; p += page)
+                                     {
+                                         *static_cast<volatile char *>(p) = 0;
+                                     }
+                                 }
+
+                                 completed[_worker] = 1;
+                             });
+            }
+            catch (...)
+            {
+                for (std::size_t t = 0; t < workers; t++)
+                {
+                    if (completed[t])
+                    {
+                        const std::pair<std::size_t, std::size_t> part = parallel_partition(_span, sizeof(T), workers, t);
+
+                        for (std::size_t i = part.first; i < std::min(part.second, _count); i++)
+                        {
+                            _dest[i].~T();
+                        }
+                    }
+                }
+                throw;
+            }
+        }
+    }
+}
@@ -0,0 +1,836 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+namespace ds
+{
+    // Immutable vector with structural sharing: a 32-way trie of leaves plus
+    // a separately held tail leaf, after Clojure's PersistentVector. Copying
+    // is O(1) and bumps two reference counts, so snapshots can be handed to
+    // other threads freely. Every update returns a new version that shares
+    // all untouched nodes with the old one and costs O(log32 n).
+    //
+    // A transient_vector batches updates: nodes it creates are tagged with
+    // its edit token and mutated in place until persistent() freezes them.
+    //
+    // slice()/take()/drop() share structure and cost O(log32 n); the trie
+    // keeps its original index space, so a deeply dropped vector keeps the
+    // height it had. concat() appends the right hand side element by element
+    // through a transient and costs O(rhs.size()).
+    template <typename T>
+    class persistent_vector
+    {
+        static constexpr unsigned BITS = 5;
+        static constexpr std::size_t WIDTH = std::size_t(1) << BITS;
+        static constexpr std::size_t MASK = WIDTH - 1;
+
+        struct node
+        {
+            std::atomic<std::uint32_t> refs{1};
+            std::uint64_t edit;
+            bool leaf;
+
+            node(std::uint64_t _edit, bool _leaf) : edit(_edit), leaf(_leaf) {}
+        };
+
+        struct inner_node : node
+        {
+            node *child[WIDTH] = {};
+
+            explicit inner_node(std::uint64_t _edit) : node(_edit, false) {}
+        };
+
+        struct leaf_node : node
+        {
+            std::uint32_t count = 0;
+            alignas(T) unsigned char storage[WIDTH * sizeof(T)];
+
+            explicit leaf_node(std::uint64_t _edit) : node(_edit, true) {}
+
+            T *data() { return reinterpret_cast<T *>(storage); }
+            const T *data() const { return reinterpret_cast<const T *>(storage); }
+        };
+
+        // root/tail pair shared by persistent and transient vectors. Index j
+        // below is a trie index; element i of the vector is trie index origin + i.
+        struct trie
+        {
+            node *root = nullptr;
+            leaf_node *tail = nullptr;
+            std::size_t cnt = 0;
+            std::size_t origin = 0;
+            unsigned shift = BITS;
+
+            trie() noexcept {}
+            trie(const trie &_other) noexcept;
+            trie(trie &&_other) noexcept;
+            ~trie() noexcept;
+            trie &operator=(trie _other) noexcept;
+
+            std::size_t tailoff() const { return cnt < WIDTH ? 0 : ((cnt - 1) >> BITS) << BITS; }
+            const leaf_node *leaf_for(std::size_t _j) const;
+
+            template <typename... Args>
+            void emplace_back(std::uint64_t _edit, Args &&...args);
+            template <typename U>
+            void assign(std::size_t _j, U &&_value, std::uint64_t _edit);
+            void truncate(std::size_t _newCnt, std::uint64_t _edit);
+            void drop_to(std::size_t _newOrigin, std::uint64_t _edit);
+
+            leaf_node *editable_tail(std::uint64_t _edit);
+            inner_node *push_tail(unsigned _level, node *_parent, leaf_node *_tail, std::uint64_t _edit);
+            template <typename U>
+            node *assoc(unsigned _level, node *_n, std::size_t _j, U &&_value, std::uint64_t _edit);
+            inner_node *trim(unsigned _level, node *_n, std::size_t _last, std::uint64_t _edit);
+            inner_node *prune(unsigned _level, node *_n, std::size_t _first, std::uint64_t _edit);
+        };
+
+        static void retain(node *_n) noexcept;
+        static void release(node *_n) noexcept;
+        static void replace(node *&_slot, node *_n) noexcept;
+        static inner_node *editable_inner(node *_n, std::uint64_t _edit);
+        static leaf_node *copy_leaf(const leaf_node *_src, std::size_t _count, std::uint64_t _edit);
+        static node *new_path(unsigned _level, node *_n, std::size_t _j, std::uint64_t _edit);
+        static std::uint64_t next_edit();
+
+        trie tree;
+
+    public:
+        using value_type = T;
+        using const_pointer = const T *;
+        using const_reference = const T &;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        class const_iterator;
+        using iterator = const_iterator;
+        class transient_vector;
+
+        // constructors
+        persistent_vector() noexcept {}
+        persistent_vector(std::initializer_list<T> _li);
+        template <typename InputIt>
+        persistent_vector(InputIt _first, InputIt _last);
+
+        // element access
+        const_reference operator[](size_type _index) const;
+        const_reference at(size_type _index) const;
+        const_reference front() const { return (*this)[0]; }
+        const_reference back() const { return (*this)[size() - 1]; }
+
+        // iterators
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, size()); }
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+
+        // capacity
+        size_type size() const { return tree.cnt - tree.origin; }
+        bool empty() const { return size() == 0; }
+
+        // updates, each returning a new version
+        [[nodiscard]] persistent_vector push_back(const T &_value) const;
+        [[nodiscard]] persistent_vector push_back(T &&_value) const;
+        [[nodiscard]] persistent_vector set(size_type _index, const T &_value) const;
+        [[nodiscard]] persistent_vector pop_back() const;
+        [[nodiscard]] persistent_vector take(size_type _count) const;
+        [[nodiscard]] persistent_vector drop(size_type _count) const;
+        [[nodiscard]] persistent_vector slice(size_type _first, size_type _last) const;
+        [[nodiscard]] persistent_vector concat(const persistent_vector &_other) const;
+
+        transient_vector transient() const { return transient_vector(*this); }
+    };
+
+    // mutable batch view of a persistent_vector; not safe to share between
+    // threads. Move-only: a copy would carry the same edit token and write
+    // into the nodes it shares with the original.
+    template <typename T>
+    class persistent_vector<T>::transient_vector
+    {
+    public:
+        explicit transient_vector(const persistent_vector &_from) : tree(_from.tree), edit(next_edit()) {}
+        transient_vector(const transient_vector &) = delete;
+        transient_vector(transient_vector &&) noexcept = default;
+
+        transient_vector &operator=(const transient_vector &) = delete;
+        transient_vector &operator=(transient_vector &&) noexcept = default;
+
+        size_type size() const { return tree.cnt - tree.origin; }
+        bool empty() const { return size() == 0; }
+
+        const_reference operator[](size_type _index) const
+        {
+            const size_type j = tree.origin + _index;
+            return tree.leaf_for(j)->data()[j & MASK];
+        }
+
+        void push_back(const T &_value) { tree.emplace_back(edit, _value); }
+        void push_back(T &&_value) { tree.emplace_back(edit, std::move(_value)); }
+
+        template <typename... Args>
+        void emplace_back(Args &&...args) { tree.emplace_back(edit, std::forward<Args>(args)...); }
+
+        void set(size_type _index, const T &_value) { tree.assign(tree.origin + _index, _value, edit); }
+        void pop_back() { tree.truncate(tree.cnt - 1, edit); }
+        void take(size_type _count) { tree.truncate(tree.origin + _count, edit); }
+        void drop(size_type _count) { tree.drop_to(tree.origin + _count, edit); }
+
+        // freezes the nodes built so far and returns them as a persistent
+        // version; the transient stays usable and copies on its next write
+        persistent_vector persistent()
+        {
+            persistent_vector result;
+            result.tree = tree;
+            edit = next_edit();
+            return result;
+        }
+
+    private:
+        trie tree;
+        std::uint64_t edit;
+    };
+
+    // random access iterator that caches the leaf it is reading from
+    template <typename T>
+    class persistent_vector<T>::const_iterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        const_iterator() = default;
+        const_iterator(const persistent_vector *_vec, size_type _index) : vec(_vec), index(_index) {}
+
+        reference operator*() const
+        {
+            const size_type j = vec->tree.origin + index;
+
+            if (block == nullptr || (j & ~MASK) != blockStart)
+            {
+                blockStart = j & ~MASK;
+                block = vec->tree.leaf_for(j)->data();
+            }
+
+            return block[j & MASK];
+        }
+
+        pointer operator->() const { return &**this; }
+        reference operator[](difference_type n) const { return *(*this + n); }
+
+        const_iterator &operator++() { ++index; return *this; }
+        const_iterator operator++(int) { const_iterator tmp = *this; ++index; return tmp; }
+        const_iterator &operator--() { --index; return *this; }
+        const_iterator operator--(int) { const_iterator tmp = *this; --index; return tmp; }
+
+        const_iterator &operator+=(difference_type n) { index += n; return *this; }
+        const_iterator &operator-=(difference_type n) { index -= n; return *this; }
+        const_iterator operator+(difference_type n) const { const_iterator tmp = *this; return tmp += n; }
+        const_iterator operator-(difference_type n) const { const_iterator tmp = *this; return tmp -= n; }
+        difference_type operator-(const const_iterator &other) const { return difference_type(index) - difference_type(other.index); }
+
+        bool operator==(const const_iterator &other) const { return index == other.index; }
+        bool operator!=(const const_iterator &other) const { return index != other.index; }
+        bool operator<(const const_iterator &other) const { return index < other.index; }
+        bool operator>(const const_iterator &other) const { return index > other.index; }
+        bool operator<=(const const_iterator &other) const { return index <= other.index; }
+        bool operator>=(const const_iterator &other) const { return index >= other.index; }
+
+    private:
+        const persistent_vector *vec = nullptr;
+        size_type index = 0;
+        mutable const T *block = nullptr;
+        mutable size_type blockStart = 0;
+    };
+
+    template <typename T>
+    std::uint64_t persistent_vector<T>::next_edit()
+    {
+        static std::atomic<std::uint64_t> counter{0};
+        return ++counter;
+    }
+
+    template <typename T>
+    void persistent_vector<T>::retain(node *_n) noexcept
+    {
+        if (_n != nullptr)
+        {
+            _n->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    template <typename T>
+    void persistent_vector<T>::release(node *_n) noexcept
+    {
+        if (_n == nullptr || _n->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        {
+            return;
+        }
+
+        if (_n->leaf)
+        {
+            leaf_node *l = static_cast<leaf_node *>(_n);
+
+            for (std::uint32_t i = 0; i < l->count; i++)
+            {
+                l->data()[i].~T();
+            }
+
+            delete l;
+        }
+        else
+        {
+            inner_node *in = static_cast<inner_node *>(_n);
+
+            for (node *c : in->child)
+            {
+                release(c);
+            }
+
+            delete in;
+        }
+    }
+
+    // points _slot at _n, dropping the reference _slot held before
+    template <typename T>
+    void persistent_vector<T>::replace(node *&_slot, node *_n) noexcept
+    {
+        if (_slot != _n)
+        {
+            release(_slot);
+            _slot = _n;
+        }
+    }
+
+    // _n itself when this edit owns it, otherwise a copy sharing its children
+    template <typename T>
+    typename persistent_vector<T>::inner_node *persistent_vector<T>::editable_inner(node *_n, std::uint64_t _edit)
+    {
+        if (_n != nullptr && _n->edit == _edit)
+        {
+            return static_cast<inner_node *>(_n);
+        }
+
+        inner_node *copy = new inner_node(_edit);
+
+        if (_n != nullptr)
+        {
+            const inner_node *src = static_cast<const inner_node *>(_n);
+
+            for (std::size_t i = 0; i < WIDTH; i++)
+            {
+                copy->child[i] = src->child[i];
+                retain(copy->child[i]);
+            }
+        }
+
+        return copy;
+    }
+
+    template <typename T>
+    typename persistent_vector<T>::leaf_node *persistent_vector<T>::copy_leaf(const leaf_node *_src, std::size_t _count, std::uint64_t _edit)
+    {
+        leaf_node *copy = new leaf_node(_edit);
+
+        try
+        {
+            for (; copy->count < _count; copy->count++)
+            {
+                new (copy->data() + copy->count) T(_src->data()[copy->count]);
+            }
+        }
+        catch (...)
+        {
+            release(copy);
+            throw;
+        }
+
+        return copy;
+    }
+
+    // chain of fresh inner nodes leading from _level down to _n along trie index _j
+    template <typename T>
+    typename persistent_vector<T>::node *persistent_vector<T>::new_path(unsigned _level, node *_n, std::size_t _j, std::uint64_t _edit)
+    {
+        if (_level == 0)
+        {
+            return _n;
+        }
+
+        inner_node *r = new inner_node(_edit);
+        r->child[(_j >> _level) & MASK] = new_path(_level - BITS, _n, _j, _edit);
+        return r;
+    }
+
+    template <typename T>
+    persistent_vector<T>::trie::trie(const trie &_other) noexcept : root(_other.root),
+                                                                    tail(_other.tail),
+                                                                    cnt(_other.cnt),
+                                                                    origin(_other.origin),
+                                                                    shift(_other.shift)
+    {
+        retain(root);
+        retain(tail);
+    }
+
+    template <typename T>
+    persistent_vector<T>::trie::trie(trie &&_other) noexcept : root(_other.root),
+                                                               tail(_other.tail),
+                                                               cnt(_other.cnt),
+                                                               origin(_other.origin),
+                                                               shift(_other.shift)
+    {
+        _other.root = nullptr;
+        _other.tail = nullptr;
+        _other.cnt = _other.origin = 0;
+        _other.shift = BITS;
+    }
+
+    template <typename T>
+    persistent_vector<T>::trie::~trie() noexcept
+    {
+        release(root);
+        release(tail);
+    }
+
+    template <typename T>
+    typename persistent_vector<T>::trie &persistent_vector<T>::trie::operator=(trie _other) noexcept
+    {
+        std::swap(root, _other.root);
+        std::swap(tail, _other.tail);
+        std::swap(cnt, _other.cnt);
+        std::swap(origin, _other.origin);
+        std::swap(shift, _other.shift);
+        return *this;
+    }
+
+    template <typename T>
+    const typename persistent_vector<T>::leaf_node *persistent_vector<T>::trie::leaf_for(std::size_t _j) const
+    {
+        if (_j >= tailoff())
+        {
+            return tail;
+        }
+
+        const node *n = root;
+
+        for (unsigned level = shift; level > 0; level -= BITS)
+        {
+            n = static_cast<const inner_node *>(n)->child[(_j >> level) & MASK];
+        }
+
+        return static_cast<const leaf_node *>(n);
+    }
+
+    // Makes the tail writable by this edit and trims it to the visible
+    // elements. Returns the previous tail when it was replaced; the caller
+    // releases it once done, since the value being written may live there.
+    template <typename T>
+    typename persistent_vector<T>::leaf_node *persistent_vector<T>::trie::editable_tail(std::uint64_t _edit)
+    {
+        const std::size_t visible = cnt - tailoff();
+
+        if (tail != nullptr && tail->edit == _edit)
+        {
+            for (; tail->count > visible; tail->count--)
+            {
+                tail->data()[tail->count - 1].~T();
+            }
+
+            return nullptr;
+        }
+
+        leaf_node *old = tail;
+        tail = old != nullptr ? copy_leaf(old, visible, _edit) : new leaf_node(_edit);
+        return old;
+    }
+
+    template <typename T>
+    typename persistent_vector<T>::inner_node *persistent_vector<T>::trie::push_tail(unsigned _level, node *_parent, leaf_node *_tail, std::uint64_t _edit)
+    {
+        inner_node *ret = editable_inner(_parent, _edit);
+        const std::size_t sub = ((cnt - 1) >> _level) & MASK;
+
+        node *insert;
+
+        if (_level == BITS)
+        {
+            insert = _tail;
+        }
+        else if (ret->child[sub] != nullptr)
+        {
+            insert = push_tail(_level - BITS, ret->child[sub], _tail, _edit);
+        }
+        else
+        {
+            insert = new_path(_level - BITS, _tail, cnt - 1, _edit);
+        }
+
+        replace(ret->child[sub], insert);
+        return ret;
+    }
+
+    template <typename T>
+    template <typename... Args>
+    void persistent_vector<T>::trie::emplace_back(std::uint64_t _edit, Args &&...args)
+    {
+        const std::size_t visible = cnt - tailoff();
+
+        if (tail != nullptr && visible < WIDTH)
+        {
+            leaf_node *old = editable_tail(_edit);
+
+            try
+            {
+                new (tail->data() + visible) T(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                release(old);
+                throw;
+            }
+
+            tail->count++;
+            cnt++;
+            release(old);
+            return;
+        }
+
+        leaf_node *fresh = new leaf_node(_edit);
+
+        try
+        {
+            new (fresh->data()) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            delete fresh;
+            throw;
+        }
+
+        fresh->count = 1;
+
+        if (tail != nullptr)
+        {
+            // the full tail moves into the trie, which takes over its reference
+            if (root == nullptr)
+            {
+                root = new inner_node(_edit);
+            }
+
+            if ((cnt >> BITS) > (std::size_t(1) << shift))
+            {
+                inner_node *top = new inner_node(_edit);
+                top->child[0] = root;
+                top->child[1] = new_path(shift, tail, cnt - 1, _edit);
+                root = top;
+                shift += BITS;
+            }
+            else
+            {
+                replace(root, push_tail(shift, root, tail, _edit));
+            }
+        }
+
+        tail = fresh;
+        cnt++;
+    }
+
+    template <typename T>
+    template <typename U>
+    typename persistent_vector<T>::node *persistent_vector<T>::trie::assoc(unsigned _level, node *_n, std::size_t _j, U &&_value, std::uint64_t _edit)
+    {
+        if (_level == 0)
+        {
+            leaf_node *l = static_cast<leaf_node *>(_n);
+
+            if (l->edit != _edit)
+            {
+                l = copy_leaf(l, l->count, _edit);
+            }
+
+            l->data()[_j & MASK] = std::forward<U>(_value);
+            return l;
+        }
+
+        inner_node *ret = editable_inner(_n, _edit);
+        const std::size_t sub = (_j >> _level) & MASK;
+
+        replace(ret->child[sub], assoc(_level - BITS, ret->child[sub], _j, std::forward<U>(_value), _edit));
+        return ret;
+    }
+
+    template <typename T>
+    template <typename U>
+    void persistent_vector<T>::trie::assign(std::size_t _j, U &&_value, std::uint64_t _edit)
+    {
+        if (_j >= tailoff())
+        {
+            leaf_node *old = editable_tail(_edit);
+            tail->data()[_j & MASK] = std::forward<U>(_value);
+            release(old);
+        }
+        else
+        {
+            replace(root, assoc(shift, root, _j, std::forward<U>(_value), _edit));
+        }
+    }
+
+    // drops every child after the path to _last
+    template <typename T>
+    typename persistent_vector<T>::inner_node *persistent_vector<T>::trie::trim(unsigned _level, node *_n, std::size_t _last, std::uint64_t _edit)
+    {
+        inner_node *ret = editable_inner(_n, _edit);
+        const std::size_t sub = (_last >> _level) & MASK;
+
+        for (std::size_t i = sub + 1; i < WIDTH; i++)
+        {
+            replace(ret->child[i], nullptr);
+        }
+
+        if (_level > BITS && ret->child[sub] != nullptr)
+        {
+            replace(ret->child[sub], trim(_level - BITS, ret->child[sub], _last, _edit));
+        }
+
+        return ret;
+    }
+
+    // drops every child before the path to _first
+    template <typename T>
+    typename persistent_vector<T>::inner_node *persistent_vector<T>::trie::prune(unsigned _level, node *_n, std::size_t _first, std::uint64_t _edit)
+    {
+        inner_node *ret = editable_inner(_n, _edit);
+        const std::size_t sub = (_first >> _level) & MASK;
+
+        for (std::size_t i = 0; i < sub; i++)
+        {
+            replace(ret->child[i], nullptr);
+        }
+
+        if (_level > BITS && ret->child[sub] != nullptr)
+        {
+            replace(ret->child[sub], prune(_level - BITS, ret->child[sub], _first, _edit));
+        }
+
+        return ret;
+    }
+
+    // keeps trie indices below _newCnt
+    template <typename T>
+    void persistent_vector<T>::trie::truncate(std::size_t _newCnt, std::uint64_t _edit)
+    {
+        if (_newCnt >= cnt)
+        {
+            return;
+        }
+
+        if (_newCnt <= origin)
+        {
+            *this = trie();
+            return;
+        }
+
+        const std::size_t newTailoff = _newCnt < WIDTH ? 0 : ((_newCnt - 1) >> BITS) << BITS;
+
+        if (newTailoff != tailoff())
+        {
+            leaf_node *newTail = const_cast<leaf_node *>(leaf_for(newTailoff));
+            retain(newTail);
+            release(tail);
+            tail = newTail;
+
+            if (newTailoff <= origin)
+            {
+                replace(root, nullptr);
+            }
+            else
+            {
+                replace(root, trim(shift, root, newTailoff - 1, _edit));
+
+                while (root != nullptr && shift > BITS && ((newTailoff - 1) >> shift) == 0)
+                {
+                    node *child = static_cast<inner_node *>(root)->child[0];
+                    retain(child);
+                    release(root);
+                    root = child;
+                    shift -= BITS;
+                }
+            }
+        }
+
+        cnt = _newCnt;
+
+        if (tail->edit == _edit)
+        {
+            editable_tail(_edit);
+        }
+    }
+
+    // forgets trie indices below _newOrigin and frees the nodes holding only them
+    template <typename T>
+    void persistent_vector<T>::trie::drop_to(std::size_t _newOrigin, std::uint64_t _edit)
+    {
+        if (_newOrigin <= origin)
+        {
+            return;
+        }
+
+        if (_newOrigin >= cnt)
+        {
+            *this = trie();
+            return;
+        }
+
+        if (_newOrigin >= tailoff())
+        {
+            replace(root, nullptr);
+        }
+        else
+        {
+            replace(root, prune(shift, root, _newOrigin, _edit));
+        }
+
+        origin = _newOrigin;
+    }
+
+    // initializer list constructor
+    template <typename T>
+    persistent_vector<T>::persistent_vector(std::initializer_list<T> _li) : persistent_vector(_li.begin(), _li.end())
+    {
+    }
+
+    // range constructor
+    template <typename T>
+    template <typename InputIt>
+    persistent_vector<T>::persistent_vector(InputIt _first, InputIt _last)
+    {
+        transient_vector t(*this);
+
+        for (; _first != _last; ++_first)
+        {
+            t.push_back(*_first);
+        }
+
+        tree = t.persistent().tree;
+    }
+
+    template <typename T>
+    typename persistent_vector<T>::const_reference persistent_vector<T>::operator[](size_type _index) const
+    {
+        const size_type j = tree.origin + _index;
+        return tree.leaf_for(j)->data()[j & MASK];
+    }
+
+    template <typename T>
+    typename persistent_vector<T>::const_reference persistent_vector<T>::at(size_type _index) const
+    {
+        if (_index >= size())
+        {
+            throw std::out_of_range("ds::persistent_vector - index is out of bounds");
+        }
+        return (*this)[_index];
+    }
+
+    template <typename T>
+    persistent_vector<T> persistent_vector<T>::push_back(const T &_value) const
+    {
+        transient_vector t(*this);
+        t.push_back(_value);
+        return t.persistent();
+    }
+
+    template <typename T>
+    persistent_vector<T> persistent_vector<T>::push_back(T &&_value) const
+    {
+        transient_vector t(*this);
+        t.push_back(std::move(_value));
+        return t.persistent();
+    }
+
+    template <typename T>
+    persistent_vector<T> persistent_vector<T>::set(size_type _index, const T &_value) const
+    {
+        if (_index >= size())
+        {
+            throw std::out_of_range("ds::persistent_vector - index is out of bounds");
+        }
+
+        transient_vector t(*this);
+        t.set(_index, _value);
+        return t.persistent();
+    }
+
+    template <typename T>
+    persistent_vector<T> persistent_vector<T>::pop_back() const
+    {
+        return take(empty() ? 0 : size() - 1);
+    }
+
+    template <typename T>
+    persistent_vector<T> persistent_vector<T>::take(size_type _count) const
+    {
+        if (_count >= size())
+        {
+            return *this;
+        }
+
+        transient_vector t(*this);
+        t.take(_count);
+        return t.persistent();
+    }
+
+    template <typename T>
+    persistent_vector<T> persistent_vector<T>::drop(size_type _count) const
+    {
+        if (_count == 0)
+        {
+            return *this;
+        }
+
+        transient_vector t(*this);
+        t.drop(_count);
+        return t.persistent();
+    }
+
+    template <typename T>
+    persistent_vector<T> persistent_vector<T>::slice(size_type _first, size_type _last) const
+    {
+        if (_first > _last || _last > size())
+        {
+            throw std::out_of_range("ds::persistent_vector - slice is out of bounds");
+        }
+
+        transient_vector t(*this);
+        t.take(_last);
+        t.drop(_first);
+        return t.persistent();
+    }
+
+    template <typename T>
+    persistent_vector<T> persistent_vector<T>::concat(const persistent_vector &_other) const
+    {
+        if (empty())
+        {
+            return _other;
+        }
+
+        transient_vector t(*this);
+
+        for (const T &value : _other)
+        {
+            t.push_back(value);
+        }
+
+        return t.persistent();
+    }
+}
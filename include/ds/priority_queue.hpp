@@ -0,0 +1,283 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+
+namespace ds
+{
+    // default for priority_queue's OnMove: positions are not tracked
+    struct heap_no_position
+    {
+        template <typename T>
+        void operator()(const T &, std::size_t) const {}
+    };
+
+    // Implicit d-ary heap over a ds::vector; like std::priority_queue, the
+    // top is the element no other compares greater than under Compare. A
+    // 4-ary heap is half as deep as a binary one and the children of a node
+    // sit next to each other, so a sift touches fewer cache lines for a few
+    // more comparisons per level. push_range appends and, when the batch
+    // is large, rebuilds the heap bottom-up (Floyd) in O(n).
+    //
+    // OnMove, if given, is called as onMove(element, position) each time an
+    // element lands in a new position, so a caller can keep an index from
+    // its own ids to heap positions; decrease_key, update and erase take
+    // such a position. A popped or erased element gets no further calls.
+    template <typename T, typename Compare = std::less<T>, std::size_t Arity = 4, typename OnMove = heap_no_position>
+    class priority_queue
+    {
+        static_assert(Arity >= 2, "ds::priority_queue needs an arity of at least 2");
+
+    public:
+        using value_type = T;
+        using value_compare = Compare;
+        using size_type = std::size_t;
+        using const_reference = const T &;
+
+        // constructors
+        priority_queue() = default;
+        explicit priority_queue(const Compare &_comp, const OnMove &_onMove = OnMove()) : comp(_comp), onMove(_onMove) {}
+
+        template <typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+        priority_queue(InputIt _first, InputIt _last, const Compare &_comp = Compare(), const OnMove &_onMove = OnMove()) : comp(_comp), onMove(_onMove) { push_range(_first, _last); }
+
+        // element access
+        const T &top() const { return heap.front(); }
+
+        // the heap array; position 0 is the top
+        const T &operator[](size_type _position) const { return heap[_position]; }
+        const T *data() const { return heap.data(); }
+
+        // capacity
+        size_type size() const { return heap.size(); }
+        bool empty() const { return heap.empty(); }
+        size_type capacity() const { return heap.capacity(); }
+        void reserve(size_type _count) { heap.reserve(_count); }
+
+        // modifiers
+        void push(const T &_value) { emplace(_value); }
+        void push(T &&_value) { emplace(std::move(_value)); }
+
+        template <typename... Args>
+        void emplace(Args &&...args);
+
+        template <typename InputIt>
+        void push_range(InputIt _first, InputIt _last);
+
+        void pop();
+
+        // removes the top and returns it
+        T take();
+
+        // _value must not order below the element at _position, which
+        // therefore only moves towards the top
+        void decrease_key(size_type _position, T _value);
+
+        // replaces the element at _position and restores the heap either way
+        void update(size_type _position, T _value);
+
+        void erase(size_type _position);
+        void clear() { heap.clear(); }
+
+    private:
+        ds::vector<T> heap;
+        Compare comp;
+        OnMove onMove;
+
+        static size_type parent(size_type _position) { return (_position - 1) / Arity; }
+
+        void place(size_type _position, T &&_value);
+        void siftUp(size_type _position, T &&_value);
+        void siftDown(size_type _position, T &&_value);
+        void heapify();
+        void checkPosition(size_type _position) const;
+    };
+
+    template <typename T, typename Compare, std::size_t Arity, typename OnMove>
+    void priority_queue<T, Compare, Arity, OnMove>::place(size_type _position, T &&_value)
+    {
+        heap[_position] = std::move(_value);
+        onMove(heap[_position], _position);
+    }
+
+    // moves parents down into the hole at _position until _value fits
+    template <typename T, typename Compare, std::size_t Arity, typename OnMove>
+    void priority_queue<T, Compare, Arity, OnMove>::siftUp(size_type _position, T &&_value)
+    {
+        while (_position > 0)
+        {
+            const size_type up = parent(_position);
+            if (!comp(heap[up], _value))
+            {
+                break;
+            }
+            place(_position, std::move(heap[up]));
+            _position = up;
+        }
+        place(_position, std::move(_value));
+    }
+
+    // moves the greatest child up into the hole at _position until _value fits
+    template <typename T, typename Compare, std::size_t Arity, typename OnMove>
+    void priority_queue<T, Compare, Arity, OnMove>::siftDown(size_type _position, T &&_value)
+    {
+        const size_type count = heap.size();
+        for (;;)
+        {
+            const size_type first = _position * Arity + 1;
+            if (first >= count)
+            {
+                break;
+            }
+
+            size_type best = first;
+            const size_type last = first + Arity < count ? first + Arity : count;
+            for (size_type child = first + 1; child < last; child++)
+            {
+                if (comp(heap[best], heap[child]))
+                {
+                    best = child;
+                }
+            }
+
+            if (!comp(_value, heap[best]))
+            {
+                break;
+            }
+            place(_position, std::move(heap[best]));
+            _position = best;
+        }
+        place(_position, std::move(_value));
+    }
+
+    template <typename T, typename Compare, std::size_t Arity, typename OnMove>
+    void priority_queue<T, Compare, Arity, OnMove>::heapify()
+    {
+        const size_type count = heap.size();
+        if (count < 2)
+        {
+            if (count == 1)
+            {
+                onMove(heap[0], 0);
+            }
+            return;
+        }
+
+        // leaves are heaps already; they only need their positions reported
+        for (size_type i = parent(count - 1) + 1; i < count; i++)
+        {
+            onMove(heap[i], i);
+        }
+        for (size_type i = parent(count - 1) + 1; i-- > 0;)
+        {
+            siftDown(i, T(std::move(heap[i])));
+        }
+    }
+
+    template <typename T, typename Compare, std::size_t Arity, typename OnMove>
+    void priority_queue<T, Compare, Arity, OnMove>::checkPosition(size_type _position) const
+    {
+        if (_position >= heap.size())
+        {
+            throw std::out_of_range("ds::priority_queue - position out of range");
+        }
+    }
+
+    template <typename T, typename Compare, std::size_t Arity, typename OnMove>
+    template <typename... Args>
+    void priority_queue<T, Compare, Arity, OnMove>::emplace(Args &&...args)
+    {
+        heap.emplace(heap.end(), std::forward<Args>(args)...);
+        siftUp(heap.size() - 1, T(std::move(heap.back())));
+    }
+
+    template <typename T, typename Compare, std::size_t Arity, typename OnMove>
+    template <typename InputIt>
+    void priority_queue<T, Compare, Arity, OnMove>::push_range(InputIt _first, InputIt _last)
+    {
+        const size_type before = heap.size();
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>)
+        {
+            heap.reserve(before + size_type(std::distance(_first, _last)));
+        }
+        for (; _first != _last; ++_first)
+        {
+            heap.push_back(*_first);
+        }
+
+        // sifting k new elements up costs about k log n, a rebuild n; the
+        // rebuild wins once the batch is a fair share of the heap
+        const size_type added = heap.size() - before;
+        if (added > before / 8)
+        {
+            heapify();
+            return;
+        }
+        for (size_type i = before; i < heap.size(); i++)
+        {
+            siftUp(i, T(std::move(heap[i])));
+        }
+    }
+
+    template <typename T, typename Compare, std::size_t Arity, typename OnMove>
+    void priority_queue<T, Compare, Arity, OnMove>::pop()
+    {
+        T last(std::move(heap.back()));
+        heap.pop_back();
+        if (!heap.empty())
+        {
+            siftDown(0, std::move(last));
+        }
+    }
+
+    template <typename T, typename Compare, std::size_t Arity, typename OnMove>
+    T priority_queue<T, Compare, Arity, OnMove>::take()
+    {
+        T result(std::move(heap.front()));
+        pop();
+        return result;
+    }
+
+    template <typename T, typename Compare, std::size_t Arity, typename OnMove>
+    void priority_queue<T, Compare, Arity, OnMove>::decrease_key(size_type _position, T _value)
+    {
+        checkPosition(_position);
+        if (comp(_value, heap[_position]))
+        {
+            throw std::invalid_argument("ds::priority_queue - decrease_key would move the element down");
+        }
+        siftUp(_position, std::move(_value));
+    }
+
+    template <typename T, typename Compare, std::size_t Arity, typename OnMove>
+    void priority_queue<T, Compare, Arity, OnMove>::update(size_type _position, T _value)
+    {
+        checkPosition(_position);
+        if (_position > 0 && comp(heap[parent(_position)], _value))
+        {
+            siftUp(_position, std::move(_value));
+        }
+        else
+        {
+            siftDown(_position, std::move(_value));
+        }
+    }
+
+    template <typename T, typename Compare, std::size_t Arity, typename OnMove>
+    void priority_queue<T, Compare, Arity, OnMove>::erase(size_type _position)
+    {
+        checkPosition(_position);
+        T last(std::move(heap.back()));
+        heap.pop_back();
+        if (_position < heap.size())
+        {
+            update(_position, std::move(last));
+        }
+    }
+}
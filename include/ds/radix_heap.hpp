@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+
+namespace ds
+{
+    // Min-heap for unsigned integer keys that never go below the last
+    // minimum taken, as in Dijkstra's algorithm or a timer queue. Elements
+    // sit in one bucket per bit of the key: bucket b holds the keys whose
+    // highest bit differing from that last minimum is bit b - 1, and bucket
+    // 0 holds keys equal to it. push is an append. When bucket 0 runs dry,
+    // the lowest non-empty bucket is scanned for its minimum, which becomes
+    // the new last key, and its elements are spread over lower buckets.
+    // An element moves at most once per bit, so pops are O(bits) amortized
+    // with no comparisons between elements, and all access is sequential.
+    //
+    // top() may do that refill, so const access from several threads at
+    // once needs outside locking.
+    template <typename Key, typename Value>
+    class radix_heap
+    {
+        static_assert(std::is_unsigned_v<Key>, "ds::radix_heap needs an unsigned integer key");
+
+    public:
+        using key_type = Key;
+        using mapped_type = Value;
+        using value_type = std::pair<Key, Value>;
+        using size_type = std::size_t;
+
+        // constructors
+        radix_heap() = default;
+
+        // element access; the pair with the smallest key, out_of_range if
+        // the heap is empty
+        const value_type &top() const;
+
+        // the key of the element top() or pop() last reached; no key below
+        // it may be pushed
+        Key last_key() const { return last; }
+
+        // capacity
+        size_type size() const { return count; }
+        bool empty() const { return count == 0; }
+
+        // modifiers
+        void push(Key _key, const Value &_value) { emplace(_key, _value); }
+        void push(Key _key, Value &&_value) { emplace(_key, std::move(_value)); }
+
+        template <typename... Args>
+        void emplace(Key _key, Args &&...args);
+
+        void pop();
+        void clear();
+
+    private:
+        static constexpr std::size_t bucketCount = std::numeric_limits<Key>::digits + 1;
+
+        mutable ds::vector<value_type> buckets[bucketCount];
+        mutable Key last = 0;
+        size_type count = 0;
+
+        std::size_t bucketOf(Key _key) const;
+        void refill() const;
+    };
+
+    // number of significant bits in _key ^ last
+    template <typename Key, typename Value>
+    std::size_t radix_heap<Key, Value>::bucketOf(Key _key) const
+    {
+        unsigned long long diff = static_cast<unsigned long long>(_key ^ last);
+#if defined(__GNUC__) || defined(__clang__)
+        return diff == 0 ? 0 : std::size_t(std::numeric_limits<unsigned long long>::digits - __builtin_clzll(diff));
+#else
+        std::size_t bits = 0;
+        while (diff != 0)
+        {
+            diff >>= 1;
+            bits++;
+        }
+        return bits;
+#endif
+    }
+
+    template <typename Key, typename Value>
+    void radix_heap<Key, Value>::refill() const
+    {
+        if (count == 0 || !buckets[0].empty())
+        {
+            return;
+        }
+
+        std::size_t b = 1;
+        while (buckets[b].empty())
+        {
+            b++;
+        }
+
+        ds::vector<value_type> &from = buckets[b];
+        Key low = from[0].first;
+        for (const value_type &x : from)
+        {
+            low = x.first < low ? x.first : low;
+        }
+
+        // every key here now differs from the new last below bit b - 1
+        last = low;
+        for (value_type &x : from)
+        {
+            buckets[bucketOf(x.first)].push_back(std::move(x));
+        }
+        from.clear();
+    }
+
+    template <typename Key, typename Value>
+    const typename radix_heap<Key, Value>::value_type &radix_heap<Key, Value>::top() const
+    {
+        if (count == 0)
+        {
+            throw std::out_of_range("ds::radix_heap - heap is empty");
+        }
+
+        refill();
+        return buckets[0].back();
+    }
+
+    template <typename Key, typename Value>
+    template <typename... Args>
+    void radix_heap<Key, Value>::emplace(Key _key, Args &&...args)
+    {
+        if (_key < last)
+        {
+            throw std::invalid_argument("ds::radix_heap - key below the last minimum");
+        }
+
+        ds::vector<value_type> &to = buckets[bucketOf(_key)];
+        to.emplace(to.end(), std::piecewise_construct, std::forward_as_tuple(_key), std::forward_as_tuple(std::forward<Args>(args)...));
+        count++;
+    }
+
+    // like circular_buffer::pop_front, popping an empty heap does nothing
+    template <typename Key, typename Value>
+    void radix_heap<Key, Value>::pop()
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        refill();
+        buckets[0].pop_back();
+        count--;
+    }
+
+    // last is kept, so keys pushed afterwards still may not go below it
+    template <typename Key, typename Value>
+    void radix_heap<Key, Value>::clear()
+    {
+        for (ds::vector<value_type> &b : buckets)
+        {
+            b.clear();
+        }
+        count = 0;
+    }
+}
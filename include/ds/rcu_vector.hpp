@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "epoch.hpp"
+#include "vector.hpp"
+
+namespace ds
+{
+    // Read-copy-update vector for data that is read all the time and
+    // changed rarely. The current version is an immutable ds::vector behind
+    // an atomic pointer. Readers take a snapshot, which is an epoch::guard and
+    // one pointer load, so readers never wait and write nothing shared
+    // besides their own epoch record. Writers copy the current version,
+    // change the copy, publish it with one pointer store and retire the old
+    // version to ds::epoch, which frees it once no snapshot can still see
+    // it. Writers take a mutex among themselves and each update copies the
+    // whole vector, so this suits tables of modest size with few updates.
+    template <typename T>
+    class rcu_vector
+    {
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+
+        // A consistent view of one version. It pins the calling thread's
+        // epoch, so it must stay on that thread and should be dropped
+        // soon, since a held snapshot holds back reclamation.
+        class snapshot
+        {
+        public:
+            snapshot(const snapshot &) = delete;
+            snapshot &operator=(const snapshot &) = delete;
+
+            const ds::vector<T> &operator*() const { return *data; }
+            const ds::vector<T> *operator->() const { return data; }
+
+            size_type size() const { return data->size(); }
+            bool empty() const { return data->empty(); }
+            const T &operator[](size_type _index) const { return (*data)[_index]; }
+
+            typename ds::vector<T>::const_iterator begin() const { return data->begin(); }
+            typename ds::vector<T>::const_iterator end() const { return data->end(); }
+
+        private:
+            friend class rcu_vector;
+
+            explicit snapshot(const std::atomic<ds::vector<T> *> &_current) : data(_current.load(std::memory_order_acquire)) {}
+
+            epoch::guard pin; // before data, so the load happens inside the critical section
+            const ds::vector<T> *data;
+        };
+
+        // constructors
+        rcu_vector() : current(new ds::vector<T>()) {}
+        explicit rcu_vector(ds::vector<T> _initial) : current(new ds::vector<T>(std::move(_initial))) {}
+        rcu_vector(const rcu_vector &) = delete;
+
+        // destructors
+        ~rcu_vector();
+
+        // operator=
+        rcu_vector &operator=(const rcu_vector &) = delete;
+
+        // readers
+        snapshot read() const { return snapshot(current); }
+
+        // runs _f(const ds::vector<T> &) on the current version
+        template <typename F>
+        decltype(auto) read(F &&_f) const
+        {
+            const snapshot view(current);
+            return std::forward<F>(_f)(*view);
+        }
+
+        size_type size() const { return read().size(); }
+
+        // writers: _f changes a private copy of the current version, which
+        // then replaces it; if _f throws nothing is published
+        template <typename F>
+        void update(F &&_f);
+
+        void store(ds::vector<T> _next);
+        void push_back(const T &_value)
+        {
+            update([&](ds::vector<T> &_v)
+                   { _v.push_back(_value); });
+        }
+
+    private:
+        std::atomic<ds::vector<T> *> current;
+        std::mutex writeLock;
+
+        void publish(ds::vector<T> *_next);
+    };
+
+    // a late snapshot elsewhere would be a bug, but retiring costs nothing
+    template <typename T>
+    rcu_vector<T>::~rcu_vector()
+    {
+        epoch::retire(current.load(std::memory_order_relaxed));
+    }
+
+    template <typename T>
+    template <typename F>
+    void rcu_vector<T>::update(F &&_f)
+    {
+        std::lock_guard<std::mutex> lock(writeLock);
+
+        auto next = std::make_unique<ds::vector<T>>(*current.load(std::memory_order_relaxed));
+        std::forward<F>(_f)(*next);
+        publish(next.release());
+    }
+
+    template <typename T>
+    void rcu_vector<T>::store(ds::vector<T> _next)
+    {
+        auto next = std::make_unique<ds::vector<T>>(std::move(_next));
+
+        std::lock_guard<std::mutex> lock(writeLock);
+        publish(next.release());
+    }
+
+    // callers hold writeLock
+    template <typename T>
+    void rcu_vector<T>::publish(ds::vector<T> *_next)
+    {
+        ds::vector<T> *old = current.exchange(_next, std::memory_order_acq_rel);
+        epoch::retire(old);
+
+        // updates are rare, so free what is ready now rather than waiting
+        // for a batch
+        epoch::reclaim();
+    }
+}
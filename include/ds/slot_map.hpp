@@ -0,0 +1,256 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#include "vector.hpp"
+
+namespace ds
+{
+    // Handle to a slot_map element: the slot it was given and that slot's
+    // generation at the time. A plain value, so it can be stored, copied
+    // and handed to other threads; it goes stale, rather than dangling,
+    // once the element is erased.
+    struct slot_key
+    {
+        std::uint32_t index = 0;
+        std::uint32_t generation = 0; // odd while the slot is in use
+
+        bool operator==(const slot_key &_other) const { return index == _other.index && generation == _other.generation; }
+        bool operator!=(const slot_key &_other) const { return !(*this == _other); }
+    };
+
+    // Container addressed by generational handles. The values sit densely
+    // in one ds::vector, so iterating is a plain array walk; erase moves the
+    // last value into the hole. A separate slot array maps handle indices
+    // to dense positions and keeps a generation counter per slot, bumped on
+    // every insert and erase, so a lookup is two array reads and a stale
+    // handle is caught by a generation mismatch. Erased slots are reused
+    // through a free list, which keeps insert and erase O(1). A slot whose
+    // generation would wrap is retired for good instead, so a key can never
+    // come back to life after 2^31 reuses of its slot. The container itself
+    // is not synchronised.
+    template <typename T>
+    class slot_map
+    {
+    public:
+        using value_type = T;
+        using key_type = slot_key;
+        using reference = T &;
+        using const_reference = const T &;
+        using size_type = std::size_t;
+
+        using iterator = typename ds::vector<T>::iterator;
+        using const_iterator = typename ds::vector<T>::const_iterator;
+
+        // constructors
+        slot_map() = default;
+
+        // element access; get returns nullptr for a stale or foreign key
+        T *get(slot_key _key);
+        const T *get(slot_key _key) const { return const_cast<slot_map *>(this)->get(_key); }
+
+        T &at(slot_key _key);
+        const T &at(slot_key _key) const { return const_cast<slot_map *>(this)->at(_key); }
+
+        // unchecked; _key must be live
+        T &operator[](slot_key _key) { return values[slots[_key.index].position]; }
+        const T &operator[](slot_key _key) const { return values[slots[_key.index].position]; }
+
+        bool contains(slot_key _key) const { return const_cast<slot_map *>(this)->get(_key) != nullptr; }
+
+        // the dense value array, in no particular order
+        T *data() { return values.data(); }
+        const T *data() const { return values.data(); }
+
+        // the key of the value at an iterator
+        slot_key key_of(const_iterator _position) const;
+
+        // iterators
+        iterator begin() { return values.begin(); }
+        const_iterator begin() const { return values.begin(); }
+
+        iterator end() { return values.end(); }
+        const_iterator end() const { return values.end(); }
+
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+
+        // capacity
+        size_type size() const { return values.size(); }
+        bool empty() const { return values.empty(); }
+        size_type capacity() const { return values.capacity(); }
+        void reserve(size_type _count);
+
+        // modifiers
+        slot_key insert(const T &_value) { return emplace(_value); }
+        slot_key insert(T &&_value) { return emplace(std::move(_value)); }
+
+        template <typename... Args>
+        slot_key emplace(Args &&...args);
+
+        // false if _key was already stale
+        bool erase(slot_key _key);
+
+        // returns the iterator to the value moved into the hole
+        iterator erase(const_iterator _position);
+
+        // every key goes stale; the slots are kept for reuse
+        void clear();
+
+    private:
+        static constexpr std::uint32_t noSlot = std::uint32_t(-1);
+
+        struct slot
+        {
+            std::uint32_t position;   // dense index while in use, else the next free slot
+            std::uint32_t generation; // odd while in use
+        };
+
+        ds::vector<T> values;
+        ds::vector<std::uint32_t> owners; // slot of each dense value
+        ds::vector<slot> slots;
+        std::uint32_t freeHead = noSlot;
+
+        void eraseAt(size_type _position);
+        void releaseSlot(std::uint32_t _index);
+    };
+
+    template <typename T>
+    T *slot_map<T>::get(slot_key _key)
+    {
+        if (_key.index >= slots.size() || slots[_key.index].generation != _key.generation || (_key.generation & 1) == 0)
+        {
+            return nullptr;
+        }
+        return values.data() + slots[_key.index].position;
+    }
+
+    template <typename T>
+    T &slot_map<T>::at(slot_key _key)
+    {
+        T *value = get(_key);
+        if (value == nullptr)
+        {
+            throw std::out_of_range("ds::slot_map - stale or invalid key");
+        }
+        return *value;
+    }
+
+    template <typename T>
+    slot_key slot_map<T>::key_of(const_iterator _position) const
+    {
+        const std::uint32_t index = owners[size_type(_position - begin())];
+        return slot_key{index, slots[index].generation};
+    }
+
+    template <typename T>
+    void slot_map<T>::reserve(size_type _count)
+    {
+        values.reserve(_count);
+        owners.reserve(_count);
+        slots.reserve(_count);
+    }
+
+    template <typename T>
+    template <typename... Args>
+    slot_key slot_map<T>::emplace(Args &&...args)
+    {
+        if (freeHead == noSlot)
+        {
+            if (slots.size() == noSlot)
+            {
+                throw std::length_error("ds::slot_map - too many slots");
+            }
+
+            // a new free slot; it stays on the free list if the value throws
+            slots.push_back(slot{noSlot, 0});
+            freeHead = std::uint32_t(slots.size() - 1);
+        }
+
+        values.emplace(values.end(), std::forward<Args>(args)...);
+        try
+        {
+            owners.push_back(freeHead);
+        }
+        catch (...)
+        {
+            values.pop_back();
+            throw;
+        }
+
+        const std::uint32_t index = freeHead;
+        slot &s = slots[index];
+        freeHead = s.position;
+        s.position = std::uint32_t(values.size() - 1);
+        s.generation++;
+
+        return slot_key{index, s.generation};
+    }
+
+    template <typename T>
+    bool slot_map<T>::erase(slot_key _key)
+    {
+        if (get(_key) == nullptr)
+        {
+            return false;
+        }
+
+        eraseAt(slots[_key.index].position);
+        return true;
+    }
+
+    template <typename T>
+    typename slot_map<T>::iterator slot_map<T>::erase(const_iterator _position)
+    {
+        const size_type position = size_type(_position - begin());
+        eraseAt(position);
+        return begin() + std::ptrdiff_t(position);
+    }
+
+    // moves the last value into _position and retires the erased slot
+    template <typename T>
+    void slot_map<T>::eraseAt(size_type _position)
+    {
+        const std::uint32_t index = owners[_position];
+        const std::uint32_t moved = owners.back();
+
+        values.unordered_erase(values.begin() + std::ptrdiff_t(_position));
+        owners.unordered_erase(owners.begin() + std::ptrdiff_t(_position));
+        slots[moved].position = std::uint32_t(_position);
+
+        releaseSlot(index);
+    }
+
+    // marks a slot free and puts it on the free list, unless its generation
+    // just wrapped to 0: reusing it would hand out generation 1 again
+    template <typename T>
+    void slot_map<T>::releaseSlot(std::uint32_t _index)
+    {
+        slot &s = slots[_index];
+        s.generation++;
+
+        if (s.generation == 0)
+        {
+            s.position = noSlot;
+            return;
+        }
+
+        s.position = freeHead;
+        freeHead = _index;
+    }
+
+    template <typename T>
+    void slot_map<T>::clear()
+    {
+        for (std::uint32_t index : owners)
+        {
+            releaseSlot(index);
+        }
+
+        values.clear();
+        owners.clear();
+    }
+}
@@ -0,0 +1,709 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "vector.hpp"
+#include "deque.hpp"
+
+// Binary snapshots of ds::vector and ds::deque holding trivially copyable
+// elements. File layout (native byte order):
+//
+//   snapshot_header
+//   uint64_t chunkChecksums[ceil(payload bytes / chunkSize)]
+//   payload: count * elementSize bytes, front to back
+//
+// Every chunkSize bytes of payload carry their own checksum so large files
+// can be read and verified by several threads at once.
+
+namespace ds
+{
+    namespace detail
+    {
+        constexpr char SNAPSHOT_MAGIC[8] = {'D', 'S', 'S', 'N', 'A', 'P', '\0', '\0'};
+        constexpr std::uint32_t SNAPSHOT_VERSION = 1;
+        constexpr std::uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+        constexpr std::uint64_t SNAPSHOT_CHUNK_SIZE = std::uint64_t(4) << 20;
+        constexpr std::uint64_t SNAPSHOT_PARALLEL_THRESHOLD = std::uint64_t(64) << 20;
+        constexpr std::uint64_t SNAPSHOT_BYTES_PER_THREAD = std::uint64_t(16) << 20;
+
+        struct snapshot_header
+        {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t byteOrder;
+            std::uint64_t elementSize;
+            std::uint64_t count;
+            std::uint64_t chunkSize;
+            std::uint64_t headerChecksum; // covers this header (with this field zeroed) and the chunk table
+        };
+
+        // 64-bit streaming checksum, four independent lanes of 8-byte words
+        class checksum64
+        {
+        public:
+            void update(const void *_data, std::size_t _bytes)
+            {
+                // an empty container may hand over a null pointer
+                if (_bytes == 0)
+                {
+                    return;
+                }
+
+                const unsigned char *p = static_cast<const unsigned char *>(_data);
+                length += _bytes;
+
+                if (bufferSize != 0)
+                {
+                    std::size_t take = std::min(_bytes, sizeof(buffer) - bufferSize);
+                    std::memcpy(buffer + bufferSize, p, take);
+                    bufferSize += take;
+                    p += take;
+                    _bytes -= take;
+
+                    if (bufferSize < sizeof(buffer))
+                    {
+                        return;
+                    }
+
+                    block(buffer);
+                    bufferSize = 0;
+                }
+
+                for (; _bytes >= sizeof(buffer); p += sizeof(buffer), _bytes -= sizeof(buffer))
+                {
+                    block(p);
+                }
+
+                std::memcpy(buffer, p, _bytes);
+                bufferSize = _bytes;
+            }
+
+            std::uint64_t digest() const
+            {
+                std::uint64_t l[4] = {lane[0], lane[1], lane[2], lane[3]};
+
+                for (std::size_t i = 0; i < bufferSize; i += 8)
+                {
+                    std::uint64_t w = 0;
+                    std::memcpy(&w, buffer + i, std::min<std::size_t>(8, bufferSize - i));
+                    l[0] = mix(l[0], w);
+                }
+
+                std::uint64_t h = length;
+
+                for (std::uint64_t x : l)
+                {
+                    h = mix(h, x);
+                }
+
+                return h;
+            }
+
+        private:
+            std::uint64_t lane[4] = {0x243f6a8885a308d3ull, 0x13198a2e03707344ull,
+                                     0xa4093822299f31d0ull, 0x082efa98ec4e6c89ull};
+            unsigned char buffer[32];
+            std::size_t bufferSize = 0;
+            std::uint64_t length = 0;
+
+            static std::uint64_t mix(std::uint64_t _h, std::uint64_t _w)
+            {
+                _h = (_h ^ _w) * 0x9e3779b97f4a7c15ull;
+                return _h ^ (_h >> 29);
+            }
+
+            void block(const unsigned char *_p)
+            {
+                for (int i = 0; i < 4; i++)
+                {
+                    std::uint64_t w;
+                    std::memcpy(&w, _p + 8 * i, 8);
+                    lane[i] = mix(lane[i], w);
+                }
+            }
+        };
+
+        // splits a byte stream into chunkSize pieces and checksums each one
+        class chunked_checksum
+        {
+        public:
+            explicit chunked_checksum(std::uint64_t _chunkSize) : chunkSize(_chunkSize) {}
+
+            void update(const void *_data, std::size_t _bytes)
+            {
+                const unsigned char *p = static_cast<const unsigned char *>(_data);
+
+                while (_bytes != 0)
+                {
+                    std::size_t take = std::size_t(std::min<std::uint64_t>(_bytes, chunkSize - filled));
+                    current.update(p, take);
+                    filled += take;
+                    p += take;
+                    _bytes -= take;
+
+                    if (filled == chunkSize)
+                    {
+                        finish();
+                    }
+                }
+            }
+
+            void finish()
+            {
+                if (filled != 0)
+                {
+                    digests.push_back(current.digest());
+                    current = checksum64();
+                    filled = 0;
+                }
+            }
+
+            std::vector<std::uint64_t> digests;
+
+        private:
+            std::uint64_t chunkSize;
+            std::uint64_t filled = 0;
+            checksum64 current;
+        };
+
+        [[noreturn]] inline void throw_errno(const char *_what)
+        {
+            throw std::system_error(errno, std::generic_category(), _what);
+        }
+
+        // writev until every iovec is consumed; _iov is advanced in place
+        inline void writev_all(int _fd, iovec *_iov, int _count)
+        {
+            while (_count > 0)
+            {
+                ssize_t n = ::writev(_fd, _iov, _count);
+
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    throw_errno("ds::save - write failed");
+                }
+
+                std::size_t done = std::size_t(n);
+
+                while (_count > 0 && done >= _iov->iov_len)
+                {
+                    done -= _iov->iov_len;
+                    ++_iov;
+                    --_count;
+                }
+
+                if (_count > 0)
+                {
+                    _iov->iov_base = static_cast<char *>(_iov->iov_base) + done;
+                    _iov->iov_len -= done;
+                }
+            }
+        }
+
+        // preadv until every iovec is filled; _iov is advanced in place
+        inline void preadv_all(int _fd, iovec *_iov, int _count, off_t _offset)
+        {
+            while (_count > 0)
+            {
+                ssize_t n = ::preadv(_fd, _iov, _count, _offset);
+
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    throw_errno("ds::load - read failed");
+                }
+
+                if (n == 0)
+                {
+                    throw std::runtime_error("ds::load - unexpected end of file");
+                }
+
+                _offset += n;
+                std::size_t done = std::size_t(n);
+
+                while (_count > 0 && done >= _iov->iov_len)
+                {
+                    done -= _iov->iov_len;
+                    ++_iov;
+                    --_count;
+                }
+
+                if (_count > 0)
+                {
+                    _iov->iov_base = static_cast<char *>(_iov->iov_base) + done;
+                    _iov->iov_len -= done;
+                }
+            }
+        }
+
+        class file_descriptor
+        {
+        public:
+            explicit file_descriptor(int _fd) : fd(_fd) {}
+            ~file_descriptor() { if (fd != -1) ::close(fd); }
+            file_descriptor(const file_descriptor &) = delete;
+            file_descriptor &operator=(const file_descriptor &) = delete;
+
+            int get() const { return fd; }
+            int release() { int f = fd; fd = -1; return f; }
+
+        private:
+            int fd;
+        };
+
+        // unlinks a half-written file unless released once it has been renamed
+        class temp_file
+        {
+        public:
+            explicit temp_file(std::string _path) : path(std::move(_path)) {}
+            ~temp_file() { if (!released) ::unlink(path.c_str()); }
+            temp_file(const temp_file &) = delete;
+            temp_file &operator=(const temp_file &) = delete;
+
+            const char *get() const { return path.c_str(); }
+            void release() { released = true; }
+
+        private:
+            std::string path;
+            bool released = false;
+        };
+
+        // the directory holding _path, whose entry a rename changes
+        inline std::string parent_directory(const char *_path)
+        {
+            const char *slash = std::strrchr(_path, '/');
+
+            if (slash == nullptr)
+            {
+                return ".";
+            }
+
+            return slash == _path ? std::string("/") : std::string(_path, slash);
+        }
+
+        // Writes a snapshot whose payload is produced by _segments(f), which
+        // must call f(const void*, bytes) for each contiguous run in order.
+        // The file is written next to _path and renamed over it once synced,
+        // then the directory is synced; on failure the temporary is removed.
+        template <typename Segments>
+        void save_segments(const char *_path, std::uint64_t _elementSize, std::uint64_t _count, Segments &&_segments)
+        {
+            chunked_checksum chunks(SNAPSHOT_CHUNK_SIZE);
+            _segments([&](const void *p, std::size_t bytes) { chunks.update(p, bytes); });
+            chunks.finish();
+
+            snapshot_header header{};
+            std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+            header.version = SNAPSHOT_VERSION;
+            header.byteOrder = SNAPSHOT_BYTE_ORDER;
+            header.elementSize = _elementSize;
+            header.count = _count;
+            header.chunkSize = SNAPSHOT_CHUNK_SIZE;
+
+            checksum64 headerSum;
+            headerSum.update(&header, sizeof(header));
+            headerSum.update(chunks.digests.data(), chunks.digests.size() * sizeof(std::uint64_t));
+            header.headerChecksum = headerSum.digest();
+
+            temp_file temp(std::string(_path) + ".tmp");
+
+            file_descriptor fd(::open(temp.get(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+
+            if (fd.get() == -1)
+            {
+                throw_errno("ds::save - open failed");
+            }
+
+            // header, checksum table and payload go out in as few writev calls
+            // as IOV_MAX allows, straight from the container's storage
+            iovec batch[IOV_MAX];
+            int used = 0;
+
+            batch[used++] = iovec{&header, sizeof(header)};
+
+            if (!chunks.digests.empty())
+            {
+                batch[used++] = iovec{chunks.digests.data(), chunks.digests.size() * sizeof(std::uint64_t)};
+            }
+
+            _segments([&](const void *p, std::size_t bytes)
+                      {
+                          if (used == IOV_MAX)
+                          {
+                              writev_all(fd.get(), batch, used);
+                              used = 0;
+                          }
+                          batch[used++] = iovec{const_cast<void *>(p), bytes}; });
+
+            writev_all(fd.get(), batch, used);
+
+            if (::fsync(fd.get()) != 0)
+            {
+                throw_errno("ds::save - fsync failed");
+            }
+
+            if (::close(fd.release()) != 0)
+            {
+                throw_errno("ds::save - close failed");
+            }
+
+            if (::rename(temp.get(), _path) != 0)
+            {
+                throw_errno("ds::save - rename failed");
+            }
+
+            temp.release();
+
+            // the rename itself is only durable once the directory is synced
+            file_descriptor dir(::open(parent_directory(_path).c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+
+            if (dir.get() == -1)
+            {
+                throw_errno("ds::save - open directory failed");
+            }
+
+            if (::fsync(dir.get()) != 0)
+            {
+                throw_errno("ds::save - directory fsync failed");
+            }
+        }
+
+        // opens a snapshot and validates its header and checksum table
+        class snapshot_reader
+        {
+        public:
+            snapshot_reader(const char *_path, std::uint64_t _elementSize) : fd(::open(_path, O_RDONLY | O_CLOEXEC))
+            {
+                if (fd.get() == -1)
+                {
+                    throw_errno("ds::load - open failed");
+                }
+
+                iovec iov{&header, sizeof(header)};
+                preadv_all(fd.get(), &iov, 1, 0);
+
+                if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0)
+                {
+                    throw std::runtime_error("ds::load - not a ds snapshot");
+                }
+
+                if (header.version != SNAPSHOT_VERSION || header.byteOrder != SNAPSHOT_BYTE_ORDER)
+                {
+                    throw std::runtime_error("ds::load - unsupported snapshot version or byte order");
+                }
+
+                if (header.elementSize != _elementSize)
+                {
+                    throw std::runtime_error("ds::load - element size does not match");
+                }
+
+                if (header.chunkSize == 0)
+                {
+                    throw std::runtime_error("ds::load - corrupt snapshot header");
+                }
+
+                payloadBytes = header.count * header.elementSize;
+
+                struct stat st;
+
+                if (::fstat(fd.get(), &st) != 0)
+                {
+                    throw_errno("ds::load - fstat failed");
+                }
+
+                const std::uint64_t chunkCount = (payloadBytes + header.chunkSize - 1) / header.chunkSize;
+                payloadOffset = sizeof(header) + chunkCount * sizeof(std::uint64_t);
+
+                if (header.count != 0 && payloadBytes / header.count != header.elementSize)
+                {
+                    throw std::runtime_error("ds::load - corrupt snapshot header");
+                }
+
+                if (std::uint64_t(st.st_size) != payloadOffset + payloadBytes)
+                {
+                    throw std::runtime_error("ds::load - snapshot is truncated or has trailing data");
+                }
+
+                checksums.resize(chunkCount);
+
+                if (chunkCount != 0)
+                {
+                    iovec table{checksums.data(), chunkCount * sizeof(std::uint64_t)};
+                    preadv_all(fd.get(), &table, 1, sizeof(header));
+                }
+
+                snapshot_header zeroed = header;
+                zeroed.headerChecksum = 0;
+
+                checksum64 headerSum;
+                headerSum.update(&zeroed, sizeof(zeroed));
+                headerSum.update(checksums.data(), checksums.size() * sizeof(std::uint64_t));
+
+                if (headerSum.digest() != header.headerChecksum)
+                {
+                    throw std::runtime_error("ds::load - snapshot header checksum mismatch");
+                }
+            }
+
+            std::uint64_t count() const { return header.count; }
+
+            // Reads the payload into the given destination runs (total size
+            // must equal the payload) and verifies every chunk. Large files
+            // are split on chunk boundaries across threads.
+            void read_into(const std::vector<iovec> &_dest)
+            {
+                if (payloadBytes == 0)
+                {
+                    return;
+                }
+
+                std::vector<std::uint64_t> starts(_dest.size());
+                std::uint64_t offset = 0;
+
+                for (std::size_t i = 0; i < _dest.size(); i++)
+                {
+                    starts[i] = offset;
+                    offset += _dest[i].iov_len;
+                }
+
+                std::size_t threads = 1;
+
+                if (payloadBytes >= SNAPSHOT_PARALLEL_THRESHOLD)
+                {
+                    threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+                    threads = std::min<std::size_t>(threads, payloadBytes / SNAPSHOT_BYTES_PER_THREAD);
+                    threads = std::min<std::size_t>(threads, checksums.size());
+                }
+
+                const std::uint64_t chunksPerThread = (checksums.size() + threads - 1) / threads;
+
+                std::vector<std::thread> workers;
+                std::vector<std::exception_ptr> errors(threads);
+
+                for (std::size_t t = 0; t < threads; t++)
+                {
+                    const std::uint64_t firstChunk = t * chunksPerThread;
+                    const std::uint64_t lastChunk = std::min<std::uint64_t>(checksums.size(), firstChunk + chunksPerThread);
+
+                    if (firstChunk >= lastChunk)
+                    {
+                        break;
+                    }
+
+                    auto work = [&, t, firstChunk, lastChunk]
+                    {
+                        try
+                        {
+                            read_range(_dest, starts, firstChunk, lastChunk);
+                        }
+                        catch (...)
+                        {
+                            errors[t] = std::current_exception();
+                        }
+                    };
+
+                    if (t + 1 == threads)
+                    {
+                        work();
+                    }
+                    else
+                    {
+                        workers.emplace_back(work);
+                    }
+                }
+
+                for (std::thread &w : workers)
+                {
+                    w.join();
+                }
+
+                for (std::exception_ptr &e : errors)
+                {
+                    if (e)
+                    {
+                        std::rethrow_exception(e);
+                    }
+                }
+            }
+
+        private:
+            file_descriptor fd;
+            snapshot_header header;
+            std::uint64_t payloadBytes = 0;
+            std::uint64_t payloadOffset = 0;
+            std::vector<std::uint64_t> checksums;
+
+            // calls f(char*, bytes) for the parts of _dest covering payload [_from, _to)
+            template <typename F>
+            static void for_each_piece(const std::vector<iovec> &_dest, const std::vector<std::uint64_t> &_starts,
+                                       std::uint64_t _from, std::uint64_t _to, F &&f)
+            {
+                std::size_t i = std::upper_bound(_starts.begin(), _starts.end(), _from) - _starts.begin() - 1;
+
+                for (; i < _dest.size() && _starts[i] < _to; i++)
+                {
+                    const std::uint64_t lo = std::max(_from, _starts[i]);
+                    const std::uint64_t hi = std::min(_to, _starts[i] + _dest[i].iov_len);
+
+                    if (lo < hi)
+                    {
+                        f(static_cast<char *>(_dest[i].iov_base) + (lo - _starts[i]), std::size_t(hi - lo));
+                    }
+                }
+            }
+
+            void read_range(const std::vector<iovec> &_dest, const std::vector<std::uint64_t> &_starts,
+                            std::uint64_t _firstChunk, std::uint64_t _lastChunk)
+            {
+                const std::uint64_t from = _firstChunk * header.chunkSize;
+                const std::uint64_t to = std::min(payloadBytes, _lastChunk * header.chunkSize);
+
+                iovec batch[IOV_MAX];
+                int used = 0;
+                off_t fileOffset = off_t(payloadOffset + from);
+
+                for_each_piece(_dest, _starts, from, to, [&](char *p, std::size_t bytes)
+                               {
+                                   if (used == IOV_MAX)
+                                   {
+                                       std::size_t batchBytes = 0;
+                                       for (int i = 0; i < used; i++)
+                                       {
+                                           batchBytes += batch[i].iov_len;
+                                       }
+                                       preadv_all(fd.get(), batch, used, fileOffset);
+                                       fileOffset += off_t(batchBytes);
+                                       used = 0;
+                                   }
+                                   batch[used++] = iovec{p, bytes}; });
+
+                preadv_all(fd.get(), batch, used, fileOffset);
+
+                chunked_checksum chunks(header.chunkSize);
+                for_each_piece(_dest, _starts, from, to, [&](char *p, std::size_t bytes) { chunks.update(p, bytes); });
+                chunks.finish();
+
+                if (!std::equal(chunks.digests.begin(), chunks.digests.end(), checksums.begin() + _firstChunk))
+                {
+                    throw std::runtime_error("ds::load - snapshot payload checksum mismatch");
+                }
+            }
+        };
+    }
+
+    // gives the snapshot functions access to container storage
+    struct snapshot_access
+    {
+        template <typename T>
+        static void allocate(vector<T> &_v, std::size_t _count)
+        {
+            _v.reserve(_count);
+            _v.vectorSize = _count;
+            _v.statsSync();
+        }
+
+        template <typename T>
+        static void allocate(deque<T> &_d, std::size_t _count)
+        {
+            _d.createStorage(_count);
+        }
+
+        template <typename T, typename F>
+        static void for_each_segment(const deque<T> &_d, F &&f)
+        {
+            _d.forEachSegment(std::forward<F>(f));
+        }
+    };
+
+    // writes _v to _path as a snapshot, replacing any existing file
+    template <typename T>
+    void save(const vector<T> &_v, const char *_path)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "ds::save requires a trivially copyable type");
+
+        detail::save_segments(_path, sizeof(T), _v.size(), [&](auto &&f)
+                              {
+                                  if (!_v.empty())
+                                  {
+                                      f(_v.data(), _v.size() * sizeof(T));
+                                  } });
+    }
+
+    template <typename T>
+    void save(const deque<T> &_d, const char *_path)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "ds::save requires a trivially copyable type");
+
+        detail::save_segments(_path, sizeof(T), _d.size(), [&](auto &&f)
+                              { snapshot_access::for_each_segment(_d, [&](const T *p, std::size_t n)
+                                                                  { f(p, n * sizeof(T)); }); });
+    }
+
+    // replaces the contents of _v with the snapshot at _path; _v is left
+    // untouched if the file is missing, malformed or fails its checksum
+    template <typename T>
+    void load(vector<T> &_v, const char *_path)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "ds::load requires a trivially copyable type");
+
+        detail::snapshot_reader reader(_path, sizeof(T));
+
+        vector<T> fresh;
+        snapshot_access::allocate(fresh, reader.count());
+
+        std::vector<iovec> dest;
+
+        if (!fresh.empty())
+        {
+            dest.push_back(iovec{fresh.data(), fresh.size() * sizeof(T)});
+        }
+
+        reader.read_into(dest);
+
+        _v = std::move(fresh);
+    }
+
+    template <typename T>
+    void load(deque<T> &_d, const char *_path)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "ds::load requires a trivially copyable type");
+
+        detail::snapshot_reader reader(_path, sizeof(T));
+
+        deque<T> fresh;
+        snapshot_access::allocate(fresh, reader.count());
+
+        std::vector<iovec> dest;
+        snapshot_access::for_each_segment(fresh, [&](T *p, std::size_t n)
+                                          { dest.push_back(iovec{p, n * sizeof(T)}); });
+
+        reader.read_into(dest);
+
+        _d = std::move(fresh);
+    }
+}
@@ -0,0 +1,807 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "parallel.hpp"
+#include "vector.hpp"
+
+namespace ds
+{
+    namespace detail
+    {
+        // below this many elements a comparison sort beats the fixed cost of
+        // the radix histograms
+        inline constexpr std::size_t SORT_RADIX_MIN = 1024;
+
+        // pdqsort tuning, as in the reference implementation
+        inline constexpr std::ptrdiff_t SORT_INSERTION_THRESHOLD = 24;
+        inline constexpr std::ptrdiff_t SORT_NINTHER_THRESHOLD = 128;
+        inline constexpr std::ptrdiff_t SORT_PARTIAL_INSERTION_LIMIT = 8;
+
+        // small partitions of scalars go through a sorting network instead
+        inline constexpr std::ptrdiff_t SORT_NETWORK_THRESHOLD = 16;
+
+        // 1 for an ascending radix sort, -1 for descending, 0 if _comp is
+        // not a plain less or greater on an integer or float key
+        template <typename T, typename Compare>
+        constexpr int radix_direction()
+        {
+            constexpr bool key = (std::is_integral_v<T> && !std::is_same_v<T, bool> && sizeof(T) <= 8) ||
+                                 (std::is_floating_point_v<T> && std::numeric_limits<T>::is_iec559 && (sizeof(T) == 4 || sizeof(T) == 8));
+            if constexpr (!key)
+            {
+                return 0;
+            }
+            else if constexpr (std::is_same_v<Compare, std::less<T>> || std::is_same_v<Compare, std::less<>>)
+            {
+                return 1;
+            }
+            else if constexpr (std::is_same_v<Compare, std::greater<T>> || std::is_same_v<Compare, std::greater<>>)
+            {
+                return -1;
+            }
+            else
+            {
+                return 0;
+            }
+        }
+
+        // maps _x to an unsigned integer with the same order: the sign bit
+        // is flipped, and for negative floats every bit
+        template <typename T>
+        auto radix_bits(T _x)
+        {
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                using U = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+                constexpr U sign = U(1) << (sizeof(U) * 8 - 1);
+                U u;
+                std::memcpy(&u, &_x, sizeof(u));
+                return (u & sign) != 0 ? U(~u) : U(u | sign);
+            }
+            else
+            {
+                using U = std::make_unsigned_t<T>;
+                if constexpr (std::is_signed_v<T>)
+                {
+                    return U(U(_x) ^ (U(1) << (sizeof(U) * 8 - 1)));
+                }
+                else
+                {
+                    return U(_x);
+                }
+            }
+        }
+
+        template <typename T, int Direction>
+        struct radix_key
+        {
+            auto operator()(const T &_x) const
+            {
+                const auto bits = radix_bits(_x);
+                return Direction > 0 ? bits : decltype(bits)(~bits);
+            }
+        };
+
+        // Stable LSD radix sort, one byte per pass, of trivially copyable
+        // items by the unsigned key _key returns. The histograms of every
+        // pass come from one read of the data, and a pass in which all keys
+        // share the byte is skipped. _scratch holds _count items.
+        template <typename Item, typename Key>
+        void radix_sort(Item *_data, std::size_t _count, Item *_scratch, Key _key)
+        {
+            using U = decltype(_key(*_data));
+            constexpr std::size_t passes = sizeof(U);
+
+            std::size_t counts[passes][256] = {};
+            for (std::size_t i = 0; i < _count; i++)
+            {
+                const U k = _key(_data[i]);
+                for (std::size_t p = 0; p < passes; p++)
+                {
+                    counts[p][(k >> (8 * p)) & 0xff]++;
+                }
+            }
+
+            Item *from = _data;
+            Item *to = _scratch;
+            for (std::size_t p = 0; p < passes; p++)
+            {
+                std::size_t *c = counts[p];
+                if (c[(_key(from[0]) >> (8 * p)) & 0xff] == _count)
+                {
+                    continue;
+                }
+
+                std::size_t offset = 0;
+                for (std::size_t d = 0; d < 256; d++)
+                {
+                    const std::size_t n = c[d];
+                    c[d] = offset;
+                    offset += n;
+                }
+                for (std::size_t i = 0; i < _count; i++)
+                {
+                    to[c[(_key(from[i]) >> (8 * p)) & 0xff]++] = from[i];
+                }
+                std::swap(from, to);
+            }
+
+            if (from != _data)
+            {
+                std::memcpy(static_cast<void *>(_data), from, _count * sizeof(Item));
+            }
+        }
+
+        // The same with each pass split over the workers: every worker
+        // counts its part, the counts give each (byte, worker) pair its
+        // place, and every worker scatters its part, which keeps it stable.
+        template <typename Item, typename Key>
+        void radix_sort(Item *_data, std::size_t _count, Item *_scratch, Key _key, parallel_t _policy)
+        {
+            using U = decltype(_key(*_data));
+            constexpr std::size_t passes = sizeof(U);
+
+            const std::size_t workers = parallel_workers(_count, sizeof(Item), _policy);
+            std::vector<std::size_t> counts(workers * 256);
+
+            Item *from = _data;
+            Item *to = _scratch;
+            for (std::size_t p = 0; p < passes; p++)
+            {
+                std::fill(counts.begin(), counts.end(), std::size_t(0));
+                parallel_for(_count, sizeof(Item), _policy, [&](std::size_t _first, std::size_t _last, std::size_t _worker)
+                             {
+                                 std::size_t *c = counts.data() + _worker * 256;
+                                 for (std::size_t i = _first; i < _last; i++)
+                                 {
+                                     c[(_key(from[i]) >> (8 * p)) & 0xff]++;
+                                 }
+                             });
+
+                std::size_t offset = 0;
+                bool trivial = false;
+                for (std::size_t d = 0; d < 256; d++)
+                {
+                    const std::size_t start = offset;
+                    for (std::size_t w = 0; w < workers; w++)
+                    {
+                        const std::size_t n = counts[w * 256 + d];
+                        counts[w * 256 + d] = offset;
+                        offset += n;
+                    }
+                    trivial = trivial || offset - start == _count;
+                }
+                if (trivial)
+                {
+                    continue;
+                }
+
+                parallel_for(_count, sizeof(Item), _policy, [&](std::size_t _first, std::size_t _last, std::size_t _worker)
+                             {
+                                 std::size_t *c = counts.data() + _worker * 256;
+                                 for (std::size_t i = _first; i < _last; i++)
+                                 {
+                                     to[c[(_key(from[i]) >> (8 * p)) & 0xff]++] = from[i];
+                                 }
+                             });
+                std::swap(from, to);
+            }
+
+            if (from != _data)
+            {
+                std::memcpy(static_cast<void *>(_data), from, _count * sizeof(Item));
+            }
+        }
+
+        struct sort_comparator
+        {
+            unsigned char first;
+            unsigned char second;
+        };
+
+        // Batcher's odd-even merge network on N inputs, as a comparator list
+        // built at compile time; Emit false only counts the comparators
+        template <std::ptrdiff_t N>
+        struct batcher_network
+        {
+            template <bool Emit, std::size_t Size>
+            static constexpr std::size_t walk(std::array<sort_comparator, Size> &_out)
+            {
+                std::size_t count = 0;
+                for (std::ptrdiff_t p = 1; p < N; p <<= 1)
+                {
+                    for (std::ptrdiff_t k = p; k >= 1; k >>= 1)
+                    {
+                        for (std::ptrdiff_t j = k % p; j + k < N; j += 2 * k)
+                        {
+                            for (std::ptrdiff_t i = 0; i < k && i + j + k < N; i++)
+                            {
+                                if ((i + j) / (2 * p) == (i + j + k) / (2 * p))
+                                {
+                                    if constexpr (Emit)
+                                    {
+                                        _out[count] = sort_comparator{(unsigned char)(i + j), (unsigned char)(i + j + k)};
+                                    }
+                                    count++;
+                                }
+                            }
+                        }
+                    }
+                }
+                return count;
+            }
+
+            static constexpr std::size_t size()
+            {
+                std::array<sort_comparator, 0> none{};
+                return walk<false>(none);
+            }
+
+            static constexpr std::array<sort_comparator, size()> build()
+            {
+                std::array<sort_comparator, size()> out{};
+                walk<true>(out);
+                return out;
+            }
+
+            static constexpr std::array<sort_comparator, size()> comparators = build();
+        };
+
+        // written as selects, so scalars compare-exchange without a
+        // data-dependent branch and the compiler can use min/max or cmov
+        template <typename T, typename Compare>
+        inline void compare_exchange(T &_x, T &_y, Compare &_comp)
+        {
+            const T a = _x;
+            const T b = _y;
+            const bool swap = _comp(b, a);
+            _x = swap ? b : a;
+            _y = swap ? a : b;
+        }
+
+        template <std::ptrdiff_t N, typename T, typename Compare, std::size_t... I>
+        void network_apply([[maybe_unused]] T *_first, [[maybe_unused]] Compare &_comp, std::index_sequence<I...>)
+        {
+            (compare_exchange(_first[batcher_network<N>::comparators[I].first], _first[batcher_network<N>::comparators[I].second], _comp), ...);
+        }
+
+        template <std::ptrdiff_t N, typename T, typename Compare>
+        void network_sort_fixed(T *_first, Compare &_comp)
+        {
+            network_apply<N>(_first, _comp, std::make_index_sequence<batcher_network<N>::size()>());
+        }
+
+        template <typename T, typename Compare, std::ptrdiff_t... N>
+        void network_sort(T *_first, std::ptrdiff_t _count, Compare &_comp, std::integer_sequence<std::ptrdiff_t, N...>)
+        {
+            using sorter = void (*)(T *, Compare &);
+            static constexpr sorter table[] = {&network_sort_fixed<N, T, Compare>...};
+            table[_count](_first, _comp);
+        }
+
+        // Sorts up to SORT_NETWORK_THRESHOLD scalars with a network fully
+        // unrolled for each size, so every compare-exchange works on fixed
+        // positions; about three times faster than insertion sort on
+        // random input of 16.
+        template <typename T, typename Compare>
+        void network_sort(T *_first, std::ptrdiff_t _count, Compare &_comp)
+        {
+            network_sort(_first, _count, _comp, std::make_integer_sequence<std::ptrdiff_t, SORT_NETWORK_THRESHOLD + 1>());
+        }
+
+        template <typename T>
+        inline constexpr bool sort_network_ok = std::is_arithmetic_v<T> || std::is_pointer_v<T>;
+
+        template <typename T, typename Compare>
+        void insertion_sort(T *_first, T *_last, Compare &_comp)
+        {
+            if (_first == _last)
+            {
+                return;
+            }
+
+            for (T *cur = _first + 1; cur != _last; ++cur)
+            {
+                T *sift = cur;
+                T *prev = cur - 1;
+                if (_comp(*sift, *prev))
+                {
+                    T tmp(std::move(*sift));
+                    do
+                    {
+                        *sift-- = std::move(*prev);
+                    } while (sift != _first && _comp(tmp, *--prev));
+                    *sift = std::move(tmp);
+                }
+            }
+        }
+
+        // *(_first - 1) orders before every element of the range
+        template <typename T, typename Compare>
+        void unguarded_insertion_sort(T *_first, T *_last, Compare &_comp)
+        {
+            if (_first == _last)
+            {
+                return;
+            }
+
+            for (T *cur = _first + 1; cur != _last; ++cur)
+            {
+                T *sift = cur;
+                T *prev = cur - 1;
+                if (_comp(*sift, *prev))
+                {
+                    T tmp(std::move(*sift));
+                    do
+                    {
+                        *sift-- = std::move(*prev);
+                    } while (_comp(tmp, *--prev));
+                    *sift = std::move(tmp);
+                }
+            }
+        }
+
+        // insertion sort that gives up after a few moves, for ranges that
+        // look sorted already
+        template <typename T, typename Compare>
+        bool partial_insertion_sort(T *_first, T *_last, Compare &_comp)
+        {
+            if (_first == _last)
+            {
+                return true;
+            }
+
+            std::ptrdiff_t moved = 0;
+            for (T *cur = _first + 1; cur != _last; ++cur)
+            {
+                T *sift = cur;
+                T *prev = cur - 1;
+                if (_comp(*sift, *prev))
+                {
+                    T tmp(std::move(*sift));
+                    do
+                    {
+                        *sift-- = std::move(*prev);
+                    } while (sift != _first && _comp(tmp, *--prev));
+                    *sift = std::move(tmp);
+                    moved += cur - sift;
+                }
+                if (moved > SORT_PARTIAL_INSERTION_LIMIT)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        template <typename T, typename Compare>
+        void sort3(T *_a, T *_b, T *_c, Compare &_comp)
+        {
+            if (_comp(*_b, *_a))
+            {
+                std::iter_swap(_a, _b);
+            }
+            if (_comp(*_c, *_b))
+            {
+                std::iter_swap(_b, _c);
+            }
+            if (_comp(*_b, *_a))
+            {
+                std::iter_swap(_a, _b);
+            }
+        }
+
+        // Partitions around the pivot at *_first, elements equal to it going
+        // right; returns the pivot's place and whether nothing had to move.
+        template <typename T, typename Compare>
+        std::pair<T *, bool> partition_right(T *_first, T *_last, Compare &_comp)
+        {
+            T pivot(std::move(*_first));
+            T *first = _first;
+            T *last = _last;
+
+            while (_comp(*++first, pivot))
+            {
+            }
+            if (first - 1 == _first)
+            {
+                while (first < last && !_comp(*--last, pivot))
+                {
+                }
+            }
+            else
+            {
+                while (!_comp(*--last, pivot))
+                {
+                }
+            }
+
+            const bool partitioned = first >= last;
+            while (first < last)
+            {
+                std::iter_swap(first, last);
+                while (_comp(*++first, pivot))
+                {
+                }
+                while (!_comp(*--last, pivot))
+                {
+                }
+            }
+
+            T *position = first - 1;
+            *_first = std::move(*position);
+            *position = std::move(pivot);
+            return {position, partitioned};
+        }
+
+        // Partitions around *_first with equal elements going left. Used when
+        // the pivot equals the element before the range, so everything that
+        // goes left equals it and needs no further sorting.
+        template <typename T, typename Compare>
+        T *partition_left(T *_first, T *_last, Compare &_comp)
+        {
+            T pivot(std::move(*_first));
+            T *first = _first;
+            T *last = _last;
+
+            while (_comp(pivot, *--last))
+            {
+            }
+            if (last + 1 == _last)
+            {
+                while (first < last && !_comp(pivot, *++first))
+                {
+                }
+            }
+            else
+            {
+                while (!_comp(pivot, *++first))
+                {
+                }
+            }
+
+            while (first < last)
+            {
+                std::iter_swap(first, last);
+                while (_comp(pivot, *--last))
+                {
+                }
+                while (!_comp(pivot, *++first))
+                {
+                }
+            }
+
+            *_first = std::move(*last);
+            *last = std::move(pivot);
+            return last;
+        }
+
+        // Pattern-defeating quicksort (Peters): median-of-3 or ninther
+        // pivots, a partition that notices already sorted input, shuffles
+        // that break up adversarial patterns after an unbalanced split, and
+        // heapsort once too many splits were bad, so O(n log n) always.
+        template <typename T, typename Compare>
+        void pdqsort(T *_first, T *_last, Compare &_comp, int _badAllowed, bool _leftmost)
+        {
+            for (;;)
+            {
+                const std::ptrdiff_t size = _last - _first;
+                if (size < SORT_INSERTION_THRESHOLD)
+                {
+                    if constexpr (sort_network_ok<T>)
+                    {
+                        if (size <= SORT_NETWORK_THRESHOLD)
+                        {
+                            network_sort(_first, size, _comp);
+                            return;
+                        }
+                    }
+                    if (_leftmost)
+                    {
+                        insertion_sort(_first, _last, _comp);
+                    }
+                    else
+                    {
+                        unguarded_insertion_sort(_first, _last, _comp);
+                    }
+                    return;
+                }
+
+                const std::ptrdiff_t half = size / 2;
+                if (size > SORT_NINTHER_THRESHOLD)
+                {
+                    sort3(_first, _first + half, _last - 1, _comp);
+                    sort3(_first + 1, _first + (half - 1), _last - 2, _comp);
+                    sort3(_first + 2, _first + (half + 1), _last - 3, _comp);
+                    sort3(_first + (half - 1), _first + half, _first + (half + 1), _comp);
+                    std::iter_swap(_first, _first + half);
+                }
+                else
+                {
+                    sort3(_first + half, _first, _last - 1, _comp);
+                }
+
+                // a pivot equal to the element before the range: take all
+                // its equals out in one go
+                if (!_leftmost && !_comp(*(_first - 1), *_first))
+                {
+                    _first = partition_left(_first, _last, _comp) + 1;
+                    continue;
+                }
+
+                const std::pair<T *, bool> split = partition_right(_first, _last, _comp);
+                T *pivot = split.first;
+                const std::ptrdiff_t left = pivot - _first;
+                const std::ptrdiff_t right = _last - (pivot + 1);
+
+                if (left < size / 8 || right < size / 8)
+                {
+                    if (--_badAllowed == 0)
+                    {
+                        std::make_heap(_first, _last, _comp);
+                        std::sort_heap(_first, _last, _comp);
+                        return;
+                    }
+
+                    if (left >= SORT_INSERTION_THRESHOLD)
+                    {
+                        std::iter_swap(_first, _first + left / 4);
+                        std::iter_swap(pivot - 1, pivot - left / 4);
+                        if (left > SORT_NINTHER_THRESHOLD)
+                        {
+                            std::iter_swap(_first + 1, _first + (left / 4 + 1));
+                            std::iter_swap(_first + 2, _first + (left / 4 + 2));
+                            std::iter_swap(pivot - 2, pivot - (left / 4 + 1));
+                            std::iter_swap(pivot - 3, pivot - (left / 4 + 2));
+                        }
+                    }
+                    if (right >= SORT_INSERTION_THRESHOLD)
+                    {
+                        std::iter_swap(pivot + 1, pivot + (1 + right / 4));
+                        std::iter_swap(_last - 1, _last - right / 4);
+                        if (right > SORT_NINTHER_THRESHOLD)
+                        {
+                            std::iter_swap(pivot + 2, pivot + (2 + right / 4));
+                            std::iter_swap(pivot + 3, pivot + (3 + right / 4));
+                            std::iter_swap(_last - 2, _last - (1 + right / 4));
+                            std::iter_swap(_last - 3, _last - (2 + right / 4));
+                        }
+                    }
+                }
+                else if (split.second && partial_insertion_sort(_first, pivot, _comp) && partial_insertion_sort(pivot + 1, _last, _comp))
+                {
+                    return;
+                }
+
+                // recurse into the left part, loop on the right
+                pdqsort(_first, pivot, _comp, _badAllowed, _leftmost);
+                _first = pivot + 1;
+                _leftmost = false;
+            }
+        }
+
+        template <typename T, typename Compare>
+        void comparison_sort(T *_first, T *_last, Compare &_comp)
+        {
+            const std::size_t size = std::size_t(_last - _first);
+            if (size < 2)
+            {
+                return;
+            }
+
+            int log2 = 0;
+            for (std::size_t n = size; n > 1; n >>= 1)
+            {
+                log2++;
+            }
+            pdqsort(_first, _last, _comp, log2, true);
+        }
+
+        // sorts every part on its own worker, then merges neighbouring parts
+        // pairwise, each round's merges running in parallel
+        template <typename T, typename Compare>
+        void parallel_comparison_sort(T *_data, std::size_t _count, Compare &_comp, parallel_t _policy)
+        {
+            const std::size_t workers = parallel_workers(_count, sizeof(T), _policy);
+            std::vector<std::pair<std::size_t, std::size_t>> parts(workers, {_count, _count});
+
+            parallel_for(_count, sizeof(T), _policy, [&](std::size_t _first, std::size_t _last, std::size_t _worker)
+                         {
+                             Compare comp = _comp;
+                             comparison_sort(_data + _first, _data + _last, comp);
+                             parts[_worker] = {_first, _last};
+                         });
+            parts.erase(std::remove_if(parts.begin(), parts.end(), [](const std::pair<std::size_t, std::size_t> &_p)
+                                       { return _p.first >= _p.second; }),
+                        parts.end());
+
+            while (parts.size() > 1)
+            {
+                std::vector<std::pair<std::size_t, std::size_t>> merged;
+                std::vector<std::thread> threads;
+                std::vector<std::exception_ptr> errors(parts.size() / 2);
+
+                for (std::size_t i = 0; i + 1 < parts.size(); i += 2)
+                {
+                    const std::pair<std::size_t, std::size_t> a = parts[i];
+                    const std::pair<std::size_t, std::size_t> b = parts[i + 1];
+                    threads.emplace_back([&, a, b, i]
+                                         {
+                                             try
+                                             {
+                                                 std::inplace_merge(_data + a.first, _data + b.first, _data + b.second, _comp);
+                                             }
+                                             catch (...)
+                                             {
+                                                 errors[i / 2] = std::current_exception();
+                                             }
+                                         });
+                    merged.emplace_back(a.first, b.second);
+                }
+                if (parts.size() % 2 != 0)
+                {
+                    merged.push_back(parts.back());
+                }
+
+                for (std::thread &t : threads)
+                {
+                    t.join();
+                }
+                for (std::exception_ptr &e : errors)
+                {
+                    if (e)
+                    {
+                        std::rethrow_exception(e);
+                    }
+                }
+                parts.swap(merged);
+            }
+        }
+
+        // key and original position, radix sorted by key for sort_by_key
+        template <typename U>
+        struct radix_item
+        {
+            U key;
+            std::size_t index;
+        };
+
+        // replaces _v by its elements in the order _order gives
+        template <typename T>
+        void apply_order(ds::vector<T> &_v, const std::size_t *_order)
+        {
+            ds::vector<T> sorted;
+            sorted.reserve(_v.size());
+            for (std::size_t i = 0; i < _v.size(); i++)
+            {
+                sorted.push_back(std::move(_v[_order[i]]));
+            }
+            _v = std::move(sorted);
+        }
+    }
+
+    // Sorts _v by _comp; not stable. With std::less or std::greater on an
+    // integer or float element, and at least SORT_RADIX_MIN of them, it is
+    // an LSD radix sort that makes one pass per key byte and needs a second
+    // buffer the size of _v. Anything else goes to pattern-defeating
+    // quicksort, with a branch-free sorting network for small partitions
+    // of scalars. Floats order as their comparison does except that -0.0
+    // goes before 0.0 and NaNs go to the ends.
+    template <typename T, typename Compare = std::less<T>>
+    void sort(ds::vector<T> &_v, Compare _comp = Compare())
+    {
+        constexpr int direction = detail::radix_direction<T, Compare>();
+        if constexpr (direction != 0)
+        {
+            if (_v.size() >= detail::SORT_RADIX_MIN)
+            {
+                std::unique_ptr<T[]> scratch(new T[_v.size()]);
+                detail::radix_sort(_v.data(), _v.size(), scratch.get(), detail::radix_key<T, direction>());
+                return;
+            }
+        }
+        detail::comparison_sort(_v.data(), _v.data() + _v.size(), _comp);
+    }
+
+    // The same split over threads as ds::parallel_for does: radix passes
+    // count and scatter per part, and comparison sorts sort each part and
+    // merge the parts pairwise.
+    template <typename T, typename Compare = std::less<T>>
+    void sort(ds::vector<T> &_v, parallel_t _policy, Compare _comp = Compare())
+    {
+        if (parallel_workers(_v.size(), sizeof(T), _policy) == 1)
+        {
+            sort(_v, _comp);
+            return;
+        }
+
+        constexpr int direction = detail::radix_direction<T, Compare>();
+        if constexpr (direction != 0)
+        {
+            std::unique_ptr<T[]> scratch(new T[_v.size()]);
+            detail::radix_sort(_v.data(), _v.size(), scratch.get(), detail::radix_key<T, direction>(), _policy);
+        }
+        else
+        {
+            detail::parallel_comparison_sort(_v.data(), _v.size(), _comp, _policy);
+        }
+    }
+
+    // Sorts _keys by _comp and moves every element of _values along with
+    // its key; stable. The order is found on (key, position) pairs, by
+    // radix sort where ds::sort would use one, then both vectors are
+    // rebuilt in that order, so Key and T only need to be movable.
+    template <typename Key, typename T, typename Compare = std::less<Key>>
+    void sort_by_key(ds::vector<Key> &_keys, ds::vector<T> &_values, Compare _comp = Compare())
+    {
+        if (_keys.size() != _values.size())
+        {
+            throw std::invalid_argument("ds::sort_by_key - keys and values differ in size");
+        }
+
+        const std::size_t count = _keys.size();
+        if (count < 2)
+        {
+            return;
+        }
+
+        ds::vector<std::size_t> order(count);
+        bool ordered = false;
+
+        constexpr int direction = detail::radix_direction<Key, Compare>();
+        if constexpr (direction != 0)
+        {
+            if (count >= detail::SORT_RADIX_MIN)
+            {
+                using U = decltype(detail::radix_key<Key, direction>()(_keys[0]));
+                using item = detail::radix_item<U>;
+
+                std::unique_ptr<item[]> items(new item[2 * count]);
+                for (std::size_t i = 0; i < count; i++)
+                {
+                    items[i] = item{detail::radix_key<Key, direction>()(_keys[i]), i};
+                }
+                detail::radix_sort(items.get(), count, items.get() + count, [](const item &_x)
+                                   { return _x.key; });
+                for (std::size_t i = 0; i < count; i++)
+                {
+                    order[i] = items[i].index;
+                }
+                ordered = true;
+            }
+        }
+
+        if (!ordered)
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                order[i] = i;
+            }
+
+            // ties broken by position keep equal keys in order
+            auto byKey = [&](std::size_t _a, std::size_t _b)
+            {
+                return _comp(_keys[_a], _keys[_b]) || (!_comp(_keys[_b], _keys[_a]) && _a < _b);
+            };
+            detail::comparison_sort(order.data(), order.data() + count, byKey);
+        }
+
+        detail::apply_order(_keys, order.data());
+        detail::apply_order(_values, order.data());
+    }
+}
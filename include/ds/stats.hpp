@@ -0,0 +1,309 @@
+#pragma once
+
+#include <cstddef>
+
+// Memory telemetry for the containers. stats() is always available and
+// reports what the container holds now; growth history (reallocations and
+// bytes moved) and the process-wide stats_registry are only compiled in
+// with -DDS_ENABLE_STATS, so default builds pay nothing for them.
+
+#ifdef DS_ENABLE_STATS
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+#endif
+
+namespace ds
+{
+    struct container_stats
+    {
+        std::size_t bytes_reserved = 0;  // element storage plus bookkeeping (deque map)
+        std::size_t bytes_in_use = 0;    // size() * sizeof(T)
+        std::size_t reallocations = 0;   // DS_ENABLE_STATS only
+        std::size_t bytes_moved = 0;     // bytes relocated by growth, DS_ENABLE_STATS only
+        std::size_t map_slots = 0;       // deque only
+        std::size_t blocks = 0;          // deque only
+
+        double slack_ratio() const
+        {
+            return bytes_reserved == 0 ? 0.0 : 1.0 - double(bytes_in_use) / double(bytes_reserved);
+        }
+    };
+
+#ifdef DS_ENABLE_STATS
+    class stats_registry;
+
+    namespace detail
+    {
+        // Embedded in every container while DS_ENABLE_STATS is set. The
+        // owning container publishes its numbers with relaxed atomic stores,
+        // so the registry can read them from any thread without a data race.
+        class stats_record
+        {
+        public:
+            stats_record(const char *_container, const std::type_info &_type);
+            ~stats_record();
+
+            stats_record(const stats_record &) = delete;
+            stats_record &operator=(const stats_record &) = delete;
+
+            void set_size(std::size_t _reserved, std::size_t _inUse) noexcept
+            {
+                bytesReserved.store(_reserved, std::memory_order_relaxed);
+                bytesInUse.store(_inUse, std::memory_order_relaxed);
+            }
+
+            void set_blocks(std::size_t _mapSlots, std::size_t _blocks) noexcept
+            {
+                mapSlots.store(_mapSlots, std::memory_order_relaxed);
+                blocks.store(_blocks, std::memory_order_relaxed);
+            }
+
+            void add_growth(std::size_t _bytesMoved) noexcept
+            {
+                reallocations.fetch_add(1, std::memory_order_relaxed);
+                bytesMoved.fetch_add(_bytesMoved, std::memory_order_relaxed);
+            }
+
+            container_stats snapshot() const noexcept
+            {
+                container_stats s;
+                s.bytes_reserved = bytesReserved.load(std::memory_order_relaxed);
+                s.bytes_in_use = bytesInUse.load(std::memory_order_relaxed);
+                s.reallocations = reallocations.load(std::memory_order_relaxed);
+                s.bytes_moved = bytesMoved.load(std::memory_order_relaxed);
+                s.map_slots = mapSlots.load(std::memory_order_relaxed);
+                s.blocks = blocks.load(std::memory_order_relaxed);
+                return s;
+            }
+
+        private:
+            friend class ds::stats_registry;
+
+            std::atomic<std::size_t> bytesReserved{0};
+            std::atomic<std::size_t> bytesInUse{0};
+            std::atomic<std::size_t> reallocations{0};
+            std::atomic<std::size_t> bytesMoved{0};
+            std::atomic<std::size_t> mapSlots{0};
+            std::atomic<std::size_t> blocks{0};
+
+            const char *container;
+            const std::type_info *type;
+
+            stats_record *prev = nullptr;
+            stats_record *next = nullptr;
+        };
+    }
+
+    // Process-wide view over every live container, grouped by container and
+    // element type. Growth counters of destroyed containers stay in the totals.
+    class stats_registry
+    {
+    public:
+        struct type_totals
+        {
+            std::string container;
+            std::string element_type;
+            std::size_t live = 0;
+            container_stats stats;
+        };
+
+        struct instance_info
+        {
+            const void *record;
+            std::string container;
+            std::string element_type;
+            container_stats stats;
+        };
+
+        static stats_registry &instance()
+        {
+            static stats_registry registry;
+            return registry;
+        }
+
+        std::vector<type_totals> totals() const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            std::map<std::pair<std::string, std::string>, type_totals> byType;
+
+            for (const auto &retired : retiredGrowth)
+            {
+                type_totals &t = byType[retired.first];
+                t.container = retired.first.first;
+                t.element_type = retired.first.second;
+                t.stats.reallocations += retired.second.reallocations;
+                t.stats.bytes_moved += retired.second.bytes_moved;
+            }
+
+            for (const detail::stats_record *r = head; r != nullptr; r = r->next)
+            {
+                const container_stats s = r->snapshot();
+                type_totals &t = byType[key(*r)];
+                t.container = r->container;
+                t.element_type = demangle(*r->type);
+                t.live++;
+                t.stats.bytes_reserved += s.bytes_reserved;
+                t.stats.bytes_in_use += s.bytes_in_use;
+                t.stats.reallocations += s.reallocations;
+                t.stats.bytes_moved += s.bytes_moved;
+                t.stats.map_slots += s.map_slots;
+                t.stats.blocks += s.blocks;
+            }
+
+            std::vector<type_totals> result;
+            for (auto &entry : byType)
+            {
+                result.push_back(entry.second);
+            }
+            return result;
+        }
+
+        // the _count live containers wasting the most reserved bytes
+        std::vector<instance_info> most_slack(std::size_t _count) const
+        {
+            std::vector<instance_info> result;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                for (const detail::stats_record *r = head; r != nullptr; r = r->next)
+                {
+                    result.push_back(instance_info{r, r->container, demangle(*r->type), r->snapshot()});
+                }
+            }
+
+            auto waste = [](const instance_info &i)
+            { return i.stats.bytes_reserved - std::min(i.stats.bytes_reserved, i.stats.bytes_in_use); };
+
+            std::sort(result.begin(), result.end(), [&](const instance_info &a, const instance_info &b)
+                      { return waste(a) > waste(b); });
+
+            if (result.size() > _count)
+            {
+                result.resize(_count);
+            }
+
+            return result;
+        }
+
+        void dump(std::ostream &_out, std::size_t _worst = 10) const
+        {
+            char line[512];
+
+            std::snprintf(line, sizeof(line), "%-12s %-24s %8s %14s %14s %7s %8s %14s %10s %10s\n", "container", "element",
+                          "live", "reserved", "in use", "slack", "reallocs", "bytes moved", "map slots", "blocks");
+            _out << line;
+
+            for (const type_totals &t : totals())
+            {
+                std::snprintf(line, sizeof(line), "%-12s %-24s %8zu %14zu %14zu %6.1f%% %8zu %14zu %10zu %10zu\n",
+                              t.container.c_str(), t.element_type.c_str(), t.live, t.stats.bytes_reserved,
+                              t.stats.bytes_in_use, 100.0 * t.stats.slack_ratio(), t.stats.reallocations,
+                              t.stats.bytes_moved, t.stats.map_slots, t.stats.blocks);
+                _out << line;
+            }
+
+            if (_worst == 0)
+            {
+                return;
+            }
+
+            _out << "largest unused reservations:\n";
+
+            for (const instance_info &i : most_slack(_worst))
+            {
+                std::snprintf(line, sizeof(line), "  %p %-12s %-24s reserved %zu in use %zu (%.1f%% slack)\n", i.record,
+                              i.container.c_str(), i.element_type.c_str(), i.stats.bytes_reserved, i.stats.bytes_in_use,
+                              100.0 * i.stats.slack_ratio());
+                _out << line;
+            }
+        }
+
+    private:
+        friend class detail::stats_record;
+
+        mutable std::mutex mutex;
+        detail::stats_record *head = nullptr;
+        std::map<std::pair<std::string, std::string>, container_stats> retiredGrowth;
+
+        static std::string demangle(const std::type_info &_type)
+        {
+#if defined(__GNUG__)
+            int status = 0;
+            char *name = abi::__cxa_demangle(_type.name(), nullptr, nullptr, &status);
+
+            if (status == 0 && name != nullptr)
+            {
+                std::string result(name);
+                std::free(name);
+                return result;
+            }
+#endif
+            return _type.name();
+        }
+
+        static std::pair<std::string, std::string> key(const detail::stats_record &_r)
+        {
+            return {_r.container, demangle(*_r.type)};
+        }
+
+        void attach(detail::stats_record *_r)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            _r->next = head;
+            if (head != nullptr)
+            {
+                head->prev = _r;
+            }
+            head = _r;
+        }
+
+        void detach(detail::stats_record *_r)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            const container_stats s = _r->snapshot();
+
+            if (s.reallocations != 0)
+            {
+                container_stats &retired = retiredGrowth[key(*_r)];
+                retired.reallocations += s.reallocations;
+                retired.bytes_moved += s.bytes_moved;
+            }
+
+            (_r->prev != nullptr ? _r->prev->next : head) = _r->next;
+            if (_r->next != nullptr)
+            {
+                _r->next->prev = _r->prev;
+            }
+        }
+    };
+
+    namespace detail
+    {
+        inline stats_record::stats_record(const char *_container, const std::type_info &_type) : container(_container),
+                                                                                                  type(&_type)
+        {
+            stats_registry::instance().attach(this);
+        }
+
+        inline stats_record::~stats_record()
+        {
+            stats_registry::instance().detach(this);
+        }
+    }
+#endif
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+namespace ds
+{
+    namespace detail
+    {
+        // swiss table control bytes: an element's 7 bit hash fragment when
+        // the slot is full, otherwise one of these negative markers
+        using ctrl_t = std::int8_t;
+
+        inline constexpr ctrl_t CTRL_EMPTY = -128;
+        inline constexpr ctrl_t CTRL_DELETED = -2;
+        inline constexpr ctrl_t CTRL_SENTINEL = -1; // after the last slot, stops iteration
+
+        template <typename Policy, typename Hash, typename KeyEqual>
+        class swiss_table;
+    }
+
+    // Forward iterator over a swiss table: walks the control bytes and the
+    // slots side by side and stops on full slots only.
+    template <typename Value, typename Ref, typename Ptr>
+    class SwissIterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::remove_const_t<Value>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Ptr;
+        using reference = Ref;
+
+        SwissIterator() = default;
+
+        // _ctrl and _slot must be a full slot or the sentinel
+        SwissIterator(const detail::ctrl_t *_ctrl, Value *_slot) : ctrl(_ctrl), slot(_slot) {}
+
+        template <typename R, typename P,
+                  typename = std::enable_if_t<std::is_convertible_v<P, Ptr> && !std::is_same_v<P, Ptr>>>
+        SwissIterator(const SwissIterator<Value, R, P> &_other) : ctrl(_other.ctrl), slot(_other.slot) {}
+
+        reference operator*() const { return *slot; }
+        pointer operator->() const { return slot; }
+
+        SwissIterator &operator++()
+        {
+            ++ctrl;
+            ++slot;
+            skipEmpty();
+            return *this;
+        }
+
+        SwissIterator operator++(int)
+        {
+            SwissIterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        template <typename R, typename P>
+        bool operator==(const SwissIterator<Value, R, P> &_other) const { return ctrl == _other.ctrl; }
+        template <typename R, typename P>
+        bool operator!=(const SwissIterator<Value, R, P> &_other) const { return ctrl != _other.ctrl; }
+
+        // moves forward to the next full slot or the sentinel
+        void skipEmpty()
+        {
+            while (*ctrl < detail::CTRL_SENTINEL)
+            {
+                ++ctrl;
+                ++slot;
+            }
+        }
+
+    private:
+        template <typename V, typename R, typename P>
+        friend class SwissIterator;
+
+        template <typename Policy, typename Hash, typename KeyEqual>
+        friend class detail::swiss_table;
+
+        const detail::ctrl_t *ctrl = nullptr;
+        Value *slot = nullptr;
+    };
+}
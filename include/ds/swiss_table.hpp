@@ -0,0 +1,760 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DS_SWISS_SSE2 1
+#endif
+
+#include "key_arg.hpp"
+#include "memory.hpp"
+#include "swiss_iterator.hpp"
+#include "vector.hpp"
+
+namespace ds
+{
+    // Transparent hash for string keys, so a flat_hash_map<std::string, V,
+    // string_hash, std::equal_to<>> can be searched with a string_view or a
+    // literal without building a std::string.
+    struct string_hash
+    {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view _s) const noexcept { return std::hash<std::string_view>()(_s); }
+        std::size_t operator()(const std::string &_s) const noexcept { return (*this)(std::string_view(_s)); }
+        std::size_t operator()(const char *_s) const noexcept { return (*this)(std::string_view(_s)); }
+    };
+
+    namespace detail
+    {
+        inline unsigned lowest_bit(std::uint32_t _mask)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return unsigned(__builtin_ctz(_mask));
+#else
+            unsigned i = 0;
+            while ((_mask & 1) == 0)
+            {
+                _mask >>= 1;
+                i++;
+            }
+            return i;
+#endif
+        }
+
+        inline unsigned highest_bit(std::uint32_t _mask)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return 31u - unsigned(__builtin_clz(_mask));
+#else
+            unsigned i = 0;
+            while (_mask >>= 1)
+            {
+                i++;
+            }
+            return i;
+#endif
+        }
+
+        // std::hash is the identity for integers on common library
+        // implementations; the table splits the hash into a probe start and
+        // a 7 bit fragment, so both need well mixed bits
+        inline std::uint64_t mix_hash(std::uint64_t _h)
+        {
+            _h ^= _h >> 33;
+            _h *= 0xff51afd7ed558ccdull;
+            _h ^= _h >> 33;
+            _h *= 0xc4ceb9fe1a85ec53ull;
+            _h ^= _h >> 33;
+            return _h;
+        }
+
+        // A group of control bytes probed at once. Each mask has one bit per
+        // slot of the group, lowest bit first.
+#ifdef DS_SWISS_SSE2
+        struct swiss_group
+        {
+            static constexpr std::size_t width = 16;
+
+            __m128i ctrl;
+
+            explicit swiss_group(const ctrl_t *_p) : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(_p))) {}
+
+            std::uint32_t match(ctrl_t _h2) const
+            {
+                return std::uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(_h2), ctrl)));
+            }
+
+            std::uint32_t maskEmpty() const
+            {
+                return std::uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(CTRL_EMPTY), ctrl)));
+            }
+
+            std::uint32_t maskEmptyOrDeleted() const
+            {
+                return std::uint32_t(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(CTRL_SENTINEL), ctrl)));
+            }
+        };
+#else
+        // eight control bytes in a 64 bit word when SSE2 is not available
+        struct swiss_group
+        {
+            static constexpr std::size_t width = 8;
+            static constexpr std::uint64_t lsbs = 0x0101010101010101ull;
+            static constexpr std::uint64_t msbs = 0x8080808080808080ull;
+
+            std::uint64_t ctrl = 0;
+
+            explicit swiss_group(const ctrl_t *_p)
+            {
+                for (std::size_t i = 0; i < width; i++)
+                {
+                    ctrl |= std::uint64_t(std::uint8_t(_p[i])) << (8 * i);
+                }
+            }
+
+            // the high bit of each byte to one bit per byte
+            static std::uint32_t compress(std::uint64_t _bytes)
+            {
+                return std::uint32_t(((_bytes >> 7) * 0x0102040810204080ull) >> 56);
+            }
+
+            // may report a false match next to a true one; callers compare keys
+            std::uint32_t match(ctrl_t _h2) const
+            {
+                const std::uint64_t x = ctrl ^ (lsbs * std::uint8_t(_h2));
+                return compress((x - lsbs) & ~x & msbs);
+            }
+
+            std::uint32_t maskEmpty() const { return compress(ctrl & (~ctrl << 6) & msbs); }
+            std::uint32_t maskEmptyOrDeleted() const { return compress(ctrl & (~ctrl << 7) & msbs); }
+        };
+#endif
+
+        // Open addressing hash table with SwissTable control bytes, shared by
+        // flat_hash_map and flat_hash_set. The capacity is 2^k - 1; ctrl has
+        // one byte per slot, the sentinel, and a copy of the first
+        // width - 1 bytes so a group load never wraps. Slots are raw storage
+        // in a ds::vector and elements are constructed in place. Policy
+        // gives the type a slot holds, the element in it, the key of an
+        // element and how to move a slot's contents to another slot.
+        template <typename Policy, typename Hash, typename KeyEqual>
+        class swiss_table
+        {
+        public:
+            using key_type = typename Policy::key_type;
+            using value_type = typename Policy::value_type;
+            using size_type = std::size_t;
+            using hasher = Hash;
+            using key_equal = KeyEqual;
+
+            using iterator = SwissIterator<value_type, typename Policy::reference, typename Policy::pointer>;
+            using const_iterator = SwissIterator<value_type, const value_type &, const value_type *>;
+
+            // constructors
+            swiss_table() = default;
+            explicit swiss_table(size_type _capacity, const Hash &_hash = Hash(), const KeyEqual &_equal = KeyEqual());
+            swiss_table(const swiss_table &_other);
+            swiss_table(swiss_table &&_temp) noexcept;
+
+            // destructors
+            ~swiss_table() noexcept;
+
+            // operator=
+            swiss_table &operator=(const swiss_table &_other);
+            swiss_table &operator=(swiss_table &&_other) noexcept;
+
+            // iterators
+            iterator begin();
+            const_iterator begin() const { return const_cast<swiss_table *>(this)->begin(); }
+
+            iterator end() { return iteratorAt(mask); }
+            const_iterator end() const { return const_cast<swiss_table *>(this)->end(); }
+
+            const_iterator cbegin() const { return begin(); }
+            const_iterator cend() const { return end(); }
+
+            // capacity
+            size_type size() const { return tableSize; }
+            bool empty() const { return tableSize == 0; }
+
+            // slots, of which at most 7/8 are filled before the table grows
+            size_type capacity() const { return mask; }
+            float load_factor() const { return mask == 0 ? 0.0f : float(tableSize) / float(mask); }
+
+            // makes room for _count elements without further rehashing
+            void reserve(size_type _count);
+
+            // rebuilds with at least _capacity slots and no tombstones;
+            // rehash(0) on an empty table releases the storage
+            void rehash(size_type _capacity);
+
+            // lookup; with a transparent Hash and KeyEqual the key may be any
+            // type they accept
+            template <typename K>
+            using key_arg = typename key_arg_impl<is_transparent<Hash>::value && is_transparent<KeyEqual>::value>::template type<K, key_type>;
+
+            template <typename K = key_type>
+            iterator find(const key_arg<K> &_key);
+            template <typename K = key_type>
+            const_iterator find(const key_arg<K> &_key) const { return const_cast<swiss_table *>(this)->find(_key); }
+
+            template <typename K = key_type>
+            bool contains(const key_arg<K> &_key) const { return find(_key) != end(); }
+
+            template <typename K = key_type>
+            size_type count(const key_arg<K> &_key) const { return contains(_key) ? 1 : 0; }
+
+            // modifiers
+            std::pair<iterator, bool> insert(const value_type &_value) { return emplaceKey(Policy::key(_value), _value); }
+            std::pair<iterator, bool> insert(value_type &&_value) { return emplaceKey(Policy::key(_value), std::move(_value)); }
+            void insert(std::initializer_list<value_type> _list) { insert(_list.begin(), _list.end()); }
+
+            template <typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+            void insert(InputIt _first, InputIt _last);
+
+            // builds the value first, so prefer insert or try_emplace when
+            // the key is at hand
+            template <typename... Args>
+            std::pair<iterator, bool> emplace(Args &&...args);
+
+            // returns the iterator following the erased element(s)
+            iterator erase(const_iterator _position);
+            iterator erase(const_iterator _first, const_iterator _last);
+
+            template <typename K = key_type>
+            size_type erase(const key_arg<K> &_key);
+
+            void clear();
+            void swap(swiss_table &_other) noexcept;
+
+            // observers
+            hasher hash_function() const { return hashFn; }
+            key_equal key_eq() const { return equalFn; }
+
+        protected:
+            static constexpr size_type npos = size_type(-1);
+            static constexpr size_type width = swiss_group::width;
+            static constexpr size_type minCapacity = 15;
+
+            using slot_type = typename Policy::slot_type;
+
+            // iterators walk the slots as an array of value_type
+            static_assert(sizeof(slot_type) == sizeof(value_type) && alignof(slot_type) == alignof(value_type),
+                          "ds::swiss_table - a slot must be laid out like its element");
+
+            // uninitialised storage for one element
+            struct raw_slot
+            {
+                alignas(slot_type) unsigned char bytes[sizeof(slot_type)];
+
+                raw_slot() {}
+            };
+
+            ds::vector<ctrl_t> ctrl;
+            ds::vector<raw_slot> slots;
+            size_type mask = 0; // capacity, 2^k - 1, or 0 before the first insert
+            size_type tableSize = 0;
+            size_type growthLeft = 0; // inserts into empty slots before a rehash
+            Hash hashFn;
+            KeyEqual equalFn;
+
+            static slot_type *slotIn(ds::vector<raw_slot> &_slots, size_type _index) { return std::launder(reinterpret_cast<slot_type *>(_slots[_index].bytes)); }
+            slot_type *slotAt(size_type _index) { return slotIn(slots, _index); }
+            value_type *elementAt(size_type _index) { return Policy::element(slotAt(_index)); }
+            iterator iteratorAt(size_type _index);
+
+            template <typename K>
+            std::uint64_t hashOf(const K &_key) const { return mix_hash(std::uint64_t(hashFn(_key))); }
+
+            static size_type growthFor(size_type _capacity) { return _capacity - _capacity / 8; }
+            static size_type normalizeCapacity(size_type _capacity);
+
+            template <typename K>
+            size_type findIndex(const K &_key, std::uint64_t _hash) const;
+            size_type findFirstNonFull(std::uint64_t _hash) const;
+            void setCtrl(size_type _index, ctrl_t _value);
+            bool wasNeverFull(size_type _index) const;
+
+            template <typename K, typename... Args>
+            std::pair<iterator, bool> emplaceKey(const K &_key, Args &&...args);
+
+            void resize(size_type _capacity);
+            void destroyAll() noexcept;
+        };
+
+        template <typename Policy, typename Hash, typename KeyEqual>
+        typename swiss_table<Policy, Hash, KeyEqual>::size_type swiss_table<Policy, Hash, KeyEqual>::normalizeCapacity(size_type _capacity)
+        {
+            size_type capacity = minCapacity;
+            while (capacity < _capacity)
+            {
+                capacity = capacity * 2 + 1;
+            }
+            return capacity;
+        }
+
+        // parameterised constructor
+        template <typename Policy, typename Hash, typename KeyEqual>
+        swiss_table<Policy, Hash, KeyEqual>::swiss_table(size_type _capacity, const Hash &_hash, const KeyEqual &_equal) : hashFn(_hash),
+                                                                                                                           equalFn(_equal)
+        {
+            reserve(_capacity);
+        }
+
+        // copy constructor: same capacity and layout, so nothing is rehashed
+        template <typename Policy, typename Hash, typename KeyEqual>
+        swiss_table<Policy, Hash, KeyEqual>::swiss_table(const swiss_table &_other) : hashFn(_other.hashFn),
+                                                                                      equalFn(_other.equalFn)
+        {
+            if (_other.mask == 0)
+            {
+                return;
+            }
+
+            ds::vector<raw_slot> newSlots(_other.mask);
+            size_type i = 0;
+            try
+            {
+                for (; i < _other.mask; i++)
+                {
+                    if (_other.ctrl[i] >= 0)
+                    {
+                        detail::construct_at(slotIn(newSlots, i), *const_cast<swiss_table &>(_other).elementAt(i));
+                    }
+                }
+            }
+            catch (...)
+            {
+                while (i-- > 0)
+                {
+                    if (_other.ctrl[i] >= 0)
+                    {
+                        slotIn(newSlots, i)->~slot_type();
+                    }
+                }
+                throw;
+            }
+
+            ctrl = _other.ctrl;
+            slots = std::move(newSlots);
+            mask = _other.mask;
+            tableSize = _other.tableSize;
+            growthLeft = _other.growthLeft;
+        }
+
+        // move constructor
+        template <typename Policy, typename Hash, typename KeyEqual>
+        swiss_table<Policy, Hash, KeyEqual>::swiss_table(swiss_table &&_temp) noexcept : ctrl(std::move(_temp.ctrl)),
+                                                                                         slots(std::move(_temp.slots)),
+                                                                                         mask(_temp.mask),
+                                                                                         tableSize(_temp.tableSize),
+                                                                                         growthLeft(_temp.growthLeft),
+                                                                                         hashFn(_temp.hashFn),
+                                                                                         equalFn(_temp.equalFn)
+        {
+            _temp.mask = _temp.tableSize = _temp.growthLeft = 0;
+        }
+
+        // destructor
+        template <typename Policy, typename Hash, typename KeyEqual>
+        swiss_table<Policy, Hash, KeyEqual>::~swiss_table() noexcept
+        {
+            destroyAll();
+        }
+
+        // copy assignment
+        template <typename Policy, typename Hash, typename KeyEqual>
+        swiss_table<Policy, Hash, KeyEqual> &swiss_table<Policy, Hash, KeyEqual>::operator=(const swiss_table &_other)
+        {
+            if (this != &_other)
+            {
+                swiss_table copy(_other);
+                swap(copy);
+            }
+
+            return *this;
+        }
+
+        // move assignment
+        template <typename Policy, typename Hash, typename KeyEqual>
+        swiss_table<Policy, Hash, KeyEqual> &swiss_table<Policy, Hash, KeyEqual>::operator=(swiss_table &&_other) noexcept
+        {
+            if (this != &_other)
+            {
+                swiss_table temp(std::move(_other));
+                swap(temp);
+            }
+
+            return *this;
+        }
+
+        template <typename Policy, typename Hash, typename KeyEqual>
+        typename swiss_table<Policy, Hash, KeyEqual>::iterator swiss_table<Policy, Hash, KeyEqual>::iteratorAt(size_type _index)
+        {
+            if (mask == 0)
+            {
+                return iterator();
+            }
+            return iterator(ctrl.data() + _index, elementAt(0) + _index);
+        }
+
+        template <typename Policy, typename Hash, typename KeyEqual>
+        typename swiss_table<Policy, Hash, KeyEqual>::iterator swiss_table<Policy, Hash, KeyEqual>::begin()
+        {
+            iterator it = iteratorAt(0);
+            if (mask != 0)
+            {
+                it.skipEmpty();
+            }
+            return it;
+        }
+
+        template <typename Policy, typename Hash, typename KeyEqual>
+        void swiss_table<Policy, Hash, KeyEqual>::reserve(size_type _count)
+        {
+            if (_count > growthLeft + tableSize || (mask == 0 && _count != 0))
+            {
+                // smallest capacity whose 7/8 holds _count
+                size_type capacity = normalizeCapacity(_count + (_count + 6) / 7);
+                while (growthFor(capacity) < _count)
+                {
+                    capacity = capacity * 2 + 1;
+                }
+                if (capacity > mask)
+                {
+                    resize(capacity);
+                }
+            }
+        }
+
+        template <typename Policy, typename Hash, typename KeyEqual>
+        void swiss_table<Policy, Hash, KeyEqual>::rehash(size_type _capacity)
+        {
+            if (_capacity == 0 && tableSize == 0)
+            {
+                destroyAll();
+                ctrl = ds::vector<ctrl_t>();
+                slots = ds::vector<raw_slot>();
+                mask = growthLeft = 0;
+                return;
+            }
+
+            size_type capacity = normalizeCapacity(_capacity);
+            while (growthFor(capacity) < tableSize)
+            {
+                capacity = capacity * 2 + 1;
+            }
+            resize(capacity);
+        }
+
+        template <typename Policy, typename Hash, typename KeyEqual>
+        template <typename K>
+        typename swiss_table<Policy, Hash, KeyEqual>::iterator swiss_table<Policy, Hash, KeyEqual>::find(const key_arg<K> &_key)
+        {
+            const size_type i = findIndex(_key, hashOf(_key));
+            return i == npos ? end() : iteratorAt(i);
+        }
+
+        template <typename Policy, typename Hash, typename KeyEqual>
+        template <typename K>
+        typename swiss_table<Policy, Hash, KeyEqual>::size_type swiss_table<Policy, Hash, KeyEqual>::findIndex(const K &_key, std::uint64_t _hash) const
+        {
+            if (mask == 0)
+            {
+                return npos;
+            }
+
+            const ctrl_t h2 = ctrl_t(_hash & 0x7f);
+            size_type offset = size_type(_hash >> 7) & mask;
+            size_type step = 0;
+
+            // quadratic probing over groups; there is always an empty slot
+            while (true)
+            {
+                const swiss_group group(ctrl.data() + offset);
+
+                for (std::uint32_t m = group.match(h2); m != 0; m &= m - 1)
+                {
+                    const size_type i = (offset + lowest_bit(m)) & mask;
+                    if (equalFn(Policy::key(*const_cast<swiss_table *>(this)->elementAt(i)), _key))
+                    {
+                        return i;
+                    }
+                }
+
+                if (group.maskEmpty() != 0)
+                {
+                    return npos;
+                }
+
+                step += width;
+                offset = (offset + step) & mask;
+            }
+        }
+
+        template <typename Policy, typename Hash, typename KeyEqual>
+        typename swiss_table<Policy, Hash, KeyEqual>::size_type swiss_table<Policy, Hash, KeyEqual>::findFirstNonFull(std::uint64_t _hash) const
+        {
+            size_type offset = size_type(_hash >> 7) & mask;
+            size_type step = 0;
+
+            while (true)
+            {
+                const std::uint32_t m = swiss_group(ctrl.data() + offset).maskEmptyOrDeleted();
+                if (m != 0)
+                {
+                    return (offset + lowest_bit(m)) & mask;
+                }
+
+                step += width;
+                offset = (offset + step) & mask;
+            }
+        }
+
+        // writes a control byte and its copy past the sentinel
+        template <typename Policy, typename Hash, typename KeyEqual>
+        void swiss_table<Policy, Hash, KeyEqual>::setCtrl(size_type _index, ctrl_t _value)
+        {
+            ctrl[_index] = _value;
+            ctrl[((_index - (width - 1)) & mask) + (width - 1)] = _value;
+        }
+
+        // True when no probe sequence can have passed over _index as full:
+        // the empty slots on either side are less than a group apart, so any
+        // group covering _index also covers an empty slot. The slot can then
+        // go back to empty instead of becoming a tombstone.
+        template <typename Policy, typename Hash, typename KeyEqual>
+        bool swiss_table<Policy, Hash, KeyEqual>::wasNeverFull(size_type _index) const
+        {
+            const std::uint32_t emptyAfter = swiss_group(ctrl.data() + _index).maskEmpty();
+            const std::uint32_t emptyBefore = swiss_group(ctrl.data() + ((_index - width) & mask)).maskEmpty();
+
+            return emptyBefore != 0 && emptyAfter != 0 &&
+                   lowest_bit(emptyAfter) + (width - 1 - highest_bit(emptyBefore)) < width;
+        }
+
+        template <typename Policy, typename Hash, typename KeyEqual>
+        template <typename K, typename... Args>
+        std::pair<typename swiss_table<Policy, Hash, KeyEqual>::iterator, bool> swiss_table<Policy, Hash, KeyEqual>::emplaceKey(const K &_key, Args &&...args)
+        {
+            const std::uint64_t hash = hashOf(_key);
+
+            size_type i = findIndex(_key, hash);
+            if (i != npos)
+            {
+                return {iteratorAt(i), false};
+            }
+
+            if (mask != 0)
+            {
+                i = findFirstNonFull(hash);
+            }
+
+            if (mask == 0 || (growthLeft == 0 && ctrl[i] != CTRL_DELETED))
+            {
+                // the arguments may refer into this table, so build the value
+                // before the rehash moves everything
+                slot_type value(std::forward<Args>(args)...);
+
+                // mostly tombstones: rebuild at the same size
+                resize(mask != 0 && tableSize <= mask / 32 * 25 ? mask : normalizeCapacity(mask * 2 + 1));
+
+                i = findFirstNonFull(hash);
+                Policy::relocate(slotAt(i), &value);
+            }
+            else
+            {
+                detail::construct_at(slotAt(i), std::forward<Args>(args)...);
+            }
+
+            if (ctrl[i] == CTRL_EMPTY)
+            {
+                growthLeft--;
+            }
+            setCtrl(i, ctrl_t(hash & 0x7f));
+            tableSize++;
+
+            return {iteratorAt(i), true};
+        }
+
+        template <typename Policy, typename Hash, typename KeyEqual>
+        template <typename InputIt, typename>
+        void swiss_table<Policy, Hash, KeyEqual>::insert(InputIt _first, InputIt _last)
+        {
+            if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>)
+            {
+                reserve(tableSize + size_type(std::distance(_first, _last)));
+            }
+
+            for (; _first != _last; ++_first)
+            {
+                insert(*_first);
+            }
+        }
+
+        template <typename Policy, typename Hash, typename KeyEqual>
+        template <typename... Args>
+        std::pair<typename swiss_table<Policy, Hash, KeyEqual>::iterator, bool> swiss_table<Policy, Hash, KeyEqual>::emplace(Args &&...args)
+        {
+            slot_type value(std::forward<Args>(args)...);
+            return emplaceKey(Policy::key(*Policy::element(&value)), Policy::take(&value));
+        }
+
+        template <typename Policy, typename Hash, typename KeyEqual>
+        typename swiss_table<Policy, Hash, KeyEqual>::iterator swiss_table<Policy, Hash, KeyEqual>::erase(const_iterator _position)
+        {
+            const size_type i = size_type(_position.ctrl - ctrl.data());
+
+            iterator next = iteratorAt(i);
+            ++next;
+
+            slotAt(i)->~slot_type();
+            tableSize--;
+
+            if (wasNeverFull(i))
+            {
+                setCtrl(i, CTRL_EMPTY);
+                growthLeft++;
+            }
+            else
+            {
+                setCtrl(i, CTRL_DELETED);
+            }
+
+            return next;
+        }
+
+        template <typename Policy, typename Hash, typename KeyEqual>
+        typename swiss_table<Policy, Hash, KeyEqual>::iterator swiss_table<Policy, Hash, KeyEqual>::erase(const_iterator _first, const_iterator _last)
+        {
+            while (_first != _last)
+            {
+                _first = erase(_first);
+            }
+
+            return iterator(_last.ctrl, _last.slot);
+        }
+
+        template <typename Policy, typename Hash, typename KeyEqual>
+        template <typename K>
+        typename swiss_table<Policy, Hash, KeyEqual>::size_type swiss_table<Policy, Hash, KeyEqual>::erase(const key_arg<K> &_key)
+        {
+            const size_type i = findIndex(_key, hashOf(_key));
+            if (i == npos)
+            {
+                return 0;
+            }
+
+            erase(const_iterator(iteratorAt(i)));
+            return 1;
+        }
+
+        template <typename Policy, typename Hash, typename KeyEqual>
+        void swiss_table<Policy, Hash, KeyEqual>::clear()
+        {
+            if (mask == 0)
+            {
+                return;
+            }
+
+            destroyAll();
+            for (size_type i = 0; i < ctrl.size(); i++)
+            {
+                ctrl[i] = CTRL_EMPTY;
+            }
+            ctrl[mask] = CTRL_SENTINEL;
+
+            tableSize = 0;
+            growthLeft = growthFor(mask);
+        }
+
+        template <typename Policy, typename Hash, typename KeyEqual>
+        void swiss_table<Policy, Hash, KeyEqual>::swap(swiss_table &_other) noexcept
+        {
+            std::swap(ctrl, _other.ctrl);
+            std::swap(slots, _other.slots);
+            std::swap(mask, _other.mask);
+            std::swap(tableSize, _other.tableSize);
+            std::swap(growthLeft, _other.growthLeft);
+            std::swap(hashFn, _other.hashFn);
+            std::swap(equalFn, _other.equalFn);
+        }
+
+        // moves every element into fresh arrays of _capacity slots; if an
+        // element can only be copied and a copy throws, the table is unchanged
+        template <typename Policy, typename Hash, typename KeyEqual>
+        void swiss_table<Policy, Hash, KeyEqual>::resize(size_type _capacity)
+        {
+            ds::vector<ctrl_t> oldCtrl(_capacity + width, CTRL_EMPTY);
+            ds::vector<raw_slot> oldSlots(_capacity);
+            const size_type oldMask = mask;
+
+            // the fresh arrays go in place and the current ones become old
+            std::swap(ctrl, oldCtrl);
+            std::swap(slots, oldSlots);
+            mask = _capacity;
+            ctrl[mask] = CTRL_SENTINEL;
+
+            size_type i = 0;
+            try
+            {
+                for (; i < oldMask; i++)
+                {
+                    if (oldCtrl[i] >= 0)
+                    {
+                        slot_type *from = slotIn(oldSlots, i);
+                        const std::uint64_t hash = hashOf(Policy::key(*Policy::element(from)));
+                        const size_type to = findFirstNonFull(hash);
+
+                        Policy::relocate(slotAt(to), from);
+                        setCtrl(to, ctrl_t(hash & 0x7f));
+                    }
+                }
+            }
+            catch (...)
+            {
+                destroyAll();
+                std::swap(ctrl, oldCtrl);
+                std::swap(slots, oldSlots);
+                mask = oldMask;
+                throw;
+            }
+
+            for (i = 0; i < oldMask; i++)
+            {
+                if (oldCtrl[i] >= 0)
+                {
+                    slotIn(oldSlots, i)->~slot_type();
+                }
+            }
+
+            growthLeft = growthFor(mask) - tableSize;
+        }
+
+        template <typename Policy, typename Hash, typename KeyEqual>
+        void swiss_table<Policy, Hash, KeyEqual>::destroyAll() noexcept
+        {
+            if constexpr (!std::is_trivially_destructible_v<value_type>)
+            {
+                for (size_type i = 0; i < mask; i++)
+                {
+                    if (ctrl[i] >= 0)
+                    {
+                        slotAt(i)->~slot_type();
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+
+namespace ds
+{
+    namespace detail
+    {
+        // Per-thread records for the reclamation schemes live in a list that
+        // only grows, so a scan never meets a freed record. Record needs an
+        // atomic<bool> inUse, true on construction, and a next pointer. A
+        // record handed back by clearing inUse goes to the next thread that
+        // asks. Lock-free.
+        template <typename Record>
+        Record *acquire_record(std::atomic<Record *> &_head)
+        {
+            for (Record *r = _head.load(std::memory_order_acquire); r != nullptr; r = r->next)
+            {
+                bool expected = false;
+                if (!r->inUse.load(std::memory_order_relaxed) && r->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                {
+                    return r;
+                }
+            }
+
+            Record *r = new Record;
+            r->next = _head.load(std::memory_order_relaxed);
+            while (!_head.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+            return r;
+        }
+
+        // only once no thread can touch the list any more
+        template <typename Record>
+        void free_records(std::atomic<Record *> &_head)
+        {
+            for (Record *r = _head.exchange(nullptr); r != nullptr;)
+            {
+                Record *next = r->next;
+                delete r;
+                r = next;
+            }
+        }
+    }
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+// Lifetime tracing for the containers. Off by default so the containers
+// can be timed; build with -DDS_ENABLE_TRACE to print every call.
+
+#ifdef DS_ENABLE_TRACE
+#include <iostream>
+#define DS_TRACE(message) (std::cout << message)
+#else
+#define DS_TRACE(message) ((void)0)
+#endif
@@ -1,12 +1,22 @@
 #pragma once
 
 #include <cstddef>
+#include <functional>
 #include <utility>
-#include <iostream>
 #include <new>
 #include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
 
+#include "memory.hpp"
 #include "normal_iterator.hpp"
+#include "parallel.hpp"
+#include "stats.hpp"
+#include "trace.hpp"
+
+#ifdef DS_ENABLE_STATS
+#include <typeinfo>
+#endif
 
 namespace ds
 {
@@ -26,83 +36,182 @@ namespace ds
         using const_iterator = NormalIterator<const_pointer, vector>;
 
         // constructors
-        vector() noexcept;
-        explicit vector(size_type _count);
-        vector(size_type count, const T &_value);
-        vector(const vector &_other);
-        vector(vector &&_temp) noexcept;
-        vector(std::initializer_list<T> _li);
+        DS_CONSTEXPR20 vector() noexcept;
+        DS_CONSTEXPR20 explicit vector(size_type _count);
+        DS_CONSTEXPR20 vector(size_type count, const T &_value);
+        DS_CONSTEXPR20 vector(const vector &_other);
+        DS_CONSTEXPR20 vector(vector &&_temp) noexcept;
+        DS_CONSTEXPR20 vector(std::initializer_list<T> _li);
+
+        // parallel constructors: each worker constructs and first-touches its
+        // own part of the buffer (see ds::parallel_partition)
+        vector(size_type _count, parallel_t _policy);
+        vector(size_type _count, const T &_value, parallel_t _policy);
 
         // destructors
-        ~vector() noexcept;
+        DS_CONSTEXPR20 ~vector() noexcept;
 
         // operator=
-        vector &operator=(const vector<T> &_other);
-        vector &operator=(vector<T> &&_other) noexcept;
+        DS_CONSTEXPR20 vector &operator=(const vector<T> &_other);
+        DS_CONSTEXPR20 vector &operator=(vector<T> &&_other) noexcept;
 
         // element access
-        reference at(size_type _index);
-        const_reference at(size_type _index) const;
+        DS_CONSTEXPR20 reference at(size_type _index);
+        DS_CONSTEXPR20 const_reference at(size_type _index) const;
+
+        DS_CONSTEXPR20 reference operator[](size_type _index) { return *(array + _index); };
+        DS_CONSTEXPR20 const_reference operator[](size_type _index) const { return *(array + _index); };
 
-        reference operator[](size_type _index) { return *(array + _index); };
-        const_reference operator[](size_type _index) const { return *(array + _index); };
+        DS_CONSTEXPR20 reference front() { return *array; };
+        DS_CONSTEXPR20 const_reference front() const { return *array; };
 
-        reference front() { return *array; };
-        const_reference front() const { return *array; };
+        DS_CONSTEXPR20 reference back() { return *(array + vectorSize - 1); };
+        DS_CONSTEXPR20 const_reference back() const { return *(array + vectorSize - 1); };
 
-        reference back() { return *(array + vectorSize - 1); };
-        const_reference back() const { return *(array + vectorSize - 1); };
+        DS_CONSTEXPR20 pointer data() { return array; }
+        DS_CONSTEXPR20 const_pointer data() const { return array; }
 
         // iterators
-        iterator begin() { return iterator(array); }
-        const_iterator begin() const { return const_iterator(array); }
+        DS_CONSTEXPR20 iterator begin() { return iterator(array); }
+        DS_CONSTEXPR20 const_iterator begin() const { return const_iterator(array); }
 
-        iterator end() { return iterator(array + vectorSize); }
-        const_iterator end() const { return const_iterator(array + vectorSize); }
+        DS_CONSTEXPR20 iterator end() { return iterator(array + vectorSize); }
+        DS_CONSTEXPR20 const_iterator end() const { return const_iterator(array + vectorSize); }
 
-        const_iterator cbegin() const { return const_iterator(array); }
-        const_iterator cend() const { return const_iterator(array + vectorSize); }
+        DS_CONSTEXPR20 const_iterator cbegin() const { return const_iterator(array); }
+        DS_CONSTEXPR20 const_iterator cend() const { return const_iterator(array + vectorSize); }
 
         // capacity
-        size_type size() { return vectorSize; }
-        size_type capacity() { return reservedSize; }
-        bool empty() { return vectorSize == 0; };
-        void reserve(size_type new_cap);
-        void shrink_to_fit();
+        DS_CONSTEXPR20 size_type size() const { return vectorSize; }
+        DS_CONSTEXPR20 size_type capacity() const { return reservedSize; }
+        DS_CONSTEXPR20 bool empty() const { return vectorSize == 0; };
+        DS_CONSTEXPR20 void reserve(size_type new_cap);
+        void reserve(size_type new_cap, parallel_t _policy);
+        DS_CONSTEXPR20 void shrink_to_fit();
 
         // modifiers
-        void clear();
-        iterator insert(const_iterator _position, const T &_value);
-        iterator insert(const_iterator _position, T &&_value);
-        iterator insert(const_iterator _position, size_type _count, const T &_value_);
-        iterator insert(const_iterator _position, const std::initializer_list<T> _li);
+        DS_CONSTEXPR20 void clear();
+        DS_CONSTEXPR20 void assign(size_type _count, const T &_value);
+        void assign(size_type _count, const T &_value, parallel_t _policy);
+        DS_CONSTEXPR20 iterator insert(const_iterator _position, const T &_value);
+        DS_CONSTEXPR20 iterator insert(const_iterator _position, T &&_value);
+        DS_CONSTEXPR20 iterator insert(const_iterator _position, size_type _count, const T &_value_);
+        DS_CONSTEXPR20 iterator insert(const_iterator _position, const std::initializer_list<T> _li);
 
         template <typename... Args>
-        iterator emplace(const_iterator _position, Args &&...args);
+        DS_CONSTEXPR20 iterator emplace(const_iterator _position, Args &&...args);
+
+        DS_CONSTEXPR20 iterator erase(const_iterator _position);
+        DS_CONSTEXPR20 iterator erase(const_iterator _first, const_iterator _last);
+        DS_CONSTEXPR20 iterator unordered_erase(const_iterator _position);
+
+        DS_CONSTEXPR20 void push_back(const T &_value);
+        DS_CONSTEXPR20 void push_back(T &&_value);
+        DS_CONSTEXPR20 void pop_back();
+
+        // buffer hand-off: adopt takes over _data, whose first _size elements
+        // are constructed, and frees it with _deleter once done with it;
+        // release gives up the buffer without touching the elements
+        struct buffer
+        {
+            pointer data = nullptr;
+            size_type size = 0;
+            size_type capacity = 0;
+            buffer_deleter<T> deleter;
+        };
 
-        iterator erase(iterator _position);
+        template <typename Deleter>
+        void adopt(pointer _data, size_type _size, size_type _capacity, Deleter &&_deleter);
+        DS_CONSTEXPR20 void adopt(pointer _data, size_type _size, size_type _capacity);
+        DS_CONSTEXPR20 void adopt(buffer &&_buffer);
+        DS_CONSTEXPR20 buffer release() noexcept;
 
-        void push_back(const T &_value);
-        void push_back(T &&_value);
-        void pop_back();
+        // telemetry
+        container_stats stats() const;
 
     private:
-        pointer array;
+        pointer array = nullptr;
 
         size_type reservedSize = 0;
         size_type vectorSize = 0;
 
-        inline void reallocate();
+        // how to free array; default for buffers allocated here
+        buffer_deleter<T> bufferDeleter;
+
+#ifdef DS_ENABLE_STATS
+        detail::stats_record statsRecord{"ds::vector", typeid(T)};
+#endif
+
+        DS_CONSTEXPR20 void reallocate(size_type _newCapacity);
+
+        DS_CONSTEXPR20 bool pointsInto(const T *_p, size_type _first, size_type _last) const;
+        DS_CONSTEXPR20 void freeBuffer() noexcept;
+
+        DS_CONSTEXPR20 void statsSync() noexcept;
+        DS_CONSTEXPR20 void statsGrowth(size_type _moved) noexcept;
+
+        template <typename... Args>
+        DS_CONSTEXPR20 void reallocateInsert(size_type _index, Args &&...args);
+
+        template <typename Value>
+        DS_CONSTEXPR20 void insertValues(size_type _index, size_type _count, Value &&_value);
+
+        friend struct snapshot_access;
     };
 
     template <typename T>
-    void vector<T>::reallocate()
+    DS_CONSTEXPR20 void vector<T>::reallocate(size_type _newCapacity)
     {
-        pointer tempArray = static_cast<T *>(::operator new(reservedSize * sizeof(T)));
+        pointer tempArray = detail::allocate<T>(_newCapacity);
 
         for (size_type i = 0; i < vectorSize; i++)
         {
-            new (tempArray + i) T(std::move(array[i]));
+            detail::construct_at(tempArray + i, std::move(array[i]));
+        }
+
+        for (size_type i = 0; i < vectorSize; i++)
+        {
+            array[i].~T();
+        }
+
+        statsGrowth(vectorSize);
+
+        freeBuffer();
+
+        array = tempArray;
+        reservedSize = _newCapacity;
+        statsSync();
+    }
+
+    // Grows the buffer and constructs the new element at _index directly in
+    // the new one before relocating the others around it, so args may refer
+    // to elements of this vector.
+    template <typename T>
+    template <typename... Args>
+    DS_CONSTEXPR20 void vector<T>::reallocateInsert(size_type _index, Args &&...args)
+    {
+        const size_type newCapacity = reservedSize == 0 ? 1 : reservedSize * 2;
+
+        pointer tempArray = detail::allocate<T>(newCapacity);
+
+        try
+        {
+            detail::construct_at(tempArray + _index, std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            detail::deallocate(tempArray, newCapacity);
+            throw;
+        }
+
+        for (size_type i = 0; i < _index; i++)
+        {
+            detail::construct_at(tempArray + i, std::move(array[i]));
+        }
+
+        for (size_type i = _index; i < vectorSize; i++)
+        {
+            detail::construct_at(tempArray + i + 1, std::move(array[i]));
         }
 
         for (size_type i = 0; i < vectorSize; i++)
@@ -110,190 +219,402 @@ namespace ds
             array[i].~T();
         }
 
-        ::operator delete(array);
+        statsGrowth(vectorSize);
+
+        freeBuffer();
 
         array = tempArray;
+        reservedSize = newCapacity;
+        vectorSize++;
+        statsSync();
+    }
+
+    // whether _p points at one of the elements [_first, _last)
+    template <typename T>
+    DS_CONSTEXPR20 bool vector<T>::pointsInto(const T *_p, size_type _first, size_type _last) const
+    {
+#ifdef DS_HAS_CONSTEXPR_VECTOR
+        // ordering unrelated pointers is not a constant expression
+        if (std::is_constant_evaluated())
+        {
+            for (size_type i = _first; i < _last; i++)
+            {
+                if (_p == array + i)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+#endif
+        return !std::less<const T *>()(_p, array + _first) && std::less<const T *>()(_p, array + _last);
+    }
+
+    // frees array through whoever provided it and goes back to the allocator
+    template <typename T>
+    DS_CONSTEXPR20 void vector<T>::freeBuffer() noexcept
+    {
+        if (array != nullptr)
+        {
+            bufferDeleter(array, reservedSize);
+        }
+
+        bufferDeleter = buffer_deleter<T>();
+    }
+
+    template <typename T>
+    DS_CONSTEXPR20 void vector<T>::statsSync() noexcept
+    {
+#ifdef DS_ENABLE_STATS
+        statsRecord.set_size(reservedSize * sizeof(T), vectorSize * sizeof(T));
+#endif
+    }
+
+    // counts a move to a new buffer; the first allocation is not a reallocation
+    template <typename T>
+    DS_CONSTEXPR20 void vector<T>::statsGrowth(size_type _moved) noexcept
+    {
+#ifdef DS_ENABLE_STATS
+        if (array != nullptr)
+        {
+            statsRecord.add_growth(_moved * sizeof(T));
+        }
+#else
+        (void)_moved;
+#endif
+    }
+
+    template <typename T>
+    container_stats vector<T>::stats() const
+    {
+#ifdef DS_ENABLE_STATS
+        container_stats s = statsRecord.snapshot();
+#else
+        container_stats s;
+#endif
+        s.bytes_reserved = reservedSize * sizeof(T);
+        s.bytes_in_use = vectorSize * sizeof(T);
+        return s;
     }
 
     // default constructor
     template <typename T>
-    vector<T>::vector() noexcept
+    DS_CONSTEXPR20 vector<T>::vector() noexcept
     {
-        std::cout << "default constructor called " << this << "\n";
-        array = static_cast<T *>(::operator new(reservedSize * sizeof(T)));
+        DS_TRACE("default constructor called " << this << "\n");
     }
 
     // default destructor
     template <typename T>
-    vector<T>::~vector() noexcept
+    DS_CONSTEXPR20 vector<T>::~vector() noexcept
     {
-        std::cout << "default destructor called" << this << "\n";
+        DS_TRACE("default destructor called" << this << "\n");
 
         for (size_type i = 0; i < vectorSize; ++i)
         {
             array[i].~T();
         }
 
-        ::operator delete(array);
+        freeBuffer();
     }
 
     // parameterised constructor
     template <typename T>
-    vector<T>::vector(size_type _count) : reservedSize(_count),
+    DS_CONSTEXPR20 vector<T>::vector(size_type _count) : reservedSize(_count),
                                           vectorSize(_count)
     {
-        std::cout << "parameterized constructor (size_type n) called " << this << "\n";
+        DS_TRACE("parameterized constructor (size_type n) called " << this << "\n");
 
-        array = static_cast<T *>(::operator new(reservedSize * sizeof(T)));
+        array = detail::allocate<T>(reservedSize);
 
         for (size_type i = 0; i < vectorSize; i++)
         {
-            new (array + i) T();
+            detail::construct_at(array + i);
         }
+
+        statsSync();
     }
 
     // parameterised constructor
     template <typename T>
-    vector<T>::vector(size_type _count, const T &_value) : reservedSize(_count),
+    DS_CONSTEXPR20 vector<T>::vector(size_type _count, const T &_value) : reservedSize(_count),
                                                            vectorSize(_count)
     {
-        std::cout << "parameterized constructor (size_type n, const T& value) called\n";
+        DS_TRACE("parameterized constructor (size_type n, const T& value) called\n");
 
-        array = static_cast<T *>(::operator new(reservedSize * sizeof(T)));
+        array = detail::allocate<T>(reservedSize);
 
         for (size_type i = 0; i < vectorSize; i++)
         {
-            new (array + i) T(_value);
+            detail::construct_at(array + i, _value);
         }
+
+        statsSync();
     }
 
     // initializer list constructor
     template <typename T>
-    vector<T>::vector(std::initializer_list<T> _li) : reservedSize(_li.size())
+    DS_CONSTEXPR20 vector<T>::vector(std::initializer_list<T> _li) : reservedSize(_li.size())
     {
 
-        std::cout << "initializer list constructor called" << this << "\n";
+        DS_TRACE("initializer list constructor called" << this << "\n");
 
-        array = static_cast<T *>(::operator new(reservedSize * sizeof(T)));
+        array = detail::allocate<T>(reservedSize);
 
         for (typename std::initializer_list<T>::const_iterator it = _li.begin(); it != _li.end(); it++)
         {
-            new (array + vectorSize) T(*it);
+            detail::construct_at(array + vectorSize, *it);
             ++vectorSize;
         }
+
+        statsSync();
+    }
+
+    // parallel constructor
+    template <typename T>
+    vector<T>::vector(size_type _count, parallel_t _policy)
+    {
+        array = detail::allocate<T>(_count);
+
+        try
+        {
+            detail::parallel_construct(array, _count, _count, _policy, [](pointer _slot, size_type)
+                                       { detail::construct_at(_slot); });
+        }
+        catch (...)
+        {
+            detail::deallocate(array, _count);
+            throw;
+        }
+
+        reservedSize = vectorSize = _count;
+        statsSync();
+    }
+
+    // parallel constructor
+    template <typename T>
+    vector<T>::vector(size_type _count, const T &_value, parallel_t _policy)
+    {
+        array = detail::allocate<T>(_count);
+
+        try
+        {
+            detail::parallel_construct(array, _count, _count, _policy, [&_value](pointer _slot, size_type)
+                                       { detail::construct_at(_slot, _value); });
+        }
+        catch (...)
+        {
+            detail::deallocate(array, _count);
+            throw;
+        }
+
+        reservedSize = vectorSize = _count;
+        statsSync();
     }
 
     // copy constructor
     template <typename T>
-    vector<T>::vector(const vector<T> &_other) : reservedSize(_other.reservedSize),
+    DS_CONSTEXPR20 vector<T>::vector(const vector<T> &_other) : reservedSize(_other.vectorSize),
                                                  vectorSize(_other.vectorSize)
     {
 
-        std::cout << "copy constructor called " << this << "\n";
+        DS_TRACE("copy constructor called " << this << "\n");
 
-        array = static_cast<T *>(::operator new(reservedSize * sizeof(T)));
+        array = detail::allocate<T>(reservedSize);
 
         for (size_type i = 0; i < vectorSize; ++i)
         {
-            new (array + i) T(_other[i]);
+            detail::construct_at(array + i, _other[i]);
         }
+
+        statsSync();
     }
 
     // move constructor
     template <typename T>
-    vector<T>::vector(vector<T> &&_temp) noexcept : array(_temp.array),
+    DS_CONSTEXPR20 vector<T>::vector(vector<T> &&_temp) noexcept : array(_temp.array),
                                                     reservedSize(_temp.reservedSize),
-                                                    vectorSize(_temp.vectorSize)
+                                                    vectorSize(_temp.vectorSize),
+                                                    bufferDeleter(std::move(_temp.bufferDeleter))
     {
-        std::cout << "move constructor called\n";
+        DS_TRACE("move constructor called\n");
         _temp.array = nullptr;
         _temp.vectorSize = _temp.reservedSize = 0;
+
+        statsSync();
+        _temp.statsSync();
     }
 
     // copy assignment
     template <typename T>
-    vector<T> &vector<T>::operator=(const vector<T> &_other)
+    DS_CONSTEXPR20 vector<T> &vector<T>::operator=(const vector<T> &_other)
     {
 
-        std::cout << "copy assignment called\n";
+        DS_TRACE("copy assignment called\n");
 
         if (this == &_other)
         {
             return *this;
         }
 
-        if (vectorSize < _other.vectorSize)
+        if (_other.vectorSize > reservedSize)
         {
+            T *tempArray = detail::allocate<T>(_other.vectorSize);
 
-            for (size_type i = 0; i < vectorSize; i++)
+            size_type constructed = 0;
+
+            try
             {
-                array[i].~T();
+                for (; constructed < _other.vectorSize; constructed++)
+                {
+                    detail::construct_at(tempArray + constructed, _other[constructed]);
+                }
             }
+            catch (...)
+            {
+                for (size_type i = 0; i < constructed; i++)
+                {
+                    tempArray[i].~T();
+                }
 
-            ::operator delete(array);
-
-            T *tempArray = static_cast<T *>(::operator new(_other.reservedSize * sizeof(T)));
+                detail::deallocate(tempArray, _other.vectorSize);
+                throw;
+            }
 
-            for (size_type i = 0; i < _other.vectorSize; i++)
+            for (size_type i = 0; i < vectorSize; i++)
             {
-                new (tempArray + i) T(_other[i]);
+                array[i].~T();
             }
 
-            array = tempArray;
+            freeBuffer();
 
-            reservedSize = _other.reservedSize;
-            vectorSize = _other.vectorSize;
+            array = tempArray;
+            reservedSize = _other.vectorSize;
         }
         else
         {
-            for (size_type i = 0; i < _other.vectorSize; i++)
+            // reuse the buffer: assign over live elements, construct the rest
+            const size_type common = vectorSize < _other.vectorSize ? vectorSize : _other.vectorSize;
+
+            for (size_type i = 0; i < common; i++)
             {
                 array[i] = _other[i];
             }
 
+            for (size_type i = common; i < _other.vectorSize; i++)
+            {
+                detail::construct_at(array + i, _other[i]);
+            }
+
             for (size_type i = _other.vectorSize; i < vectorSize; i++)
             {
                 array[i].~T();
             }
-
-            vectorSize = _other.vectorSize;
-            reservedSize = _other.reservedSize;
         }
 
+        vectorSize = _other.vectorSize;
+        statsSync();
+
         return *this;
     }
 
     // move assignment
     template <typename T>
-    vector<T> &vector<T>::operator=(vector<T> &&_other) noexcept
+    DS_CONSTEXPR20 vector<T> &vector<T>::operator=(vector<T> &&_other) noexcept
     {
-        std::cout << "Move assignment called\n";
+        DS_TRACE("Move assignment called\n");
 
         if (this == &_other)
         {
             return *this;
         }
 
-        for (size_type i = 0; i < reservedSize; ++i)
+        for (size_type i = 0; i < vectorSize; ++i)
         {
             array[i].~T();
         }
 
-        ::operator delete(array);
+        freeBuffer();
 
         array = _other.array;
         vectorSize = _other.vectorSize;
         reservedSize = _other.reservedSize;
+        bufferDeleter = std::move(_other.bufferDeleter);
 
         _other.array = nullptr;
         _other.vectorSize = 0;
         _other.reservedSize = 0;
 
+        statsSync();
+        _other.statsSync();
+
         return *this;
     }
 
+    // Takes over a buffer from a decoder, mmap or another library without
+    // copying. _deleter(_data, _capacity) or _deleter(_data) frees it after
+    // the vector has destroyed the elements, either when the vector dies or
+    // when it moves to a bigger buffer. Nothing is taken over if this throws.
+    template <typename T>
+    template <typename Deleter>
+    void vector<T>::adopt(pointer _data, size_type _size, size_type _capacity, Deleter &&_deleter)
+    {
+        adopt(buffer{_data, _size, _capacity, buffer_deleter<T>(std::forward<Deleter>(_deleter))});
+    }
+
+    // _data must come from std::allocator<T>, e.g. another vector's release()
+    template <typename T>
+    DS_CONSTEXPR20 void vector<T>::adopt(pointer _data, size_type _size, size_type _capacity)
+    {
+        adopt(buffer{_data, _size, _capacity, buffer_deleter<T>()});
+    }
+
+    template <typename T>
+    DS_CONSTEXPR20 void vector<T>::adopt(buffer &&_buffer)
+    {
+        if (_buffer.size > _buffer.capacity)
+        {
+            throw std::invalid_argument("ds::vector - adopted size exceeds capacity");
+        }
+
+        if (_buffer.data == nullptr && _buffer.capacity != 0)
+        {
+            throw std::invalid_argument("ds::vector - adopted buffer is null");
+        }
+
+        clear();
+        freeBuffer();
+
+        array = _buffer.data;
+        vectorSize = _buffer.size;
+        reservedSize = _buffer.capacity;
+        bufferDeleter = std::move(_buffer.deleter);
+
+        _buffer.data = nullptr;
+        _buffer.size = _buffer.capacity = 0;
+
+        statsSync();
+    }
+
+    // The caller owns the returned elements and storage: destroy the first
+    // size elements, then call deleter(data, capacity). The vector is left
+    // empty with no buffer.
     template <typename T>
-    typename vector<T>::reference vector<T>::at(size_type _index)
+    DS_CONSTEXPR20 typename vector<T>::buffer vector<T>::release() noexcept
+    {
+        buffer released{array, vectorSize, reservedSize, std::move(bufferDeleter)};
+
+        array = nullptr;
+        vectorSize = reservedSize = 0;
+        bufferDeleter = buffer_deleter<T>();
+
+        statsSync();
+
+        return released;
+    }
+
+    template <typename T>
+    DS_CONSTEXPR20 typename vector<T>::reference vector<T>::at(size_type _index)
     {
         if (_index >= vectorSize)
         {
@@ -303,7 +624,7 @@ namespace ds
     }
 
     template <typename T>
-    typename vector<T>::const_reference vector<T>::at(size_type _index) const
+    DS_CONSTEXPR20 typename vector<T>::const_reference vector<T>::at(size_type _index) const
     {
         if (_index >= vectorSize)
         {
@@ -313,53 +634,46 @@ namespace ds
     }
 
     template <typename T>
-    void vector<T>::push_back(const T &_value)
+    DS_CONSTEXPR20 void vector<T>::push_back(const T &_value)
     {
-        if (reservedSize == 0)
-        {
-            reservedSize = 1;
-            reallocate();
-        }
-        else if (vectorSize == reservedSize)
+        if (vectorSize == reservedSize)
         {
-            reservedSize = reservedSize * 2;
-            reallocate();
+            reallocateInsert(vectorSize, _value);
+            return;
         }
 
-        new (array + vectorSize) T(_value);
+        detail::construct_at(array + vectorSize, _value);
         vectorSize++;
+        statsSync();
     }
 
     template <typename T>
-    void vector<T>::push_back(T &&_value)
+    DS_CONSTEXPR20 void vector<T>::push_back(T &&_value)
     {
-        if (reservedSize == 0)
-        {
-            reservedSize = 1;
-            reallocate();
-        }
-        else if (vectorSize == reservedSize)
+        if (vectorSize == reservedSize)
         {
-            reservedSize = reservedSize * 2;
-            reallocate();
+            reallocateInsert(vectorSize, std::move(_value));
+            return;
         }
 
-        new (array + vectorSize) T(std::move(_value));
+        detail::construct_at(array + vectorSize, std::move(_value));
         vectorSize++;
+        statsSync();
     }
 
     template <typename T>
-    void vector<T>::pop_back()
+    DS_CONSTEXPR20 void vector<T>::pop_back()
     {
         if (vectorSize != 0)
         {
             --vectorSize;
             array[vectorSize].~T();
+            statsSync();
         }
     }
 
     template <typename T>
-    void vector<T>::clear()
+    DS_CONSTEXPR20 void vector<T>::clear()
     {
         for (size_type i = 0; i < vectorSize; i++)
         {
@@ -367,345 +681,515 @@ namespace ds
         }
 
         vectorSize = 0;
+        statsSync();
     }
 
     template <typename T>
-    typename vector<T>::iterator vector<T>::insert(vector<T>::const_iterator _position, const T &_value)
+    DS_CONSTEXPR20 void vector<T>::assign(size_type _count, const T &_value)
     {
-        std::cout << "inside insert\n";
+        // _value may be an element of this vector, which clear() destroys
+        if (pointsInto(&_value, 0, vectorSize))
+        {
+            const T copy(_value);
+            assign(_count, copy);
+            return;
+        }
 
-        const size_type insert_index = _position.base() - array;
-        iterator pos = begin() + insert_index; // convert to non-const iterator
+        clear();
 
-        if (vectorSize < reservedSize)
+        if (_count > reservedSize)
         {
-            if (vectorSize != 0)
-            {
-                new (array + vectorSize) T(std::move(array[vectorSize - 1]));
-            }
+            pointer tempArray = detail::allocate<T>(_count);
 
-            for (size_t i = vectorSize - 1; i - 1 >= insert_index; i--)
-            {
-                array[i] = std::move(array[i - 1]);
-            }
+            freeBuffer();
 
-            new (pos.base()) T(_value);
+            array = tempArray;
+            reservedSize = _count;
+        }
 
-            vectorSize++;
+        for (; vectorSize < _count; vectorSize++)
+        {
+            detail::construct_at(array + vectorSize, _value);
         }
 
-        if (vectorSize == reservedSize)
+        statsSync();
+    }
+
+    // Like assign(_count, _value), but a new buffer is filled and
+    // first-touched by the workers; a reused buffer keeps its page placement.
+    template <typename T>
+    void vector<T>::assign(size_type _count, const T &_value, parallel_t _policy)
+    {
+        if (pointsInto(&_value, 0, vectorSize))
         {
-            if (reservedSize == 0)
-            {
-                reservedSize = 1;
-            }
-            else
-            {
-                reservedSize = reservedSize * 2;
-            }
+            const T copy(_value);
+            assign(_count, copy, _policy);
+            return;
+        }
 
-            T *tempArray = static_cast<T *>(::operator new(reservedSize * sizeof(T)));
+        clear();
 
-            for (size_type i = 0; i < insert_index; i++)
-            {
-                new (tempArray + i) T(std::move(array[i]));
-            }
+        if (_count > reservedSize)
+        {
+            pointer tempArray = detail::allocate<T>(_count);
 
-            new (tempArray + insert_index) T(_value);
+            freeBuffer();
 
-            for (size_type i = insert_index; i < vectorSize; i++)
-            {
-                new (tempArray + i + 1) T(std::move(array[i]));
-            }
+            array = tempArray;
+            reservedSize = _count;
+        }
+
+        detail::parallel_construct(array, _count, _count, _policy, [&_value](pointer _slot, size_type)
+                                   { detail::construct_at(_slot, _value); });
+
+        vectorSize = _count;
+        statsSync();
+    }
+
+    template <typename T>
+    DS_CONSTEXPR20 typename vector<T>::iterator vector<T>::insert(vector<T>::const_iterator _position, const T &_value)
+    {
+        DS_TRACE("inside insert\n");
 
-            for (size_t i = 0; i < vectorSize; i++)
+        const size_type insert_index = _position.base() - array;
+
+        if (vectorSize < reservedSize)
+        {
+            if (insert_index == vectorSize)
             {
-                array[i].~T();
+                detail::construct_at(array + vectorSize, _value);
             }
+            else
+            {
+                // _value may be an element of this vector that the shift moves one slot up
+                const T *source = &_value;
+                if (pointsInto(source, insert_index, vectorSize))
+                {
+                    ++source;
+                }
 
-            ::operator delete(array);
+                detail::construct_at(array + vectorSize, std::move(array[vectorSize - 1]));
 
-            array = tempArray;
+                for (size_type i = vectorSize - 1; i > insert_index; i--)
+                {
+                    array[i] = std::move(array[i - 1]);
+                }
 
-            vectorSize++;
+                array[insert_index] = *source;
+            }
+        }
+        else
+        {
+            reallocateInsert(insert_index, _value);
+            return begin() + insert_index;
         }
 
-        pos = begin() + insert_index;
+        vectorSize++;
+        statsSync();
 
-        return pos;
+        return begin() + insert_index;
     }
 
     template <typename T>
-    typename vector<T>::iterator vector<T>::insert(vector<T>::const_iterator _position, T &&_value)
+    DS_CONSTEXPR20 typename vector<T>::iterator vector<T>::insert(vector<T>::const_iterator _position, T &&_value)
     {
         const size_type insert_index = _position.base() - array;
-        iterator pos = begin() + insert_index; // convert to non-const iterator
 
         if (vectorSize < reservedSize)
         {
-            if (vectorSize != 0)
+            if (insert_index == vectorSize)
             {
-                new (array + vectorSize) T(std::move(array[vectorSize - 1]));
+                detail::construct_at(array + vectorSize, std::move(_value));
             }
-
-            for (size_t i = vectorSize - 1; i - 1 >= insert_index; i--)
+            else
             {
-                array[i] = std::move(array[i - 1]);
-            }
+                detail::construct_at(array + vectorSize, std::move(array[vectorSize - 1]));
 
-            new (pos.base()) T(std::move(_value));
+                for (size_type i = vectorSize - 1; i > insert_index; i--)
+                {
+                    array[i] = std::move(array[i - 1]);
+                }
 
-            vectorSize++;
+                array[insert_index] = std::move(_value);
+            }
+        }
+        else
+        {
+            reallocateInsert(insert_index, std::move(_value));
+            return begin() + insert_index;
         }
 
-        if (vectorSize >= reservedSize)
+        vectorSize++;
+        statsSync();
+
+        return begin() + insert_index;
+    }
+
+    // Inserts _count elements at _index, the k-th a copy of _value(k).
+    // Without room, the new elements are constructed in a new buffer first
+    // and the others relocated around them, as in reallocateInsert. With
+    // room, the tail is relocated first: slots past size() are constructed,
+    // live ones move-assigned, working back from the end. _value is only
+    // read after that, so in this case it must already account for the
+    // shift of elements at or after _index.
+    template <typename T>
+    template <typename Value>
+    DS_CONSTEXPR20 void vector<T>::insertValues(size_type _index, size_type _count, Value &&_value)
+    {
+        const size_type oldSize = vectorSize;
+
+        if (reservedSize - vectorSize < _count)
         {
+            const size_type newCapacity = 2 * reservedSize > vectorSize + _count ? 2 * reservedSize : vectorSize + _count;
+
+            pointer tempArray = detail::allocate<T>(newCapacity);
 
-            if (reservedSize == 0)
+            size_type built = 0;
+            try
             {
-                reservedSize = 1;
+                for (; built < _count; built++)
+                {
+                    detail::construct_at(tempArray + _index + built, _value(built));
+                }
             }
-            else
+            catch (...)
             {
-                reservedSize = reservedSize * 2;
+                for (size_type k = 0; k < built; k++)
+                {
+                    tempArray[_index + k].~T();
+                }
+                detail::deallocate(tempArray, newCapacity);
+                throw;
             }
 
-            T *tempArray = static_cast<T *>(::operator new(reservedSize * sizeof(T)));
-
-            for (size_type i = 0; i < insert_index; i++)
+            for (size_type i = 0; i < _index; i++)
             {
-                new (tempArray + i) T(std::move(array[i]));
+                detail::construct_at(tempArray + i, std::move(array[i]));
             }
 
-            new (tempArray + insert_index) T(std::move(_value));
-
-            for (size_type i = insert_index; i < vectorSize; i++)
+            for (size_type i = _index; i < vectorSize; i++)
             {
-                new (tempArray + i + 1) T(std::move(array[i]));
+                detail::construct_at(tempArray + i + _count, std::move(array[i]));
             }
 
-            for (size_t i = 0; i < vectorSize; i++)
+            for (size_type i = 0; i < vectorSize; i++)
             {
                 array[i].~T();
             }
 
-            ::operator delete(array);
+            statsGrowth(vectorSize);
 
-            array = tempArray;
+            freeBuffer();
 
-            vectorSize++;
+            array = tempArray;
+            reservedSize = newCapacity;
+            vectorSize += _count;
+            statsSync();
+            return;
         }
 
-        pos = begin() + insert_index;
+        const size_type tail = oldSize - _index;
 
-        return pos;
-    }
-
-    template <typename T>
-    typename vector<T>::iterator vector<T>::insert(vector<T>::const_iterator _position, size_type _count, const T &_value)
-    {
-        const size_type insert_index = _position.base() - array;
-        iterator pos = begin() + insert_index; // convert to non-const iterator
-
-        if (vectorSize + _count - 1 < reservedSize)
+        if (tail > _count)
         {
-            for (size_t i = vectorSize - 1 + _count; i - _count >= insert_index; i--)
+            // the last _count elements move into raw slots, the rest of the
+            // tail shifts up over live ones, and the new values are assigned
+            for (size_type i = 0; i < _count; i++)
             {
-                array[i] = T(std::move(array[i - _count]));
+                detail::construct_at(array + oldSize + i, std::move(array[oldSize - _count + i]));
             }
+            vectorSize += _count;
 
-            for (size_t i = 0; i < _count; i++)
+            for (size_type i = oldSize; i-- > _index + _count;)
             {
-                new (pos.base()) T(_value);
-                pos++;
+                array[i] = std::move(array[i - _count]);
             }
-        }
 
-        if (vectorSize + _count - 1 >= reservedSize)
+            for (size_type k = 0; k < _count; k++)
+            {
+                array[_index + k] = _value(k);
+            }
+        }
+        else
         {
-            reservedSize = vectorSize + _count;
-
-            T *tempArray = static_cast<T *>(::operator new(reservedSize * sizeof(T)));
-
-            for (size_type i = 0; i < insert_index; i++)
+            // the whole tail lands in raw slots, and so do the new values
+            // past the old end
+            for (size_type i = 0; i < tail; i++)
             {
-                new (tempArray + i) T(std::move(array[i]));
+                detail::construct_at(array + _index + _count + i, std::move(array[_index + i]));
             }
 
-            for (size_t i = 0; i < _count; i++)
+            size_type built = tail;
+            try
             {
-                new (tempArray + insert_index + i) T(_value);
+                for (; built < _count; built++)
+                {
+                    detail::construct_at(array + _index + built, _value(built));
+                }
             }
-
-            for (size_type i = insert_index; i < vectorSize; i++)
+            catch (...)
             {
-                new (tempArray + i + _count) T(std::move(array[i]));
+                // move the tail back so the vector is unchanged
+                for (size_type k = tail; k < built; k++)
+                {
+                    array[_index + k].~T();
+                }
+                for (size_type i = 0; i < tail; i++)
+                {
+                    array[_index + i] = std::move(array[_index + _count + i]);
+                    array[_index + _count + i].~T();
+                }
+                throw;
             }
+            vectorSize += _count;
 
-            for (size_t i = 0; i < vectorSize; i++)
+            for (size_type k = 0; k < tail; k++)
             {
-                array[i].~T();
+                array[_index + k] = _value(k);
             }
+        }
 
-            ::operator delete(array);
+        statsSync();
+    }
 
-            array = tempArray;
+    template <typename T>
+    DS_CONSTEXPR20 typename vector<T>::iterator vector<T>::insert(vector<T>::const_iterator _position, size_type _count, const T &_value)
+    {
+        const size_type insert_index = _position.base() - array;
+
+        if (_count == 0)
+        {
+            return begin() + insert_index;
         }
 
-        vectorSize = vectorSize + _count;
+        // _value may be an element of this vector that an in-place insert
+        // moves _count slots up
+        const T *source = &_value;
+        if (reservedSize - vectorSize >= _count && pointsInto(source, insert_index, vectorSize))
+        {
+            source += _count;
+        }
 
-        pos = begin() + insert_index;
+        insertValues(insert_index, _count, [source](size_type) -> const T & { return *source; });
 
-        return pos;
+        return begin() + insert_index;
     }
 
     template <typename T>
-    typename vector<T>::iterator vector<T>::insert(vector<T>::const_iterator _position, const std::initializer_list<T> _li)
+    DS_CONSTEXPR20 typename vector<T>::iterator vector<T>::insert(vector<T>::const_iterator _position, const std::initializer_list<T> _li)
     {
         const size_type insert_index = _position.base() - array;
-        iterator pos = begin() + insert_index; // convert to non-const iterator
-        size_t count = _li.size();
 
-        if (vectorSize + count - 1 < reservedSize)
+        if (_li.size() != 0)
         {
-            for (size_t i = vectorSize - 1 + count; i - count >= insert_index; i--)
-            {
-                array[i] = T(std::move(array[i - count]));
-            }
-
-            for (typename std::initializer_list<T>::const_iterator it = _li.begin(); it != _li.end(); it++)
-            {
-                new (pos.base()) T(std::move(*it));
-                pos++;
-            }
+            insertValues(insert_index, _li.size(), [&_li](size_type _k) -> const T & { return _li.begin()[_k]; });
         }
 
-        if (vectorSize + count - 1 >= reservedSize)
-        {
+        return begin() + insert_index;
+    }
 
-            reservedSize = reservedSize * 2;
+    // Constructs the element in its final slot; no temporary is made. When
+    // no reallocation is needed, args must not refer to elements at or after
+    // _position, since those are shifted before construction.
+    template <typename T>
+    template <typename... Args>
+    DS_CONSTEXPR20 typename vector<T>::iterator vector<T>::emplace(const_iterator _position, Args &&...args)
+    {
+        const size_type insert_index = _position.base() - array;
 
-            T *tempArray = static_cast<T *>(::operator new(reservedSize * sizeof(T)));
+        if (vectorSize == reservedSize)
+        {
+            reallocateInsert(insert_index, std::forward<Args>(args)...);
+            return begin() + insert_index;
+        }
 
-            for (size_type i = 0; i < insert_index; i++)
-            {
-                new (tempArray + i) T(std::move(array[i]));
-            }
+        if (insert_index == vectorSize)
+        {
+            detail::construct_at(array + vectorSize, std::forward<Args>(args)...);
+        }
+        else
+        {
+            detail::construct_at(array + vectorSize, std::move(array[vectorSize - 1]));
 
-            for (size_t i = 0; i < count; i++)
+            for (size_type i = vectorSize - 1; i > insert_index; i--)
             {
-                new (tempArray + insert_index + i) T(std::move(*(_li.begin() + i)));
+                array[i] = std::move(array[i - 1]);
             }
 
-            for (size_type i = insert_index; i < vectorSize; i++)
-            {
-                new (tempArray + i + count) T(std::move(array[i]));
-            }
+            array[insert_index].~T();
 
-            for (size_t i = 0; i < vectorSize; i++)
+            try
             {
-                array[i].~T();
+                detail::construct_at(array + insert_index, std::forward<Args>(args)...);
             }
+            catch (...)
+            {
+                // close the gap again so the vector is unchanged
+                detail::construct_at(array + insert_index, std::move(array[insert_index + 1]));
 
-            ::operator delete(array);
+                for (size_type i = insert_index + 1; i < vectorSize; i++)
+                {
+                    array[i] = std::move(array[i + 1]);
+                }
 
-            array = tempArray;
+                array[vectorSize].~T();
+                throw;
+            }
         }
 
-        vectorSize = vectorSize + count;
-
-        pos = begin() + insert_index;
+        vectorSize++;
+        statsSync();
 
-        return pos;
+        return begin() + insert_index;
     }
 
     template <typename T>
-    template <typename... Args>
-    typename vector<T>::iterator vector<T>::emplace(const_iterator _position, Args &&...args)
+    DS_CONSTEXPR20 typename vector<T>::iterator vector<T>::erase(const_iterator _position)
     {
-        const size_type insert_index = _position.base() - array;
-        iterator pos = begin() + insert_index;
+        return erase(_position, _position + 1);
+    }
 
-        T tempObj(std::forward<Args>(args)...);
+    // Shifts the tail down over the range in one pass and destroys the
+    // leftover slots at the end: O(n) moves however many are erased.
+    template <typename T>
+    DS_CONSTEXPR20 typename vector<T>::iterator vector<T>::erase(const_iterator _first, const_iterator _last)
+    {
+        const size_type first_index = _first.base() - array;
+        const size_type count = _last.base() - _first.base();
 
-        if (vectorSize == reservedSize)
+        if (count == 0)
         {
-            if (reservedSize == 0)
-            {
-                reservedSize = 1;
-            }
-            else
-            {
-                reservedSize = reservedSize * 2;
-            }
+            return begin() + first_index;
+        }
 
-            reallocate();
+        for (size_type i = first_index; i + count < vectorSize; i++)
+        {
+            array[i] = std::move(array[i + count]);
         }
 
-        if (insert_index <= vectorSize)
+        for (size_type i = vectorSize - count; i < vectorSize; i++)
         {
-            // construct element at some other place then move assign it at _position
+            array[i].~T();
+        }
 
-            for (size_type i = vectorSize; i - 1 >= insert_index; --i)
-            {
-                array[i] = std::move(array[i - 1]);
-            }
+        vectorSize -= count;
+        statsSync();
 
-            new (array + insert_index) T(std::move(tempObj));
+        return begin() + first_index;
+    }
+
+    // O(1) erase that does not keep order: the last element takes the
+    // erased one's place
+    template <typename T>
+    DS_CONSTEXPR20 typename vector<T>::iterator vector<T>::unordered_erase(const_iterator _position)
+    {
+        const size_type erase_index = _position.base() - array;
+
+        if (erase_index + 1 != vectorSize)
+        {
+            array[erase_index] = std::move(array[vectorSize - 1]);
         }
 
-        vectorSize++;
-        pos = begin() + insert_index;
+        pop_back();
 
-        return pos;
+        return begin() + erase_index;
     }
 
 
     template <typename T>
-    typename vector<T>::iterator vector<T>::erase(vector<T>::iterator _position)
+    DS_CONSTEXPR20 void vector<T>::reserve(vector<T>::size_type new_cap)
+    {
+        if (new_cap > reservedSize)
+        {
+            reallocate(new_cap);
+        }
+    }
+
+    // Moves the elements and first-touches the spare capacity in parallel,
+    // partitioned over new_cap, so a vector filled up to new_cap later has
+    // its pages spread the same way as one built with ds::parallel.
+    template <typename T>
+    void vector<T>::reserve(vector<T>::size_type new_cap, parallel_t _policy)
     {
-        const size_t erase_index = _position.base() - array;
+        if (new_cap <= reservedSize)
+        {
+            return;
+        }
 
-        T backup = array[erase_index]; // If T is cheap to copy
+        pointer tempArray = detail::allocate<T>(new_cap);
 
         try
         {
-            for (size_t i = erase_index; i < vectorSize - 1; ++i)
-                array[i] = std::move(array[i + 1]);
+            detail::parallel_construct(tempArray, vectorSize, new_cap, _policy, [this](pointer _slot, size_type _i)
+                                       { detail::construct_at(_slot, std::move(array[_i])); });
         }
         catch (...)
         {
-            array[erase_index] = std::move(backup); // Rollback
+            detail::deallocate(tempArray, new_cap);
             throw;
         }
 
-        array[vectorSize - 1].~T();
+        for (size_type i = 0; i < vectorSize; i++)
+        {
+            array[i].~T();
+        }
 
-        vectorSize--;
+        statsGrowth(vectorSize);
 
-        return begin() + erase_index;
-    }
+        freeBuffer();
 
+        array = tempArray;
+        reservedSize = new_cap;
+        statsSync();
+    }
 
     template <typename T>
-    void vector<T>::reserve(vector<T>::size_type new_cap)
+    DS_CONSTEXPR20 void vector<T>::shrink_to_fit()
     {
-        if (new_cap > reservedSize)
+        if (reservedSize > vectorSize)
         {
-            reservedSize = new_cap;
-            reallocate();
+            reallocate(vectorSize);
         }
     }
 
-    template <typename T>
-    void vector<T>::shrink_to_fit()
+    // Removes every element matching _pred in a single pass: survivors are
+    // moved down once each and the tail is destroyed. Returns the count removed.
+    template <typename T, typename Pred>
+    DS_CONSTEXPR20 typename vector<T>::size_type erase_if(vector<T> &_vec, Pred _pred)
     {
-        if (reservedSize > vectorSize)
+        auto first = _vec.begin();
+        const auto last = _vec.end();
+
+        while (first != last && !_pred(*first))
+        {
+            ++first;
+        }
+
+        if (first == last)
         {
-            reservedSize = vectorSize;
-            reallocate();
+            return 0;
         }
+
+        auto out = first;
+
+        for (++first; first != last; ++first)
+        {
+            if (!_pred(*first))
+            {
+                *out = std::move(*first);
+                ++out;
+            }
+        }
+
+        const typename vector<T>::size_type removed = last - out;
+        _vec.erase(out, last);
+
+        return removed;
     }
 
-}
\ No newline at end of file
+    template <typename T, typename U>
+    DS_CONSTEXPR20 typename vector<T>::size_type erase(vector<T> &_vec, const U &_value)
+    {
+        return erase_if(_vec, [&_value](const T &_element) { return _element == _value; });
+    }
+}
@@ -1,10 +1,11 @@
 #include <iostream>
 #include "A.hpp"
+#include "../include/ds/trace.hpp"
 
 // default constructor
 A::A()
 {
-    std::cout << "default ctor for A called " << this << "\n";
+    DS_TRACE("default ctor for A called " << this << "\n");
     i = new int;
     f = new float;
     *i = 10;
@@ -14,7 +15,7 @@ A::A()
 // parametrised constructor
 A::A(int in, float fl)
 {
-    std::cout << "Para ctor for A is called " << this << "\n";
+    DS_TRACE("Para ctor for A is called " << this << "\n");
     i = new int;
     f = new float;
 
@@ -25,7 +26,7 @@ A::A(int in, float fl)
 // copy constructor
 A::A(const A &other)
 {
-    std::cout << "copy constructor of A called " << this << "\n";
+    DS_TRACE("copy constructor of A called " << this << "\n");
     i = new int;
     f = new float;
 
@@ -36,7 +37,7 @@ A::A(const A &other)
 // move constructor
 A::A(A &&other)
 {
-    std::cout << "move ctor for A called " << this << "\n";
+    DS_TRACE("move ctor for A called " << this << "\n");
     i = other.i;
     f = other.f;
 
@@ -47,7 +48,7 @@ A::A(A &&other)
 // copy assignment
 A &A::operator=(const A &other)
 {
-    std::cout << "copy assignment of A called " << this << "\n";
+    DS_TRACE("copy assignment of A called " << this << "\n");
     if (this != &other)
     {
         delete f;
@@ -63,7 +64,7 @@ A &A::operator=(const A &other)
 // move assignment
 A &A::operator=(A &&other) noexcept
 {
-    std::cout << "move assignment of A called " << this << "\n";
+    DS_TRACE("move assignment of A called " << this << "\n");
     if (this != &other)
     {
         delete f;
@@ -82,7 +83,7 @@ A &A::operator=(A &&other) noexcept
 // destructor
 A::~A()
 {
-    std::cout << "dtor for A called " << this << "\n";
+    DS_TRACE("dtor for A called " << this << "\n");
     delete f;
     delete i;
 }
@@ -0,0 +1,57 @@
+#include "Counted.hpp"
+
+Counted::Counters Counted::counters;
+
+// default constructor
+Counted::Counted() : value(0)
+{
+    ++counters.defaultConstructs;
+}
+
+// parametrised constructor
+Counted::Counted(int v) : value(v)
+{
+    ++counters.valueConstructs;
+}
+
+// two argument constructor
+Counted::Counted(int a, int b) : value(a + b)
+{
+    ++counters.valueConstructs;
+}
+
+// copy constructor
+Counted::Counted(const Counted &other) : value(other.value)
+{
+    ++counters.copyConstructs;
+}
+
+// move constructor
+Counted::Counted(Counted &&other) noexcept : value(other.value)
+{
+    other.value = -1;
+    ++counters.moveConstructs;
+}
+
+// copy assignment
+Counted &Counted::operator=(const Counted &other)
+{
+    value = other.value;
+    ++counters.copyAssigns;
+    return *this;
+}
+
+// move assignment
+Counted &Counted::operator=(Counted &&other) noexcept
+{
+    value = other.value;
+    other.value = -1;
+    ++counters.moveAssigns;
+    return *this;
+}
+
+// destructor
+Counted::~Counted()
+{
+    ++counters.destructs;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+
+// Element type that counts every special member call instead of printing it
+// like A does. Moves are noexcept so containers are expected to move it.
+class Counted
+{
+public:
+    struct Counters
+    {
+        std::size_t defaultConstructs = 0;
+        std::size_t valueConstructs = 0;
+        std::size_t copyConstructs = 0;
+        std::size_t moveConstructs = 0;
+        std::size_t copyAssigns = 0;
+        std::size_t moveAssigns = 0;
+        std::size_t destructs = 0;
+
+        std::size_t copies() const { return copyConstructs + copyAssigns; }
+        std::size_t moves() const { return moveConstructs + moveAssigns; }
+        std::size_t constructs() const { return defaultConstructs + valueConstructs + copyConstructs + moveConstructs; }
+    };
+
+    static Counters counters;
+    static void reset() { counters = Counters(); }
+
+    int value;
+
+    // default constructor
+    Counted();
+
+    // parametrised constructor
+    explicit Counted(int v);
+
+    // two argument constructor, for emplace
+    Counted(int a, int b);
+
+    // copy constructor
+    Counted(const Counted &other);
+
+    // move constructor
+    Counted(Counted &&other) noexcept;
+
+    // copy assignment
+    Counted &operator=(const Counted &other);
+
+    // move assignment
+    Counted &operator=(Counted &&other) noexcept;
+
+    // destructor
+    ~Counted();
+};
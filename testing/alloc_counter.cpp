@@ -0,0 +1,54 @@
+#include <cstdlib>
+#include <new>
+
+#include "alloc_counter.hpp"
+
+AllocCounter *AllocCounter::active = nullptr;
+
+void *operator new(std::size_t size)
+{
+    if (AllocCounter::active != nullptr)
+    {
+        AllocCounter::active->allocations++;
+        AllocCounter::active->bytesAllocated += size;
+    }
+
+    void *p = std::malloc(size == 0 ? 1 : size);
+
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    return p;
+}
+
+void *operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    if (p != nullptr && AllocCounter::active != nullptr)
+    {
+        AllocCounter::active->deallocations++;
+    }
+
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    ::operator delete(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    ::operator delete(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+    ::operator delete(p);
+}
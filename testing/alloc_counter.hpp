@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+
+// The containers allocate through ::operator new, so allocations are counted
+// by replacing the global allocation functions (see alloc_counter.cpp).
+// Only allocations made while a scope is active are counted.
+struct AllocCounter
+{
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+    std::size_t bytesAllocated = 0;
+
+    static AllocCounter *active;
+
+    AllocCounter() { active = this; }
+    ~AllocCounter() { active = nullptr; }
+
+    AllocCounter(const AllocCounter &) = delete;
+    AllocCounter &operator=(const AllocCounter &) = delete;
+};
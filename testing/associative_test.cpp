@@ -0,0 +1,792 @@
+// Behaviour checks for the associative containers, compared against the
+// standard library ones.
+
+#include <cstddef>
+#include <cstdio>
+#include <iterator>
+#include <map>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../include/ds/btree_map.hpp"
+#include "../include/ds/btree_set.hpp"
+#include "../include/ds/flat_hash_map.hpp"
+#include "../include/ds/flat_hash_set.hpp"
+#include "../include/ds/flat_map.hpp"
+#include "../include/ds/flat_set.hpp"
+#include "../include/ds/slot_map.hpp"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                           \
+    do                                                                        \
+    {                                                                         \
+        if (!(cond))                                                          \
+        {                                                                     \
+            std::printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures;                                                       \
+        }                                                                     \
+    } while (0)
+
+// counts live instances, to catch leaked or doubly destroyed elements
+struct Tracked
+{
+    static int live;
+    int value = 0;
+
+    Tracked() { live++; }
+    Tracked(int _value) : value(_value) { live++; }
+    Tracked(const Tracked &_other) : value(_other.value) { live++; }
+    Tracked(Tracked &&_other) noexcept : value(_other.value) { live++; }
+    Tracked &operator=(const Tracked &) = default;
+    Tracked &operator=(Tracked &&) = default;
+    ~Tracked() { live--; }
+};
+
+int Tracked::live = 0;
+
+template <typename Map, typename Model>
+static bool same_map(const Map &_map, const Model &_model)
+{
+    if (_map.size() != _model.size())
+    {
+        return false;
+    }
+
+    std::size_t seen = 0;
+    for (const auto &kv : _map)
+    {
+        auto found = _model.find(kv.first);
+        if (found == _model.end() || found->second != kv.second.value)
+        {
+            return false;
+        }
+        seen++;
+    }
+    return seen == _model.size();
+}
+
+static void hash_map_random_ops()
+{
+    std::mt19937 rng(41);
+    {
+        ds::flat_hash_map<int, Tracked> map;
+        std::unordered_map<int, int> model;
+
+        for (int step = 0; step < 60000; step++)
+        {
+            // insert heavy, then erase heavy to leave tombstones behind
+            const int key = int(rng() % 4096);
+            const unsigned op = rng() % 10;
+            const bool inserting = step < 30000 ? op < 6 : op < 3;
+
+            if (inserting)
+            {
+                const bool inserted = map.try_emplace(key, step).second;
+                CHECK(inserted == model.emplace(key, step).second);
+            }
+            else if (op < 8)
+            {
+                CHECK(map.erase(key) == model.erase(key));
+            }
+            else
+            {
+                auto it = map.find(key);
+                CHECK((it == map.end()) == (model.count(key) == 0));
+                CHECK(it == map.end() || it->second.value == model[key]);
+            }
+        }
+        CHECK(same_map(map, model));
+        CHECK(map.load_factor() <= 0.875f);
+
+        for (auto it = map.begin(); it != map.end();)
+        {
+            if (it->first % 3 == 0)
+            {
+                model.erase(it->first);
+                it = map.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        CHECK(same_map(map, model));
+
+        ds::flat_hash_map<int, Tracked> copy(map);
+        CHECK(same_map(copy, model));
+
+        ds::flat_hash_map<int, Tracked> moved(std::move(copy));
+        CHECK(same_map(moved, model) && copy.empty());
+
+        map[-1].value = 7;
+        CHECK(map.at(-1).value == 7);
+        map.insert_or_assign(-1, Tracked(8));
+        CHECK(map.at(-1).value == 8 && map.count(-1) == 1);
+
+        bool thrown = false;
+        try
+        {
+            map.at(-2);
+        }
+        catch (const std::out_of_range &)
+        {
+            thrown = true;
+        }
+        CHECK(thrown);
+
+        map.clear();
+        CHECK(map.empty() && map.begin() == map.end());
+        map.rehash(0);
+        CHECK(map.capacity() == 0);
+    }
+    CHECK(Tracked::live == 0);
+}
+
+static void hash_map_reserve()
+{
+    ds::flat_hash_map<int, int> map;
+    map.reserve(1000);
+    const std::size_t capacity = map.capacity();
+    CHECK(capacity >= 1000);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        map[i] = i * i;
+    }
+    CHECK(map.capacity() == capacity);
+
+    // a reference into the map as the value while the insert rehashes
+    ds::flat_hash_map<int, std::string> grow;
+    grow[0] = std::string(40, 'x');
+    for (int i = 1; i < 200; i++)
+    {
+        grow.try_emplace(i, grow.at(i - 1));
+    }
+    CHECK(grow.size() == 200 && grow.at(199) == std::string(40, 'x'));
+}
+
+static void hash_map_heterogeneous()
+{
+    ds::flat_hash_map<std::string, int, ds::string_hash, std::equal_to<>> words;
+    words["alpha"] = 1;
+    words["beta"] = 2;
+    words.emplace("gamma", 3);
+
+    const std::string_view beta = "beta";
+    CHECK(words.find(beta) != words.end() && words.find(beta)->second == 2);
+    CHECK(words.contains("gamma") && !words.contains(std::string_view("delta")));
+    CHECK(words.at(std::string_view("alpha")) == 1);
+    CHECK(words.erase(std::string_view("alpha")) == 1 && words.size() == 2);
+}
+
+// key that counts its copies; rehashes should move keys, never copy them
+struct CountedKey
+{
+    static int copies;
+    std::string text;
+
+    explicit CountedKey(std::string _text) : text(std::move(_text)) {}
+    CountedKey(const CountedKey &_other) : text(_other.text) { copies++; }
+    CountedKey(CountedKey &&_other) noexcept = default;
+    CountedKey &operator=(const CountedKey &) = delete;
+    CountedKey &operator=(CountedKey &&) = delete;
+
+    bool operator==(const CountedKey &_other) const { return text == _other.text; }
+};
+
+int CountedKey::copies = 0;
+
+struct CountedKeyHash
+{
+    std::size_t operator()(const CountedKey &_key) const { return std::hash<std::string>()(_key.text); }
+};
+
+static void hash_map_relocates_keys()
+{
+    ds::flat_hash_map<CountedKey, int, CountedKeyHash> map;
+    CountedKey::copies = 0;
+    for (int i = 0; i < 2000; i++)
+    {
+        map.emplace(CountedKey(std::string(24, 'k') + std::to_string(i)), i);
+    }
+    CHECK(CountedKey::copies == 0);
+    CHECK(map.size() == 2000 && map.at(CountedKey(std::string(24, 'k') + "1234")) == 1234);
+
+    // copying the map copies each key once
+    ds::flat_hash_map<CountedKey, int, CountedKeyHash> copy(map);
+    CHECK(CountedKey::copies == 2000 && copy.size() == 2000);
+
+    bool same = true;
+    for (const auto &kv : map)
+    {
+        same = same && copy.at(kv.first) == kv.second && kv.first.text.size() > 24;
+    }
+    CHECK(same);
+}
+
+static void hash_set_basics()
+{
+    ds::flat_hash_set<std::string> set{"one", "two", "three"};
+    CHECK(!set.insert("two").second);
+    CHECK(set.insert("four").second);
+    CHECK(set.size() == 4 && set.contains("three"));
+
+    std::set<std::string> sorted(set.begin(), set.end());
+    CHECK(sorted == std::set<std::string>({"four", "one", "three", "two"}));
+
+    ds::flat_hash_set<int> numbers;
+    for (int i = 0; i < 10000; i++)
+    {
+        numbers.insert(i % 5000);
+    }
+    CHECK(numbers.size() == 5000);
+
+    long sum = 0;
+    for (int x : numbers)
+    {
+        sum += x;
+    }
+    CHECK(sum == 4999L * 5000 / 2);
+}
+
+template <typename Map, typename Model>
+static bool same_sorted(const Map &_map, const Model &_model)
+{
+    if (_map.size() != _model.size())
+    {
+        return false;
+    }
+
+    auto it = _model.begin();
+    for (auto kv : _map)
+    {
+        if (kv.first != it->first || kv.second != it->second)
+        {
+            return false;
+        }
+        ++it;
+    }
+    return true;
+}
+
+static void flat_map_random_ops()
+{
+    std::mt19937 rng(42);
+    ds::flat_map<int, int> map;
+    std::map<int, int> model;
+
+    for (int round = 0; round < 30; round++)
+    {
+        // a batch with duplicates inside it and against the map
+        std::vector<std::pair<int, int>> batch;
+        for (int i = 0; i < 300; i++)
+        {
+            batch.emplace_back(int(rng() % 5000), round * 1000 + i);
+        }
+        map.insert_range(batch.begin(), batch.end());
+        for (const auto &kv : batch)
+        {
+            model.emplace(kv.first, kv.second);
+        }
+
+        for (int i = 0; i < 50; i++)
+        {
+            const int key = int(rng() % 5000);
+            switch (rng() % 3)
+            {
+            case 0:
+                CHECK(map.try_emplace(key, i).second == model.emplace(key, i).second);
+                break;
+            case 1:
+                CHECK(map.erase(key) == model.erase(key));
+                break;
+            default:
+                map[key] = i;
+                model[key] = i;
+            }
+        }
+    }
+    CHECK(same_sorted(map, model));
+
+    // the index answers exactly like the binary search
+    std::vector<std::size_t> plain;
+    for (int key = -1; key <= 5001; key++)
+    {
+        plain.push_back(std::size_t(map.lower_bound(key) - map.begin()));
+        plain.push_back(std::size_t(map.upper_bound(key) - map.begin()));
+    }
+
+    map.build_search_index();
+    CHECK(map.has_search_index());
+
+    bool indexedMatches = true;
+    std::size_t next = 0;
+    for (int key = -1; key <= 5001; key++)
+    {
+        indexedMatches = indexedMatches && std::size_t(map.lower_bound(key) - map.begin()) == plain[next++];
+        indexedMatches = indexedMatches && std::size_t(map.upper_bound(key) - map.begin()) == plain[next++];
+        indexedMatches = indexedMatches && map.contains(key) == (model.count(key) == 1);
+    }
+    CHECK(indexedMatches);
+
+    const int some = model.begin()->first;
+    CHECK(map.at(some) == model[some] && map.find(some)->second == model[some]);
+    map.erase(some);
+    CHECK(!map.has_search_index() && !map.contains(some));
+
+    bool thrown = false;
+    try
+    {
+        map.at(some);
+    }
+    catch (const std::out_of_range &)
+    {
+        thrown = true;
+    }
+    CHECK(thrown);
+}
+
+static void flat_map_strings()
+{
+    ds::flat_map<std::string, int, std::less<>> routes{{"/b", 2}, {"/a", 1}, {"/c", 3}, {"/a", 9}};
+    CHECK(routes.size() == 3 && routes.at("/a") == 1);
+    CHECK(routes.keys()[0] == "/a" && routes.values()[2] == 3);
+
+    routes.build_search_index();
+    CHECK(routes.find(std::string_view("/b"))->second == 2);
+    CHECK(routes.count("/d") == 0);
+
+    routes.insert_or_assign("/b", 20);
+    CHECK(routes.at(std::string_view("/b")) == 20 && routes.has_search_index());
+
+    ds::flat_map<std::string, int, std::less<>> copy(routes);
+    CHECK(copy.erase("/c") == 1 && copy.size() == 2 && routes.size() == 3);
+
+    // a single element and an empty map with an index
+    ds::flat_map<int, int> one{{5, 50}};
+    one.build_search_index();
+    CHECK(one.contains(5) && !one.contains(4) && !one.contains(6));
+    one.clear();
+    one.build_search_index();
+    CHECK(!one.contains(5) && one.lower_bound(0) == one.end());
+}
+
+// value whose move may throw, so flat_map has to copy it; the copy throws
+// once copiesLeft runs out
+struct FragileValue
+{
+    static int copiesLeft;
+    int value = 0;
+
+    FragileValue(int _value) : value(_value) {}
+    FragileValue(const FragileValue &_other) : value(_other.value)
+    {
+        if (--copiesLeft < 0)
+        {
+            throw std::runtime_error("copy failed");
+        }
+    }
+    FragileValue(FragileValue &&_other) : value(_other.value) {}
+    FragileValue &operator=(const FragileValue &) = default;
+    FragileValue &operator=(FragileValue &&) = default;
+};
+
+int FragileValue::copiesLeft = 1 << 30;
+
+static void flat_map_insert_range_throws()
+{
+    ds::flat_map<int, FragileValue> map;
+    for (int i = 0; i < 10; i++)
+    {
+        map.try_emplace(i * 2, i * 20);
+    }
+
+    // the batch is appended (5 copies), then the merge copies entries one
+    // by one and throws part way through
+    std::vector<std::pair<int, FragileValue>> batch;
+    for (int i = 0; i < 5; i++)
+    {
+        batch.emplace_back(i * 2 + 1, -i);
+    }
+
+    FragileValue::copiesLeft = 8;
+    bool threw = false;
+    try
+    {
+        map.insert_range(batch.begin(), batch.end());
+    }
+    catch (const std::runtime_error &)
+    {
+        threw = true;
+    }
+    FragileValue::copiesLeft = 1 << 30;
+
+    bool intact = map.size() == 10;
+    for (int i = 0; intact && i < 10; i++)
+    {
+        intact = map.keys()[i] == i * 2 && map.values()[i].value == i * 20;
+    }
+    CHECK(threw && intact);
+
+    map.insert_range(batch.begin(), batch.end());
+    CHECK(map.size() == 15 && map.at(3).value == -1 && map.at(4).value == 40);
+}
+
+static void flat_set_basics()
+{
+    std::mt19937 rng(42);
+    ds::flat_set<int> set;
+    std::set<int> model;
+
+    for (int round = 0; round < 20; round++)
+    {
+        std::vector<int> batch;
+        for (int i = 0; i < 200; i++)
+        {
+            batch.push_back(int(rng() % 3000));
+        }
+        set.insert_range(batch.begin(), batch.end());
+        model.insert(batch.begin(), batch.end());
+
+        const int key = int(rng() % 3000);
+        CHECK(set.erase(key) == model.erase(key));
+        CHECK(set.insert(key).second);
+        model.insert(key);
+    }
+    CHECK(std::equal(set.begin(), set.end(), model.begin(), model.end()));
+
+    set.build_search_index();
+    bool indexedMatches = true;
+    for (int key = -1; key <= 3001; key++)
+    {
+        indexedMatches = indexedMatches && set.contains(key) == (model.count(key) == 1);
+        indexedMatches = indexedMatches && std::distance(set.begin(), set.lower_bound(key)) == std::distance(model.begin(), model.lower_bound(key));
+    }
+    CHECK(indexedMatches);
+
+    auto it = set.erase(set.begin());
+    CHECK(*it == *std::next(model.begin()));
+}
+
+template <typename Map, typename Model>
+static bool same_ordered(const Map &_map, const Model &_model)
+{
+    if (_map.size() != _model.size() || std::distance(_map.begin(), _map.end()) != std::ptrdiff_t(_model.size()))
+    {
+        return false;
+    }
+
+    auto it = _model.begin();
+    for (auto kv : _map)
+    {
+        if (kv.first != it->first || kv.second.value != it->second)
+        {
+            return false;
+        }
+        ++it;
+    }
+
+    // and backwards through the leaf links
+    auto back = _model.rbegin();
+    for (auto mit = _map.end(); mit != _map.begin();)
+    {
+        --mit;
+        if (mit->first != back->first)
+        {
+            return false;
+        }
+        ++back;
+    }
+    return true;
+}
+
+static void btree_map_random_ops()
+{
+    std::mt19937 rng(43);
+    {
+        ds::btree_map<int, Tracked> map;
+        std::map<int, int> model;
+
+        for (int step = 0; step < 80000; step++)
+        {
+            // grow, then shrink, so nodes split, borrow and merge
+            const int key = int(rng() % 8192);
+            const unsigned op = rng() % 10;
+            const bool inserting = step < 40000 ? op < 6 : op < 3;
+
+            if (inserting)
+            {
+                CHECK(map.try_emplace(key, step).second == model.emplace(key, step).second);
+            }
+            else if (op < 8)
+            {
+                CHECK(map.erase(key) == model.erase(key));
+            }
+            else
+            {
+                auto lower = map.lower_bound(key);
+                auto expected = model.lower_bound(key);
+                CHECK((lower == map.end()) == (expected == model.end()));
+                CHECK(lower == map.end() || lower->first == expected->first);
+
+                auto upper = map.upper_bound(key);
+                expected = model.upper_bound(key);
+                CHECK((upper == map.end()) == (expected == model.end()));
+                CHECK(upper == map.end() || upper->first == expected->first);
+            }
+
+            if (step % 20000 == 0)
+            {
+                CHECK(same_ordered(map, model));
+            }
+        }
+        CHECK(same_ordered(map, model));
+
+        // erase through iterators while walking
+        for (auto it = map.begin(); it != map.end();)
+        {
+            if (it->first % 3 == 0)
+            {
+                model.erase(it->first);
+                it = map.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        CHECK(same_ordered(map, model));
+
+        ds::btree_map<int, Tracked> copy(map);
+        CHECK(same_ordered(copy, model));
+
+        ds::btree_map<int, Tracked> moved(std::move(copy));
+        CHECK(same_ordered(moved, model) && copy.empty() && copy.begin() == copy.end());
+
+        // a range erase in the middle
+        auto from = moved.lower_bound(2000);
+        auto to = moved.lower_bound(6000);
+        auto after = moved.erase(from, to);
+        model.erase(model.lower_bound(2000), model.lower_bound(6000));
+        CHECK(same_ordered(moved, model));
+        CHECK(after == moved.end() || after->first == model.lower_bound(6000)->first);
+
+        while (!moved.empty())
+        {
+            moved.erase(moved.begin());
+        }
+        CHECK(moved.height() == 0 && moved.begin() == moved.end());
+
+        map.clear();
+        CHECK(map.empty() && map.begin() == map.end());
+        map[5].value = 50;
+        CHECK(map.at(5).value == 50 && map.size() == 1);
+    }
+    CHECK(Tracked::live == 0);
+}
+
+static void btree_map_sequential()
+{
+    // ascending inserts take the append path and pack the leaves
+    ds::btree_map<long, long> map;
+    const long n = 100000;
+    for (long i = 0; i < n; i++)
+    {
+        map.try_emplace(i, i * 2);
+    }
+    CHECK(map.size() == std::size_t(n) && map.height() <= 4);
+
+    long expected = 0;
+    bool ordered = true;
+    for (auto kv : map)
+    {
+        ordered = ordered && kv.first == expected && kv.second == expected * 2;
+        expected++;
+    }
+    CHECK(ordered && expected == n);
+
+    // a range scan
+    long sum = 0;
+    for (auto it = map.lower_bound(1000), stop = map.upper_bound(1999); it != stop; ++it)
+    {
+        sum += it->first;
+    }
+    CHECK(sum == (1000 + 1999) * 1000 / 2);
+
+    map.insert_or_assign(7, -7);
+    CHECK(map.at(7) == -7 && map.count(7) == 1 && !map.contains(n));
+
+    bool thrown = false;
+    try
+    {
+        map.at(n);
+    }
+    catch (const std::out_of_range &)
+    {
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    // descending erases merge from the right edge
+    for (long i = n - 1; i >= 0; i -= 2)
+    {
+        map.erase(i);
+    }
+    CHECK(map.size() == std::size_t(n / 2) && map.begin()->first == 0 && (--map.end())->first == n - 2);
+}
+
+static void btree_set_basics()
+{
+    ds::btree_set<std::string, std::less<>> words{"pear", "apple", "fig", "apple"};
+    CHECK(words.size() == 3 && *words.begin() == "apple");
+    CHECK(words.contains(std::string_view("fig")) && !words.contains("kiwi"));
+    CHECK(words.insert("kiwi").second && !words.insert(std::string("pear")).second);
+
+    auto range = words.equal_range(std::string_view("kiwi"));
+    CHECK(std::distance(range.first, range.second) == 1 && *range.first == "kiwi");
+    CHECK(words.erase(std::string_view("apple")) == 1);
+    CHECK(std::equal(words.begin(), words.end(), std::set<std::string>({"fig", "kiwi", "pear"}).begin()));
+
+    std::mt19937 rng(44);
+    std::vector<int> values;
+    for (int i = 0; i < 20000; i++)
+    {
+        values.push_back(int(rng() % 50000));
+    }
+    ds::btree_set<int> set(values.begin(), values.end());
+    std::set<int> model(values.begin(), values.end());
+    CHECK(set.size() == model.size() && std::equal(set.begin(), set.end(), model.begin()));
+
+    ds::btree_set<int> other;
+    other = set;
+    for (int v : values)
+    {
+        other.erase(v);
+    }
+    CHECK(other.empty() && set.size() == model.size());
+}
+
+static void slot_map_random_ops()
+{
+    std::mt19937 rng(45);
+    {
+        ds::slot_map<Tracked> map;
+        std::vector<std::pair<ds::slot_key, int>> live;
+        std::vector<ds::slot_key> stale;
+
+        for (int step = 0; step < 50000; step++)
+        {
+            if (live.empty() || rng() % 10 < 6)
+            {
+                const ds::slot_key key = map.emplace(step);
+                live.emplace_back(key, step);
+            }
+            else
+            {
+                const std::size_t victim = rng() % live.size();
+                CHECK(map.erase(live[victim].first));
+                stale.push_back(live[victim].first);
+                live[victim] = live.back();
+                live.pop_back();
+            }
+        }
+        CHECK(map.size() == live.size());
+
+        bool liveOk = true;
+        for (const auto &kv : live)
+        {
+            const Tracked *value = map.get(kv.first);
+            liveOk = liveOk && value != nullptr && value->value == kv.second && map[kv.first].value == kv.second;
+        }
+        CHECK(liveOk);
+
+        // reused slots carry a newer generation, so old keys stay dead
+        bool staleOk = true;
+        for (const ds::slot_key &key : stale)
+        {
+            staleOk = staleOk && !map.contains(key) && !map.erase(key);
+        }
+        CHECK(staleOk);
+        CHECK(!map.contains(ds::slot_key{}) && !map.contains(ds::slot_key{1u << 30, 1}));
+
+        // dense iteration sees every value once, and key_of leads back to it
+        long sum = 0;
+        long expected = 0;
+        bool keysOk = true;
+        for (auto it = map.begin(); it != map.end(); ++it)
+        {
+            sum += it->value;
+            keysOk = keysOk && &map.at(map.key_of(it)) == &*it;
+        }
+        for (const auto &kv : live)
+        {
+            expected += kv.second;
+        }
+        CHECK(sum == expected && keysOk);
+
+        // erase through iterators while walking
+        for (auto it = map.begin(); it != map.end();)
+        {
+            it = it->value % 2 == 0 ? map.erase(it) : std::next(it);
+        }
+        bool oddOk = true;
+        for (const auto &kv : live)
+        {
+            oddOk = oddOk && map.contains(kv.first) == (kv.second % 2 != 0);
+        }
+        CHECK(oddOk);
+
+        const ds::slot_key before = live.back().first;
+        ds::slot_map<Tracked> copy(map);
+        map.clear();
+        CHECK(map.empty() && !map.contains(before) && copy.contains(before) == (live.back().second % 2 != 0));
+
+        bool thrown = false;
+        try
+        {
+            map.at(before);
+        }
+        catch (const std::out_of_range &)
+        {
+            thrown = true;
+        }
+        CHECK(thrown);
+
+        const ds::slot_key fresh = map.insert(Tracked(1));
+        CHECK(map.size() == 1 && map.at(fresh).value == 1 && fresh != before);
+    }
+    CHECK(Tracked::live == 0);
+}
+
+int main()
+{
+    hash_map_random_ops();
+    hash_map_reserve();
+    hash_map_heterogeneous();
+    hash_map_relocates_keys();
+    hash_set_basics();
+    flat_map_random_ops();
+    flat_map_strings();
+    flat_map_insert_range_throws();
+    flat_set_basics();
+    btree_map_random_ops();
+    btree_map_sequential();
+    btree_set_basics();
+    slot_map_random_ops();
+
+    if (failures != 0)
+    {
+        std::printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    std::printf("all associative checks passed\n");
+    return 0;
+}
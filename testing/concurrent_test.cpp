@@ -0,0 +1,369 @@
+// Checks the containers meant to be shared between threads: several
+// threads update and read at once, and the end state is compared with
+// what the threads did. Checks run on the main thread after the workers
+// join.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "../include/ds/concurrent_hash_map.hpp"
+#include "../include/ds/epoch.hpp"
+#include "../include/ds/hazard.hpp"
+#include "../include/ds/rcu_vector.hpp"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                           \
+    do                                                                        \
+    {                                                                         \
+        if (!(cond))                                                          \
+        {                                                                     \
+            std::printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures;                                                       \
+        }                                                                     \
+    } while (0)
+
+static constexpr int threadCount = 4;
+
+template <typename F>
+static void run_threads(F _f)
+{
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threadCount; t++)
+    {
+        workers.emplace_back(_f, t);
+    }
+    for (std::thread &w : workers)
+    {
+        w.join();
+    }
+}
+
+static void concurrent_map_updates()
+{
+    ds::concurrent_hash_map<int, long> map(8);
+    CHECK(map.shard_count() == 8);
+
+    const int perThread = 20000;
+    std::atomic<int> misses{0};
+
+    // each thread owns a key range, reads the others' and erases its odd keys
+    run_threads([&](int t)
+                {
+                    const int base = t * perThread;
+                    for (int i = 0; i < perThread; i++)
+                    {
+                        map.try_emplace(base + i, long(base + i));
+                        if (i % 4 == 0)
+                        {
+                            map.find((base + perThread + i) % (threadCount * perThread));
+                        }
+                    }
+                    for (int i = 0; i < perThread; i++)
+                    {
+                        if (!map.contains(base + i))
+                        {
+                            misses++;
+                        }
+                    }
+                    for (int i = 1; i < perThread; i += 2)
+                    {
+                        map.erase(base + i);
+                    } });
+
+    CHECK(misses == 0);
+    CHECK(map.size() == std::size_t(threadCount * perThread / 2));
+    CHECK(map.find(2) == 2L && !map.find(3).has_value());
+
+    // shared counters bumped under the shard lock
+    const int bumps = 5000;
+    run_threads([&](int)
+                {
+                    for (int i = 0; i < bumps; i++)
+                    {
+                        map.visit(i % 10 * 2, [](long &_value)
+                                  { _value += 1000000; });
+                    } });
+
+    bool bumped = true;
+    for (int k = 0; k < 20; k += 2)
+    {
+        bumped = bumped && map.find(k) == long(k) + long(threadCount) * bumps / 10 * 1000000;
+    }
+    CHECK(bumped);
+
+    // racing insert_or_assign on one key: exactly one insert wins
+    std::atomic<int> inserted{0};
+    run_threads([&](int t)
+                {
+                    if (map.insert_or_assign(-1, long(t)))
+                    {
+                        inserted++;
+                    } });
+    CHECK(inserted == 1 && map.contains(-1));
+
+    std::size_t seen = 0;
+    map.visit_all([&](const int &, long &)
+                  { seen++; });
+    CHECK(seen == map.size());
+
+    const std::size_t removed = map.erase_if([](const int &_key, const long &)
+                                             { return _key < 0 || _key % 4 == 0; });
+    CHECK(removed == std::size_t(threadCount * perThread / 4 + 1) && map.size() == std::size_t(threadCount * perThread / 4));
+
+    map.clear();
+    CHECK(map.empty());
+}
+
+static void concurrent_map_strings()
+{
+    ds::concurrent_hash_map<std::string, int, ds::string_hash, std::equal_to<>> sessions;
+    sessions.reserve(1000);
+
+    run_threads([&](int t)
+                {
+                    for (int i = 0; i < 250; i++)
+                    {
+                        sessions.insert_or_assign("session-" + std::to_string(t * 250 + i), t);
+                    } });
+
+    CHECK(sessions.size() == 1000);
+    CHECK(sessions.find(std::string_view("session-999")) == 3);
+    CHECK(sessions.erase(std::string_view("session-0")) == 1 && !sessions.contains("session-0"));
+
+    const auto &view = sessions;
+    int seen = -1;
+    CHECK(view.visit(std::string_view("session-250"), [&](const int &_value)
+                     { seen = _value; }));
+    CHECK(seen == 1);
+}
+
+// counts live instances across threads
+struct Shared
+{
+    static std::atomic<long> live;
+    int value = 0;
+
+    Shared(int _value = 0) : value(_value) { live++; }
+    Shared(const Shared &_other) : value(_other.value) { live++; }
+    Shared &operator=(const Shared &) = default;
+    ~Shared() { live--; }
+};
+
+std::atomic<long> Shared::live{0};
+
+static void epoch_holds_back_reclamation()
+{
+    std::atomic<int> stage{0};
+
+    // a reader sits in a critical section until told to leave
+    std::thread reader([&]
+                       {
+                           ds::epoch::guard pin;
+                           stage = 1;
+                           while (stage != 2)
+                           {
+                               std::this_thread::yield();
+                           } });
+
+    while (stage != 1)
+    {
+        std::this_thread::yield();
+    }
+
+    ds::epoch::retire(new Shared(7));
+    for (int i = 0; i < 4; i++)
+    {
+        ds::epoch::reclaim();
+    }
+    CHECK(Shared::live == 1);
+
+    stage = 2;
+    reader.join();
+    for (int i = 0; i < 4 && Shared::live != 0; i++)
+    {
+        ds::epoch::reclaim();
+    }
+    CHECK(Shared::live == 0);
+}
+
+static void epoch_synchronize()
+{
+    // what exiting threads leave behind is picked up by the next reclaim
+    run_threads([](int)
+                {
+                    ds::epoch::register_thread();
+                    for (int i = 0; i < 10; i++)
+                    {
+                        ds::epoch::retire(new Shared(i));
+                    } });
+
+    for (int i = 0; i < 3; i++)
+    {
+        ds::epoch::retire(new Shared(i));
+    }
+    ds::epoch::synchronize();
+    CHECK(Shared::live == 0);
+
+    bool threw = false;
+    {
+        ds::epoch::guard pin;
+        try
+        {
+            ds::epoch::synchronize();
+        }
+        catch (const std::logic_error &)
+        {
+            threw = true;
+        }
+    }
+    CHECK(threw);
+}
+
+static void hazard_protects_objects()
+{
+    std::atomic<Shared *> slot{new Shared(0)};
+
+    // a protected object survives reclaim until its slot lets go
+    {
+        ds::hazard_pointer hp;
+        Shared *p = hp.protect(slot);
+        slot.store(new Shared(1));
+        ds::hazard_pointer::retire(p);
+
+        CHECK(ds::hazard_pointer::reclaim() == 0 && Shared::live == 2 && p->value == 0);
+        hp.reset();
+        CHECK(ds::hazard_pointer::reclaim() == 1 && Shared::live == 1);
+    }
+
+    std::atomic<bool> done{false};
+    std::atomic<int> regressed{0};
+    std::atomic<long> reads{0};
+
+    // one writer replaces the object while readers follow it; versions
+    // only go up and every object read is still alive
+    run_threads([&](int t)
+                {
+                    if (t == 0)
+                    {
+                        for (int version = 2; version <= 300; version++)
+                        {
+                            ds::hazard_pointer::retire(slot.exchange(new Shared(version)));
+                            std::this_thread::yield();
+                        }
+                        done = true;
+                        return;
+                    }
+
+                    ds::hazard_pointer hp;
+                    int last = 0;
+                    do
+                    {
+                        const Shared *p = hp.protect(slot);
+                        if (p->value < last)
+                        {
+                            regressed++;
+                        }
+                        last = p->value;
+                        hp.reset();
+                        reads++;
+                    } while (!done); });
+
+    CHECK(regressed == 0 && reads > 0);
+    CHECK(slot.load()->value == 300);
+
+    ds::hazard_pointer::retire(slot.exchange(nullptr));
+    ds::hazard_pointer::reclaim();
+    CHECK(Shared::live == 0);
+}
+
+static void rcu_vector_versions()
+{
+    const std::size_t width = 16;
+    {
+        ds::rcu_vector<Shared> table(ds::vector<Shared>(width, Shared(0)));
+        std::atomic<bool> done{false};
+        std::atomic<int> torn{0};
+        std::atomic<long> reads{0};
+
+        // one writer bumps every element per version while readers check
+        // that a snapshot never mixes two versions
+        run_threads([&](int t)
+                    {
+                        if (t == 0)
+                        {
+                            for (int version = 1; version <= 300; version++)
+                            {
+                                table.update([&](ds::vector<Shared> &_v)
+                                             {
+                                                 for (Shared &x : _v)
+                                                 {
+                                                     x.value = version;
+                                                 } });
+                                std::this_thread::yield();
+                            }
+                            done = true;
+                            return;
+                        }
+
+                        do
+                        {
+                            const auto view = table.read();
+                            for (const Shared &x : view)
+                            {
+                                if (x.value != view[0].value)
+                                {
+                                    torn++;
+                                }
+                            }
+                            reads++;
+                        } while (!done); });
+
+        CHECK(torn == 0 && reads > 0);
+        CHECK(table.read()[width - 1].value == 300);
+        CHECK(table.read([](const ds::vector<Shared> &_v)
+                         { return _v.size(); }) == width);
+
+        table.push_back(Shared(301));
+        table.store(ds::vector<Shared>(2, Shared(5)));
+        CHECK(table.size() == 2 && table.read()[1].value == 5);
+
+        // with every reader gone the old versions go away
+        for (int i = 0; i < 4; i++)
+        {
+            ds::epoch::reclaim();
+        }
+        CHECK(Shared::live == 2);
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        ds::epoch::reclaim();
+    }
+    CHECK(Shared::live == 0);
+}
+
+int main()
+{
+    concurrent_map_updates();
+    concurrent_map_strings();
+    epoch_holds_back_reclamation();
+    epoch_synchronize();
+    hazard_protects_objects();
+    rcu_vector_versions();
+
+    if (failures != 0)
+    {
+        std::printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    std::printf("all concurrent checks passed\n");
+    return 0;
+}
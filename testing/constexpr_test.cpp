@@ -0,0 +1,127 @@
+// Builds ds::vector values during constant evaluation (C++20). Everything
+// is checked with static_assert, so this file failing to compile is the
+// failure; main() only repeats a few checks at run time.
+
+#include <array>
+#include <cstddef>
+#include <cstdio>
+
+#include "../include/ds/vector.hpp"
+
+#ifndef DS_HAS_CONSTEXPR_VECTOR
+#error "constexpr_test needs a C++20 compiler with constexpr allocation"
+#endif
+
+// a lookup table computed with ds::vector and materialized as static data
+template <std::size_t N>
+constexpr std::array<unsigned, N> make_primes()
+{
+    ds::vector<unsigned> primes;
+
+    for (unsigned candidate = 2; primes.size() < N; candidate++)
+    {
+        bool prime = true;
+
+        for (unsigned p : primes)
+        {
+            if (p * p > candidate)
+            {
+                break;
+            }
+            if (candidate % p == 0)
+            {
+                prime = false;
+                break;
+            }
+        }
+
+        if (prime)
+        {
+            primes.push_back(candidate);
+        }
+    }
+
+    std::array<unsigned, N> table{};
+    for (std::size_t i = 0; i < N; i++)
+    {
+        table[i] = primes[i];
+    }
+    return table;
+}
+
+static constexpr auto PRIMES = make_primes<64>();
+static_assert(PRIMES[0] == 2 && PRIMES[9] == 29 && PRIMES[63] == 311);
+
+constexpr bool modifiers()
+{
+    ds::vector<int> v{1, 2, 3};
+    v.reserve(10);
+    v.insert(v.begin() + 1, 9);          // 1 9 2 3
+    v.insert(v.begin(), v[3]);           // 3 1 9 2 3
+    v.emplace(v.end(), 4);               // 3 1 9 2 3 4
+    v.erase(v.begin() + 2);              // 3 1 2 3 4
+    v.pop_back();                        // 3 1 2 3
+    v.shrink_to_fit();
+
+    ds::vector<int> copy(v);
+    ds::vector<int> moved(static_cast<ds::vector<int> &&>(copy));
+    copy = moved;
+
+    ds::vector<int> filled(3, 7);
+    filled.assign(5, filled[0]);
+
+    return v.size() == 4 && v.capacity() == 4 && v.front() == 3 && v.at(2) == 2 && v.back() == 3 &&
+           moved.size() == 4 && copy[1] == 1 && filled.size() == 5 && filled[4] == 7;
+}
+
+static_assert(modifiers());
+
+// multi-element inserts with and without room, including an aliased value
+constexpr bool insert_many()
+{
+    ds::vector<int> v;
+    v.insert(v.begin(), {4, 5, 6});              // 4 5 6, grown from empty
+    v.insert(v.begin(), 2, 1);                   // 1 1 4 5 6
+    v.reserve(16);
+    v.insert(v.begin() + 2, {2, 3});             // 1 1 2 3 4 5 6
+    v.insert(v.begin() + 1, 3, v[6]);            // 1 6 6 6 1 2 3 4 5 6
+    v.insert(v.end(), 0, 9);
+    v.insert(v.end(), {7});                      // ... 6 7
+
+    return v.size() == 11 && v[0] == 1 && v[1] == 6 && v[3] == 6 && v[4] == 1 && v[5] == 2 &&
+           v[9] == 6 && v[10] == 7 && v.capacity() == 16;
+}
+
+static_assert(insert_many());
+
+// nested allocations are all released before evaluation ends
+constexpr std::size_t nested()
+{
+    ds::vector<ds::vector<int>> rows;
+
+    for (int r = 0; r < 8; r++)
+    {
+        rows.push_back(ds::vector<int>(std::size_t(r), r));
+    }
+
+    std::size_t total = 0;
+    for (const auto &row : rows)
+    {
+        total += row.size();
+    }
+    return total;
+}
+
+static_assert(nested() == 28);
+
+int main()
+{
+    if (!modifiers() || nested() != 28 || make_primes<64>() != PRIMES)
+    {
+        std::printf("constexpr results differ at run time\n");
+        return 1;
+    }
+
+    std::printf("all constexpr checks passed\n");
+    return 0;
+}
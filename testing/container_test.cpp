@@ -0,0 +1,939 @@
+// Behaviour checks for the containers that have no dedicated test, compared
+// against the standard library where one exists.
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <cstdio>
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <map>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../include/ds/circular_buffer.hpp"
+#include "../include/ds/gap_buffer.hpp"
+#include "../include/ds/gather.hpp"
+#include "../include/ds/hive.hpp"
+#include "../include/ds/persistent_vector.hpp"
+#include "../include/ds/priority_queue.hpp"
+#include "../include/ds/radix_heap.hpp"
+#include "../include/ds/sort.hpp"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                           \
+    do                                                                        \
+    {                                                                         \
+        if (!(cond))                                                          \
+        {                                                                     \
+            std::printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures;                                                       \
+        }                                                                     \
+    } while (0)
+
+template <typename A, typename B>
+static bool same_elements(const A &_a, const B &_b)
+{
+    if (_a.size() != _b.size())
+    {
+        return false;
+    }
+
+    auto it = _b.begin();
+    for (const auto &x : _a)
+    {
+        if (!(x == *it++))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T, typename Make>
+static void gap_buffer_random_edits(Make _make)
+{
+    std::mt19937 rng(38);
+    ds::gap_buffer<T> g;
+    std::vector<T> model;
+
+    for (int step = 0; step < 4000; step++)
+    {
+        const std::size_t pos = model.empty() ? 0 : rng() % (model.size() + 1);
+
+        switch (rng() % 5)
+        {
+        case 0:
+        case 1:
+            g.insert(g.begin() + pos, _make(step));
+            model.insert(model.begin() + pos, _make(step));
+            break;
+        case 2:
+            g.insert(g.begin() + pos, 3, _make(step));
+            model.insert(model.begin() + pos, 3, _make(step));
+            break;
+        case 3:
+            if (pos < model.size())
+            {
+                const std::size_t last = pos + (rng() % 4 < model.size() - pos ? rng() % 4 : 0);
+                g.erase(g.begin() + pos, g.begin() + last);
+                model.erase(model.begin() + pos, model.begin() + last);
+            }
+            break;
+        default:
+            if (!model.empty())
+            {
+                // inserting an element of the buffer itself
+                const std::size_t from = rng() % model.size();
+                g.insert(g.begin() + pos, g[from]);
+                model.insert(model.begin() + pos, T(model[from]));
+            }
+        }
+    }
+
+    CHECK(same_elements(g, model));
+
+    ds::gap_buffer<T> copy(g);
+    copy.shrink_to_fit();
+    CHECK(copy.capacity() == model.size());
+    CHECK(same_elements(copy, model));
+
+    const T *flat = g.contiguous();
+    bool flatMatches = true;
+    for (std::size_t i = 0; i < model.size(); i++)
+    {
+        flatMatches = flatMatches && flat[i] == model[i];
+    }
+    CHECK(flatMatches);
+    CHECK(g.gap_position() == g.size());
+}
+
+static void gap_buffer_cursor()
+{
+    ds::gap_buffer<int> g{1, 2, 3, 7, 8};
+
+    // a run of inserts at one cursor moves the gap only once
+    auto it = g.begin() + 3;
+    for (int v = 4; v <= 6; v++)
+    {
+        it = g.insert(it, v) + 1;
+    }
+
+    CHECK(g.gap_position() == 6);
+    CHECK(same_elements(g, std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8}));
+
+    g.erase(g.begin() + 6);
+    g.pop_back();
+    CHECK(same_elements(g, std::vector<int>{1, 2, 3, 4, 5, 6}));
+    CHECK(g.at(5) == 6 && g.front() == 1 && g.back() == 6);
+
+    bool thrown = false;
+    try
+    {
+        g.at(6);
+    }
+    catch (const std::out_of_range &)
+    {
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    ds::gap_buffer<int> moved(std::move(g));
+    CHECK(moved.size() == 6 && g.size() == 0);
+    g = moved;
+    CHECK(same_elements(g, moved));
+}
+
+static void circular_buffer_policies()
+{
+    ds::circular_buffer<int> over(5);
+    CHECK(over.capacity() == 8);
+
+    std::deque<int> model;
+    for (int i = 0; i < 20; i++)
+    {
+        CHECK(over.push_back(i));
+        model.push_back(i);
+        if (model.size() > 8)
+        {
+            model.pop_front();
+        }
+    }
+    CHECK(over.full());
+    CHECK(same_elements(over, model));
+    CHECK(over.front() == 12 && over.back() == 19 && over.at(3) == 15);
+
+    // wrapped contents come out as two runs in order
+    auto runs = over.readable();
+    CHECK(runs.first.size + runs.second.size == 8);
+    CHECK(runs.second.size != 0);
+    CHECK(runs.first.data[0] == 12 && runs.second.data[runs.second.size - 1] == 19);
+
+    int out[8];
+    CHECK(over.copy_to(out, 8) == 8);
+    CHECK(out[0] == 12 && out[7] == 19);
+
+    ds::circular_buffer<int> reject(4, ds::full_policy::reject);
+    for (int i = 0; i < 4; i++)
+    {
+        CHECK(reject.push_back(i));
+    }
+    CHECK(!reject.push_back(4));
+    CHECK(reject.back() == 3);
+
+    reject.pop_front(2);
+    const int more[] = {10, 11, 12};
+    CHECK(reject.push_back(more, 3) == 2);
+    CHECK(same_elements(reject, std::vector<int>{2, 3, 10, 11}));
+
+    // bulk overwrite keeps only the newest elements
+    std::vector<int> big(13);
+    for (int i = 0; i < 13; i++)
+    {
+        big[i] = 100 + i;
+    }
+    over.push_back(big.data(), big.size());
+    CHECK(over.size() == 8 && over.front() == 105 && over.back() == 112);
+}
+
+static void circular_buffer_objects()
+{
+    ds::circular_buffer<std::string> window(4);
+    std::deque<std::string> model;
+
+    for (int i = 0; i < 50; i++)
+    {
+        std::string s(30, char('a' + i % 26));
+        window.push_back(s);
+        model.push_back(s);
+        if (model.size() > 4)
+        {
+            model.pop_front();
+        }
+        if (i % 7 == 0)
+        {
+            window.pop_front();
+            model.pop_front();
+        }
+    }
+    CHECK(same_elements(window, model));
+
+    ds::circular_buffer<std::string> copy(window);
+    CHECK(same_elements(copy, model));
+
+    ds::circular_buffer<std::string> moved(std::move(copy));
+    CHECK(same_elements(moved, model));
+    CHECK(!copy.push_back("x"));
+
+    window.clear();
+    CHECK(window.empty());
+}
+
+// every element is in the model at the address it was inserted at
+template <typename T>
+static bool hive_matches(const ds::hive<T> &_h, const std::map<T, const T *> &_model)
+{
+    std::size_t forward = 0;
+    for (const T &x : _h)
+    {
+        auto found = _model.find(x);
+        if (found == _model.end() || found->second != &x)
+        {
+            return false;
+        }
+        forward++;
+    }
+
+    std::size_t backward = 0;
+    for (auto it = _h.end(); it != _h.begin();)
+    {
+        --it;
+        backward++;
+    }
+
+    return forward == _model.size() && backward == _model.size() && _h.size() == _model.size();
+}
+
+template <typename T, typename Make>
+static void hive_churn(Make _make)
+{
+    std::mt19937 rng(40);
+    ds::hive<T> h;
+    std::map<T, const T *> model;
+    int next = 0;
+
+    for (int step = 0; step < 20000; step++)
+    {
+        // grow to a few blocks, then churn around that size
+        if (model.empty() || rng() % 100 < (step < 10000 ? 60u : 50u))
+        {
+            auto it = h.insert(_make(next++));
+            model[*it] = &*it;
+        }
+        else
+        {
+            auto victim = model.begin();
+            std::advance(victim, rng() % model.size());
+            auto it = h.erase(h.get_iterator(victim->second));
+            model.erase(victim);
+            CHECK(it == h.end() || model.count(*it) == 1);
+        }
+    }
+    CHECK(hive_matches(h, model));
+
+    const T pivot = _make(1000);
+    const std::size_t removed = ds::erase_if(h, [&pivot](const T &x) { return x < pivot; });
+    for (auto it = model.begin(); it != model.end();)
+    {
+        it = it->first < pivot ? model.erase(it) : std::next(it);
+    }
+    CHECK(removed != 0);
+    CHECK(hive_matches(h, model));
+
+    ds::hive<T> copy(h);
+    CHECK(copy.size() == h.size());
+    CHECK(std::is_permutation(copy.begin(), copy.end(), h.begin()));
+
+    ds::hive<T> moved(std::move(h));
+    CHECK(hive_matches(moved, model));
+    CHECK(h.empty() && h.begin() == h.end());
+
+    moved.erase(moved.begin(), moved.end());
+    CHECK(moved.empty() && moved.begin() == moved.end());
+    CHECK(moved.capacity() == ds::hive<T>::block_capacity());
+    moved.shrink_to_fit();
+    CHECK(moved.capacity() == 0);
+}
+
+static void hive_slot_reuse()
+{
+    ds::hive<int> h;
+    std::vector<int *> addresses;
+    for (int i = 0; i < 100; i++)
+    {
+        addresses.push_back(&*h.insert(i));
+    }
+    const std::size_t capacity = h.capacity();
+
+    // erase a run in the middle, then refill it: nothing new is allocated
+    // and the freed slots are the ones handed back
+    auto first = h.get_iterator(addresses[40]);
+    auto last = h.get_iterator(addresses[60]);
+    auto after = h.erase(first, last);
+    CHECK(&*after == addresses[60]);
+    CHECK(h.size() == 80);
+
+    std::vector<int *> reused;
+    for (int i = 0; i < 20; i++)
+    {
+        reused.push_back(&*h.insert(1000 + i));
+    }
+    CHECK(h.capacity() == capacity);
+    std::sort(reused.begin(), reused.end());
+    CHECK(std::equal(reused.begin(), reused.end(), addresses.begin() + 40));
+
+    int sum = 0;
+    for (int x : h)
+    {
+        sum += x;
+    }
+    CHECK(sum == (0 + 99) * 100 / 2 - (40 + 59) * 20 / 2 + (1000 + 1019) * 20 / 2);
+
+    ds::hive<std::string> words{"alpha", "beta", "gamma"};
+    words.erase(words.begin());
+    CHECK(words.size() == 2 && *words.begin() == "beta");
+}
+
+template <typename T, std::size_t Arity, typename Make>
+static void priority_queue_against_std(Make _make)
+{
+    std::mt19937 rng(48);
+    ds::priority_queue<T, std::less<T>, Arity> heap;
+    std::priority_queue<T> model;
+
+    for (int step = 0; step < 20000; step++)
+    {
+        const unsigned op = rng() % 10;
+        if (op < 5)
+        {
+            const T value = _make(int(rng() % 1000));
+            heap.push(value);
+            model.push(value);
+        }
+        else if (op < 9)
+        {
+            if (!model.empty())
+            {
+                CHECK(heap.top() == model.top());
+                heap.pop();
+                model.pop();
+            }
+        }
+        else
+        {
+            // batches both small and large relative to the heap
+            std::vector<T> batch;
+            const std::size_t count = rng() % 2 == 0 ? rng() % 4 : rng() % 400;
+            for (std::size_t i = 0; i < count; i++)
+            {
+                batch.push_back(_make(int(rng() % 1000)));
+                model.push(batch.back());
+            }
+            heap.push_range(batch.begin(), batch.end());
+        }
+        CHECK(heap.size() == model.size());
+    }
+
+    while (!model.empty())
+    {
+        CHECK(heap.take() == model.top());
+        model.pop();
+    }
+    CHECK(heap.empty());
+}
+
+// a Dijkstra-style queue of node ids ordered by distance, with the
+// position of each node kept through OnMove
+static void priority_queue_positions()
+{
+    struct by_distance
+    {
+        const std::vector<unsigned> *dist;
+        bool operator()(int _a, int _b) const { return (*dist)[std::size_t(_a)] > (*dist)[std::size_t(_b)]; }
+    };
+    struct track
+    {
+        std::vector<std::size_t> *pos;
+        void operator()(int _node, std::size_t _position) const { (*pos)[std::size_t(_node)] = _position; }
+    };
+
+    const std::size_t nodes = 500;
+    std::vector<unsigned> dist(nodes);
+    std::vector<std::size_t> pos(nodes);
+    std::vector<bool> queued(nodes, true);
+    std::mt19937 rng(480);
+
+    std::vector<int> ids;
+    for (std::size_t i = 0; i < nodes; i++)
+    {
+        dist[i] = 100000 + rng() % 100000;
+        ids.push_back(int(i));
+    }
+
+    ds::priority_queue<int, by_distance, 4, track> heap(ids.begin(), ids.end(), by_distance{&dist}, track{&pos});
+
+    const auto positions_valid = [&]
+    {
+        for (std::size_t i = 0; i < heap.size(); i++)
+        {
+            if (pos[std::size_t(heap[i])] != i)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    CHECK(positions_valid());
+
+    bool ordered = true;
+    while (!heap.empty())
+    {
+        const unsigned op = rng() % 4;
+        const int node = heap[rng() % heap.size()];
+        if (op == 0)
+        {
+            dist[std::size_t(node)] -= rng() % 1000;
+            heap.decrease_key(pos[std::size_t(node)], node);
+        }
+        else if (op == 1)
+        {
+            dist[std::size_t(node)] = dist[std::size_t(node)] - 500 + rng() % 1000;
+            heap.update(pos[std::size_t(node)], node);
+        }
+        else if (op == 2 && rng() % 8 == 0)
+        {
+            heap.erase(pos[std::size_t(node)]);
+            queued[std::size_t(node)] = false;
+        }
+        else
+        {
+            // every node still queued is at least as far as the top
+            const int top = heap.take();
+            queued[std::size_t(top)] = false;
+            for (std::size_t i = 0; i < nodes; i++)
+            {
+                ordered = ordered && (!queued[i] || dist[i] >= dist[std::size_t(top)]);
+            }
+        }
+        CHECK(positions_valid());
+    }
+    CHECK(ordered);
+
+    bool threw = false;
+    ds::priority_queue<int> plain;
+    plain.push(5);
+    try
+    {
+        plain.decrease_key(0, 3);
+    }
+    catch (const std::invalid_argument &)
+    {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+static void radix_heap_monotone()
+{
+    std::mt19937 rng(4800);
+    ds::radix_heap<unsigned, std::string> heap;
+    std::priority_queue<std::pair<unsigned, std::string>, std::vector<std::pair<unsigned, std::string>>, std::greater<>> model;
+
+    // keys pushed never go below the current minimum, as in Dijkstra
+    unsigned floor = 0;
+    for (int step = 0; step < 20000; step++)
+    {
+        if (rng() % 3 != 0 || model.empty())
+        {
+            const unsigned key = floor + rng() % (rng() % 2 == 0 ? 16 : 1u << 20);
+            heap.push(key, std::to_string(key));
+            model.emplace(key, std::to_string(key));
+        }
+        else
+        {
+            CHECK(heap.top().first == model.top().first && heap.top().second == std::to_string(heap.top().first));
+            floor = heap.top().first;
+            heap.pop();
+            model.pop();
+        }
+        CHECK(heap.size() == model.size());
+    }
+
+    while (!model.empty())
+    {
+        CHECK(heap.top().first == model.top().first);
+        heap.pop();
+        model.pop();
+    }
+
+    bool threw = false;
+    try
+    {
+        heap.push(heap.last_key() - 1, "");
+    }
+    catch (const std::invalid_argument &)
+    {
+        threw = true;
+    }
+    CHECK(threw && heap.empty());
+
+    // an empty heap has no top and ignores pop
+    threw = false;
+    try
+    {
+        heap.top();
+    }
+    catch (const std::out_of_range &)
+    {
+        threw = true;
+    }
+    heap.pop();
+    CHECK(threw && heap.empty() && heap.size() == 0);
+    heap.push(heap.last_key(), "again");
+    CHECK(heap.top().second == "again");
+
+    ds::radix_heap<std::uint64_t, int> wide;
+    wide.push(~std::uint64_t(0), 2);
+    wide.push(1, 1);
+    CHECK(wide.top().second == 1);
+    wide.pop();
+    CHECK(wide.top().first == ~std::uint64_t(0));
+}
+
+// sorts the same data with ds::sort and std::sort over sizes around the
+// radix cut-off and the small-partition paths, on several input patterns
+template <typename T, typename Compare, typename Make>
+static void sort_against_std(Make _make, Compare _comp = Compare())
+{
+    std::mt19937 rng(49);
+    const std::size_t sizes[] = {0, 1, 2, 5, 16, 17, 24, 100, 1023, 1024, 5000, 40000};
+
+    for (std::size_t n : sizes)
+    {
+        for (int pattern = 0; pattern < 5; pattern++)
+        {
+            std::vector<T> model;
+            for (std::size_t i = 0; i < n; i++)
+            {
+                switch (pattern)
+                {
+                case 0: // random
+                    model.push_back(_make(std::int64_t(rng())));
+                    break;
+                case 1: // few distinct values
+                    model.push_back(_make(std::int64_t(rng() % 4)));
+                    break;
+                case 2: // ascending
+                    model.push_back(_make(std::int64_t(i)));
+                    break;
+                case 3: // descending
+                    model.push_back(_make(-std::int64_t(i)));
+                    break;
+                default: // organ pipe
+                    model.push_back(_make(std::int64_t(i < n / 2 ? i : n - i)));
+                    break;
+                }
+            }
+
+            ds::vector<T> v;
+            for (const T &x : model)
+            {
+                v.push_back(x);
+            }
+            ds::sort(v, _comp);
+            std::sort(model.begin(), model.end(), _comp);
+
+            // elements equal under _comp may differ otherwise, so compare
+            // order and contents separately
+            bool sorted = true;
+            for (std::size_t i = 1; i < n; i++)
+            {
+                sorted = sorted && !_comp(v[i], v[i - 1]);
+            }
+            CHECK(sorted);
+            CHECK(v.size() == model.size());
+
+            std::vector<T> got(v.begin(), v.end());
+            std::sort(got.begin(), got.end());
+            std::sort(model.begin(), model.end());
+            CHECK(got == model);
+        }
+    }
+}
+
+static void sort_special_values()
+{
+    const double inf = std::numeric_limits<double>::infinity();
+    ds::vector<double> v;
+    std::vector<double> model;
+    std::mt19937 rng(490);
+    for (int i = 0; i < 3000; i++)
+    {
+        const double x = i % 7 == 0 ? -inf : i % 11 == 0 ? inf : i % 13 == 0 ? -0.0 : (double(rng()) - 2e9) / 1e3;
+        v.push_back(x);
+        model.push_back(x);
+    }
+    ds::sort(v);
+    std::sort(model.begin(), model.end());
+    CHECK(same_elements(v, model));
+
+    ds::vector<std::int8_t> bytes;
+    for (int i = 0; i < 5000; i++)
+    {
+        bytes.push_back(std::int8_t(rng()));
+    }
+    ds::sort(bytes, std::greater<>());
+    CHECK(std::is_sorted(bytes.begin(), bytes.end(), std::greater<>()));
+}
+
+static void sort_by_key_stable()
+{
+    for (std::size_t n : {std::size_t(10), std::size_t(3000)})
+    {
+        std::mt19937 rng(4900);
+        ds::vector<std::uint32_t> keys;
+        ds::vector<std::string> values;
+        std::vector<std::pair<std::uint32_t, std::string>> model;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            keys.push_back(rng() % 50);
+            values.push_back(std::to_string(i));
+            model.emplace_back(keys.back(), values.back());
+        }
+
+        ds::sort_by_key(keys, values);
+        std::stable_sort(model.begin(), model.end(), [](const auto &_a, const auto &_b)
+                         { return _a.first < _b.first; });
+
+        bool same = keys.size() == n && values.size() == n;
+        for (std::size_t i = 0; same && i < n; i++)
+        {
+            same = keys[i] == model[i].first && values[i] == model[i].second;
+        }
+        CHECK(same);
+
+        // a key with no radix path goes through the index sort
+        ds::vector<std::string> names;
+        ds::vector<std::size_t> ids;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            names.push_back(std::to_string(rng() % 97));
+            ids.push_back(i);
+        }
+        ds::sort_by_key(names, ids, std::greater<std::string>());
+        bool ordered = true;
+        for (std::size_t i = 1; i < n; i++)
+        {
+            ordered = ordered && (names[i - 1] > names[i] || (names[i - 1] == names[i] && ids[i - 1] < ids[i]));
+        }
+        CHECK(ordered);
+    }
+
+    bool threw = false;
+    ds::vector<int> keys(3, 0);
+    ds::vector<int> values(2, 0);
+    try
+    {
+        ds::sort_by_key(keys, values);
+    }
+    catch (const std::invalid_argument &)
+    {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+// gathers through random, repeated and edge indices with several prefetch
+// distances and checks each against operator[]
+static void gather_indices()
+{
+    std::mt19937 rng(50);
+    const std::size_t n = 20000;
+
+    ds::vector<std::string> v;
+    ds::deque<std::string> d(n);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        v.push_back(std::to_string(i));
+        d[i] = std::to_string(i);
+    }
+
+    for (std::size_t count : {std::size_t(0), std::size_t(1), std::size_t(7), std::size_t(5000)})
+    {
+        ds::vector<std::uint32_t> indices;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            indices.push_back(i % 5 == 0 ? std::uint32_t(n - 1) : std::uint32_t(rng() % n));
+        }
+
+        for (std::size_t distance : {std::size_t(0), std::size_t(3), std::size_t(16), std::size_t(100000)})
+        {
+            std::vector<std::string> fromVector;
+            std::vector<std::string> fromDeque(count);
+            ds::gather(v, indices, std::back_inserter(fromVector), distance);
+            const auto end = ds::gather(d, indices, fromDeque.begin(), distance);
+
+            bool same = fromVector.size() == count && end == fromDeque.end();
+            for (std::size_t i = 0; same && i < count; i++)
+            {
+                same = fromVector[i] == v[indices[i]] && fromDeque[i] == d[indices[i]];
+            }
+            CHECK(same);
+        }
+    }
+
+    // indices from a plain array, into a raw buffer
+    const ds::vector<double> table{0.5, 1.5, 2.5, 3.5};
+    const int picks[] = {3, 0, 3, 2};
+    double out[4] = {};
+    CHECK(ds::gather(table, picks, out) == out + 4 && out[0] == 3.5 && out[1] == 0.5 && out[3] == 2.5);
+}
+
+// random updates on a persistent_vector; every version kept along the
+// way must still match the std::vector it was checked against
+template <typename T, typename Make>
+static void persistent_vector_versions(Make _make)
+{
+    std::mt19937 rng(41);
+    std::vector<ds::persistent_vector<T>> versions;
+    std::vector<std::vector<T>> models;
+
+    ds::persistent_vector<T> v;
+    std::vector<T> model;
+    for (int i = 0; i < 3000; i++)
+    {
+        v = v.push_back(_make(i));
+        model.push_back(_make(i));
+        if (i % 500 == 0)
+        {
+            versions.push_back(v);
+            models.push_back(model);
+        }
+    }
+    CHECK(same_elements(v, model) && v.front() == model.front() && v.back() == model.back());
+
+    for (int step = 0; step < 400; step++)
+    {
+        const std::size_t n = model.size();
+        switch (rng() % 7)
+        {
+        case 0:
+            v = v.push_back(_make(step));
+            model.push_back(_make(step));
+            break;
+        case 1:
+            if (n != 0)
+            {
+                const std::size_t at = rng() % n;
+                v = v.set(at, _make(-step));
+                model[at] = _make(-step);
+            }
+            break;
+        case 2:
+            if (n != 0)
+            {
+                v = v.pop_back();
+                model.pop_back();
+            }
+            break;
+        case 3:
+        {
+            const std::size_t count = rng() % (n + 1);
+            v = v.take(count);
+            model.resize(count);
+            break;
+        }
+        case 4:
+        {
+            const std::size_t count = rng() % (n / 4 + 1);
+            v = v.drop(count);
+            model.erase(model.begin(), model.begin() + std::ptrdiff_t(count));
+            break;
+        }
+        case 5:
+        {
+            const std::size_t first = rng() % (n + 1);
+            const std::size_t last = first + rng() % (n - first + 1);
+            v = v.slice(first, last);
+            model = std::vector<T>(model.begin() + std::ptrdiff_t(first), model.begin() + std::ptrdiff_t(last));
+            break;
+        }
+        default:
+        {
+            const std::size_t pick = rng() % versions.size();
+            v = v.concat(versions[pick]);
+            model.insert(model.end(), models[pick].begin(), models[pick].end());
+            break;
+        }
+        }
+
+        if (step % 20 == 0)
+        {
+            versions.push_back(v);
+            models.push_back(model);
+        }
+    }
+    CHECK(same_elements(v, model));
+
+    bool unchanged = true;
+    for (std::size_t i = 0; i < versions.size(); i++)
+    {
+        unchanged = unchanged && same_elements(versions[i], models[i]);
+    }
+    CHECK(unchanged);
+
+    bool threw = false;
+    try
+    {
+        v.at(v.size());
+    }
+    catch (const std::out_of_range &)
+    {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+static void persistent_vector_transients()
+{
+    const ds::persistent_vector<std::string> base{"a", "b", "c"};
+
+    // a transient mutates its own nodes in place and leaves the source alone
+    auto t = base.transient();
+    std::vector<std::string> model{"a", "b", "c"};
+    for (int i = 0; i < 2000; i++)
+    {
+        t.push_back(std::to_string(i));
+        model.push_back(std::to_string(i));
+    }
+    t.set(1, "B");
+    model[1] = "B";
+    CHECK(t.size() == model.size() && t[1] == "B" && t[2002] == "1999");
+    CHECK(base.size() == 3 && base[1] == "b");
+
+    // transients only move, so no two of them hold the same edit token
+    static_assert(!std::is_copy_constructible_v<ds::persistent_vector<std::string>::transient_vector>);
+    static_assert(!std::is_copy_assignable_v<ds::persistent_vector<std::string>::transient_vector>);
+    auto moved = std::move(t);
+    t = std::move(moved);
+    CHECK(t.size() == model.size() && t[1] == "B");
+
+    // the frozen version survives further writes through the transient
+    const ds::persistent_vector<std::string> frozen = t.persistent();
+    CHECK(same_elements(frozen, model));
+
+    t.set(0, "changed");
+    t.pop_back();
+    t.drop(10);
+    t.take(100);
+    t.emplace_back(3, 'z');
+    CHECK(same_elements(frozen, model));
+    CHECK(t.size() == 101 && t[0] == model[10] && t[100] == "zzz");
+
+    const ds::persistent_vector<std::string> second = t.persistent();
+    CHECK(second.size() == 101 && second[99] == model[109] && second.back() == "zzz");
+
+    // concat of two versions that share most of their nodes
+    const ds::persistent_vector<std::string> both = frozen.concat(second);
+    CHECK(both.size() == frozen.size() + second.size() && both[frozen.size()] == model[10]);
+    CHECK(same_elements(frozen, model));
+}
+
+int main()
+{
+    gap_buffer_cursor();
+    gap_buffer_random_edits<int>([](int i) { return i; });
+    gap_buffer_random_edits<std::string>([](int i) { return std::string(40, char('a' + i % 26)); });
+    circular_buffer_policies();
+    circular_buffer_objects();
+    hive_slot_reuse();
+    hive_churn<long>([](int i) { return long(i); });
+    hive_churn<std::string>([](int i)
+                            {
+                                char digits[16];
+                                std::snprintf(digits, sizeof(digits), "%08d", i);
+                                return std::string(digits) + std::string(20, 'x'); });
+
+    priority_queue_against_std<int, 4>([](int i) { return i; });
+    priority_queue_against_std<int, 2>([](int i) { return i; });
+    priority_queue_against_std<std::string, 8>([](int i) { return std::string(20, 'x') + std::to_string(i); });
+    priority_queue_positions();
+    radix_heap_monotone();
+    sort_against_std<int, std::less<int>>([](std::int64_t i) { return int(i); });
+    sort_against_std<std::uint64_t, std::less<>>([](std::int64_t i) { return std::uint64_t(i) * 0x9E3779B97F4A7C15ull; });
+    sort_against_std<std::int64_t, std::greater<std::int64_t>>([](std::int64_t i) { return i - (std::int64_t(1) << 40); });
+    sort_against_std<float, std::less<float>>([](std::int64_t i) { return float(i % 100000) / 7.0f; });
+    sort_against_std<int, bool (*)(int, int)>([](std::int64_t i) { return int(i % 1000); }, [](int _a, int _b) { return _a % 100 < _b % 100; });
+    sort_against_std<std::string, std::less<std::string>>([](std::int64_t i) { return std::to_string(i % 5000); });
+    sort_special_values();
+    sort_by_key_stable();
+    gather_indices();
+    persistent_vector_versions<int>([](int i) { return i; });
+    persistent_vector_versions<std::string>([](int i) { return std::string(24, 'p') + std::to_string(i); });
+    persistent_vector_transients();
+
+    if (failures != 0)
+    {
+        std::printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    std::printf("all container checks passed\n");
+    return 0;
+}
@@ -0,0 +1,565 @@
+// Counts element operations and allocations made by ds::vector and
+// ds::deque and checks them against fixed upper bounds. Unlike timings,
+// the counts are deterministic, so a hidden extra copy fails here.
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+#include "../include/ds/vector.hpp"
+#include "../include/ds/deque.hpp"
+#include "Counted.hpp"
+#include "alloc_counter.hpp"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                           \
+    do                                                                        \
+    {                                                                         \
+        if (!(cond))                                                          \
+        {                                                                     \
+            std::printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures;                                                       \
+        }                                                                     \
+    } while (0)
+
+static const Counted::Counters &ops() { return Counted::counters; }
+
+static void vector_constructors()
+{
+    {
+        Counted::reset();
+        AllocCounter alloc;
+        ds::vector<Counted> v;
+        CHECK(alloc.allocations == 0);
+    }
+
+    {
+        Counted::reset();
+        AllocCounter alloc;
+        ds::vector<Counted> v(100);
+        CHECK(ops().defaultConstructs == 100);
+        CHECK(ops().copies() == 0 && ops().moves() == 0);
+        CHECK(alloc.allocations == 1);
+        CHECK(alloc.bytesAllocated == 100 * sizeof(Counted));
+    }
+
+    {
+        Counted value(7);
+        Counted::reset();
+        AllocCounter alloc;
+        ds::vector<Counted> v(100, value);
+        CHECK(ops().copyConstructs == 100);
+        CHECK(ops().moves() == 0);
+        CHECK(alloc.allocations == 1);
+    }
+
+    {
+        ds::vector<Counted> src(10);
+        src.reserve(1000);
+        Counted::reset();
+        AllocCounter alloc;
+        ds::vector<Counted> copy(src);
+        CHECK(ops().copyConstructs == 10);
+        CHECK(ops().moves() == 0);
+        CHECK(alloc.allocations == 1);
+        CHECK(alloc.bytesAllocated == 10 * sizeof(Counted)); // spare capacity is not copied
+    }
+
+    {
+        ds::vector<Counted> src(10);
+        Counted::reset();
+        AllocCounter alloc;
+        ds::vector<Counted> moved(std::move(src));
+        CHECK(ops().constructs() == 0 && ops().destructs == 0);
+        CHECK(alloc.allocations == 0);
+        CHECK(moved.size() == 10 && src.size() == 0);
+    }
+}
+
+static void vector_assignment()
+{
+    {
+        ds::vector<Counted> src(10);
+        ds::vector<Counted> dst(20);
+        Counted::reset();
+        AllocCounter alloc;
+        dst = src;
+        CHECK(ops().copyAssigns == 10);
+        CHECK(ops().copyConstructs == 0);
+        CHECK(ops().destructs == 10);
+        CHECK(alloc.allocations == 0);
+        CHECK(dst.size() == 10);
+    }
+
+    {
+        ds::vector<Counted> src(10);
+        ds::vector<Counted> dst(5);
+        dst.reserve(50);
+        Counted::reset();
+        AllocCounter alloc;
+        dst = src;
+        CHECK(ops().copies() == 10);
+        CHECK(alloc.allocations == 0); // fits in the existing buffer
+    }
+
+    {
+        ds::vector<Counted> src(10);
+        ds::vector<Counted> dst(3);
+        Counted::reset();
+        AllocCounter alloc;
+        dst = std::move(src);
+        CHECK(ops().constructs() == 0 && ops().copies() == 0 && ops().moves() == 0);
+        CHECK(ops().destructs == 3);
+        CHECK(alloc.allocations == 0);
+    }
+}
+
+static void vector_push_back()
+{
+    const std::size_t n = 1000;
+
+    {
+        Counted::reset();
+        AllocCounter alloc;
+        ds::vector<Counted> v;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            v.push_back(Counted(int(i)));
+        }
+        // nothrow-movable elements are never copied; one move per call plus
+        // fewer than 2n relocations from doubling
+        CHECK(ops().copies() == 0);
+        CHECK(ops().moves() <= 3 * n);
+        CHECK(alloc.allocations <= 11);
+        CHECK(alloc.bytesAllocated <= 4 * n * sizeof(Counted));
+    }
+
+    {
+        Counted value(3);
+        Counted::reset();
+        ds::vector<Counted> v;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            v.push_back(value);
+        }
+        CHECK(ops().copies() == n);
+    }
+
+    {
+        // the argument refers into the buffer that push_back reallocates
+        ds::vector<Counted> v;
+        v.push_back(Counted(42));
+        for (int i = 0; i < 10; i++)
+        {
+            v.push_back(v[0]);
+        }
+        bool same = true;
+        for (std::size_t i = 0; i < v.size(); i++)
+        {
+            same = same && v[i].value == 42;
+        }
+        CHECK(same);
+    }
+
+    {
+        ds::vector<Counted> v(10);
+        Counted::reset();
+        AllocCounter alloc;
+        v.pop_back();
+        CHECK(ops().destructs == 1);
+        v.clear();
+        CHECK(ops().destructs == 10);
+        CHECK(alloc.allocations == 0);
+    }
+}
+
+static void vector_emplace_insert()
+{
+    {
+        ds::vector<Counted> v(10);
+        v.reserve(20);
+        Counted::reset();
+        v.emplace(v.end(), 1, 2);
+        CHECK(ops().valueConstructs == 1);
+        CHECK(ops().copies() == 0 && ops().moves() == 0);
+        CHECK(v.back().value == 3);
+    }
+
+    {
+        ds::vector<Counted> v(10);
+        v.reserve(20);
+        Counted::reset();
+        AllocCounter alloc;
+        v.emplace(v.begin() + 4, 1, 2);
+        CHECK(ops().valueConstructs == 1); // no temporary
+        CHECK(ops().copies() == 0);
+        CHECK(ops().moves() == 6);
+        CHECK(alloc.allocations == 0);
+        CHECK(v[4].value == 3 && v.size() == 11);
+    }
+
+    {
+        ds::vector<Counted> v(8);
+        Counted::reset();
+        AllocCounter alloc;
+        v.emplace(v.begin() + 4, 1, 2);
+        CHECK(ops().valueConstructs == 1);
+        CHECK(ops().copies() == 0);
+        CHECK(ops().moves() == 8);
+        CHECK(alloc.allocations == 1);
+        CHECK(v[4].value == 3 && v.size() == 9);
+    }
+
+    {
+        ds::vector<Counted> v(10);
+        v.reserve(20);
+        Counted value(5);
+        Counted::reset();
+        v.insert(v.begin() + 4, value);
+        CHECK(ops().copies() == 1);
+        CHECK(ops().moves() == 6);
+        CHECK(v[4].value == 5);
+    }
+
+    {
+        ds::vector<Counted> v(10);
+        v.reserve(20);
+        Counted::reset();
+        v.insert(v.begin() + 4, Counted(5));
+        CHECK(ops().copies() == 0);
+        CHECK(ops().moves() == 7);
+        CHECK(v[4].value == 5);
+    }
+
+    {
+        ds::vector<Counted> v(10);
+        Counted::reset();
+        v.insert(v.begin(), Counted(5));
+        CHECK(ops().copies() == 0);
+        CHECK(v[0].value == 5 && v.size() == 11);
+    }
+}
+
+// values 0..9, then three copies of 99 (or 97, 98, 99 from a list) at _at
+static bool inserted_at(const ds::vector<Counted> &_v, std::size_t _at, bool _list)
+{
+    bool ok = _v.size() == 13;
+    for (std::size_t i = 0; ok && i < 13; i++)
+    {
+        const int expected = i < _at ? int(i) : i < _at + 3 ? (_list ? int(97 + i - _at) : 99) : int(i - 3);
+        ok = _v[i].value == expected;
+    }
+    return ok;
+}
+
+static void vector_insert_many()
+{
+    // front, middle and end; every element of the tail moves exactly once,
+    // into a raw slot or over a live one, and each new value is one copy
+    for (std::size_t at : {std::size_t(0), std::size_t(4), std::size_t(8), std::size_t(10)})
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            const bool list = i == 1;
+            ds::vector<Counted> v;
+            v.reserve(20);
+            for (int k = 0; k < 10; k++)
+            {
+                v.emplace(v.end(), k);
+            }
+            Counted value(99);
+            Counted::reset();
+            AllocCounter alloc;
+            if (list)
+            {
+                v.insert(v.begin() + std::ptrdiff_t(at), {Counted(97), Counted(98), Counted(99)});
+            }
+            else
+            {
+                v.insert(v.begin() + std::ptrdiff_t(at), 3, value);
+            }
+            CHECK(ops().copyConstructs + ops().copyAssigns == 3);
+            CHECK(ops().moves() == 10 - at);
+            CHECK(ops().destructs == (list ? 3u : 0u)); // the list's own elements
+            CHECK(alloc.allocations == 0);
+            CHECK(inserted_at(v, at, list));
+        }
+    }
+
+    // without spare capacity the new values are built in the new buffer and
+    // every old element is relocated once
+    for (std::size_t at : {std::size_t(0), std::size_t(4), std::size_t(10)})
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            const bool list = i == 1;
+            ds::vector<Counted> v;
+            v.reserve(10);
+            for (int k = 0; k < 10; k++)
+            {
+                v.emplace(v.end(), k);
+            }
+            Counted value(99);
+            Counted::reset();
+            AllocCounter alloc;
+            if (list)
+            {
+                v.insert(v.begin() + std::ptrdiff_t(at), {Counted(97), Counted(98), Counted(99)});
+            }
+            else
+            {
+                v.insert(v.begin() + std::ptrdiff_t(at), 3, value);
+            }
+            CHECK(ops().copyConstructs == 3 && ops().copyAssigns == 0);
+            CHECK(ops().moveConstructs == 10 && ops().moveAssigns == 0);
+            CHECK(alloc.allocations == 1);
+            CHECK(v.capacity() == 20);
+            CHECK(inserted_at(v, at, list));
+        }
+    }
+
+    {
+        // an element of the vector itself as the value
+        ds::vector<Counted> v;
+        v.reserve(8);
+        v.emplace(v.end(), 1);
+        v.emplace(v.end(), 2);
+        v.insert(v.begin(), 2, v[1]);
+        CHECK(v.size() == 4 && v[0].value == 2 && v[1].value == 2 && v[2].value == 1 && v[3].value == 2);
+    }
+
+    {
+        ds::vector<Counted> v(4);
+        Counted::reset();
+        AllocCounter alloc;
+        v.insert(v.begin() + 2, 0, Counted(1));
+        CHECK(ops().copies() == 0 && ops().moves() == 0);
+        CHECK(alloc.allocations == 0 && v.size() == 4);
+    }
+
+    {
+        // an empty vector grows to exactly what the list needs
+        ds::vector<Counted> v;
+        Counted::reset();
+        AllocCounter alloc;
+        v.insert(v.begin(), {Counted(1), Counted(2), Counted(3)});
+        CHECK(ops().copyConstructs == 3 && ops().moves() == 0);
+        CHECK(alloc.allocations == 1 && v.capacity() == 3);
+        CHECK(v.size() == 3 && v[0].value == 1 && v[2].value == 3);
+    }
+}
+
+static void vector_capacity_erase()
+{
+    {
+        ds::vector<Counted> v(10);
+        Counted::reset();
+        AllocCounter alloc;
+        v.reserve(100);
+        CHECK(ops().moveConstructs == 10);
+        CHECK(ops().copies() == 0);
+        CHECK(alloc.allocations == 1);
+        CHECK(alloc.bytesAllocated == 100 * sizeof(Counted));
+
+        Counted::reset();
+        v.shrink_to_fit();
+        CHECK(ops().moveConstructs == 10);
+        CHECK(ops().copies() == 0);
+        CHECK(alloc.allocations == 2);
+    }
+
+    {
+        ds::vector<Counted> v(10);
+        Counted::reset();
+        AllocCounter alloc;
+        v.erase(v.begin() + 4);
+        CHECK(ops().copies() == 0);
+        CHECK(ops().moveAssigns == 5);
+        CHECK(ops().destructs == 1);
+        CHECK(alloc.allocations == 0);
+        CHECK(v.size() == 9);
+    }
+
+    {
+        ds::vector<Counted> v(100);
+        Counted::reset();
+        v.erase(v.begin() + 10, v.begin() + 40);
+        CHECK(ops().copies() == 0);
+        CHECK(ops().moveAssigns == 60); // each survivor moves once
+        CHECK(ops().destructs == 30);
+        CHECK(v.size() == 70);
+    }
+
+    {
+        ds::vector<Counted> v;
+        for (int i = 0; i < 1000; i++)
+        {
+            v.push_back(Counted(i));
+        }
+
+        Counted::reset();
+        std::size_t removed = ds::erase_if(v, [](const Counted &c) { return c.value % 3 == 0; });
+        CHECK(removed == 334);
+        CHECK(v.size() == 666);
+        CHECK(v[0].value == 1 && v[1].value == 2 && v[2].value == 4);
+        CHECK(ops().copies() == 0);
+        CHECK(ops().moveAssigns <= 666);
+        CHECK(ops().destructs == 334);
+
+        Counted::reset();
+        v.unordered_erase(v.begin());
+        CHECK(ops().moveAssigns == 1 && ops().destructs == 1);
+        CHECK(v.size() == 665 && v[0].value == 998);
+    }
+}
+
+static void vector_adopt_release()
+{
+    // a buffer from "another library": malloc'd and constructed in place
+    Counted *raw = static_cast<Counted *>(std::malloc(8 * sizeof(Counted)));
+    for (int i = 0; i < 5; i++)
+    {
+        new (raw + i) Counted(i);
+    }
+
+    int freed = 0;
+
+    {
+        Counted::reset();
+        ds::vector<Counted> v;
+
+        {
+            AllocCounter alloc;
+            v.adopt(raw, 5, 8, [&freed](Counted *_p, std::size_t _capacity)
+                    {
+                        CHECK(_capacity == 8);
+                        std::free(_p);
+                        freed++;
+                    });
+            CHECK(alloc.allocations == 1); // the type-erased deleter only
+        }
+
+        CHECK(ops().copies() == 0 && ops().moves() == 0);
+        CHECK(v.size() == 5 && v.capacity() == 8 && v[4].value == 4);
+
+        for (int i = 5; i < 9; i++)
+        {
+            v.push_back(Counted(i));
+        }
+
+        // growing past the adopted capacity frees it through the deleter
+        CHECK(freed == 1);
+        CHECK(v[8].value == 8);
+
+        // release and re-adopt: no element is touched, nothing allocated
+        Counted::reset();
+        AllocCounter alloc;
+        ds::vector<Counted>::buffer b = v.release();
+        CHECK(v.size() == 0 && v.capacity() == 0 && v.data() == nullptr);
+
+        ds::vector<Counted> w;
+        w.adopt(std::move(b));
+        CHECK(w.size() == 9 && w[0].value == 0);
+        CHECK(ops().copies() == 0 && ops().moves() == 0 && ops().destructs == 0);
+        CHECK(alloc.allocations == 0);
+    }
+
+    CHECK(ops().destructs == 9);
+}
+
+static void deque_operations()
+{
+    const std::size_t n = 1000;
+    const std::size_t blocks = n / (DEQUE_BUF_SIZE / sizeof(Counted)) + 1;
+
+    {
+        Counted::reset();
+        AllocCounter alloc;
+        ds::deque<Counted> d(n);
+        CHECK(ops().defaultConstructs == n);
+        CHECK(ops().copies() == 0 && ops().moves() == 0);
+        CHECK(alloc.allocations == blocks + 1); // blocks plus the map
+    }
+    CHECK(ops().destructs == n);
+
+    {
+        Counted value(1);
+        Counted::reset();
+        ds::deque<Counted> d(n, value);
+        CHECK(ops().copyConstructs == n);
+        CHECK(ops().moves() == 0);
+    }
+
+    {
+        ds::deque<Counted> src(n);
+        Counted::reset();
+        AllocCounter alloc;
+        ds::deque<Counted> copy(src);
+        CHECK(ops().copyConstructs == n);
+        CHECK(ops().moves() == 0);
+        CHECK(alloc.allocations == blocks + 1);
+    }
+
+    {
+        ds::deque<Counted> src(n);
+        ds::deque<Counted> dst(n);
+        Counted::reset();
+        AllocCounter alloc;
+        dst = src;
+        CHECK(ops().copies() == n);
+        CHECK(ops().destructs == n);
+        CHECK(alloc.allocations == 0);
+    }
+
+    {
+        ds::deque<Counted> src(n);
+        Counted::reset();
+        AllocCounter alloc;
+        ds::deque<Counted> moved(std::move(src));
+        ds::deque<Counted> other(10);
+        Counted::reset();
+        other = std::move(moved);
+        CHECK(ops().constructs() == 0 && ops().copies() == 0 && ops().moves() == 0);
+        CHECK(ops().destructs == 10);
+        CHECK(other.size() == n);
+    }
+}
+
+int main()
+{
+    vector_constructors();
+    vector_assignment();
+    vector_push_back();
+    vector_emplace_insert();
+    vector_insert_many();
+    vector_capacity_erase();
+    vector_adopt_release();
+    deque_operations();
+
+    {
+        Counted::reset();
+        {
+            ds::vector<Counted> v;
+            for (int i = 0; i < 100; i++)
+            {
+                v.emplace(v.begin() + v.size() / 2, i, 0);
+            }
+            ds::vector<Counted> w(v);
+            w = v;
+            ds::deque<Counted> d(300);
+        }
+        CHECK(ops().constructs() == ops().destructs); // nothing leaked
+    }
+
+    if (failures != 0)
+    {
+        std::printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    std::printf("all operation counts within bounds\n");
+    return 0;
+}
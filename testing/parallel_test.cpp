@@ -0,0 +1,221 @@
+// Checks the parallel construction paths of ds::vector: contents, the page
+// aligned partition, that each part is built by its own thread, and that a
+// throwing constructor leaves nothing alive.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+#include "../include/ds/sort.hpp"
+#include "../include/ds/vector.hpp"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                           \
+    do                                                                        \
+    {                                                                         \
+        if (!(cond))                                                          \
+        {                                                                     \
+            std::printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures;                                                       \
+        }                                                                     \
+    } while (0)
+
+// remembers the thread that constructed it
+struct Tagged
+{
+    std::thread::id owner = std::this_thread::get_id();
+};
+
+// throws once the given number of constructions is reached
+struct Fragile
+{
+    static std::atomic<long> constructed;
+    static std::atomic<long> alive;
+    static long throwAt;
+
+    Fragile()
+    {
+        if (constructed.fetch_add(1) == throwAt)
+        {
+            throw std::runtime_error("Fragile");
+        }
+        alive++;
+    }
+
+    Fragile(const Fragile &) : Fragile() {}
+
+    ~Fragile() { alive--; }
+};
+
+std::atomic<long> Fragile::constructed{0};
+std::atomic<long> Fragile::alive{0};
+long Fragile::throwAt = -1;
+
+static const std::size_t COUNT = std::size_t(1) << 20;
+
+static void partition()
+{
+    const std::size_t workers = ds::parallel_workers(COUNT, sizeof(int), ds::parallel(4));
+    CHECK(workers == 4);
+
+    const std::size_t perPage = ds::detail::page_size() / sizeof(int);
+    std::size_t next = 0;
+
+    for (std::size_t t = 0; t < workers; t++)
+    {
+        auto part = ds::parallel_partition(COUNT, sizeof(int), workers, t);
+        CHECK(part.first == next);
+        CHECK(part.second == COUNT || part.second % perPage == 0);
+        next = part.second;
+    }
+
+    CHECK(next == COUNT);
+
+    // small ranges stay on the calling thread by default
+    CHECK(ds::parallel_workers(100, sizeof(int), ds::parallel) == 1);
+}
+
+static void construction()
+{
+    ds::vector<int> v(COUNT, 7, ds::parallel(4));
+    CHECK(v.size() == COUNT);
+    CHECK(v.capacity() == COUNT);
+
+    bool same = true;
+    for (std::size_t i = 0; i < COUNT; i++)
+    {
+        same = same && v[i] == 7;
+    }
+    CHECK(same);
+
+    ds::vector<int> zeros(COUNT, ds::parallel(4));
+    CHECK(zeros.size() == COUNT && zeros[0] == 0 && zeros[COUNT - 1] == 0);
+
+    ds::vector<int> empty(0, ds::parallel);
+    CHECK(empty.size() == 0);
+}
+
+static void first_touch_owner()
+{
+    const std::size_t count = COUNT / 4;
+    ds::vector<Tagged> v(count, ds::parallel(4));
+
+    const std::size_t workers = ds::parallel_workers(count, sizeof(Tagged), ds::parallel(4));
+    std::set<std::thread::id> owners;
+
+    for (std::size_t t = 0; t < workers; t++)
+    {
+        auto part = ds::parallel_partition(count, sizeof(Tagged), workers, t);
+
+        bool oneOwner = true;
+        for (std::size_t i = part.first; i < part.second; i++)
+        {
+            oneOwner = oneOwner && v[i].owner == v[part.first].owner;
+        }
+
+        CHECK(oneOwner);
+        owners.insert(v[part.first].owner);
+    }
+
+    CHECK(owners.size() == workers);
+
+    // parallel_for hands out the same parts
+    std::atomic<std::size_t> matching{0};
+    ds::parallel_for(count, sizeof(Tagged), ds::parallel(4), [&](std::size_t _first, std::size_t _last, std::size_t _worker)
+                     {
+                         auto part = ds::parallel_partition(count, sizeof(Tagged), workers, _worker);
+                         matching += part.first == _first && part.second == _last;
+                     });
+    CHECK(matching == workers);
+}
+
+static void reserve_and_assign()
+{
+    ds::vector<int> v;
+    for (int i = 0; i < 1000; i++)
+    {
+        v.push_back(i);
+    }
+
+    v.reserve(COUNT, ds::parallel(4));
+    CHECK(v.capacity() == COUNT);
+    CHECK(v.size() == 1000 && v[0] == 0 && v[999] == 999);
+
+    v.assign(COUNT, 3, ds::parallel(4));
+    CHECK(v.size() == COUNT && v[0] == 3 && v[COUNT - 1] == 3);
+
+    v.assign(10, v[5]);
+    CHECK(v.size() == 10 && v[9] == 3);
+}
+
+static void throwing_constructor()
+{
+    const std::size_t count = COUNT / 4;
+
+    Fragile::constructed = 0;
+    Fragile::throwAt = long(count / 8 * 5);
+
+    bool thrown = false;
+    try
+    {
+        ds::vector<Fragile> v(count, ds::parallel(4));
+    }
+    catch (const std::runtime_error &)
+    {
+        thrown = true;
+    }
+
+    CHECK(thrown);
+    CHECK(Fragile::alive == 0);
+
+    Fragile::throwAt = -1;
+}
+
+// both parallel sort paths against the sequential one
+static void parallel_sort()
+{
+    std::mt19937 rng(1);
+    ds::vector<std::uint32_t> keys;
+    for (std::size_t i = 0; i < COUNT; i++)
+    {
+        keys.push_back(rng() >> (i % 3 == 0 ? 16 : 0));
+    }
+    ds::vector<std::uint32_t> expected(keys);
+    ds::sort(expected);
+
+    ds::vector<std::uint32_t> radix(keys);
+    ds::sort(radix, ds::parallel(4));
+    CHECK(radix.size() == expected.size() && std::equal(radix.begin(), radix.end(), expected.begin()));
+
+    // a comparator with no radix path: sort the parts, then merge
+    ds::vector<std::uint32_t> merged(keys);
+    ds::sort(merged, ds::parallel(4), [](std::uint32_t _a, std::uint32_t _b) { return _a < _b; });
+    CHECK(merged.size() == expected.size() && std::equal(merged.begin(), merged.end(), expected.begin()));
+}
+
+int main()
+{
+    partition();
+    construction();
+    first_touch_owner();
+    reserve_and_assign();
+    throwing_constructor();
+    parallel_sort();
+
+    if (failures != 0)
+    {
+        std::printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    std::printf("all parallel checks passed\n");
+    return 0;
+}
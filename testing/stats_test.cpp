@@ -0,0 +1,128 @@
+// Checks the memory telemetry reported by ds::vector and ds::deque and the
+// per element type totals kept by ds::stats_registry. Built with
+// DS_ENABLE_STATS.
+
+#include <cstddef>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "../include/ds/vector.hpp"
+#include "../include/ds/deque.hpp"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                           \
+    do                                                                        \
+    {                                                                         \
+        if (!(cond))                                                          \
+        {                                                                     \
+            std::printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures;                                                       \
+        }                                                                     \
+    } while (0)
+
+static const ds::stats_registry::type_totals *find(const std::vector<ds::stats_registry::type_totals> &_totals,
+                                                   const std::string &_container, const std::string &_element)
+{
+    for (const auto &t : _totals)
+    {
+        if (t.container == _container && t.element_type == _element)
+        {
+            return &t;
+        }
+    }
+    return nullptr;
+}
+
+static void vector_stats()
+{
+    ds::vector<long> v;
+    CHECK(v.stats().bytes_reserved == 0);
+    CHECK(v.stats().slack_ratio() == 0.0);
+
+    for (long i = 0; i < 5; i++)
+    {
+        v.push_back(i);
+    }
+
+    // capacities 1, 2, 4, 8: three moves of 1 + 2 + 4 elements
+    ds::container_stats s = v.stats();
+    CHECK(s.bytes_reserved == 8 * sizeof(long));
+    CHECK(s.bytes_in_use == 5 * sizeof(long));
+    CHECK(s.reallocations == 3);
+    CHECK(s.bytes_moved == 7 * sizeof(long));
+    CHECK(s.slack_ratio() == 1.0 - 5.0 / 8.0);
+
+    v.shrink_to_fit();
+    CHECK(v.stats().bytes_reserved == 5 * sizeof(long));
+    CHECK(v.stats().reallocations == 4);
+
+    ds::vector<long> moved(std::move(v));
+    CHECK(moved.stats().bytes_in_use == 5 * sizeof(long));
+    CHECK(v.stats().bytes_reserved == 0);
+}
+
+static void deque_stats()
+{
+    const std::size_t perBlock = 512 / sizeof(int);
+
+    ds::deque<int> d(perBlock * 2 + 1, 3);
+    ds::container_stats s = d.stats();
+    CHECK(s.map_slots == 3);
+    CHECK(s.blocks == 3);
+    CHECK(s.bytes_in_use == (perBlock * 2 + 1) * sizeof(int));
+    CHECK(s.bytes_reserved == 3 * (sizeof(int *) + 512));
+}
+
+static void registry_totals()
+{
+    ds::vector<short> a(100);
+    ds::vector<short> b;
+    b.reserve(1000);
+
+    {
+        ds::vector<short> gone;
+        gone.push_back(1);
+        gone.push_back(2);
+    }
+
+    auto totals = ds::stats_registry::instance().totals();
+    const auto *t = find(totals, "ds::vector", "short");
+    CHECK(t != nullptr);
+
+    if (t != nullptr)
+    {
+        CHECK(t->live == 2);
+        CHECK(t->stats.bytes_reserved == 1100 * sizeof(short));
+        CHECK(t->stats.bytes_in_use == 100 * sizeof(short));
+        // the destroyed vector's growth is kept
+        CHECK(t->stats.reallocations == 1);
+    }
+
+    auto worst = ds::stats_registry::instance().most_slack(1);
+    CHECK(worst.size() == 1);
+    CHECK(!worst.empty() && worst[0].stats.bytes_reserved == 1000 * sizeof(short));
+
+    std::ostringstream out;
+    ds::stats_registry::instance().dump(out);
+    CHECK(out.str().find("ds::vector") != std::string::npos);
+    CHECK(out.str().find("short") != std::string::npos);
+}
+
+int main()
+{
+    vector_stats();
+    deque_stats();
+    registry_totals();
+
+    if (failures != 0)
+    {
+        std::printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    std::printf("all stats checks passed\n");
+    return 0;
+}
@@ -0,0 +1,428 @@
+// Checks the containers that live in files or move data through file
+// descriptors. Every test works on its own file under the system temp
+// directory and removes it when done.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/ds/iobuf_chain.hpp"
+#include "../include/ds/mmap_vector.hpp"
+#include "../include/ds/snapshot.hpp"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                           \
+    do                                                                        \
+    {                                                                         \
+        if (!(cond))                                                          \
+        {                                                                     \
+            std::printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures;                                                       \
+        }                                                                     \
+    } while (0)
+
+// a path unique to this process and test
+static std::string temp_path(const char *_name)
+{
+    const char *dir = std::getenv("TMPDIR");
+    return std::string(dir != nullptr ? dir : "/tmp") + "/ds_storage_" + std::to_string(::getpid()) + "_" + _name;
+}
+
+static long long file_size(const std::string &_path)
+{
+    struct stat st;
+    return ::stat(_path.c_str(), &st) == 0 ? static_cast<long long>(st.st_size) : -1;
+}
+
+// flips every bit of the byte at _offset, or of the last byte if negative
+static void corrupt_byte(const std::string &_path, long long _offset)
+{
+    const int fd = ::open(_path.c_str(), O_RDWR);
+    const off_t at = _offset >= 0 ? off_t(_offset) : off_t(file_size(_path) + _offset);
+    unsigned char byte = 0;
+    CHECK(fd != -1 && ::pread(fd, &byte, 1, at) == 1);
+    byte ^= 0xff;
+    CHECK(::pwrite(fd, &byte, 1, at) == 1);
+    ::close(fd);
+}
+
+// runs _load and reports whether it threw std::runtime_error
+template <typename F>
+static bool load_rejected(F &&_load)
+{
+    try
+    {
+        _load();
+    }
+    catch (const std::runtime_error &)
+    {
+        return true;
+    }
+    return false;
+}
+
+static void mmap_vector_grow_and_reopen()
+{
+    const std::string path = temp_path("mmap");
+    ::unlink(path.c_str());
+
+    {
+        ds::mmap_vector<std::uint64_t> v(path.c_str());
+        CHECK(v.is_open() && v.empty());
+
+        // push_back doubles the mapping; values survive every remap
+        for (std::uint64_t i = 0; i < 5000; i++)
+        {
+            v.push_back(i * i);
+        }
+        CHECK(v.size() == 5000 && v.capacity() >= 5000);
+
+        v.resize(6000);
+        CHECK(v.size() == 6000 && v[5999] == 0 && v[4999] == 4999ull * 4999ull);
+
+        // pushing an element of the mapping itself while it remaps
+        v.reserve(v.size());
+        v.push_back(v[10]);
+        CHECK(v.back() == 100);
+
+        v.pop_back();
+        v.reserve(20000);
+        CHECK(file_size(path) == 20000 * static_cast<long long>(sizeof(std::uint64_t)));
+
+        // close() trims the spare capacity off the file
+        v.close();
+        CHECK(!v.is_open() && file_size(path) == 6000 * static_cast<long long>(sizeof(std::uint64_t)));
+    }
+
+    {
+        ds::mmap_vector<std::uint64_t> v(path.c_str());
+        bool same = v.size() == 6000;
+        for (std::uint64_t i = 0; same && i < 5000; i++)
+        {
+            same = v[i] == i * i;
+        }
+        CHECK(same);
+
+        v.resize(100);
+        v.shrink_to_fit();
+        CHECK(v.capacity() == 100 && file_size(path) == 100 * static_cast<long long>(sizeof(std::uint64_t)));
+        CHECK(v.at(99) == 99ull * 99ull);
+
+        bool threw = false;
+        try
+        {
+            v.at(100);
+        }
+        catch (const std::out_of_range &)
+        {
+            threw = true;
+        }
+        CHECK(threw);
+    }
+
+    ::unlink(path.c_str());
+}
+
+static void mmap_vector_read_only()
+{
+    const std::string path = temp_path("mmap_ro");
+    ::unlink(path.c_str());
+
+    {
+        ds::mmap_vector<int> v(path.c_str());
+        for (int i = 0; i < 300; i++)
+        {
+            v.push_back(i);
+        }
+    }
+
+    ds::mmap_vector<int> v(path.c_str(), ds::mmap_vector<int>::mode::read_only);
+    CHECK(v.read_only() && v.size() == 300 && v[299] == 299);
+
+    bool threw = false;
+    try
+    {
+        v.push_back(1);
+    }
+    catch (const std::logic_error &)
+    {
+        threw = true;
+    }
+    CHECK(threw && v.size() == 300);
+
+    // closing a read-only mapping leaves the file alone
+    v.close();
+    CHECK(file_size(path) == 300 * static_cast<long long>(sizeof(int)));
+
+    // a file that is not a whole number of elements is refused
+    ::truncate(path.c_str(), 301 * sizeof(int) - 1);
+    threw = false;
+    try
+    {
+        ds::mmap_vector<int> broken(path.c_str(), ds::mmap_vector<int>::mode::read_only);
+    }
+    catch (const std::runtime_error &)
+    {
+        threw = true;
+    }
+    CHECK(threw);
+
+    ::unlink(path.c_str());
+}
+
+static void snapshot_round_trip()
+{
+    const std::string path = temp_path("snapshot");
+
+    ds::vector<std::uint64_t> v;
+    for (std::uint64_t i = 0; i < 100000; i++)
+    {
+        v.push_back(i * 2654435761u);
+    }
+    ds::save(v, path.c_str());
+
+    ds::vector<std::uint64_t> back;
+    back.push_back(7);
+    ds::load(back, path.c_str());
+    CHECK(back.size() == v.size() && std::equal(v.begin(), v.end(), back.begin()));
+    CHECK(::access((path + ".tmp").c_str(), F_OK) != 0);
+
+    // a deque's blocks go out as separate segments of the same layout
+    ds::deque<int> d(100000);
+    for (std::size_t i = 0; i < d.size(); i++)
+    {
+        d[i] = int(i * 7 % 1000);
+    }
+    ds::save(d, path.c_str());
+
+    ds::deque<int> dback;
+    ds::load(dback, path.c_str());
+    CHECK(dback.size() == d.size() && std::equal(d.begin(), d.end(), dback.begin()));
+
+    // the file only depends on the elements, not on where they lived
+    ds::vector<int> flat;
+    ds::load(flat, path.c_str());
+    CHECK(flat.size() == d.size() && std::equal(d.begin(), d.end(), flat.begin()));
+
+    ds::vector<int> none;
+    ds::save(none, path.c_str());
+    ds::load(flat, path.c_str());
+    CHECK(flat.empty());
+
+    ::unlink(path.c_str());
+}
+
+static void snapshot_rejects_damage()
+{
+    const std::string path = temp_path("snapshot_bad");
+
+    ds::vector<int> v;
+    for (int i = 0; i < 1000; i++)
+    {
+        v.push_back(i);
+    }
+    ds::save(v, path.c_str());
+
+    // the wrong element type is refused before anything is read
+    ds::vector<long long> wide;
+    CHECK(load_rejected([&]
+                        { ds::load(wide, path.c_str()); }));
+
+    // a damaged payload byte fails its chunk checksum; the target keeps
+    // its old contents
+    ds::vector<int> target;
+    target.push_back(42);
+    corrupt_byte(path, -1);
+    CHECK(load_rejected([&]
+                        { ds::load(target, path.c_str()); }));
+    CHECK(target.size() == 1 && target[0] == 42);
+
+    // so does a damaged header checksum
+    ds::save(v, path.c_str());
+    corrupt_byte(path, offsetof(ds::detail::snapshot_header, headerChecksum));
+    CHECK(load_rejected([&]
+                        { ds::load(target, path.c_str()); }));
+    CHECK(target.size() == 1);
+
+    // and a file cut short
+    ds::save(v, path.c_str());
+    CHECK(::truncate(path.c_str(), file_size(path) - 1) == 0);
+    CHECK(load_rejected([&]
+                        { ds::load(target, path.c_str()); }));
+
+    ::unlink(path.c_str());
+    CHECK(load_rejected([&]
+                        { ds::load(target, path.c_str()); }));
+    CHECK(target.size() == 1);
+
+    // a save that fails after writing its temporary removes it again; here
+    // the rename fails because the target is a directory
+    const std::string dir = temp_path("snapshot_dir");
+    CHECK(::mkdir(dir.c_str(), 0755) == 0);
+    bool threw = false;
+    try
+    {
+        ds::save(v, dir.c_str());
+    }
+    catch (const std::system_error &)
+    {
+        threw = true;
+    }
+    CHECK(threw && ::access((dir + ".tmp").c_str(), F_OK) != 0);
+    ::rmdir(dir.c_str());
+}
+
+// the whole chain as one string
+static std::string contents(const ds::iobuf_chain &_chain)
+{
+    std::string out(_chain.size(), '\0');
+    _chain.copy_to(&out[0], 0, out.size());
+    return out;
+}
+
+static void iobuf_chain_blocks()
+{
+    ds::iobuf_chain chain(16);
+
+    // prepare hands out the free space block by block
+    iovec iov[8];
+    int used = chain.prepare(40, iov, 8);
+    CHECK(used == 3 && iov[0].iov_len == 16 && iov[1].iov_len == 16 && iov[2].iov_len == 8);
+    CHECK(chain.prepare(40, iov, 1) == 1 && iov[0].iov_len == 16);
+
+    std::string model;
+    used = chain.prepare(40, iov, 8);
+    for (int i = 0; i < used; i++)
+    {
+        char *p = static_cast<char *>(iov[i].iov_base);
+        for (std::size_t j = 0; j < iov[i].iov_len; j++)
+        {
+            p[j] = char('a' + model.size() % 26);
+            model += p[j];
+        }
+    }
+    chain.commit(40);
+    CHECK(chain.size() == 40 && chain.block_count() == 3 && contents(chain) == model);
+
+    // consuming across a block boundary releases the front block
+    chain.consume(20);
+    model.erase(0, 20);
+    CHECK(chain.size() == 20 && chain.block_count() == 2);
+    CHECK(chain.readable(iov, 8) == 2 && iov[0].iov_len == 12 && iov[1].iov_len == 8);
+
+    char part[10];
+    CHECK(chain.copy_to(part, 5, 10) == 10 && std::string(part, 10) == model.substr(5, 10));
+    CHECK(chain.copy_to(part, 15, 10) == 5 && chain.copy_to(part, 20, 10) == 0);
+
+    // uneven appends and consumes wrap the ring many times
+    for (int round = 0; round < 500; round++)
+    {
+        std::string data;
+        for (int i = 0; i < round % 37 + 1; i++)
+        {
+            data += char('A' + (round + i) % 26);
+        }
+        chain.append(data.data(), data.size());
+        model += data;
+
+        const std::size_t drop = std::min<std::size_t>(model.size(), round % 41);
+        chain.consume(drop);
+        model.erase(0, drop);
+    }
+    CHECK(chain.size() == model.size() && contents(chain) == model);
+    CHECK(chain.block_count() * chain.block_size() < model.size() + 2 * chain.block_size());
+
+    bool threw = false;
+    try
+    {
+        chain.consume(chain.size() + 1);
+    }
+    catch (const std::out_of_range &)
+    {
+        threw = true;
+    }
+    CHECK(threw && contents(chain) == model);
+
+    threw = false;
+    try
+    {
+        chain.commit(chain.block_count() * chain.block_size());
+    }
+    catch (const std::out_of_range &)
+    {
+        threw = true;
+    }
+    CHECK(threw && chain.size() == model.size());
+
+    ds::iobuf_chain moved(std::move(chain));
+    CHECK(chain.empty() && contents(moved) == model);
+
+    moved.clear();
+    CHECK(moved.empty() && moved.block_count() <= 1);
+}
+
+static void iobuf_chain_pipe()
+{
+    int fds[2];
+    CHECK(::pipe(fds) == 0);
+
+    ds::iobuf_chain out(64);
+    std::string model;
+    for (int i = 0; i < 20000; i++)
+    {
+        model += char(i * 31 % 251);
+    }
+    out.append(model.data(), model.size());
+
+    // writev drains the chain in as many calls as the pipe needs
+    while (!out.empty())
+    {
+        CHECK(out.write_to(fds[1]) > 0);
+    }
+    CHECK(out.write_to(fds[1]) == 0);
+    ::close(fds[1]);
+
+    // readv lands the bytes in fresh blocks, a few hundred at a time
+    ds::iobuf_chain in(64);
+    for (;;)
+    {
+        const ssize_t n = in.read_from(fds[0], 300);
+        CHECK(n >= 0 && n <= 300);
+        if (n <= 0)
+        {
+            break;
+        }
+    }
+    ::close(fds[0]);
+
+    CHECK(in.size() == model.size() && contents(in) == model);
+}
+
+int main()
+{
+    mmap_vector_grow_and_reopen();
+    mmap_vector_read_only();
+    snapshot_round_trip();
+    snapshot_rejects_damage();
+    iobuf_chain_blocks();
+    iobuf_chain_pipe();
+
+    if (failures != 0)
+    {
+        std::printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    std::printf("all storage checks passed\n");
+    return 0;
+}